@@ -6,6 +6,8 @@
 
 #include <QObject>
 
+class ConfigStore;
+
 /**
  * @brief 应用程序上下文单例类
  * 
@@ -40,6 +42,7 @@ private:
     PlayState m_playState{PlayState::StoppedState};
 
     std::shared_ptr<AppData> m_appData;
+    ConfigStore             *m_configStore;
 
 private:
     explicit AppContext(QObject *parent = nullptr);
@@ -1,29 +1,140 @@
 #include "appdata.h"
+#include "configstore.h"
+#include <QDebug>
 #include <QFileInfo>
+#include <QJsonArray>
+
+namespace {
+
+QJsonObject fileToJson(const PlayFile &file)
+{
+    QJsonObject obj;
+    obj["name"] = file.filename_;
+    obj["path"] = file.filepath_;
+    return obj;
+}
+
+PlayFile fileFromJson(const QJsonObject &obj)
+{
+    return PlayFile{obj["name"].toString(), obj["path"].toString()};
+}
+
+EqualizerSettings equalizerFromJson(const QJsonObject &obj)
+{
+    EqualizerSettings settings;
+    settings.enabled = obj["enabled"].toBool();
+    settings.preampDb = float(obj["preamp"].toDouble());
+    settings.bassBoostDb = float(obj["bass"].toDouble());
+    const QJsonArray bands = obj["bands"].toArray();
+    for (int i = 0; i < EqualizerSettings::kBands && i < bands.size(); ++i)
+        settings.bandsDb[i] = float(bands[i].toDouble());
+    return settings;
+}
+
+} // namespace
 
 AppData::AppData() {}
 
+bool AppData::applyChange(const QJsonObject &change)
+{
+    const QString op = change["op"].toString();
+    const QString album = change["album"].toString();
+
+    m_replaying = true;
+    bool known = true;
+    if (op == "add") {
+        if (album.isEmpty())
+            addPlayFileToDefAlbum(fileFromJson(change));
+        else
+            addPlayFileToCusAlbum(album, fileFromJson(change));
+    } else if (op == "add_many") {
+        QList<PlayFile> files;
+        for (const QJsonValue &value : change["files"].toArray())
+            files.append(fileFromJson(value.toObject()));
+        addPlayFilesToDefAlbum(files);
+    } else if (op == "delete") {
+        if (album.isEmpty())
+            deletePlayFileFromDefAlbum(change["name"].toString());
+        else
+            deletePlayFileFromCusAlbum(album, change["name"].toString());
+    } else if (op == "album") {
+        addCustomAlbum(change["name"].toString());
+    } else if (op == "rename") {
+        renamePlayFile(change["from"].toString(), change["to"].toString());
+    } else if (op == "volume") {
+        setVolume(change["value"].toInt());
+    } else if (op == "mute") {
+        setMute(change["value"].toBool());
+    } else if (op == "replaygain") {
+        setReplayGainMode(static_cast<ReplayGainMode>(change["value"].toInt()));
+    } else if (op == "equalizer") {
+        setEqualizer(equalizerFromJson(change));
+    } else if (op == "downmix") {
+        setDownmixMode(static_cast<DownmixMode>(change["value"].toInt()));
+    } else if (op == "audioOnly") {
+        setAudioOnly(change["value"].toBool());
+    } else if (op == "syncMaster") {
+        setSyncMaster(static_cast<SyncMaster>(change["value"].toInt()));
+    } else {
+        known = false;
+    }
+    m_replaying = false;
+    return known;
+}
+
 void AppData::addPlayFileToDefAlbum(const PlayFile &file)
 {
     m_defaultAlbum.addPlayFile(file);
+
+    QJsonObject change = fileToJson(file);
+    change["op"] = "add";
+    notify(change);
+}
+
+void AppData::addPlayFilesToDefAlbum(const QList<PlayFile> &files)
+{
+    if (files.isEmpty())
+        return;
+
+    // 整批一条记录，拖入大文件夹时日志只追加一行
+    QJsonArray array;
+    for (const PlayFile &file : files) {
+        m_defaultAlbum.addPlayFile(file);
+        array.append(fileToJson(file));
+    }
+
+    QJsonObject change;
+    change["op"] = "add_many";
+    change["files"] = array;
+    notify(change);
 }
 
 void AppData::deletePlayFileFromDefAlbum(const QString &filename)
 {
     m_defaultAlbum.deletePlayFile(filename);
+
+    QJsonObject change;
+    change["op"] = "delete";
+    change["name"] = filename;
+    notify(change);
 }
 
 void AppData::addPlayFileToDefAlbum(const QString &filepath)
 {
     QFileInfo info(filepath);
     if (info.isFile()) {
-        m_defaultAlbum.addPlayFile({info.fileName(), filepath});
+        addPlayFileToDefAlbum(PlayFile{info.fileName(), filepath});
     }
 }
 
 void AppData::addCustomAlbum(const QString &albumName)
 {
     m_customAlbums.append(Album(albumName));
+
+    QJsonObject change;
+    change["op"] = "album";
+    change["name"] = albumName;
+    notify(change);
 }
 
 void AppData::addPlayFileToCusAlbum(const QString &albumName, const PlayFile &file)
@@ -34,6 +145,11 @@ void AppData::addPlayFileToCusAlbum(const QString &albumName, const PlayFile &fi
             break;
         }
     }
+
+    QJsonObject change = fileToJson(file);
+    change["op"] = "add";
+    change["album"] = albumName;
+    notify(change);
 }
 
 void AppData::deletePlayFileFromCusAlbum(const QString &albumName, const QString &filename)
@@ -44,14 +160,144 @@ void AppData::deletePlayFileFromCusAlbum(const QString &albumName, const QString
             break;
         }
     }
+
+    QJsonObject change;
+    change["op"] = "delete";
+    change["album"] = albumName;
+    change["name"] = filename;
+    notify(change);
+}
+
+void AppData::renamePlayFile(const QString &from, const QString &to)
+{
+    bool renamed = m_defaultAlbum.renamePlayFile(from, to);
+    for (Album &album : m_customAlbums)
+        renamed = album.renamePlayFile(from, to) || renamed;
+    if (!renamed)
+        return;
+
+    QJsonObject change;
+    change["op"] = "rename";
+    change["from"] = from;
+    change["to"] = to;
+    notify(change);
+}
+
+void AppData::setVolume(int volume)
+{
+    if (m_volume == volume)
+        return;
+    m_volume = volume;
+
+    QJsonObject change;
+    change["op"] = "volume";
+    change["value"] = volume;
+    notify(change);
+}
+
+void AppData::setMute(bool isMute)
+{
+    if (m_isMute == isMute)
+        return;
+    m_isMute = isMute;
+
+    QJsonObject change;
+    change["op"] = "mute";
+    change["value"] = isMute;
+    notify(change);
+}
+
+void AppData::setReplayGainMode(ReplayGainMode mode)
+{
+    if (m_replayGainMode == mode)
+        return;
+    m_replayGainMode = mode;
+
+    QJsonObject change;
+    change["op"] = "replaygain";
+    change["value"] = static_cast<int>(mode);
+    notify(change);
+}
+
+void AppData::setEqualizer(const EqualizerSettings &settings)
+{
+    if (m_equalizer == settings)
+        return;
+    m_equalizer = settings;
+
+    QJsonObject change;
+    change["op"] = "equalizer";
+    change["enabled"] = settings.enabled;
+    change["preamp"] = settings.preampDb;
+    change["bass"] = settings.bassBoostDb;
+    QJsonArray bands;
+    for (float db : settings.bandsDb)
+        bands.append(db);
+    change["bands"] = bands;
+    notify(change);
+}
+
+void AppData::setDownmixMode(DownmixMode mode)
+{
+    if (m_downmixMode == mode)
+        return;
+    m_downmixMode = mode;
+
+    QJsonObject change;
+    change["op"] = "downmix";
+    change["value"] = static_cast<int>(mode);
+    notify(change);
+}
+
+void AppData::setAudioOnly(bool audioOnly)
+{
+    if (m_audioOnly == audioOnly)
+        return;
+    m_audioOnly = audioOnly;
+
+    QJsonObject change;
+    change["op"] = "audioOnly";
+    change["value"] = audioOnly;
+    notify(change);
+}
+
+void AppData::setSyncMaster(SyncMaster master)
+{
+    if (m_syncMaster == master)
+        return;
+    m_syncMaster = master;
+
+    QJsonObject change;
+    change["op"] = "syncMaster";
+    change["value"] = static_cast<int>(master);
+    notify(change);
+}
+
+void AppData::notify(const QJsonObject &change)
+{
+    if (m_changeHandler && !m_replaying)
+        m_changeHandler(change);
 }
 
 Album::Album(const QString &name)
     : m_name(name)
 {}
 
+const QList<PlayFile> &Album::getPlayfiles() const
+{
+    ensureLoaded();
+    return m_files;
+}
+
+void Album::addPlayFile(const PlayFile &file)
+{
+    ensureLoaded();
+    m_files.append(file);
+}
+
 void Album::deletePlayFile(const QString &filename)
 {
+    ensureLoaded();
     for (auto iter = m_files.begin(); iter != m_files.end();) {
         if ((*iter).filename_ == filename)
             iter = m_files.erase(iter);
@@ -59,3 +305,41 @@ void Album::deletePlayFile(const QString &filename)
             ++iter;
     }
 }
+
+bool Album::mayContain(const QString &filepath) const
+{
+    if (isLoaded())
+        return true;
+    // 在原文中查找（JSON只转义反斜杠与引号）
+    QByteArray escaped = filepath.toUtf8();
+    escaped.replace('\\', "\\\\").replace('"', "\\\"");
+    return m_pendingFiles.contains(escaped);
+}
+
+bool Album::renamePlayFile(const QString &from, const QString &to)
+{
+    // 未解析的专辑不包含该路径时无需解析
+    if (!mayContain(from))
+        return false;
+    ensureLoaded();
+
+    bool renamed = false;
+    for (PlayFile &file : m_files) {
+        if (file.filepath_ == from) {
+            file.filepath_ = to;
+            file.filename_ = QFileInfo(to).fileName();
+            renamed = true;
+        }
+    }
+    return renamed;
+}
+
+void Album::ensureLoaded() const
+{
+    if (m_pendingFiles.isEmpty())
+        return;
+    const QByteArray json = m_pendingFiles;
+    m_pendingFiles.clear();
+    if (!ConfigStore::parsePlayFiles(json, m_files))
+        qWarning() << "parse album files failed:" << m_name;
+}
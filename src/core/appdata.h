@@ -1,69 +1,133 @@
 #ifndef APPDATA_H
 #define APPDATA_H
 
-#include <obj_conv/reflex_format.hpp>
+#include "constants.h"
+
+#include <functional>
+#include <QByteArray>
+#include <QJsonObject>
 #include <QList>
+#include <QString>
 
 struct PlayFile
 {
     QString filename_;
     QString filepath_;
-
-    REFLEX_BIND(A(filename_, "filename"), A(filepath_, "filepath"))
 };
 
+/**
+ * @brief 专辑 - 文件列表可延迟解析
+ *
+ * 加载配置时未显示的专辑只保存 files 数组的JSON原文，第一次访问或修改文件列表时才解析；
+ * 未解析的专辑写快照时原文照抄。
+ */
 class Album
 {
 public:
     Album() = default;
     Album(const QString &name);
 
-    QString getAlbumName() const { return m_name; }
-    void    setAlbumName(const QString &name) { m_name = name; }
+    const QString &getAlbumName() const { return m_name; }
+    void           setAlbumName(const QString &name) { m_name = name; }
+
+    const QList<PlayFile> &getPlayfiles() const;
+    void                   addPlayFile(const PlayFile &file);
+    void                   deletePlayFile(const QString &filename);
+    bool                   renamePlayFile(const QString &from, const QString &to);
+
+    // 延迟解析：json 为 files 数组的原文
+    void              setPendingFiles(const QByteArray &json) { m_pendingFiles = json; }
+    bool              isLoaded() const { return m_pendingFiles.isEmpty(); }
+    const QByteArray &pendingFiles() const { return m_pendingFiles; }
 
-    QList<PlayFile> getPlayfiles() const { return m_files; }
-    void            addPlayFile(const PlayFile &file) { m_files.append(file); }
-    void            deletePlayFile(const QString &filename);
+    // 专辑可能包含该路径：未解析时只在原文中查找，不会触发解析；返回true时仍需解析后确认
+    bool mayContain(const QString &filepath) const;
 
 private:
-    QString         m_name{"默认专辑"};
-    QList<PlayFile> m_files;
+    void ensureLoaded() const;
 
-    REFLEX_BIND(A(m_name, "name"), A(m_files, "files"))
+    QString                 m_name{"默认专辑"};
+    mutable QList<PlayFile> m_files;
+    mutable QByteArray      m_pendingFiles;
 };
 
+/**
+ * @brief 应用数据 - 专辑与播放设置
+ *
+ * 每次修改都以一条变更记录（QJsonObject）通知 ChangeHandler，由 ConfigStore 追加到日志；
+ * 启动时 applyChange 按顺序重放日志恢复上次未写入快照的修改。
+ */
 class AppData
 {
 public:
+    using ChangeHandler = std::function<void(const QJsonObject &change)>;
+
     AppData();
 
-    QString getDefaultAlbumName() { return m_defaultAlbum.getAlbumName(); }
-    Album   getDefaultAlbum() const { return m_defaultAlbum; }
-    void    addPlayFileToDefAlbum(const PlayFile &file);
-    void    deletePlayFileFromDefAlbum(const QString &filename);
-    void    addPlayFileToDefAlbum(const QString &filepath);
+    void setChangeHandler(const ChangeHandler &handler) { m_changeHandler = handler; }
+
+    // 重放一条变更记录（不会再次通知 ChangeHandler）
+    bool applyChange(const QJsonObject &change);
+
+    // 快照已包含的最后一条日志序号
+    qint64 getJournalSeq() const { return m_journalSeq; }
+    void   setJournalSeq(qint64 seq) { m_journalSeq = seq; }
 
-    QList<Album> getCustomAlbums() const { return m_customAlbums; }
-    void         addCustomAlbum(const QString &albumName);
-    void         addPlayFileToCusAlbum(const QString &albumName, const PlayFile &file);
-    void         deletePlayFileFromCusAlbum(const QString &albumName, const QString &filename);
+    QString      getDefaultAlbumName() const { return m_defaultAlbum.getAlbumName(); }
+    const Album &getDefaultAlbum() const { return m_defaultAlbum; }
+    void         addPlayFileToDefAlbum(const PlayFile &file);
+    void         addPlayFilesToDefAlbum(const QList<PlayFile> &files);
+    void         deletePlayFileFromDefAlbum(const QString &filename);
+    void         addPlayFileToDefAlbum(const QString &filepath);
+
+    const QList<Album> &getCustomAlbums() const { return m_customAlbums; }
+    void                addCustomAlbum(const QString &albumName);
+    void                addPlayFileToCusAlbum(const QString &albumName, const PlayFile &file);
+    void                deletePlayFileFromCusAlbum(const QString &albumName, const QString &filename);
+
+    // 文件被重命名或移动后同步更新所有专辑中的路径
+    void renamePlayFile(const QString &from, const QString &to);
 
     int  getVolume() const { return m_volume; }
-    void setVolume(int volume) { m_volume = volume; }
+    void setVolume(int volume);
 
     bool isMute() const { return m_isMute; }
-    void setMute(bool isMute) { m_isMute = isMute; }
+    void setMute(bool isMute);
+
+    ReplayGainMode getReplayGainMode() const { return m_replayGainMode; }
+    void           setReplayGainMode(ReplayGainMode mode);
+
+    const EqualizerSettings &getEqualizer() const { return m_equalizer; }
+    void                     setEqualizer(const EqualizerSettings &settings);
+
+    DownmixMode getDownmixMode() const { return m_downmixMode; }
+    void        setDownmixMode(DownmixMode mode);
+
+    bool isAudioOnly() const { return m_audioOnly; }
+    void setAudioOnly(bool audioOnly);
+
+    SyncMaster getSyncMaster() const { return m_syncMaster; }
+    void       setSyncMaster(SyncMaster master);
 
 private:
-    Album        m_defaultAlbum;
-    QList<Album> m_customAlbums;
-    int          m_volume{50};
-    bool         m_isMute{false};
-
-    REFLEX_BIND(A(m_defaultAlbum, "defaultAlbum"),
-                A(m_customAlbums, "customAlbums"),
-                A(m_volume, "volume"),
-                A(m_isMute, "isMute"))
+    void notify(const QJsonObject &change);
+
+    // 配置的读写直接访问各字段
+    friend class ConfigStore;
+
+    Album             m_defaultAlbum;
+    QList<Album>      m_customAlbums;
+    int               m_volume{50};
+    bool              m_isMute{false};
+    ReplayGainMode    m_replayGainMode{ReplayGainMode::Off};
+    EqualizerSettings m_equalizer;
+    DownmixMode       m_downmixMode{DownmixMode::Auto};
+    bool              m_audioOnly{false};
+    SyncMaster        m_syncMaster{SyncMaster::Auto};
+    qint64            m_journalSeq{0};
+
+    ChangeHandler m_changeHandler;
+    bool          m_replaying{false};
 };
 
 #endif // APPDATA_H
@@ -73,7 +73,9 @@ bool Application::initializeHotkey()
                                          {K_PlaySelected, "Enter"},
                                          {K_PausePlay, "Space"},
                                          {K_NextPlay, "Right"},
-                                         {K_PrevPlay, "Left"}};
+                                         {K_PrevPlay, "Left"},
+                                         {K_StepForward, "."},
+                                         {K_StepBackward, ","}};
     for (auto it = hotkeys.begin(); it != hotkeys.end(); ++it) {
         ShortcutManager::instance()->registerHotkey(it.value(), it.key());
     }
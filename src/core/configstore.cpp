@@ -0,0 +1,608 @@
+#include "configstore.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QTextCodec>
+#include <rapidjson/reader.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <string>
+#include <vector>
+
+// 最后一次修改后延迟写快照（毫秒）
+static constexpr int kSaveDelayMs = 3000;
+// 日志累积到该条数时尽快压缩
+static constexpr int kCompactRecords = 2000;
+// 日志缓冲的刷新间隔（毫秒）
+static constexpr int kFlushIntervalMs = 100;
+
+namespace {
+
+/**
+ * @brief ConfigSaxHandler - 流式解析配置，不构建DOM
+ *
+ * 默认专辑立即解析；lazyAlbums 为true时自定义专辑的 files 数组只记录原文区间，由 Album 首次访问时再解析。
+ */
+class ConfigSaxHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, ConfigSaxHandler>
+{
+public:
+    enum class Scope { Root, Album, AlbumList, FileList, File, Equalizer, EqualizerBands, Unknown };
+
+    ConfigSaxHandler(const rapidjson::StringStream &stream, const char *json, bool lazyAlbums)
+        : m_stream(stream)
+        , m_json(json)
+        , m_lazyAlbums(lazyAlbums)
+    {}
+
+    // 从 files 数组开始解析（只解析文件列表）
+    void beginFileList()
+    {
+        m_scopes.push_back(Scope::Album);
+        m_key = "files";
+    }
+
+    bool StartObject()
+    {
+        if (m_rawDepth > 0) {
+            ++m_rawDepth;
+            return true;
+        }
+
+        Scope scope = Scope::Unknown;
+        if (m_scopes.empty()) {
+            scope = Scope::Root;
+        } else if (m_scopes.back() == Scope::Root && m_key == "defaultAlbum") {
+            scope = Scope::Album;
+        } else if (m_scopes.back() == Scope::Root && m_key == "equalizer") {
+            scope = Scope::Equalizer;
+        } else if (m_scopes.back() == Scope::AlbumList) {
+            scope = Scope::Album;
+        } else if (m_scopes.back() == Scope::FileList) {
+            scope = Scope::File;
+            m_file = PlayFile();
+        }
+        if (scope == Scope::Album)
+            m_album = Album();
+        m_scopes.push_back(scope);
+        return true;
+    }
+
+    bool EndObject(rapidjson::SizeType)
+    {
+        if (m_rawDepth > 0) {
+            --m_rawDepth;
+            return true;
+        }
+
+        const Scope scope = m_scopes.back();
+        m_scopes.pop_back();
+        if (scope == Scope::File) {
+            m_files.append(m_file);
+        } else if (scope == Scope::Album) {
+            if (!m_scopes.empty() && m_scopes.back() == Scope::AlbumList)
+                customAlbums.append(m_album);
+            else
+                defaultAlbum = m_album;
+        }
+        return true;
+    }
+
+    bool StartArray()
+    {
+        if (m_rawDepth > 0) {
+            ++m_rawDepth;
+            return true;
+        }
+
+        Scope scope = Scope::Unknown;
+        if (m_scopes.empty()) {
+            // 根不是对象，按未知内容跳过
+        } else if (m_scopes.back() == Scope::Root && m_key == "customAlbums") {
+            scope = Scope::AlbumList;
+        } else if (m_scopes.back() == Scope::Equalizer && m_key == "bands") {
+            scope = Scope::EqualizerBands;
+            m_bandIndex = 0;
+        } else if (m_scopes.back() == Scope::Album && m_key == "files") {
+            const bool custom = m_scopes.size() >= 2 && m_scopes[m_scopes.size() - 2] == Scope::AlbumList;
+            if (m_lazyAlbums && custom) {
+                // '[' 已被读取
+                m_rawStart = m_stream.Tell() - 1;
+                m_rawDepth = 1;
+                return true;
+            }
+            scope = Scope::FileList;
+            m_files.clear();
+        }
+        m_scopes.push_back(scope);
+        return true;
+    }
+
+    bool EndArray(rapidjson::SizeType)
+    {
+        if (m_rawDepth > 0) {
+            if (--m_rawDepth == 0)
+                m_album.setPendingFiles(QByteArray(m_json + m_rawStart, int(m_stream.Tell() - m_rawStart)));
+            return true;
+        }
+
+        const Scope scope = m_scopes.back();
+        m_scopes.pop_back();
+        if (scope == Scope::FileList) {
+            for (const PlayFile &file : qAsConst(m_files))
+                m_album.addPlayFile(file);
+            files = m_files;
+        }
+        return true;
+    }
+
+    bool Key(const char *str, rapidjson::SizeType length, bool)
+    {
+        if (m_rawDepth == 0)
+            m_key.assign(str, length);
+        return true;
+    }
+
+    bool String(const char *str, rapidjson::SizeType length, bool)
+    {
+        if (m_rawDepth > 0 || m_scopes.empty())
+            return true;
+
+        const Scope scope = m_scopes.back();
+        if (scope == Scope::Album && m_key == "name")
+            m_album.setAlbumName(QString::fromUtf8(str, int(length)));
+        else if (scope == Scope::File && m_key == "filename")
+            m_file.filename_ = QString::fromUtf8(str, int(length));
+        else if (scope == Scope::File && m_key == "filepath")
+            m_file.filepath_ = QString::fromUtf8(str, int(length));
+        return true;
+    }
+
+    bool Int(int value) { return Int64(value); }
+    bool Uint(unsigned value) { return Int64(value); }
+    bool Uint64(uint64_t value) { return Int64(int64_t(value)); }
+    bool Int64(int64_t value)
+    {
+        if (m_rawDepth > 0 || m_scopes.empty())
+            return true;
+        // 均衡器中整数形式的dB值
+        if (m_scopes.back() != Scope::Root)
+            return Double(double(value));
+
+        if (m_key == "volume")
+            volume = int(value);
+        else if (m_key == "journalSeq")
+            journalSeq = value;
+        else if (m_key == "replayGain" && value >= 0 && value <= int(ReplayGainMode::Album))
+            replayGainMode = static_cast<ReplayGainMode>(value);
+        else if (m_key == "downmix" && value >= 0 && value <= int(DownmixMode::Binaural))
+            downmixMode = static_cast<DownmixMode>(value);
+        else if (m_key == "syncMaster" && value >= 0 && value <= int(SyncMaster::External))
+            syncMaster = static_cast<SyncMaster>(value);
+        else if (m_key == "isMute") // 兼容以整数保存的布尔值
+            isMute = value != 0;
+        return true;
+    }
+
+    bool Double(double value)
+    {
+        if (m_rawDepth > 0 || m_scopes.empty())
+            return true;
+
+        const Scope  scope = m_scopes.back();
+        const double limit = EqualizerSettings::kMaxGainDb;
+        const float  db = float(qBound(-limit, value, limit));
+        if (scope == Scope::Equalizer && m_key == "preamp")
+            equalizer.preampDb = db;
+        else if (scope == Scope::Equalizer && m_key == "bass")
+            equalizer.bassBoostDb = db;
+        else if (scope == Scope::EqualizerBands && m_bandIndex < EqualizerSettings::kBands)
+            equalizer.bandsDb[m_bandIndex++] = db;
+        return true;
+    }
+
+    bool Bool(bool value)
+    {
+        if (m_rawDepth > 0 || m_scopes.empty())
+            return true;
+
+        const Scope scope = m_scopes.back();
+        if (scope == Scope::Root && m_key == "isMute")
+            isMute = value;
+        else if (scope == Scope::Root && m_key == "audioOnly")
+            audioOnly = value;
+        else if (scope == Scope::Equalizer && m_key == "enabled")
+            equalizer.enabled = value;
+        return true;
+    }
+
+    // 解析结果
+    Album             defaultAlbum;
+    QList<Album>      customAlbums;
+    QList<PlayFile>   files; // beginFileList 模式下的结果
+    int               volume{50};
+    bool              isMute{false};
+    ReplayGainMode    replayGainMode{ReplayGainMode::Off};
+    EqualizerSettings equalizer;
+    DownmixMode       downmixMode{DownmixMode::Auto};
+    bool              audioOnly{false};
+    SyncMaster        syncMaster{SyncMaster::Auto};
+    qint64            journalSeq{0};
+
+private:
+    const rapidjson::StringStream &m_stream;
+    const char                    *m_json;
+    bool                           m_lazyAlbums;
+
+    std::vector<Scope> m_scopes;
+    std::string        m_key;
+    Album              m_album;
+    PlayFile           m_file;
+    QList<PlayFile>    m_files;
+    size_t             m_rawStart{0};
+    int                m_rawDepth{0}; // 大于0时处于延迟解析的 files 数组内
+    int                m_bandIndex{0};
+};
+
+template<typename Writer>
+void writeString(Writer &writer, const QString &text)
+{
+    const QByteArray utf8 = text.toUtf8();
+    writer.String(utf8.constData(), rapidjson::SizeType(utf8.size()));
+}
+
+template<typename Writer>
+void writeAlbum(Writer &writer, const Album &album)
+{
+    writer.StartObject();
+    writer.Key("name");
+    writeString(writer, album.getAlbumName());
+    writer.Key("files");
+    if (!album.isLoaded()) {
+        // 未解析过的文件列表原文照抄
+        const QByteArray &raw = album.pendingFiles();
+        writer.RawValue(raw.constData(), size_t(raw.size()), rapidjson::kArrayType);
+    } else {
+        writer.StartArray();
+        for (const PlayFile &file : album.getPlayfiles()) {
+            writer.StartObject();
+            writer.Key("filename");
+            writeString(writer, file.filename_);
+            writer.Key("filepath");
+            writeString(writer, file.filepath_);
+            writer.EndObject();
+        }
+        writer.EndArray();
+    }
+    writer.EndObject();
+}
+
+} // namespace
+
+/**
+ * @brief ConfigSaveTask - 在后台线程序列化 AppData 副本并原子写入快照
+ */
+class ConfigSaveTask : public QRunnable
+{
+public:
+    ConfigSaveTask(ConfigStore *store, const AppData &data, const QString &path)
+        : m_store(store)
+        , m_data(data)
+        , m_path(path)
+    {}
+
+    void run() override
+    {
+        const bool ok = ConfigStore::writeSnapshot(m_data, m_path);
+        // close() 会等待线程池，此处指针一定有效
+        ConfigStore *store = m_store;
+        QMetaObject::invokeMethod(
+            store, [store, ok]() { store->onSaveFinished(ok); }, Qt::QueuedConnection);
+    }
+
+private:
+    ConfigStore *m_store;
+    AppData      m_data;
+    QString      m_path;
+};
+
+ConfigStore::ConfigStore(const QString &path, std::shared_ptr<AppData> data, QObject *parent)
+    : QObject(parent)
+    , m_path(path)
+    , m_journalPath(path + ".journal")
+    , m_sealedPath(path + ".journal.1")
+    , m_badPath(path + ".bad")
+    , m_data(std::move(data))
+{
+    m_worker.setMaxThreadCount(1);
+
+    m_saveTimer.setSingleShot(true);
+    connect(&m_saveTimer, &QTimer::timeout, this, &ConfigStore::startSave);
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(kFlushIntervalMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, [this]() { m_journal.flush(); });
+}
+
+ConfigStore::~ConfigStore()
+{
+    close();
+}
+
+bool ConfigStore::load()
+{
+    bool ok = true;
+    if (QFileInfo(m_path).isFile()) {
+        QFile file(m_path);
+        if (file.open(QIODevice::ReadOnly)) {
+            QByteArray bytes = file.readAll();
+            // 旧版本按本地编码写入，非UTF-8时先转换
+            QTextCodec::ConverterState state;
+            QTextCodec::codecForName("UTF-8")->toUnicode(bytes.constData(), bytes.size(), &state);
+            if (state.invalidChars > 0)
+                bytes = QString::fromLocal8Bit(bytes).toUtf8();
+
+            ok = readSnapshot(bytes);
+            file.close();
+            // 解析失败的快照可能还能手工修复：改名保留，之后写入的快照不会覆盖它
+            if (!ok) {
+                QFile::remove(m_badPath);
+                if (QFile::rename(m_path, m_badPath))
+                    qWarning() << "unreadable config moved to" << m_badPath;
+            }
+        } else {
+            qWarning() << "open config failed:" << file.errorString();
+            ok = false;
+        }
+    }
+    // 读不到快照时日志里的修改只能重放在默认值上，此时压缩会把日志并入几乎为空的快照，
+    // 因此在成功读取快照之前保留日志、不写快照
+    m_snapshotLoaded = ok && (QFileInfo(m_path).isFile() || !QFileInfo::exists(m_badPath));
+    if (!m_snapshotLoaded)
+        qWarning() << "config snapshot not loaded, changes kept in journal until" << m_path << "is restored.";
+
+    // 快照之后的修改在日志中：先重放上次未完成压缩的旧日志，再重放当前日志
+    const qint64 snapshotSeq = m_data->getJournalSeq();
+    m_seq = snapshotSeq;
+    const int replayed = replayJournal(m_sealedPath, snapshotSeq) + replayJournal(m_journalPath, snapshotSeq);
+    if (replayed > 0)
+        qInfo() << "config journal replayed:" << replayed << "changes";
+
+    openJournal();
+    m_data->setChangeHandler([this](const QJsonObject &change) { record(change); });
+    if (replayed > 0 || QFileInfo::exists(m_sealedPath))
+        scheduleSave(true);
+    return ok;
+}
+
+void ConfigStore::close()
+{
+    m_saveTimer.stop();
+    m_worker.waitForDone();
+    m_journal.flush();
+
+    // 退出时把日志并入快照，下次启动无需重放
+    if (m_snapshotLoaded && (m_journalRecords > 0 || QFileInfo::exists(m_sealedPath))) {
+        AppData snapshot = *m_data;
+        snapshot.setJournalSeq(m_seq);
+        if (writeSnapshot(snapshot, m_path)) {
+            m_journal.close();
+            QFile::remove(m_journalPath);
+            QFile::remove(m_sealedPath);
+            m_journalRecords = 0;
+        } else {
+            qWarning() << "config save failed.";
+        }
+    }
+}
+
+void ConfigStore::record(const QJsonObject &change)
+{
+    QJsonObject entry = change;
+    entry["seq"] = ++m_seq;
+    m_journal.write(QJsonDocument(entry).toJson(QJsonDocument::Compact));
+    m_journal.write("\n", 1);
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+
+    scheduleSave(++m_journalRecords >= kCompactRecords);
+}
+
+void ConfigStore::scheduleSave(bool soon)
+{
+    if (!m_snapshotLoaded)
+        return;
+    if (soon)
+        m_saveTimer.start(0);
+    else if (!m_saveTimer.isActive() || m_saveTimer.remainingTime() > 0)
+        m_saveTimer.start(kSaveDelayMs);
+}
+
+void ConfigStore::startSave()
+{
+    if (m_saving) {
+        m_saveAgain = true;
+        return;
+    }
+    if (!sealJournal())
+        return;
+
+    // AppData 中的列表是隐式共享的，复制只增加引用计数；后续修改会在GUI线程分离，不影响后台序列化
+    AppData snapshot = *m_data;
+    snapshot.setJournalSeq(m_seq);
+    // 自定义专辑在GUI线程首次访问时原地解析（const接口修改 mutable 成员），不会分离共享的列表，
+    // 因此专辑逐个复制到新列表，后台线程只读自己的 Album 对象
+    QList<Album> albums;
+    albums.reserve(m_data->m_customAlbums.size());
+    for (const Album &album : qAsConst(m_data->m_customAlbums))
+        albums.append(album);
+    snapshot.m_customAlbums = albums;
+    m_saving = true;
+    m_worker.start(new ConfigSaveTask(this, snapshot, m_path));
+}
+
+void ConfigStore::onSaveFinished(bool ok)
+{
+    m_saving = false;
+    if (ok) {
+        // 快照已包含旧日志中的全部修改
+        QFile::remove(m_sealedPath);
+    } else {
+        qWarning() << "config save failed, changes kept in journal.";
+    }
+
+    if (m_saveAgain) {
+        m_saveAgain = false;
+        scheduleSave(true);
+    }
+}
+
+bool ConfigStore::openJournal()
+{
+    m_journal.setFileName(m_journalPath);
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "open config journal failed:" << m_journal.errorString();
+        return false;
+    }
+    m_journalRecords = 0;
+    return true;
+}
+
+bool ConfigStore::sealJournal()
+{
+    m_journal.flush();
+    m_journal.close();
+
+    // 上次保存失败时旧日志仍在：把当前日志接到其后，保证序号连续
+    bool ok = true;
+    if (QFileInfo::exists(m_sealedPath)) {
+        QFile current(m_journalPath);
+        QFile sealed(m_sealedPath);
+        ok = current.open(QIODevice::ReadOnly) && sealed.open(QIODevice::WriteOnly | QIODevice::Append)
+             && sealed.write(current.readAll()) >= 0;
+        current.close();
+        if (ok)
+            QFile::remove(m_journalPath);
+    } else {
+        ok = !QFileInfo::exists(m_journalPath) || QFile::rename(m_journalPath, m_sealedPath);
+    }
+
+    openJournal();
+    return ok;
+}
+
+int ConfigStore::replayJournal(const QString &path, qint64 snapshotSeq)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+
+    int replayed = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+        // 崩溃时最后一行可能只写了一半，之后的内容不可信
+        const QJsonDocument doc = QJsonDocument::fromJson(line);
+        if (!doc.isObject())
+            break;
+        const QJsonObject change = doc.object();
+        const qint64      seq = change["seq"].toVariant().toLongLong();
+        if (seq <= snapshotSeq)
+            continue;
+        m_data->applyChange(change);
+        m_seq = qMax(m_seq, seq);
+        ++replayed;
+    }
+    return replayed;
+}
+
+bool ConfigStore::parsePlayFiles(const QByteArray &json, QList<PlayFile> &files)
+{
+    rapidjson::StringStream stream(json.constData());
+    ConfigSaxHandler        handler(stream, json.constData(), false);
+    handler.beginFileList();
+
+    rapidjson::Reader reader;
+    if (reader.Parse(stream, handler).IsError())
+        return false;
+    files = handler.files;
+    return true;
+}
+
+bool ConfigStore::readSnapshot(const QByteArray &json)
+{
+    // 流式解析：不构建DOM，自定义专辑的文件列表延迟到首次访问
+    rapidjson::StringStream stream(json.constData());
+    ConfigSaxHandler        handler(stream, json.constData(), true);
+    rapidjson::Reader       reader;
+    const auto              result = reader.Parse(stream, handler);
+    if (result.IsError()) {
+        qWarning() << "parse config failed at offset" << result.Offset() << "error" << result.Code();
+        return false;
+    }
+
+    m_data->m_defaultAlbum = handler.defaultAlbum;
+    m_data->m_customAlbums = handler.customAlbums;
+    m_data->m_volume = handler.volume;
+    m_data->m_isMute = handler.isMute;
+    m_data->m_replayGainMode = handler.replayGainMode;
+    m_data->m_equalizer = handler.equalizer;
+    m_data->m_downmixMode = handler.downmixMode;
+    m_data->m_audioOnly = handler.audioOnly;
+    m_data->m_syncMaster = handler.syncMaster;
+    m_data->m_journalSeq = handler.journalSeq;
+    return true;
+}
+
+bool ConfigStore::writeSnapshot(const AppData &data, const QString &path)
+{
+    rapidjson::StringBuffer                    buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("defaultAlbum");
+    writeAlbum(writer, data.m_defaultAlbum);
+    writer.Key("customAlbums");
+    writer.StartArray();
+    for (const Album &album : data.m_customAlbums)
+        writeAlbum(writer, album);
+    writer.EndArray();
+    writer.Key("volume");
+    writer.Int(data.m_volume);
+    writer.Key("isMute");
+    writer.Bool(data.m_isMute);
+    writer.Key("replayGain");
+    writer.Int(static_cast<int>(data.m_replayGainMode));
+    writer.Key("downmix");
+    writer.Int(static_cast<int>(data.m_downmixMode));
+    writer.Key("audioOnly");
+    writer.Bool(data.m_audioOnly);
+    writer.Key("syncMaster");
+    writer.Int(static_cast<int>(data.m_syncMaster));
+    writer.Key("equalizer");
+    writer.StartObject();
+    writer.Key("enabled");
+    writer.Bool(data.m_equalizer.enabled);
+    writer.Key("preamp");
+    writer.Double(data.m_equalizer.preampDb);
+    writer.Key("bass");
+    writer.Double(data.m_equalizer.bassBoostDb);
+    writer.Key("bands");
+    writer.StartArray();
+    for (float db : data.m_equalizer.bandsDb)
+        writer.Double(db);
+    writer.EndArray();
+    writer.EndObject();
+    writer.Key("journalSeq");
+    writer.Int64(data.m_journalSeq);
+    writer.EndObject();
+
+    // 输出即为UTF-8，原样写入；QSaveFile 先写临时文件再重命名，中途崩溃不会损坏旧快照
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(buffer.GetString(), qint64(buffer.GetSize()));
+    return file.commit();
+}
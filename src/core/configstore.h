@@ -0,0 +1,70 @@
+#ifndef CONFIGSTORE_H
+#define CONFIGSTORE_H
+
+#include "appdata.h"
+
+#include <memory>
+#include <QFile>
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+
+/**
+ * @brief 配置持久化 - 快照 + 追加日志
+ *
+ * 每次修改立即以一行 JSON 追加到日志（config.json.journal），崩溃后重启时在快照之上重放；
+ * 修改停止一段时间或日志过长时，复制一份 AppData（隐式共享，代价很小）在后台线程序列化，
+ * 经 QSaveFile 原子写入快照，随后丢弃已被快照覆盖的日志（压缩）。GUI 线程只做追加写。
+ * 快照无法解析时改名为 config.json.bad 保留，在成功读取快照之前只记日志、不写快照，
+ * 修复或放回快照后重启即可在其上重放这期间的修改。
+ */
+class ConfigStore : public QObject
+{
+    Q_OBJECT
+public:
+    ConfigStore(const QString &path, std::shared_ptr<AppData> data, QObject *parent = nullptr);
+    ~ConfigStore();
+
+    // 读取快照并重放日志，之后开始记录修改
+    bool load();
+
+    // 等待后台写入完成，日志非空时同步写一次快照（退出时调用）
+    void close();
+
+    // 解析专辑的 files 数组（Album 延迟加载时调用）
+    static bool parsePlayFiles(const QByteArray &json, QList<PlayFile> &files);
+
+private:
+    void record(const QJsonObject &change);
+    void scheduleSave(bool soon);
+    void startSave();
+    void onSaveFinished(bool ok);
+    bool openJournal();
+    bool sealJournal();
+    int  replayJournal(const QString &path, qint64 snapshotSeq);
+    bool readSnapshot(const QByteArray &json);
+
+    static bool writeSnapshot(const AppData &data, const QString &path);
+
+    friend class ConfigSaveTask;
+
+    QString                  m_path;
+    QString                  m_journalPath;
+    QString                  m_sealedPath; // 正在写入的快照所覆盖的日志
+    QString                  m_badPath;    // 无法解析的快照改名后的路径
+    std::shared_ptr<AppData> m_data;
+
+    QFile  m_journal;
+    qint64 m_seq{0};               // 最后一条日志的序号
+    int    m_journalRecords{0};    // 当前日志中的记录数
+    bool   m_snapshotLoaded{true}; // 快照读取失败（或只剩改名保留的坏快照）时为false，不压缩日志
+
+    QTimer m_saveTimer;
+    QTimer m_flushTimer;
+    bool   m_saving{false};
+    bool   m_saveAgain{false};
+
+    QThreadPool m_worker;
+};
+
+#endif // CONFIGSTORE_H
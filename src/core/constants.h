@@ -1,6 +1,8 @@
 #ifndef CONSTANTS_H
 #define CONSTANTS_H
 
+#include <array>
+
 enum class PlayState {
     StoppedState = 0, // 暂停状态（包含未播放状态）
     PlayingState,     // 播放状态
@@ -12,6 +14,45 @@ enum class VoiceState {
     MuteState        // 静音状态
 };
 
+enum class ReplayGainMode {
+    Off = 0, // 不做响度均衡
+    Track,   // 按曲目
+    Album    // 按专辑（同一专辑内保持相对响度）
+};
+
+enum class DownmixMode {
+    Auto = 0, // 按设备支持的声道数输出，多出的声道按标准系数缩混
+    Stereo,   // 始终缩混为立体声（ITU-R BS.775）
+    Binaural  // 耳机：立体声缩混并加入简单的对侧串扰，环绕声道保留方位感
+};
+
+// 音视频同步的主时钟
+enum class SyncMaster {
+    Auto = 0, // 有音频时以音频为准，否则使用外部时钟
+    Audio,    // 视频跟随音频；没有音频流时退回外部时钟
+    Video,    // 音频以微调重采样比例跟随视频；没有视频流时退回音频
+    External  // 独立的外部时钟，音视频都跟随它
+};
+
+// 均衡器设置：preamp 与各频段随 enabled 生效，低音增强独立
+struct EqualizerSettings
+{
+    static constexpr int   kBands = 10;
+    static constexpr float kMaxGainDb = 12.0f;
+
+    bool                      enabled{false};
+    float                     preampDb{0.0f};
+    float                     bassBoostDb{0.0f}; // 0 ~ kMaxGainDb
+    std::array<float, kBands> bandsDb{};       // 31Hz ~ 16kHz 倍频程，-kMaxGainDb ~ kMaxGainDb
+
+    bool operator==(const EqualizerSettings &other) const
+    {
+        return enabled == other.enabled && preampDb == other.preampDb && bassBoostDb == other.bassBoostDb
+               && bandsDb == other.bandsDb;
+    }
+    bool operator!=(const EqualizerSettings &other) const { return !(*this == other); }
+};
+
 enum HotkeyType {
     K_OpenFile = 1, // 打开文件（F3)
     K_OpenFolder,   // 打开文件夹（F2)
@@ -22,7 +63,9 @@ enum HotkeyType {
     K_PlaySelected, // 播放选中项（Enter）
     K_PausePlay,    // 暂停/继续播放（Space）
     K_NextPlay,     // 快进/下一个（Right）
-    K_PrevPlay      // 快退/上一个（Left）
+    K_PrevPlay,     // 快退/上一个（Left）
+    K_StepForward,  // 暂停并前进一帧（.）
+    K_StepBackward  // 暂停并后退一帧（,）
 };
 
 #endif // CONSTANTS_H
@@ -0,0 +1,247 @@
+#include "librarywatcher.h"
+#include "mediaprober.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QMultiHash>
+#include <QRunnable>
+
+// 最后一次变化后等待的时间（毫秒），复制或解压等连续写入合并为一次比较
+static constexpr int kDebounceMs = 300;
+// 持续变化时最长推迟（毫秒）
+static constexpr int kMaxDelayMs = 2000;
+
+/**
+ * @brief DirectoryDiffTask - 在线程池中重新列出目录，并与上次快照比较
+ */
+class DirectoryDiffTask : public QRunnable
+{
+public:
+    DirectoryDiffTask(LibraryWatcher                    *watcher,
+                      const QString                     &dir,
+                      const LibraryWatcher::Snapshot    &previous,
+                      bool                               initial,
+                      std::shared_ptr<std::atomic<bool>> cancel)
+        : m_watcher(watcher)
+        , m_dir(dir)
+        , m_previous(previous)
+        , m_initial(initial)
+        , m_cancel(std::move(cancel))
+    {}
+
+    void run() override
+    {
+        LibraryWatcher::Snapshot snapshot;
+        QDirIterator             it(m_dir, QDir::Files | QDir::AllDirs | QDir::NoDotAndDotDot);
+        while (it.hasNext()) {
+            if (m_cancel->load(std::memory_order_relaxed))
+                return;
+            it.next();
+            const QFileInfo       info = it.fileInfo();
+            LibraryWatcher::Entry entry;
+            entry.isDir = info.isDir();
+            entry.size = entry.isDir ? 0 : info.size();
+            entry.mtime = info.lastModified().toMSecsSinceEpoch();
+            snapshot.insert(info.fileName(), entry);
+        }
+
+        FileChanges changes;
+        changes.directory = m_dir;
+        if (!m_initial)
+            diff(snapshot, changes);
+
+        if (m_cancel->load(std::memory_order_relaxed))
+            return;
+        // 单例析构前会取消并等待线程池，此处指针一定有效
+        LibraryWatcher *watcher = m_watcher;
+        QMetaObject::invokeMethod(
+            watcher,
+            [watcher, dir = m_dir, snapshot, changes]() { watcher->onDiffReady(dir, snapshot, changes); },
+            Qt::QueuedConnection);
+    }
+
+private:
+    void diff(const LibraryWatcher::Snapshot &current, FileChanges &changes) const
+    {
+        const QDir dir(m_dir);
+
+        // 新出现的文件按 大小+修改时间 建索引，用于把 删除+新增 识别为重命名（重命名不改变这两项）
+        QStringList                  addedNames;
+        QMultiHash<QString, QString> addedByStamp;
+        for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+            auto old = m_previous.constFind(it.key());
+            if (old == m_previous.constEnd()) {
+                addedNames.append(it.key());
+                if (!it->isDir)
+                    addedByStamp.insert(stampKey(*it), it.key());
+            } else if (!it->isDir && (old->size != it->size || old->mtime != it->mtime)) {
+                changes.modified.append(dir.absoluteFilePath(it.key()));
+            }
+        }
+
+        QSet<QString> renamedTo;
+        for (auto it = m_previous.constBegin(); it != m_previous.constEnd(); ++it) {
+            if (current.contains(it.key()))
+                continue;
+            const QString from = dir.absoluteFilePath(it.key());
+            if (!it->isDir) {
+                auto match = addedByStamp.find(stampKey(*it));
+                if (match != addedByStamp.end()) {
+                    renamedTo.insert(match.value());
+                    changes.renamed.append({from, dir.absoluteFilePath(match.value())});
+                    addedByStamp.erase(match);
+                    continue;
+                }
+            }
+            changes.removed.append(from);
+        }
+
+        for (const QString &name : qAsConst(addedNames)) {
+            if (!renamedTo.contains(name))
+                changes.added.append(dir.absoluteFilePath(name));
+        }
+    }
+
+    static QString stampKey(const LibraryWatcher::Entry &entry)
+    {
+        return QString::number(entry.size) + '|' + QString::number(entry.mtime);
+    }
+
+private:
+    LibraryWatcher                    *m_watcher;
+    QString                            m_dir;
+    LibraryWatcher::Snapshot           m_previous;
+    bool                               m_initial;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+
+LibraryWatcher *LibraryWatcher::instance()
+{
+    static LibraryWatcher instance;
+    return &instance;
+}
+
+LibraryWatcher::LibraryWatcher(QObject *parent)
+    : QObject(parent)
+    , m_cancel(std::make_shared<std::atomic<bool>>(false))
+{
+    m_workers.setMaxThreadCount(2);
+
+    m_debounceTimer.setSingleShot(true);
+    connect(&m_debounceTimer, &QTimer::timeout, this, &LibraryWatcher::flushDirty);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &LibraryWatcher::onDirectoryChanged);
+}
+
+LibraryWatcher::~LibraryWatcher()
+{
+    m_cancel->store(true, std::memory_order_relaxed);
+    m_workers.clear();
+    m_workers.waitForDone();
+}
+
+void LibraryWatcher::watchDirectory(const QString &dir)
+{
+    const QString path = QDir(dir).absolutePath();
+    DirState     &state = m_dirs[path];
+    if (state.refs++ > 0)
+        return;
+
+    if (!m_watcher.addPath(path))
+        qWarning() << "watch directory failed:" << path;
+    // 先建立基准快照，之后的变化才能算出差异
+    startDiff(path, true);
+}
+
+void LibraryWatcher::unwatchDirectory(const QString &dir)
+{
+    const QString path = QDir(dir).absolutePath();
+    auto          it = m_dirs.find(path);
+    if (it == m_dirs.end() || --it->refs > 0)
+        return;
+
+    m_dirs.erase(it);
+    m_dirtyDirs.remove(path);
+    m_watcher.removePath(path);
+}
+
+void LibraryWatcher::watchFile(const QString &path)
+{
+    watchDirectory(QFileInfo(path).absolutePath());
+}
+
+void LibraryWatcher::unwatchFile(const QString &path)
+{
+    unwatchDirectory(QFileInfo(path).absolutePath());
+}
+
+void LibraryWatcher::onDirectoryChanged(const QString &dir)
+{
+    if (!m_dirs.contains(dir))
+        return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (m_dirtyDirs.isEmpty())
+        m_firstDirtyMs = now;
+    m_dirtyDirs.insert(dir);
+
+    // 每次变化都重新计时，但距第一次变化不超过 kMaxDelayMs
+    const qint64 remaining = m_firstDirtyMs + kMaxDelayMs - now;
+    m_debounceTimer.start(int(qBound<qint64>(0, remaining, kDebounceMs)));
+}
+
+void LibraryWatcher::flushDirty()
+{
+    const QSet<QString> dirs = m_dirtyDirs;
+    m_dirtyDirs.clear();
+    for (const QString &dir : dirs)
+        startDiff(dir, false);
+}
+
+void LibraryWatcher::startDiff(const QString &dir, bool initial)
+{
+    auto it = m_dirs.find(dir);
+    if (it == m_dirs.end())
+        return;
+    if (it->diffing) {
+        // 同一目录同时只比较一次，当前任务完成后再补一次
+        it->dirtyAgain = true;
+        return;
+    }
+    it->diffing = true;
+    m_workers.start(new DirectoryDiffTask(this, dir, it->snapshot, initial, m_cancel));
+}
+
+void LibraryWatcher::onDiffReady(const QString &dir, const Snapshot &snapshot, const FileChanges &changes)
+{
+    auto it = m_dirs.find(dir);
+    if (it == m_dirs.end())
+        return; // 已取消监视
+
+    it->snapshot = snapshot;
+    it->diffing = false;
+    if (it->dirtyAgain) {
+        it->dirtyAgain = false;
+        startDiff(dir, false);
+    }
+
+    // 目录被删除或移走后 QFileSystemWatcher 会自动移除，目录重新出现时再加回
+    if (!m_watcher.directories().contains(dir) && QFileInfo::exists(dir))
+        m_watcher.addPath(dir);
+
+    if (changes.isEmpty())
+        return;
+
+    // 元数据缓存以路径为键：删除与修改使其失效，重命名迁移到新路径
+    MediaProber *prober = MediaProber::instance();
+    for (const QString &path : changes.removed)
+        prober->invalidate(path);
+    for (const QString &path : changes.modified)
+        prober->invalidate(path);
+    for (const auto &rename : changes.renamed)
+        prober->rename(rename.first, rename.second);
+
+    emit sigChanged(changes);
+}
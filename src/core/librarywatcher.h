@@ -0,0 +1,98 @@
+#ifndef LIBRARYWATCHER_H
+#define LIBRARYWATCHER_H
+
+#include <atomic>
+#include <memory>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+/**
+ * @brief 目录的一次增量变化，路径均为绝对路径
+ */
+struct FileChanges
+{
+    QString                        directory;
+    QStringList                    added;
+    QStringList                    removed;
+    QStringList                    modified; // 大小或修改时间变化
+    QList<QPair<QString, QString>> renamed;  // (原路径, 新路径)
+
+    bool isEmpty() const { return added.isEmpty() && removed.isEmpty() && modified.isEmpty() && renamed.isEmpty(); }
+};
+
+/**
+ * @brief 文件系统监视服务（单例）
+ *
+ * 基于 QFileSystemWatcher（Linux 下为 inotify）只监视目录，按引用计数共享；目录变化先合并去抖，
+ * 再在线程池中重新列出目录并与上次快照比较，得出新增/删除/修改/重命名后一次性发出 sigChanged。
+ * 删除、修改与重命名同时同步到 MediaProber 的元数据缓存。
+ */
+class LibraryWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    static LibraryWatcher *instance();
+
+    // 目录按引用计数监视，watch 与 unwatch 需成对调用
+    void watchDirectory(const QString &dir);
+    void unwatchDirectory(const QString &dir);
+
+    // 监视文件所在目录
+    void watchFile(const QString &path);
+    void unwatchFile(const QString &path);
+
+signals:
+    // 某个被监视目录的变化（已去抖合并）
+    void sigChanged(const FileChanges &changes);
+
+private:
+    struct Entry
+    {
+        qint64 size{0};
+        qint64 mtime{0};
+        bool   isDir{false};
+    };
+    using Snapshot = QHash<QString, Entry>; // 文件名 -> 状态
+
+    struct DirState
+    {
+        int      refs{0};
+        Snapshot snapshot;
+        bool     diffing{false};    // 线程池中有该目录的任务
+        bool     dirtyAgain{false}; // 任务执行期间目录再次变化
+    };
+
+    void onDirectoryChanged(const QString &dir);
+    void flushDirty();
+    void startDiff(const QString &dir, bool initial);
+    void onDiffReady(const QString &dir, const Snapshot &snapshot, const FileChanges &changes);
+
+    friend class DirectoryDiffTask;
+
+private:
+    explicit LibraryWatcher(QObject *parent = nullptr);
+    ~LibraryWatcher();
+
+    LibraryWatcher(const LibraryWatcher &) = delete;
+    LibraryWatcher &operator=(const LibraryWatcher &) = delete;
+
+    QFileSystemWatcher       m_watcher;
+    QHash<QString, DirState> m_dirs;
+
+    // 去抖
+    QSet<QString> m_dirtyDirs;
+    QTimer        m_debounceTimer;
+    qint64        m_firstDirtyMs{0}; // 本轮第一次变化的时刻，持续变化时也不会无限推迟
+
+    QThreadPool                        m_workers;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+
+#endif // LIBRARYWATCHER_H
@@ -0,0 +1,299 @@
+#include "loudnessscanner.h"
+#include "appcontext.h"
+#include "loudnessmeter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QThread>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+#include <libswresample/swresample.h>
+}
+
+// 增益范围（dB），正增益由输出级的限制器防止削波
+static constexpr double kMinGainDb = -24.0;
+static constexpr double kMaxGainDb = 12.0;
+
+namespace {
+
+/**
+ * @brief 完整解码一个文件的音频流并测量响度
+ */
+bool scanFile(const QString &path, const std::atomic<bool> &cancel, LoudnessInfo &info)
+{
+    AVFormatContext *format = nullptr;
+    if (avformat_open_input(&format, path.toUtf8().constData(), nullptr, nullptr) < 0)
+        return false;
+
+    bool                           ok = false;
+    AVCodecContext                *codec = nullptr;
+    SwrContext                    *swr = nullptr;
+    AVPacket                      *packet = av_packet_alloc();
+    AVFrame                       *frame = av_frame_alloc();
+    std::unique_ptr<LoudnessMeter> meter;
+    std::vector<float>             samples;
+    qint64                         frames = 0;
+
+    do {
+        if (avformat_find_stream_info(format, nullptr) < 0)
+            break;
+        const int streamIndex = av_find_best_stream(format, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+        if (streamIndex < 0)
+            break;
+        AVStream      *stream = format->streams[streamIndex];
+        const AVCodec *decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+        if (!decoder)
+            break;
+        codec = avcodec_alloc_context3(decoder);
+        if (!codec || avcodec_parameters_to_context(codec, stream->codecpar) < 0)
+            break;
+        codec->thread_count = 1; // 并行度由线程池提供
+        if (avcodec_open2(codec, decoder, nullptr) < 0 || codec->channels <= 0 || codec->sample_rate <= 0)
+            break;
+
+        // 只丢弃其他流的包，解复用开销很小
+        for (unsigned i = 0; i < format->nb_streams; ++i) {
+            if (int(i) != streamIndex)
+                format->streams[i]->discard = AVDISCARD_ALL;
+        }
+
+        const int     channels = codec->channels;
+        const int64_t layout = codec->channel_layout ? int64_t(codec->channel_layout)
+                                                     : av_get_default_channel_layout(channels);
+        swr = swr_alloc_set_opts(nullptr,
+                                 layout,
+                                 AV_SAMPLE_FMT_FLTP,
+                                 codec->sample_rate,
+                                 layout,
+                                 codec->sample_fmt,
+                                 codec->sample_rate,
+                                 0,
+                                 nullptr);
+        if (!swr || swr_init(swr) < 0)
+            break;
+        meter = std::make_unique<LoudnessMeter>(codec->sample_rate, channels, uint64_t(layout));
+
+        std::vector<float *> planes(channels);
+        bool                 flushed = false;
+        while (!cancel.load(std::memory_order_relaxed)) {
+            if (!flushed) {
+                if (av_read_frame(format, packet) < 0) {
+                    avcodec_send_packet(codec, nullptr);
+                    flushed = true;
+                } else {
+                    const bool isAudio = packet->stream_index == streamIndex;
+                    if (isAudio)
+                        avcodec_send_packet(codec, packet);
+                    av_packet_unref(packet);
+                    if (!isAudio)
+                        continue;
+                }
+            }
+
+            while (avcodec_receive_frame(codec, frame) >= 0) {
+                const int count = frame->nb_samples;
+                if (count <= 0 || frame->channels != channels || frame->format != codec->sample_fmt) {
+                    av_frame_unref(frame);
+                    continue;
+                }
+                samples.resize(size_t(channels) * count);
+                for (int ch = 0; ch < channels; ++ch)
+                    planes[ch] = samples.data() + size_t(ch) * count;
+                const int converted = swr_convert(swr,
+                                                  reinterpret_cast<uint8_t **>(planes.data()),
+                                                  count,
+                                                  const_cast<const uint8_t **>(frame->extended_data),
+                                                  count);
+                av_frame_unref(frame);
+                if (converted > 0) {
+                    meter->addFrames(planes.data(), converted);
+                    frames += converted;
+                }
+            }
+            if (flushed)
+                break;
+        }
+        ok = frames > 0 && !cancel.load(std::memory_order_relaxed);
+        if (ok) {
+            info.valid = true;
+            info.integratedLufs = meter->integratedLoudness();
+            info.rangeLu = meter->loudnessRange();
+            // 全静音时真峰值为负无穷，JSON无法保存
+            info.truePeakDb = std::max(-120.0, meter->truePeakDb());
+            info.durationMs = frames * 1000 / codec->sample_rate;
+        }
+    } while (false);
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    swr_free(&swr);
+    avcodec_free_context(&codec);
+    avformat_close_input(&format);
+    return ok;
+}
+
+} // namespace
+
+/**
+ * @brief LoudnessScanTask - 线程池中的单个文件扫描任务
+ */
+class LoudnessScanTask : public QRunnable
+{
+public:
+    LoudnessScanTask(LoudnessScanner *scanner, const QString &path, std::shared_ptr<std::atomic<bool>> cancel)
+        : m_scanner(scanner)
+        , m_path(path)
+        , m_cancel(std::move(cancel))
+    {}
+
+    void run() override
+    {
+        if (m_cancel->load(std::memory_order_relaxed))
+            return;
+
+        QElapsedTimer timer;
+        timer.start();
+        LoudnessInfo  info;
+        const bool    ok = scanFile(m_path, *m_cancel, info);
+        const qint64  scanMs = timer.elapsed();
+
+        if (m_cancel->load(std::memory_order_relaxed))
+            return;
+        // 单例析构前会取消并等待线程池，此处指针一定有效
+        LoudnessScanner *scanner = m_scanner;
+        QMetaObject::invokeMethod(
+            scanner,
+            [scanner, path = m_path, ok, info, scanMs]() { scanner->onScanFinished(path, ok, info, scanMs); },
+            Qt::QueuedConnection);
+    }
+
+private:
+    LoudnessScanner                   *m_scanner;
+    QString                            m_path;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+
+LoudnessScanner *LoudnessScanner::instance()
+{
+    static LoudnessScanner instance;
+    return &instance;
+}
+
+LoudnessScanner::LoudnessScanner(QObject *parent)
+    : QObject(parent)
+    , m_cancel(std::make_shared<std::atomic<bool>>(false))
+{
+    // 完整解码以CPU为主，与播放同时进行，只占用一半核心
+    m_workers.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+}
+
+LoudnessScanner::~LoudnessScanner()
+{
+    m_cancel->store(true, std::memory_order_relaxed);
+    m_workers.clear();
+    m_workers.waitForDone();
+}
+
+bool LoudnessScanner::lookup(const QString &path, LoudnessInfo &info) const
+{
+    return MediaProber::instance()->lookupLoudness(QFileInfo(path), info);
+}
+
+void LoudnessScanner::request(const QString &path)
+{
+    const QFileInfo info(path);
+    const QString   absolute = info.absoluteFilePath();
+    LoudnessInfo    cached;
+    if (m_inFlight.contains(absolute) || m_failed.contains(absolute) || !info.isFile()
+        || MediaProber::instance()->lookupLoudness(info, cached)) {
+        return;
+    }
+    m_inFlight.insert(absolute);
+    m_workers.start(new LoudnessScanTask(this, absolute, m_cancel));
+}
+
+double LoudnessScanner::gainFor(const QString &path, ReplayGainMode mode, bool *pending)
+{
+    if (pending)
+        *pending = false;
+    if (mode == ReplayGainMode::Off)
+        return 0.0;
+
+    // 专辑响度：各曲目按时长加权的能量平均（近似，各曲目门限分别计算）
+    const QStringList files = mode == ReplayGainMode::Album ? albumFiles(path) : QStringList{path};
+    double            energy = 0.0;
+    double            weight = 0.0;
+    for (const QString &file : files) {
+        LoudnessInfo info;
+        if (!lookup(file, info)) {
+            request(file);
+            if (pending && m_inFlight.contains(QFileInfo(file).absoluteFilePath()))
+                *pending = true;
+            continue;
+        }
+        if (info.integratedLufs <= LoudnessMeter::kSilenceLufs)
+            continue; // 静音曲目不参与
+        const double w = double(qMax<qint64>(1, info.durationMs));
+        energy += w * std::pow(10.0, info.integratedLufs / 10.0);
+        weight += w;
+    }
+    if (weight <= 0.0)
+        return 0.0;
+
+    const double loudness = 10.0 * std::log10(energy / weight);
+    return qBound(kMinGainDb, kReferenceLufs - loudness, kMaxGainDb);
+}
+
+QStringList LoudnessScanner::albumFiles(const QString &path) const
+{
+    const QString absolute = QFileInfo(path).absoluteFilePath();
+    auto          appData = AppContext::instance()->getAppData();
+
+    QStringList files;
+    for (const Album &album : appData->getCustomAlbums()) {
+        // 只解析原文中包含该文件的专辑
+        if (!album.mayContain(absolute))
+            continue;
+        const QList<PlayFile> &albumFiles = album.getPlayfiles();
+        auto                   found = std::find_if(albumFiles.begin(), albumFiles.end(), [&](const PlayFile &file) {
+            return file.filepath_ == absolute;
+        });
+        if (found == albumFiles.end())
+            continue;
+        for (const PlayFile &file : albumFiles)
+            files.append(file.filepath_);
+        return files;
+    }
+
+    // 默认专辑收录所有打开过的文件，不构成真正的专辑，按所在目录分组
+    const QString dir = QFileInfo(absolute).absolutePath();
+    for (const PlayFile &file : appData->getDefaultAlbum().getPlayfiles()) {
+        if (QFileInfo(file.filepath_).absolutePath() == dir)
+            files.append(file.filepath_);
+    }
+    if (!files.contains(absolute))
+        files.append(absolute);
+    return files;
+}
+
+void LoudnessScanner::onScanFinished(const QString &path, bool ok, const LoudnessInfo &info, qint64 scanMs)
+{
+    m_inFlight.remove(path);
+    if (!ok) {
+        m_failed.insert(path);
+        return;
+    }
+
+    MediaProber::instance()->storeLoudness(QFileInfo(path), info);
+    qInfo() << "响度扫描:" << path << info.integratedLufs << "LUFS, LRA" << info.rangeLu << "LU, 真峰值"
+            << info.truePeakDb << "dBTP, 耗时" << scanMs << "ms";
+    emit sigScanned(path);
+}
@@ -0,0 +1,64 @@
+#ifndef LOUDNESSSCANNER_H
+#define LOUDNESSSCANNER_H
+
+#include "constants.h"
+#include "mediaprober.h"
+
+#include <atomic>
+#include <memory>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+
+/**
+ * @brief 响度扫描服务（单例）
+ *
+ * 工作线程池中每个文件各用一个独立解码器完整解码音频流，测量综合响度、响度范围与真峰值（EBU R128），
+ * 结果写入 MediaProber 的缓存（与元数据同一条目）。gainFor 按曲目或专辑计算把响度拉到参考电平所需的增益，
+ * 专辑为包含该文件的自定义专辑，不在自定义专辑中时取默认专辑里同一目录下的文件。
+ */
+class LoudnessScanner : public QObject
+{
+    Q_OBJECT
+public:
+    static LoudnessScanner *instance();
+
+    // 参考响度（ReplayGain 2.0）
+    static constexpr double kReferenceLufs = -18.0;
+
+    // 命中缓存时填充 info 并返回true
+    bool lookup(const QString &path, LoudnessInfo &info) const;
+
+    // 未命中缓存时提交后台扫描，完成后发出 sigScanned
+    void request(const QString &path);
+
+    // 按模式计算增益（dB）；尚缺结果的文件会提交扫描，仍有文件在扫描中时 pending 置为true
+    double gainFor(const QString &path, ReplayGainMode mode, bool *pending = nullptr);
+
+    // 与该文件同属一个专辑的文件（含自身）
+    QStringList albumFiles(const QString &path) const;
+
+signals:
+    void sigScanned(const QString &path);
+
+private:
+    void onScanFinished(const QString &path, bool ok, const LoudnessInfo &info, qint64 scanMs);
+
+    friend class LoudnessScanTask;
+
+private:
+    explicit LoudnessScanner(QObject *parent = nullptr);
+    ~LoudnessScanner();
+
+    LoudnessScanner(const LoudnessScanner &) = delete;
+    LoudnessScanner &operator=(const LoudnessScanner &) = delete;
+
+    QSet<QString> m_inFlight;
+    QSet<QString> m_failed; // 无音频或无法解码，本次运行不再重试
+
+    QThreadPool                        m_workers;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+
+#endif // LOUDNESSSCANNER_H
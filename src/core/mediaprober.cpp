@@ -0,0 +1,408 @@
+#include "mediaprober.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThread>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/dict.h>
+}
+
+#define MEDIA_CACHE_PATH "./mediacache.json"
+
+// 缓存格式版本，字段变化时递增以丢弃旧缓存
+static constexpr int kCacheVersion = 1;
+// 合并通知的间隔（毫秒）
+static constexpr int kFlushIntervalMs = 100;
+// 缓存变化后写盘的延迟（毫秒），批量探测或扫描时合并为一次写入
+static constexpr int kSaveDelayMs = 2000;
+
+namespace {
+
+// 只读取头部信息，限制探测量以保持轻量
+bool probeFile(const QString &path, MediaInfo &info)
+{
+    AVDictionary *options = nullptr;
+    av_dict_set(&options, "probesize", "1000000", 0);
+    av_dict_set(&options, "analyzeduration", "1000000", 0);
+
+    AVFormatContext *format = nullptr;
+    int              ret = avformat_open_input(&format, path.toUtf8().constData(), nullptr, &options);
+    av_dict_free(&options);
+    if (ret < 0)
+        return false;
+
+    if (avformat_find_stream_info(format, nullptr) < 0) {
+        avformat_close_input(&format);
+        return false;
+    }
+
+    if (format->duration != AV_NOPTS_VALUE)
+        info.durationMs = format->duration / 1000;
+    info.bitrate = format->bit_rate;
+
+    const int videoIndex = av_find_best_stream(format, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (videoIndex >= 0 && !(format->streams[videoIndex]->disposition & AV_DISPOSITION_ATTACHED_PIC)) {
+        const AVCodecParameters *par = format->streams[videoIndex]->codecpar;
+        info.width = par->width;
+        info.height = par->height;
+        info.videoCodec = avcodec_get_name(par->codec_id);
+    }
+
+    const int audioIndex = av_find_best_stream(format, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    if (audioIndex >= 0) {
+        const AVCodecParameters *par = format->streams[audioIndex]->codecpar;
+        info.sampleRate = par->sample_rate;
+        info.channels = par->channels;
+        info.audioCodec = avcodec_get_name(par->codec_id);
+    }
+
+    avformat_close_input(&format);
+    return true;
+}
+
+QJsonObject infoToJson(const MediaInfo &info)
+{
+    QJsonObject obj;
+    obj["duration_ms"] = info.durationMs;
+    obj["width"] = info.width;
+    obj["height"] = info.height;
+    obj["bitrate"] = info.bitrate;
+    obj["sample_rate"] = info.sampleRate;
+    obj["channels"] = info.channels;
+    obj["vcodec"] = info.videoCodec;
+    obj["acodec"] = info.audioCodec;
+    return obj;
+}
+
+MediaInfo infoFromJson(const QJsonObject &obj)
+{
+    MediaInfo info;
+    info.durationMs = obj["duration_ms"].toVariant().toLongLong();
+    info.width = obj["width"].toInt();
+    info.height = obj["height"].toInt();
+    info.bitrate = obj["bitrate"].toVariant().toLongLong();
+    info.sampleRate = obj["sample_rate"].toInt();
+    info.channels = obj["channels"].toInt();
+    info.videoCodec = obj["vcodec"].toString();
+    info.audioCodec = obj["acodec"].toString();
+    return info;
+}
+
+} // namespace
+
+/**
+ * @brief MediaProbeTask - 线程池中的单个文件探测任务
+ */
+class MediaProbeTask : public QRunnable
+{
+public:
+    MediaProbeTask(MediaProber *prober, const QFileInfo &fileInfo, std::shared_ptr<std::atomic<bool>> cancel)
+        : m_prober(prober)
+        , m_path(fileInfo.absoluteFilePath())
+        , m_size(fileInfo.size())
+        , m_mtime(fileInfo.lastModified().toMSecsSinceEpoch())
+        , m_cancel(std::move(cancel))
+    {}
+
+    void run() override
+    {
+        if (m_cancel->load(std::memory_order_relaxed))
+            return;
+
+        QElapsedTimer timer;
+        timer.start();
+        MediaInfo     info;
+        const bool    valid = probeFile(m_path, info);
+        const qint64  probeUs = timer.nsecsElapsed() / 1000;
+
+        if (m_cancel->load(std::memory_order_relaxed))
+            return;
+        // 单例析构前会取消并等待线程池，此处指针一定有效
+        MediaProber *prober = m_prober;
+        QMetaObject::invokeMethod(
+            prober,
+            [prober, path = m_path, size = m_size, mtime = m_mtime, valid, info, probeUs]() {
+                prober->onProbeFinished(path, size, mtime, valid, info, probeUs);
+            },
+            Qt::QueuedConnection);
+    }
+
+private:
+    MediaProber                       *m_prober;
+    QString                            m_path;
+    qint64                             m_size;
+    qint64                             m_mtime;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+
+MediaProber *MediaProber::instance()
+{
+    static MediaProber instance;
+    return &instance;
+}
+
+MediaProber::MediaProber(QObject *parent)
+    : QObject(parent)
+    , m_cancel(std::make_shared<std::atomic<bool>>(false))
+{
+    // 探测以IO等待为主，线程数与核心数一致
+    m_workers.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(kFlushIntervalMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &MediaProber::flushProbed);
+
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(kSaveDelayMs);
+    connect(&m_saveTimer, &QTimer::timeout, this, [this]() {
+        if (m_dirty && !save())
+            qWarning() << "media cache save failed.";
+    });
+    // 单例在静态析构阶段才析构，此时 QApplication 已销毁；退出前先写一次
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
+            m_saveTimer.stop();
+            if (m_dirty && !save())
+                qWarning() << "media cache save failed.";
+        });
+    }
+
+    load();
+}
+
+MediaProber::~MediaProber()
+{
+    m_cancel->store(true, std::memory_order_relaxed);
+    m_workers.clear();
+    m_workers.waitForDone();
+
+    // 兜底：正常退出时已在 aboutToQuit 中保存
+    if (m_dirty && !save())
+        qWarning() << "media cache save failed.";
+}
+
+bool MediaProber::lookup(const QFileInfo &fileInfo, MediaInfo &info)
+{
+    const CacheEntry *entry = freshEntry(fileInfo);
+    if (!entry)
+        return false;
+    ++m_hits;
+    info = entry->info;
+    return entry->valid;
+}
+
+bool MediaProber::result(const QFileInfo &fileInfo, MediaInfo &info) const
+{
+    const CacheEntry *entry = freshEntry(fileInfo);
+    if (!entry)
+        return false;
+    info = entry->info;
+    return entry->valid;
+}
+
+const MediaProber::CacheEntry *MediaProber::freshEntry(const QFileInfo &fileInfo) const
+{
+    auto it = m_cache.constFind(fileInfo.absoluteFilePath());
+    if (it == m_cache.constEnd() || !it->probed || it->size != fileInfo.size()
+        || it->mtime != fileInfo.lastModified().toMSecsSinceEpoch()) {
+        return nullptr;
+    }
+    return &it.value();
+}
+
+bool MediaProber::lookupLoudness(const QFileInfo &fileInfo, LoudnessInfo &loudness) const
+{
+    auto it = m_cache.constFind(fileInfo.absoluteFilePath());
+    if (it == m_cache.constEnd() || !it->loudness.valid || it->size != fileInfo.size()
+        || it->mtime != fileInfo.lastModified().toMSecsSinceEpoch()) {
+        return false;
+    }
+    loudness = it->loudness;
+    return true;
+}
+
+void MediaProber::storeLoudness(const QFileInfo &fileInfo, const LoudnessInfo &loudness)
+{
+    const qint64 size = fileInfo.size();
+    const qint64 mtime = fileInfo.lastModified().toMSecsSinceEpoch();
+    CacheEntry  &entry = m_cache[fileInfo.absoluteFilePath()];
+    if (entry.size != size || entry.mtime != mtime) {
+        // 新条目或文件已变化：旧的元数据作废，等待重新探测
+        entry = CacheEntry();
+        entry.size = size;
+        entry.mtime = mtime;
+    }
+    entry.loudness = loudness;
+    markDirty();
+}
+
+void MediaProber::request(const QFileInfo &fileInfo)
+{
+    // 命中由 lookup 统计；已在探测中的文件在首次请求时已记为未命中
+    const QString path = fileInfo.absoluteFilePath();
+    if (freshEntry(fileInfo) || m_inFlight.contains(path))
+        return;
+
+    ++m_misses;
+    if (m_inFlight.isEmpty()) {
+        m_batchStartMs = QDateTime::currentMSecsSinceEpoch();
+        m_batchProbed = 0;
+    }
+    m_inFlight.insert(path);
+    m_workers.start(new MediaProbeTask(this, fileInfo, m_cancel));
+}
+
+void MediaProber::invalidate(const QString &path)
+{
+    if (m_cache.remove(path) > 0)
+        markDirty();
+}
+
+void MediaProber::rename(const QString &from, const QString &to)
+{
+    auto it = m_cache.find(from);
+    if (it == m_cache.end())
+        return;
+    const CacheEntry entry = it.value();
+    m_cache.erase(it);
+    m_cache.insert(to, entry);
+    markDirty();
+}
+
+QJsonObject MediaProber::stats() const
+{
+    QJsonObject obj;
+    obj["entries"] = m_cache.size();
+    obj["hits"] = m_hits;
+    obj["misses"] = m_misses;
+    obj["hit_rate"] = (m_hits + m_misses) > 0 ? double(m_hits) / (m_hits + m_misses) : 0.0;
+    obj["probed"] = m_probed;
+    obj["failed"] = m_failed;
+    obj["mean_probe_ms"] = m_probed > 0 ? m_probeUs / 1000.0 / m_probed : 0.0;
+    return obj;
+}
+
+bool MediaProber::save()
+{
+    QJsonArray entries;
+    for (auto it = m_cache.constBegin(); it != m_cache.constEnd(); ++it) {
+        QJsonObject obj = infoToJson(it->info);
+        obj["path"] = it.key();
+        obj["size"] = it->size;
+        obj["mtime"] = it->mtime;
+        obj["valid"] = it->valid;
+        if (!it->probed)
+            obj["probed"] = false;
+        if (it->loudness.valid) {
+            obj["lufs"] = it->loudness.integratedLufs;
+            obj["lra"] = it->loudness.rangeLu;
+            obj["true_peak"] = it->loudness.truePeakDb;
+            obj["loudness_ms"] = it->loudness.durationMs;
+        }
+        entries.append(obj);
+    }
+    QJsonObject root;
+    root["version"] = kCacheVersion;
+    root["entries"] = entries;
+
+    QSaveFile file(MEDIA_CACHE_PATH);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit())
+        return false;
+    m_dirty = false;
+    return true;
+}
+
+void MediaProber::onProbeFinished(
+    const QString &path, qint64 size, qint64 mtime, bool valid, const MediaInfo &info, qint64 probeUs)
+{
+    m_inFlight.remove(path);
+
+    // 已有的响度结果在文件未变化时保留
+    CacheEntry &entry = m_cache[path];
+    if (entry.size != size || entry.mtime != mtime)
+        entry.loudness = LoudnessInfo();
+    entry.size = size;
+    entry.mtime = mtime;
+    entry.probed = true;
+    entry.valid = valid;
+    entry.info = info;
+    markDirty();
+
+    ++m_probed;
+    ++m_batchProbed;
+    m_probeUs += probeUs;
+    if (!valid)
+        ++m_failed;
+
+    m_probedPaths.append(path);
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+
+    // 一批探测全部完成时报告吞吐与命中率
+    if (m_inFlight.isEmpty()) {
+        const qint64 elapsedMs = qMax<qint64>(1, QDateTime::currentMSecsSinceEpoch() - m_batchStartMs);
+        qInfo() << "媒体元数据探测完成:" << m_batchProbed << "个文件，耗时" << elapsedMs << "ms，吞吐"
+                << m_batchProbed * 1000.0 / elapsedMs << "个/秒，缓存命中率"
+                << stats()["hit_rate"].toDouble();
+    }
+}
+
+void MediaProber::markDirty()
+{
+    m_dirty = true;
+    if (!m_saveTimer.isActive())
+        m_saveTimer.start();
+}
+
+void MediaProber::flushProbed()
+{
+    if (m_probedPaths.isEmpty())
+        return;
+    emit sigProbed(m_probedPaths);
+    m_probedPaths.clear();
+}
+
+void MediaProber::load()
+{
+    QFile file(MEDIA_CACHE_PATH);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root["version"].toInt() != kCacheVersion)
+        return;
+
+    const QJsonArray entries = root["entries"].toArray();
+    m_cache.reserve(entries.size());
+    for (const QJsonValue &value : entries) {
+        const QJsonObject obj = value.toObject();
+        CacheEntry        entry;
+        entry.size = obj["size"].toVariant().toLongLong();
+        entry.mtime = obj["mtime"].toVariant().toLongLong();
+        entry.probed = obj["probed"].toBool(true);
+        entry.valid = obj["valid"].toBool();
+        entry.info = infoFromJson(obj);
+        if (obj.contains("lufs")) {
+            entry.loudness.valid = true;
+            entry.loudness.integratedLufs = obj["lufs"].toDouble();
+            entry.loudness.rangeLu = obj["lra"].toDouble();
+            entry.loudness.truePeakDb = obj["true_peak"].toDouble();
+            entry.loudness.durationMs = obj["loudness_ms"].toVariant().toLongLong();
+        }
+        m_cache.insert(obj["path"].toString(), entry);
+    }
+    qDebug() << "media cache loaded:" << m_cache.size() << "entries";
+}
@@ -0,0 +1,136 @@
+#ifndef MEDIAPROBER_H
+#define MEDIAPROBER_H
+
+#include <atomic>
+#include <memory>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+/**
+ * @brief 媒体元数据 - 探测结果
+ */
+struct MediaInfo
+{
+    qint64  durationMs{-1}; // 未知时为-1
+    int     width{0};
+    int     height{0};
+    qint64  bitrate{0};
+    int     sampleRate{0};
+    int     channels{0};
+    QString videoCodec;
+    QString audioCodec;
+
+    bool hasVideo() const { return width > 0 && height > 0; }
+};
+
+/**
+ * @brief 响度扫描结果（EBU R128）
+ */
+struct LoudnessInfo
+{
+    bool   valid{false};
+    double integratedLufs{0.0}; // 综合响度
+    double rangeLu{0.0};        // 响度范围
+    double truePeakDb{0.0};     // 真峰值（dBTP）
+    qint64 durationMs{0};       // 参与测量的时长，专辑响度按此加权
+};
+
+/**
+ * @brief 媒体元数据探测服务（单例）
+ *
+ * 工作线程池以轻量的 avformat_open_input + avformat_find_stream_info 读取时长、分辨率、编码与码率，
+ * 结果写入以 路径+大小+修改时间 为键的持久化缓存（./mediacache.json），播放列表无需播放即可显示和排序。
+ * 缓存（尤其是代价较高的响度结果）在变化后数秒内写盘，程序退出前（aboutToQuit）再写一次，析构时的保存只作兜底。
+ */
+class MediaProber : public QObject
+{
+    Q_OBJECT
+public:
+    static MediaProber *instance();
+
+    // 命中缓存时填充 info 并返回true（文件大小或修改时间变化视为未命中）
+    bool lookup(const QFileInfo &fileInfo, MediaInfo &info);
+
+    // 未命中缓存时提交后台探测，完成后发出 sigProbed
+    void request(const QFileInfo &fileInfo);
+
+    // 与 lookup 相同但不计入命中统计，用于收到 sigProbed 后读取探测结果
+    bool result(const QFileInfo &fileInfo, MediaInfo &info) const;
+
+    // 响度扫描结果与元数据存放在同一缓存条目中，文件变化时一并失效
+    bool lookupLoudness(const QFileInfo &fileInfo, LoudnessInfo &loudness) const;
+    void storeLoudness(const QFileInfo &fileInfo, const LoudnessInfo &loudness);
+
+    // 文件被删除或修改时丢弃缓存条目
+    void invalidate(const QString &path);
+
+    // 文件被重命名时把缓存条目迁移到新路径（大小与修改时间不变）
+    void rename(const QString &from, const QString &to);
+
+    // 缓存命中率与探测吞吐
+    QJsonObject stats() const;
+
+    // 将缓存写回磁盘
+    bool save();
+
+signals:
+    // 一批文件探测完成（合并发出），参数为文件绝对路径
+    void sigProbed(const QStringList &paths);
+
+private:
+    struct CacheEntry
+    {
+        qint64    size{0};
+        qint64    mtime{0};
+        bool         probed{false}; // 条目可能先由响度扫描建立，尚未探测元数据
+        bool         valid{false};  // 探测失败的文件也缓存，避免反复尝试
+        MediaInfo    info;
+        LoudnessInfo loudness;
+    };
+
+    // 大小与修改时间都与文件一致、且已探测过元数据的条目，否则为nullptr
+    const CacheEntry *freshEntry(const QFileInfo &fileInfo) const;
+
+    void onProbeFinished(const QString &path, qint64 size, qint64 mtime, bool valid, const MediaInfo &info, qint64 probeUs);
+    void flushProbed();
+    void load();
+    // 缓存有变化：标记并安排稍后写盘
+    void markDirty();
+
+    friend class MediaProbeTask;
+
+private:
+    explicit MediaProber(QObject *parent = nullptr);
+    ~MediaProber();
+
+    MediaProber(const MediaProber &) = delete;
+    MediaProber &operator=(const MediaProber &) = delete;
+
+    QHash<QString, CacheEntry> m_cache;
+    QSet<QString>              m_inFlight;
+    bool                       m_dirty{false};
+
+    QThreadPool                        m_workers;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+
+    QStringList m_probedPaths;
+    QTimer      m_flushTimer;
+    QTimer      m_saveTimer; // 合并连续的写入，变化后延迟写盘
+
+    // 统计
+    qint64 m_hits{0};
+    qint64 m_misses{0};
+    qint64 m_probed{0};
+    qint64 m_failed{0};
+    qint64 m_probeUs{0};      // 各次探测耗时之和
+    qint64 m_batchStartMs{0}; // 当前批次开始时刻，用于计算吞吐
+    qint64 m_batchProbed{0};
+};
+
+#endif // MEDIAPROBER_H
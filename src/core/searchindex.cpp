@@ -0,0 +1,240 @@
+#include "searchindex.h"
+
+#include <algorithm>
+#include <QElapsedTimer>
+
+// 失效文档超过该数量且多于有效文档时压缩倒排表
+static constexpr int kCompactThreshold = 1024;
+
+// 低于该得分的文档不作为结果：只零星命中几个三元组的文档与查询无关
+static constexpr int kMinScore = 12;
+
+namespace {
+
+inline quint64 packTrigram(const QString &text, int pos)
+{
+    return (quint64(text.at(pos).unicode()) << 32) | (quint64(text.at(pos + 1).unicode()) << 16)
+           | quint64(text.at(pos + 2).unicode());
+}
+
+// 词内允许缺失的三元组数：一个错字最多破坏3个三元组，最多容忍三分之一缺失，即一个错字
+inline int allowedMisses(int trigramCount)
+{
+    return qMin(3, trigramCount / 3);
+}
+
+} // namespace
+
+void SearchIndex::insert(const QString &key, const QString &name, const QString &extra)
+{
+    remove(key);
+
+    Document doc;
+    doc.key = key;
+    doc.name = normalize(name);
+    doc.extra = normalize(extra);
+    doc.alive = true;
+
+    const int id = int(m_docs.size());
+    m_docs.push_back(doc);
+    m_idOfKey.insert(key, id);
+    addPostings(id);
+}
+
+void SearchIndex::remove(const QString &key)
+{
+    auto it = m_idOfKey.find(key);
+    if (it == m_idOfKey.end())
+        return;
+
+    // 倒排表中的id保留到压缩时再清理，查询时跳过
+    Document &doc = m_docs[it.value()];
+    doc.alive = false;
+    doc.name.clear();
+    doc.extra.clear();
+    m_idOfKey.erase(it);
+
+    if (++m_dead > kCompactThreshold && m_dead > m_idOfKey.size())
+        compact();
+}
+
+void SearchIndex::clear()
+{
+    m_docs.clear();
+    m_idOfKey.clear();
+    m_postings.clear();
+    m_dead = 0;
+}
+
+SearchIndex::Result SearchIndex::search(const QString &query, int limit, int budgetUs) const
+{
+    Result        result;
+    const QString normalized = normalize(query);
+    if (normalized.isEmpty() || limit <= 0)
+        return result;
+    const QStringList terms = normalized.split(' ');
+
+    // 查询词切分为三元组（不加首尾填充，词中间的片段也能命中）
+    QSet<quint64> trigrams;
+    int           misses = 0;
+    for (const QString &term : terms) {
+        if (term.size() < 3)
+            continue;
+        for (int i = 0; i + 3 <= term.size(); ++i)
+            trigrams.insert(packTrigram(term, i));
+        misses += allowedMisses(term.size() - 2);
+    }
+    // 只有一两个字符的查询没有三元组可用，直接扫描
+    if (trigrams.isEmpty())
+        return scanShortQuery(terms, limit, budgetUs);
+
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 budgetNs = qint64(budgetUs) * 1000;
+
+    // 累计每个文档命中的三元组数，刚达到阈值时记为候选，打分时再逐词检查缺失数
+    const int        required = qMax(1, trigrams.size() - misses);
+    std::vector<int> candidates;
+    m_counts.assign(m_docs.size(), 0);
+    for (quint64 trigram : qAsConst(trigrams)) {
+        auto it = m_postings.constFind(trigram);
+        if (it == m_postings.constEnd())
+            continue;
+        for (int id : it.value()) {
+            if (++m_counts[id] == required)
+                candidates.push_back(id);
+        }
+        if (timer.nsecsElapsed() > budgetNs) {
+            result.complete = false;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const Document &doc = m_docs[candidates[i]];
+        if (doc.alive) {
+            const int score = scoreDocument(doc, terms, m_counts[candidates[i]]);
+            if (score >= kMinScore)
+                result.hits.append({doc.key, score});
+        }
+        if ((i & 255) == 255 && timer.nsecsElapsed() > budgetNs) {
+            result.complete = false;
+            break;
+        }
+    }
+
+    // 稳定排序：同分时保持加入顺序
+    std::stable_sort(result.hits.begin(), result.hits.end(), [](const Hit &a, const Hit &b) {
+        return a.score > b.score;
+    });
+    if (result.hits.size() > limit)
+        result.hits.erase(result.hits.begin() + limit, result.hits.end());
+    return result;
+}
+
+QString SearchIndex::normalize(const QString &text)
+{
+    // 折叠大小写，标点与分隔符统一为空格
+    QString folded = text.toCaseFolded();
+    for (QChar &c : folded) {
+        if (!c.isLetterOrNumber())
+            c = QLatin1Char(' ');
+    }
+    return folded.simplified();
+}
+
+void SearchIndex::collectTrigrams(const QString &text, QSet<quint64> &trigrams)
+{
+    if (text.isEmpty())
+        return;
+    // 首尾补空格，让一两个字符的词和词首也产生三元组
+    const QString padded = QLatin1Char(' ') + text + QLatin1Char(' ');
+    for (int i = 0; i + 3 <= padded.size(); ++i)
+        trigrams.insert(packTrigram(padded, i));
+}
+
+int SearchIndex::scoreDocument(const Document &doc, const QStringList &terms, int matchedTrigrams)
+{
+    int score = matchedTrigrams * 4;
+    for (const QString &term : terms) {
+        const int pos = doc.name.indexOf(term);
+        if (pos >= 0) {
+            score += 100;
+            if (pos == 0 || doc.name.at(pos - 1) == QLatin1Char(' '))
+                score += 50; // 词首匹配
+        } else if (doc.extra.contains(term)) {
+            score += 40;
+        } else if (term.size() < 3) {
+            return 0; // 短词无法容错，必须原样出现
+        } else {
+            // 没有原样出现的词逐个检查三元组，缺失超过允许值时不匹配
+            const int count = term.size() - 2;
+            int       missing = 0;
+            for (int i = 0; i < count; ++i) {
+                const QStringRef trigram = term.midRef(i, 3);
+                if (!doc.name.contains(trigram) && !doc.extra.contains(trigram))
+                    ++missing;
+            }
+            if (missing > allowedMisses(count))
+                return 0;
+        }
+    }
+    // 同等匹配下文件名越短越相关
+    return score - qMin(doc.name.size(), 200) / 20;
+}
+
+void SearchIndex::addPostings(int id)
+{
+    QSet<quint64> trigrams;
+    collectTrigrams(m_docs[id].name, trigrams);
+    collectTrigrams(m_docs[id].extra, trigrams);
+    for (quint64 trigram : qAsConst(trigrams))
+        m_postings[trigram].push_back(id);
+}
+
+void SearchIndex::compact()
+{
+    std::vector<Document> docs;
+    docs.reserve(m_idOfKey.size());
+    for (Document &doc : m_docs) {
+        if (doc.alive)
+            docs.push_back(std::move(doc));
+    }
+
+    m_docs.swap(docs);
+    m_idOfKey.clear();
+    m_postings.clear();
+    m_dead = 0;
+    for (int id = 0; id < int(m_docs.size()); ++id) {
+        m_idOfKey.insert(m_docs[id].key, id);
+        addPostings(id);
+    }
+}
+
+SearchIndex::Result SearchIndex::scanShortQuery(const QStringList &terms, int limit, int budgetUs) const
+{
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 budgetNs = qint64(budgetUs) * 1000;
+
+    Result result;
+    for (int id = 0; id < int(m_docs.size()); ++id) {
+        const Document &doc = m_docs[id];
+        if (doc.alive) {
+            const int score = scoreDocument(doc, terms, 0);
+            if (score >= kMinScore)
+                result.hits.append({doc.key, score});
+        }
+        if ((id & 1023) == 1023 && timer.nsecsElapsed() > budgetNs) {
+            result.complete = false;
+            break;
+        }
+    }
+
+    std::stable_sort(result.hits.begin(), result.hits.end(), [](const Hit &a, const Hit &b) {
+        return a.score > b.score;
+    });
+    if (result.hits.size() > limit)
+        result.hits.erase(result.hits.begin() + limit, result.hits.end());
+    return result;
+}
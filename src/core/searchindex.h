@@ -0,0 +1,69 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <vector>
+
+/**
+ * @brief 三元组（trigram）搜索索引 - 文件名、路径与元数据的增量索引
+ *
+ * 文本统一折叠大小写、标点视为分隔符后切分为三元组，倒排表记录包含该三元组的文档。
+ * 查询时累计每个文档命中的三元组数，每个词最多容忍一个错字（缺失不超过三分之一的三元组），
+ * 再以文件名/路径中的实际匹配情况打分排序，得分过低的文档不返回。
+ * 删除只做标记，失效文档过多时整体压缩。
+ */
+class SearchIndex
+{
+public:
+    struct Hit
+    {
+        QString key;
+        int     score{0};
+    };
+
+    struct Result
+    {
+        QList<Hit> hits;           // 按得分从高到低
+        bool       complete{true}; // 超出时间预算时为false，结果只覆盖部分文档
+    };
+
+    // 添加或更新文档，key 通常为文件绝对路径
+    void insert(const QString &key, const QString &name, const QString &extra);
+    void remove(const QString &key);
+    void clear();
+
+    int  size() const { return m_idOfKey.size(); }
+    bool contains(const QString &key) const { return m_idOfKey.contains(key); }
+
+    // 模糊查询，budgetUs 为本次查询的时间预算（微秒）
+    Result search(const QString &query, int limit = 200, int budgetUs = 8000) const;
+
+private:
+    struct Document
+    {
+        QString key;
+        QString name;  // 归一化后的文件名
+        QString extra; // 归一化后的路径与元数据
+        bool    alive{false};
+    };
+
+    static QString normalize(const QString &text);
+    static void    collectTrigrams(const QString &text, QSet<quint64> &trigrams);
+    static int     scoreDocument(const Document &doc, const QStringList &terms, int matchedTrigrams);
+
+    void   addPostings(int id);
+    void   compact();
+    Result scanShortQuery(const QStringList &terms, int limit, int budgetUs) const;
+
+    std::vector<Document>            m_docs;
+    QHash<QString, int>              m_idOfKey;
+    QHash<quint64, std::vector<int>> m_postings; // 三元组 -> 文档id（递增）
+    int                              m_dead{0}; // 已删除但仍留在倒排表中的文档数
+
+    mutable std::vector<quint16> m_counts; // 查询时的计数缓冲，避免每次分配
+};
+
+#endif // SEARCHINDEX_H
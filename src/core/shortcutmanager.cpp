@@ -151,7 +151,9 @@ UINT ShortcutManager::getVirtualKeyCode(const QString &keyStr) const
                                                     {"Left", VK_LEFT},
                                                     {"Right", VK_RIGHT},
                                                     {"Up", VK_UP},
-                                                    {"Down", VK_DOWN}};
+                                                    {"Down", VK_DOWN},
+                                                    {".", VK_OEM_PERIOD},
+                                                    {",", VK_OEM_COMMA}};
 
     // 检查是否是特殊键
     if (specialKeys.contains(keyStr)) {
@@ -1,6 +1,14 @@
 #include "clickmovableslider.h"
+#include "waveformbuilder.h"
 #include <QDebug>
 #include <QMouseEvent>
+#include <QPainter>
+
+// 波形配色：已播放部分沿用进度条的高亮色
+static const QColor kPlayedPeakColor(0xFA, 0xE1, 0x00);
+static const QColor kPlayedRmsColor(0xFF, 0xF0, 0x80);
+static const QColor kPeakColor(0x66, 0x66, 0x66);
+static const QColor kRmsColor(0x99, 0x99, 0x99);
 
 ClickMovableSlider::ClickMovableSlider(QWidget *parent)
     : QSlider(parent)
@@ -8,6 +16,12 @@ ClickMovableSlider::ClickMovableSlider(QWidget *parent)
     setMouseTracking(true);
 }
 
+void ClickMovableSlider::setWaveform(const WaveformData *waveform)
+{
+    m_waveform = waveform;
+    update();
+}
+
 void ClickMovableSlider::mousePressEvent(QMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton) {
@@ -43,3 +57,63 @@ void ClickMovableSlider::setPosition(int x)
         emit sigSeekTo(position);
     }
 }
+
+void ClickMovableSlider::paintEvent(QPaintEvent *event)
+{
+    if (!m_waveform || m_waveform->isEmpty() || orientation() != Qt::Horizontal) {
+        QSlider::paintEvent(event);
+        return;
+    }
+    paintWaveform();
+}
+
+void ClickMovableSlider::paintWaveform()
+{
+    const int w = width();
+    if (w <= 0)
+        return;
+
+    // 选取桶数不少于像素数的最粗一级，每像素合并其覆盖的桶
+    const QVector<WaveformPeak> &peaks = m_waveform->levelFor(w);
+    const int                    buckets = peaks.size();
+    const double                 mid = height() / 2.0;
+    const double                 half = qMax(1.0, mid - 1.0);
+    const int                    range = maximum() - minimum();
+    const int                    playedX = range > 0 ? int(double(sliderPosition() - minimum()) / range * w) : 0;
+
+    QVector<QLineF> playedPeaks, playedRms, restPeaks, restRms;
+    for (int x = 0; x < w; ++x) {
+        const int    first = int(qint64(x) * buckets / w);
+        const int    last = qMax(first + 1, int(qint64(x + 1) * buckets / w));
+        WaveformPeak peak;
+        for (int i = first; i < last && i < buckets; ++i)
+            peak = WaveformPeak::merge(peak, peaks.at(i));
+        if (!peak.isValid())
+            continue; // 尚未解码的区间留空，生成过程中逐步补齐
+
+        const bool played = x < playedX;
+        // 至少画出1像素，静音段也能看出进度
+        const double top = qMin(mid - 0.5, mid - peak.max * half);
+        const double bottom = qMax(mid + 0.5, mid - peak.min * half);
+        const double rms = peak.rms * half;
+        (played ? playedPeaks : restPeaks).append(QLineF(x + 0.5, top, x + 0.5, bottom));
+        if (rms >= 1.0)
+            (played ? playedRms : restRms).append(QLineF(x + 0.5, mid - rms, x + 0.5, mid + rms));
+    }
+
+    QPainter painter(this);
+    if (!isEnabled())
+        painter.setOpacity(0.5);
+    painter.setPen(kPeakColor);
+    painter.drawLines(restPeaks);
+    painter.setPen(kRmsColor);
+    painter.drawLines(restRms);
+    painter.setPen(kPlayedPeakColor);
+    painter.drawLines(playedPeaks);
+    painter.setPen(kPlayedRmsColor);
+    painter.drawLines(playedRms);
+
+    // 播放位置
+    painter.setPen(QColor(0xF0, 0xF0, 0xF0));
+    painter.drawLine(QLineF(playedX + 0.5, 0, playedX + 0.5, height()));
+}
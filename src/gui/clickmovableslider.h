@@ -3,12 +3,20 @@
 
 #include <QSlider>
 
+class WaveformData;
+
+/**
+ * @brief ClickMovableSlider - 点击即跳转的进度条，可叠加显示音频波形概览
+ */
 class ClickMovableSlider : public QSlider
 {
     Q_OBJECT
 public:
     ClickMovableSlider(QWidget *parent = nullptr);
 
+    // 设置波形数据（由调用方持有），nullptr 或空波形时按普通滑块绘制；数据更新后调用 update()
+    void setWaveform(const WaveformData *waveform);
+
 signals:
     void sigSeekTo(int position);
 
@@ -16,13 +24,17 @@ protected:
     void mousePressEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
 
 private:
     void setPosition(int x);
+    void paintWaveform();
 
 private:
     bool m_bPressed{false};
     int  m_pressPosition{0};
+
+    const WaveformData *m_waveform{nullptr};
 };
 
 #endif // CLICKMOVABLESLIDER_H
@@ -0,0 +1,125 @@
+#include "equalizerdialog.h"
+
+#include <QCheckBox>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QSlider>
+#include <QVBoxLayout>
+
+// 滑块以 0.1dB 为单位
+static constexpr int kSliderScale = 10;
+
+namespace {
+
+const char *const kBandNames[EqualizerSettings::kBands]
+    = {"31", "62", "125", "250", "500", "1k", "2k", "4k", "8k", "16k"};
+
+float sliderDb(const QSlider *slider)
+{
+    return float(slider->value()) / kSliderScale;
+}
+
+} // namespace
+
+EqualizerDialog::EqualizerDialog(const EqualizerSettings &settings, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("均衡器"));
+
+    m_enabled = new QCheckBox(tr("启用均衡器"), this);
+    m_enabled->setChecked(settings.enabled);
+    QPushButton *resetButton = new QPushButton(tr("重置"), this);
+
+    QHBoxLayout *topLayout = new QHBoxLayout;
+    topLayout->addWidget(m_enabled);
+    topLayout->addStretch();
+    topLayout->addWidget(resetButton);
+
+    // 列：前级 | 各频段 | 低音增强
+    QGridLayout *grid = new QGridLayout;
+    auto         addColumn = [&](int column, QSlider *slider, const QString &name, int labelIndex) {
+        QLabel *value = new QLabel(this);
+        QLabel *caption = new QLabel(name, this);
+        value->setAlignment(Qt::AlignCenter);
+        caption->setAlignment(Qt::AlignCenter);
+        grid->addWidget(value, 0, column);
+        grid->addWidget(slider, 1, column, Qt::AlignHCenter);
+        grid->addWidget(caption, 2, column);
+        m_valueLabels[labelIndex] = value;
+    };
+
+    m_preamp = createSlider(settings.preampDb, -EqualizerSettings::kMaxGainDb);
+    addColumn(0, m_preamp, tr("前级"), EqualizerSettings::kBands);
+    grid->setColumnMinimumWidth(1, 12);
+    for (int i = 0; i < EqualizerSettings::kBands; ++i) {
+        m_bands[i] = createSlider(settings.bandsDb[i], -EqualizerSettings::kMaxGainDb);
+        addColumn(i + 2, m_bands[i], QString::fromLatin1(kBandNames[i]), i);
+    }
+    grid->setColumnMinimumWidth(EqualizerSettings::kBands + 2, 12);
+    m_bassBoost = createSlider(settings.bassBoostDb, 0.0f);
+    addColumn(EqualizerSettings::kBands + 3, m_bassBoost, tr("低音"), EqualizerSettings::kBands + 1);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(topLayout);
+    layout->addLayout(grid);
+
+    connect(m_enabled, &QCheckBox::toggled, this, &EqualizerDialog::onValueChanged);
+    connect(resetButton, &QPushButton::clicked, this, &EqualizerDialog::onReset);
+
+    // 只刷新数值标签，不发信号
+    m_updating = true;
+    onValueChanged();
+    m_updating = false;
+}
+
+QSlider *EqualizerDialog::createSlider(float db, float minDb)
+{
+    QSlider *slider = new QSlider(Qt::Vertical, this);
+    slider->setRange(int(minDb * kSliderScale), int(EqualizerSettings::kMaxGainDb * kSliderScale));
+    slider->setValue(qRound(db * kSliderScale));
+    slider->setSingleStep(5);
+    slider->setPageStep(30);
+    slider->setTickPosition(QSlider::TicksBothSides);
+    slider->setTickInterval(60);
+    slider->setMinimumHeight(140);
+    connect(slider, &QSlider::valueChanged, this, &EqualizerDialog::onValueChanged);
+    return slider;
+}
+
+EqualizerSettings EqualizerDialog::settings() const
+{
+    EqualizerSettings settings;
+    settings.enabled = m_enabled->isChecked();
+    settings.preampDb = sliderDb(m_preamp);
+    settings.bassBoostDb = sliderDb(m_bassBoost);
+    for (int i = 0; i < EqualizerSettings::kBands; ++i)
+        settings.bandsDb[i] = sliderDb(m_bands[i]);
+    return settings;
+}
+
+void EqualizerDialog::onValueChanged()
+{
+    const EqualizerSettings current = settings();
+    auto                    format = [](float db) { return QString::number(db, 'f', 1); };
+    for (int i = 0; i < EqualizerSettings::kBands; ++i)
+        m_valueLabels[i]->setText(format(current.bandsDb[i]));
+    m_valueLabels[EqualizerSettings::kBands]->setText(format(current.preampDb));
+    m_valueLabels[EqualizerSettings::kBands + 1]->setText(format(current.bassBoostDb));
+
+    if (!m_updating)
+        emit sigChanged(current);
+}
+
+void EqualizerDialog::onReset()
+{
+    // 归零过程中只在最后发一次信号
+    m_updating = true;
+    m_preamp->setValue(0);
+    m_bassBoost->setValue(0);
+    for (QSlider *slider : m_bands)
+        slider->setValue(0);
+    m_updating = false;
+    onValueChanged();
+}
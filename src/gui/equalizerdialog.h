@@ -0,0 +1,43 @@
+#ifndef EQUALIZERDIALOG_H
+#define EQUALIZERDIALOG_H
+
+#include "constants.h"
+
+#include <array>
+#include <QDialog>
+
+class QCheckBox;
+class QLabel;
+class QSlider;
+
+/**
+ * @brief EqualizerDialog - 前级增益、10段均衡与低音增强的调节窗口
+ *
+ * 非模态，任意滑块变化时发出 sigChanged，由主窗口转发给播放管线并保存。
+ */
+class EqualizerDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit EqualizerDialog(const EqualizerSettings &settings, QWidget *parent = nullptr);
+
+    EqualizerSettings settings() const;
+
+signals:
+    void sigChanged(const EqualizerSettings &settings);
+
+private:
+    QSlider *createSlider(float db, float minDb);
+    void     onValueChanged();
+    void     onReset();
+
+private:
+    QCheckBox                                          *m_enabled;
+    QSlider                                            *m_preamp;
+    QSlider                                            *m_bassBoost;
+    std::array<QSlider *, EqualizerSettings::kBands>    m_bands;
+    std::array<QLabel *, EqualizerSettings::kBands + 2> m_valueLabels; // 各频段、前级、低音增强的数值
+    bool                                                m_updating{false};
+};
+
+#endif // EQUALIZERDIALOG_H
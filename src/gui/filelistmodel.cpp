@@ -1,17 +1,126 @@
 #include "filelistmodel.h"
+#include "librarywatcher.h"
+#include "thumbnailprovider.h"
+#include <algorithm>
+#include <climits>
 #include <QApplication>
 #include <QDebug>
+#include <QDirIterator>
+#include <QHash>
+#include <QPersistentModelIndex>
+#include <QRunnable>
+#include <QSet>
 #include <QStorageInfo>
 #include <QStyle>
 
 #define ROOT_NAME tr("::MyComputer")
 
+// 后台枚举每批投递的条目数
+static constexpr int kScanBatchSize = 512;
+// 每次 fetchMore 加入模型的条目数
+static constexpr int kFetchBatchSize = 256;
+
+static bool fileNameLessThan(const QFileInfo &a, const QFileInfo &b)
+{
+    return QString::compare(a.fileName(), b.fileName(), Qt::CaseInsensitive) < 0;
+}
+
+// 模型中的整体顺序：目录在前，各自按名称排序
+static bool entryLessThan(const QFileInfo &a, const QFileInfo &b)
+{
+    if (a.isDir() != b.isDir())
+        return a.isDir();
+    return fileNameLessThan(a, b);
+}
+
+/**
+ * @brief DirectoryScanTask - 在线程池中枚举目录，先整批投递已排序的子目录，再分批投递媒体文件
+ */
+class DirectoryScanTask : public QRunnable
+{
+public:
+    DirectoryScanTask(FileListModel *model, const QString &path, int generation, std::shared_ptr<std::atomic<bool>> cancel)
+        : m_model(model)
+        , m_path(path)
+        , m_generation(generation)
+        , m_cancel(std::move(cancel))
+    {}
+
+    void run() override
+    {
+        // 子目录通常较少，排序后一次投递，保证目录在前
+        QList<QFileInfo> dirs;
+        QDirIterator     dirIt(m_path, QDir::AllDirs | QDir::NoDotAndDotDot);
+        while (dirIt.hasNext() && !isCanceled()) {
+            dirIt.next();
+            dirs.append(dirIt.fileInfo());
+        }
+        std::sort(dirs.begin(), dirs.end(), fileNameLessThan);
+        post(dirs);
+
+        QList<QFileInfo> batch;
+        batch.reserve(kScanBatchSize);
+        QDirIterator fileIt(m_path, QDir::Files);
+        while (fileIt.hasNext() && !isCanceled()) {
+            fileIt.next();
+            const QFileInfo info = fileIt.fileInfo();
+            if (!FileListModel::isMediaFile(info))
+                continue;
+            batch.append(info);
+            if (batch.size() >= kScanBatchSize) {
+                std::sort(batch.begin(), batch.end(), fileNameLessThan);
+                post(batch);
+                batch.clear();
+            }
+        }
+        std::sort(batch.begin(), batch.end(), fileNameLessThan);
+        post(batch);
+
+        if (isCanceled())
+            return;
+        FileListModel *model = m_model;
+        const int      generation = m_generation;
+        QMetaObject::invokeMethod(
+            model, [model, generation]() { model->onScanFinished(generation); }, Qt::QueuedConnection);
+    }
+
+private:
+    bool isCanceled() const { return m_cancel->load(std::memory_order_relaxed); }
+
+    void post(const QList<QFileInfo> &batch)
+    {
+        if (batch.isEmpty() || isCanceled())
+            return;
+        // 模型析构前会取消并等待线程池，投递时模型一定有效
+        FileListModel *model = m_model;
+        const int      generation = m_generation;
+        QMetaObject::invokeMethod(
+            model, [model, generation, batch]() { model->onScanBatch(generation, batch); }, Qt::QueuedConnection);
+    }
+
+private:
+    FileListModel                     *m_model;
+    QString                            m_path;
+    int                                m_generation;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+
 FileListModel::FileListModel(QObject *parent)
     : QAbstractListModel(parent)
 {
+    // 同一时刻只枚举一个目录
+    m_scanPool.setMaxThreadCount(1);
+
     // 初始化图标提供器，设置选项以获取系统图标
     m_iconProvider = new QFileIconProvider();
 
+    // 文件图标与缩略图异步获取，就绪后刷新对应行
+    m_thumbnails = new ThumbnailProvider(this);
+    connect(m_thumbnails, &ThumbnailProvider::sigIconsUpdated, this, &FileListModel::onIconsUpdated);
+
+    // 当前目录的文件变化增量应用到模型，无需重新枚举
+    connect(LibraryWatcher::instance(), &LibraryWatcher::sigChanged, this, &FileListModel::onFilesChanged);
+
     // 初始化为系统视频目录
     QString videoPath = QDir::homePath() + "/Videos";
 
@@ -25,6 +134,10 @@ FileListModel::FileListModel(QObject *parent)
 
 FileListModel::~FileListModel()
 {
+    if (!m_watchedDir.isEmpty())
+        LibraryWatcher::instance()->unwatchDirectory(m_watchedDir);
+    cancelScan();
+    m_scanPool.waitForDone();
     delete m_iconProvider;
 }
 
@@ -87,6 +200,29 @@ QVariant FileListModel::data(const QModelIndex &index, int role) const
     }
 }
 
+bool FileListModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return false;
+    return !m_pending.isEmpty();
+}
+
+void FileListModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || m_pending.isEmpty())
+        return;
+
+    const int count = qMin(kFetchBatchSize, m_pending.size());
+    const int first = m_fileList.size() + (shouldShowUpDirectory() ? 1 : 0);
+
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+    for (int i = 0; i < count; ++i)
+        m_rowOfPath.insert(m_pending.at(i).absoluteFilePath(), m_fileList.size() + i);
+    m_fileList.append(m_pending.mid(0, count));
+    m_pending.erase(m_pending.begin(), m_pending.begin() + count);
+    endInsertRows();
+}
+
 void FileListModel::setDirectory(const QString &path)
 {
     beginResetModel();
@@ -97,6 +233,8 @@ void FileListModel::setDirectory(const QString &path)
     }
 
     m_currentDir.setPath(path);
+    updateDirectoryState();
+    watchCurrentDirectory();
     refreshFileList();
 
     endResetModel();
@@ -134,10 +272,7 @@ QString FileListModel::filePath(const QModelIndex &index) const
         QDir parentDir(m_currentDir);
 
         // 检查当前是否是盘符根目录
-        QStorageInfo storageInfo(m_currentDir.absolutePath());
-        bool         isInDriveRoot = (m_currentDir.absolutePath() == storageInfo.rootPath());
-
-        if (isInDriveRoot) {
+        if (m_isDriveRoot) {
             // 在Windows中返回"计算机"特殊文件夹
             return ROOT_NAME;
         } else {
@@ -154,9 +289,18 @@ QString FileListModel::filePath(const QModelIndex &index) const
     return m_fileList.at(actualRow).absoluteFilePath();
 }
 
+bool FileListModel::isScanning() const
+{
+    return m_scanning;
+}
+
 void FileListModel::refreshFileList()
 {
+    cancelScan();
+    m_thumbnails->cancelPending();
     m_fileList.clear();
+    m_pending.clear();
+    m_rowOfPath.clear();
 
     if (m_currentDir.absolutePath() == ROOT_NAME) {
         // 列出所有磁盘驱动器
@@ -169,27 +313,201 @@ void FileListModel::refreshFileList()
         return;
     }
 
-    // 设置文件过滤器
-    QDir::Filters filters = QDir::AllDirs | QDir::Files | QDir::NoDotAndDotDot;
+    // 普通目录在后台枚举，结果通过 onScanBatch 分批到达
+    startScan();
+}
+
+void FileListModel::startScan()
+{
+    m_scanCancel = std::make_shared<std::atomic<bool>>(false);
+    m_scanning = true;
+    m_scanBatches = 0;
+    m_scanPool.start(
+        new DirectoryScanTask(this, m_currentDir.absolutePath(), ++m_scanGeneration, m_scanCancel));
+}
+
+void FileListModel::cancelScan()
+{
+    if (m_scanCancel)
+        m_scanCancel->store(true, std::memory_order_relaxed);
+    m_scanning = false;
+}
+
+void FileListModel::onScanBatch(int generation, const QList<QFileInfo> &batch)
+{
+    // 已切换目录，丢弃过期结果
+    if (generation != m_scanGeneration)
+        return;
+
+    if (!batch.first().isDir())
+        ++m_scanBatches;
+    m_pending.append(batch);
+
+    // 首屏由模型主动加载，其余等视图滚动时通过 fetchMore 拉取
+    if (m_fileList.size() < kFetchBatchSize)
+        fetchMore(QModelIndex());
+}
+
+void FileListModel::onScanFinished(int generation)
+{
+    if (generation != m_scanGeneration)
+        return;
+    m_scanning = false;
+
+    // 文件分多批到达时，各批内部有序，整体需再排一次；目录始终在前
+    if (m_scanBatches > 1) {
+        QList<QFileInfo> all = m_fileList + m_pending;
+        auto             firstFile = std::stable_partition(all.begin(), all.end(), [](const QFileInfo &info) {
+            return info.isDir();
+        });
+        std::stable_sort(firstFile, all.end(), fileNameLessThan);
+
+        emit layoutAboutToBeChanged();
+        const QModelIndexList oldIndexes = persistentIndexList();
+        QStringList           oldPaths;
+        for (const QModelIndex &oldIndex : oldIndexes)
+            oldPaths.append(filePath(oldIndex));
+
+        const int           offset = shouldShowUpDirectory() ? 1 : 0;
+        QHash<QString, int> newRows;
+        for (int i = 0; i < m_fileList.size(); ++i)
+            newRows.insert(all.at(i).absoluteFilePath(), i);
+
+        m_fileList = all.mid(0, m_fileList.size());
+        m_pending = all.mid(m_fileList.size());
+        rebuildRowIndex();
+
+        QModelIndexList newIndexes;
+        for (int i = 0; i < oldIndexes.size(); ++i) {
+            const QModelIndex &oldIndex = oldIndexes.at(i);
+            if (oldIndex.row() < offset) {
+                newIndexes.append(oldIndex);
+                continue;
+            }
+            // 已加载的条目可能被排到未加载部分，此时索引失效
+            const int newRow = newRows.value(oldPaths.at(i), -1);
+            newIndexes.append(newRow >= 0 ? index(newRow + offset) : QModelIndex());
+        }
+        changePersistentIndexList(oldIndexes, newIndexes);
+        emit layoutChanged();
+    }
+
+    emit sigScanFinished(m_fileList.size() + m_pending.size());
+}
+
+void FileListModel::onIconsUpdated(const QStringList &paths)
+{
+    // 合并为一次覆盖最小到最大行的刷新
+    int first = INT_MAX;
+    int last = -1;
+    for (const QString &path : paths) {
+        const int row = m_rowOfPath.value(path, -1);
+        if (row < 0)
+            continue;
+        first = qMin(first, row);
+        last = qMax(last, row);
+    }
+    if (last < 0)
+        return;
+
+    const int offset = shouldShowUpDirectory() ? 1 : 0;
+    emit      dataChanged(index(first + offset), index(last + offset), {Qt::DecorationRole});
+}
+
+void FileListModel::onFilesChanged(const FileChanges &changes)
+{
+    // 枚举进行中的目录由枚举结果为准
+    if (changes.directory != m_watchedDir || m_scanning)
+        return;
+
+    const int offset = shouldShowUpDirectory() ? 1 : 0;
 
-    // 获取所有文件和文件夹
-    QFileInfoList allFiles = m_currentDir.entryInfoList(filters, QDir::DirsFirst);
+    // 删除（重命名视为删除旧名+新增新名）：已加载的行从后往前删，未加载的直接从待取列表移除
+    QSet<QString> removed;
+    for (const QString &path : changes.removed)
+        removed.insert(path);
+    for (const auto &rename : changes.renamed)
+        removed.insert(rename.first);
 
-    // 过滤出媒体文件和文件夹
-    for (const QFileInfo &fileInfo : allFiles) {
-        if (fileInfo.isDir() || isMediaFile(fileInfo)) {
-            m_fileList.append(fileInfo);
+    QList<int> rows;
+    for (const QString &path : qAsConst(removed)) {
+        const int row = m_rowOfPath.value(path, -1);
+        if (row >= 0)
+            rows.append(row);
+    }
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    for (int row : qAsConst(rows)) {
+        beginRemoveRows(QModelIndex(), row + offset, row + offset);
+        m_fileList.removeAt(row);
+        endRemoveRows();
+    }
+    m_pending.erase(std::remove_if(m_pending.begin(),
+                                   m_pending.end(),
+                                   [&removed](const QFileInfo &info) {
+                                       return removed.contains(info.absoluteFilePath());
+                                   }),
+                    m_pending.end());
+
+    // 新增：按排序位置插入；落在已加载部分之后的放入待取列表
+    QStringList added = changes.added;
+    for (const auto &rename : changes.renamed)
+        added.append(rename.second);
+    if (!rows.isEmpty())
+        rebuildRowIndex();
+    for (const QString &path : qAsConst(added)) {
+        const QFileInfo info(path);
+        if (!info.exists() || !isMediaFile(info) || m_rowOfPath.contains(path))
+            continue;
+        const int pos = int(std::lower_bound(m_fileList.begin(), m_fileList.end(), info, entryLessThan)
+                            - m_fileList.begin());
+        if (pos == m_fileList.size() && !m_pending.isEmpty()) {
+            m_pending.insert(std::lower_bound(m_pending.begin(), m_pending.end(), info, entryLessThan), info);
+            continue;
         }
+        beginInsertRows(QModelIndex(), pos + offset, pos + offset);
+        m_fileList.insert(pos, info);
+        m_rowOfPath.insert(path, -1); // 占位防止同批重复，随后统一重建
+        endInsertRows();
+    }
+    rebuildRowIndex();
+
+    // 修改：刷新文件信息，缩略图以 路径+大小+修改时间 为键会自动重新生成
+    for (const QString &path : changes.modified) {
+        const int row = m_rowOfPath.value(path, -1);
+        if (row < 0)
+            continue;
+        m_fileList[row].refresh();
+        emit dataChanged(index(row + offset), index(row + offset));
     }
 }
 
-bool FileListModel::isMediaFile(const QFileInfo &fileInfo) const
+void FileListModel::watchCurrentDirectory()
+{
+    const QString dir = m_currentDir.absolutePath() == ROOT_NAME ? QString() : m_currentDir.absolutePath();
+    if (dir == m_watchedDir)
+        return;
+    if (!m_watchedDir.isEmpty())
+        LibraryWatcher::instance()->unwatchDirectory(m_watchedDir);
+    m_watchedDir = dir;
+    if (!m_watchedDir.isEmpty())
+        LibraryWatcher::instance()->watchDirectory(m_watchedDir);
+}
+
+void FileListModel::rebuildRowIndex()
+{
+    m_rowOfPath.clear();
+    m_rowOfPath.reserve(m_fileList.size());
+    for (int i = 0; i < m_fileList.size(); ++i)
+        m_rowOfPath.insert(m_fileList.at(i).absoluteFilePath(), i);
+}
+
+bool FileListModel::isMediaFile(const QFileInfo &fileInfo)
 {
     if (fileInfo.isDir())
         return true;
 
     // 常见音视频文件扩展名
-    static QStringList mediaExtensions = {// 视频格式
+    static const QSet<QString> mediaExtensions = {// 视频格式
                                           "mp4",
                                           "avi",
                                           "mkv",
@@ -211,25 +529,31 @@ bool FileListModel::isMediaFile(const QFileInfo &fileInfo) const
                                           "m4a",
                                           "opus"};
 
-    QString ext = fileInfo.suffix().toLower();
-    return mediaExtensions.contains(ext);
+    return mediaExtensions.contains(fileInfo.suffix().toLower());
 }
 
 QIcon FileListModel::getFileIcon(const QFileInfo &fileInfo) const
 {
-    // 使用QFileIconProvider获取与系统一致的图标
-    return m_iconProvider->icon(fileInfo);
+    // 类型图标按扩展名缓存，视频文件的缩略图在后台生成，就绪前以类型图标占位
+    return m_thumbnails->icon(fileInfo);
 }
 
 bool FileListModel::shouldShowUpDirectory() const
+{
+    return m_showUpDirectory;
+}
+
+void FileListModel::updateDirectoryState()
 {
     if (m_currentDir.absolutePath() == ROOT_NAME) {
-        return false;
+        m_isDriveRoot = false;
+        m_showUpDirectory = false;
+        return;
     }
-    // 判断是否为驱动器根目录（例如C:/）
+    // 判断是否为驱动器根目录（例如C:/），QStorageInfo 较慢，每个目录只查询一次
     QStorageInfo storageInfo(m_currentDir.absolutePath());
-    bool         isInDriveRoot = (m_currentDir.absolutePath() == storageInfo.rootPath());
+    m_isDriveRoot = (m_currentDir.absolutePath() == storageInfo.rootPath());
 
     // 如果不是系统根目录或者是驱动器根目录，则显示返回上层选项
-    return (m_currentDir.path() != QDir::rootPath() || isInDriveRoot);
+    m_showUpDirectory = (m_currentDir.path() != QDir::rootPath() || m_isDriveRoot);
 }
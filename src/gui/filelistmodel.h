@@ -1,12 +1,22 @@
 #ifndef FILELISTMODEL_H
 #define FILELISTMODEL_H
 
+#include <atomic>
+#include <memory>
 #include <QAbstractListModel>
 #include <QDir>
 #include <QFileIconProvider>
 #include <QFileInfo>
+#include <QHash>
 #include <QList>
+#include <QThreadPool>
 
+class ThumbnailProvider;
+struct FileChanges;
+
+/**
+ * @brief 文件浏览模型 - 目录在后台线程枚举，结果分批进入待取列表，视图通过 fetchMore 增量加载
+ */
 class FileListModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -18,21 +28,60 @@ public:
     int      rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
+    // 增量加载
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
     void    setDirectory(const QString &path);
     QString currentDirectory() const;
     bool    isDirectory(const QModelIndex &index) const;
     QString filePath(const QModelIndex &index) const;
 
+    // 是否仍在枚举当前目录
+    bool isScanning() const;
+
+    // 判断是否为支持的媒体文件（可在任意线程调用）
+    static bool isMediaFile(const QFileInfo &fileInfo);
+
+signals:
+    // 当前目录枚举完成
+    void sigScanFinished(int count);
+
 private:
     void  refreshFileList();
-    bool  isMediaFile(const QFileInfo &fileInfo) const;
+    void  startScan();
+    void  cancelScan();
+    void  onScanBatch(int generation, const QList<QFileInfo> &batch);
+    void  onScanFinished(int generation);
+    void  onIconsUpdated(const QStringList &paths);
+    void  onFilesChanged(const FileChanges &changes); // 当前目录的增量变化
+    void  watchCurrentDirectory();
+    void  rebuildRowIndex();
     QIcon getFileIcon(const QFileInfo &fileInfo) const;
     bool  shouldShowUpDirectory() const; // 判断是否显示"返回上一级"选项
+    void  updateDirectoryState();        // 缓存与 QStorageInfo 相关的判断
+
+    friend class DirectoryScanTask;
+
+    QDir                m_currentDir;
+    QList<QFileInfo>    m_fileList; // 已加入模型的条目
+    QList<QFileInfo>    m_pending;  // 已枚举、等待 fetchMore 的条目
+    QFileIconProvider  *m_iconProvider;
+    ThumbnailProvider  *m_thumbnails;
+    QHash<QString, int> m_rowOfPath;   // 绝对路径 -> m_fileList 中的行，用于缩略图就绪后定位
+    QString             m_previousDir; // 上一层目录
+    QString             m_watchedDir;  // 正在监视的目录（"此电脑"不监视）
+
+    // 目录状态缓存，setDirectory 时计算一次
+    bool m_showUpDirectory{false};
+    bool m_isDriveRoot{false};
 
-    QDir               m_currentDir;
-    QList<QFileInfo>   m_fileList;
-    QFileIconProvider *m_iconProvider;
-    QString            m_previousDir; // 上一层目录
+    // 后台枚举
+    QThreadPool                        m_scanPool;
+    std::shared_ptr<std::atomic<bool>> m_scanCancel;
+    int                                m_scanGeneration{0};
+    bool                               m_scanning{false};
+    int                                m_scanBatches{0};
 };
 
 #endif // FILELISTMODEL_H
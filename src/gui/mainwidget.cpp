@@ -4,6 +4,10 @@
 #include "audiorenderthread.h"
 #include "common.h"
 #include "demuxthread.h"
+#include "equalizerdialog.h"
+#include "filelistmodel.h"
+#include "loudnessscanner.h"
+#include "playtrace.h"
 #include "renderthread.h"
 #include "sdlwidget.h"
 #include "shortcutmanager.h"
@@ -11,26 +15,83 @@
 #include "ui_mainwidget.h"
 #include "videodecodethread.h"
 
+#include <QActionGroup>
 #include <QApplication>
 #include <QCloseEvent>
 #include <QCursor>
 #include <QDebug>
+#include <QDirIterator>
 #include <QEvent>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QIcon>
 #include <QMessageBox>
 #include <QMouseEvent>
+#include <QRunnable>
 #include <QScreen>
 #include <QStandardPaths>
 #include <QStyle>
 #include <QWindow>
 
+// 打开文件夹时每批加入默认专辑的文件数
+static constexpr int kFolderScanBatchSize = 512;
+
+/**
+ * @brief FolderScanTask - 在线程池中递归收集文件夹里的媒体文件，分批投递到界面线程加入默认专辑
+ */
+class FolderScanTask : public QRunnable
+{
+public:
+    FolderScanTask(MainWidget *widget, const QString &path, std::shared_ptr<std::atomic<bool>> cancel)
+        : m_widget(widget)
+        , m_path(path)
+        , m_cancel(std::move(cancel))
+    {}
+
+    void run() override
+    {
+        QStringList batch;
+        batch.reserve(kFolderScanBatchSize);
+        QDirIterator it(m_path, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext() && !isCanceled()) {
+            it.next();
+            if (!FileListModel::isMediaFile(it.fileInfo()))
+                continue;
+            batch.append(it.filePath());
+            if (batch.size() >= kFolderScanBatchSize) {
+                post(batch);
+                batch.clear();
+            }
+        }
+        post(batch);
+    }
+
+private:
+    bool isCanceled() const { return m_cancel->load(std::memory_order_relaxed); }
+
+    void post(const QStringList &files)
+    {
+        if (files.isEmpty() || isCanceled())
+            return;
+        // 窗口析构前会取消并等待线程池，投递时窗口一定有效
+        MainWidget *widget = m_widget;
+        QMetaObject::invokeMethod(
+            widget, [widget, files]() { widget->onFolderFilesFound(files); }, Qt::QueuedConnection);
+    }
+
+private:
+    MainWidget                        *m_widget;
+    QString                            m_path;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+
 MainWidget::MainWidget(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::MainWidget)
     , m_threadManager(nullptr)
 {
     ui->setupUi(this);
+    m_folderScanPool.setMaxThreadCount(1);
     setWindowFlags(windowFlags() | Qt::FramelessWindowHint);
     setMouseTracking(true);
 
@@ -69,6 +130,10 @@ MainWidget::MainWidget(QWidget *parent)
 
 MainWidget::~MainWidget()
 {
+    m_folderScanCancel->store(true);
+    m_folderScanPool.clear();
+    m_folderScanPool.waitForDone();
+
     delete ui;
     delete m_menu;
     delete m_trayMenu;
@@ -83,11 +148,30 @@ void MainWidget::changeEvent(QEvent *event)
         } else if (windowState() & Qt::WindowNoState) {
             m_isMaximized = false;
         }
+        updateVideoVisibility();
     }
 
     QWidget::changeEvent(event);
 }
 
+void MainWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    updateVideoVisibility();
+}
+
+void MainWidget::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    updateVideoVisibility();
+}
+
+void MainWidget::updateVideoVisibility()
+{
+    if (m_threadManager)
+        m_threadManager->setVideoVisible(isVisible() && !isMinimized());
+}
+
 void MainWidget::mousePressEvent(QMouseEvent *event)
 {
     if (m_isMaximized) {
@@ -232,6 +316,50 @@ void MainWidget::setupMenu()
     openFolderAction->setShortcut(QKeySequence("F2"));
     QAction *closeAction = new QAction(tr("关闭(F4)"), this);
     closeAction->setShortcut(QKeySequence("F4"));
+    QAction *spectrumAction = new QAction(tr("频谱(F6)"), this);
+    spectrumAction->setShortcut(QKeySequence("F6"));
+    spectrumAction->setCheckable(true);
+    QAction *audioOnlyAction = new QAction(tr("仅播放音频"), this);
+    audioOnlyAction->setCheckable(true);
+    audioOnlyAction->setChecked(AppContext::instance()->getAppData()->isAudioOnly());
+    QAction      *equalizerAction = new QAction(tr("均衡器"), this);
+    QMenu        *downmixMenu = new QMenu(tr("声道"), m_menu);
+    QActionGroup *downmixGroup = new QActionGroup(downmixMenu);
+    const QPair<QString, DownmixMode> downmixModes[] = {{tr("自动"), DownmixMode::Auto},
+                                                        {tr("立体声"), DownmixMode::Stereo},
+                                                        {tr("耳机（双耳）"), DownmixMode::Binaural}};
+    for (const auto &mode : downmixModes) {
+        QAction *action = downmixMenu->addAction(mode.first);
+        action->setCheckable(true);
+        action->setData(int(mode.second));
+        action->setChecked(mode.second == AppContext::instance()->getAppData()->getDownmixMode());
+        downmixGroup->addAction(action);
+    }
+    QMenu        *syncMenu = new QMenu(tr("同步时钟"), m_menu);
+    QActionGroup *syncGroup = new QActionGroup(syncMenu);
+    const QPair<QString, SyncMaster> syncMasters[] = {{tr("自动"), SyncMaster::Auto},
+                                                      {tr("音频"), SyncMaster::Audio},
+                                                      {tr("视频"), SyncMaster::Video},
+                                                      {tr("外部时钟"), SyncMaster::External}};
+    for (const auto &master : syncMasters) {
+        QAction *action = syncMenu->addAction(master.first);
+        action->setCheckable(true);
+        action->setData(int(master.second));
+        action->setChecked(master.second == AppContext::instance()->getAppData()->getSyncMaster());
+        syncGroup->addAction(action);
+    }
+    QMenu        *replayGainMenu = new QMenu(tr("音量均衡"), m_menu);
+    QActionGroup *replayGainGroup = new QActionGroup(replayGainMenu);
+    const QPair<QString, ReplayGainMode> replayGainModes[] = {{tr("关闭"), ReplayGainMode::Off},
+                                                              {tr("按曲目"), ReplayGainMode::Track},
+                                                              {tr("按专辑"), ReplayGainMode::Album}};
+    for (const auto &mode : replayGainModes) {
+        QAction *action = replayGainMenu->addAction(mode.first);
+        action->setCheckable(true);
+        action->setData(int(mode.second));
+        action->setChecked(mode.second == AppContext::instance()->getAppData()->getReplayGainMode());
+        replayGainGroup->addAction(action);
+    }
     QAction *optionsAction = new QAction(tr("选项(F5)"), this);
     optionsAction->setShortcut(QKeySequence("F5"));
     QAction *aboutAction = new QAction(tr("关于(F12)"), this);
@@ -244,6 +372,12 @@ void MainWidget::setupMenu()
     m_menu->addAction(openFolderAction);
     m_menu->addAction(closeAction);
     m_menu->addSeparator();
+    m_menu->addAction(spectrumAction);
+    m_menu->addAction(audioOnlyAction);
+    m_menu->addAction(equalizerAction);
+    m_menu->addMenu(downmixMenu);
+    m_menu->addMenu(syncMenu);
+    m_menu->addMenu(replayGainMenu);
     m_menu->addAction(optionsAction);
     m_menu->addAction(aboutAction);
     m_menu->addSeparator();
@@ -253,6 +387,32 @@ void MainWidget::setupMenu()
     connect(openFileAction, &QAction::triggered, this, &MainWidget::onOpenFileDlg);
     connect(openFolderAction, &QAction::triggered, this, &MainWidget::onOpenFolder);
     connect(closeAction, &QAction::triggered, this, &MainWidget::onCloseToTray);
+    connect(spectrumAction, &QAction::toggled, ui->videoWidget, &VideoWidget::setSpectrumVisible);
+    connect(audioOnlyAction, &QAction::toggled, this, [this](bool checked) {
+        AppContext::instance()->getAppData()->setAudioOnly(checked);
+        m_threadManager->setAudioOnly(checked);
+        // 播放中切换时从当前位置重新打开，使视频管线立即启停
+        if (m_threadManager->isPlaying() && !m_currentFile.isEmpty()) {
+            const int64_t position = m_threadManager->getPlayDuration();
+            if (onOpenFile(m_currentFile))
+                m_threadManager->seekToPosition(position);
+        }
+    });
+    connect(equalizerAction, &QAction::triggered, this, &MainWidget::onEqualizer);
+    connect(downmixGroup, &QActionGroup::triggered, this, [this](QAction *action) {
+        const DownmixMode mode = DownmixMode(action->data().toInt());
+        AppContext::instance()->getAppData()->setDownmixMode(mode);
+        m_threadManager->setDownmixMode(mode);
+    });
+    connect(syncGroup, &QActionGroup::triggered, this, [this](QAction *action) {
+        const SyncMaster master = SyncMaster(action->data().toInt());
+        AppContext::instance()->getAppData()->setSyncMaster(master);
+        m_threadManager->setSyncMaster(master);
+    });
+    connect(replayGainGroup, &QActionGroup::triggered, this, [this](QAction *action) {
+        AppContext::instance()->getAppData()->setReplayGainMode(ReplayGainMode(action->data().toInt()));
+        applyReplayGain();
+    });
     connect(optionsAction, &QAction::triggered, this, &MainWidget::onOptions);
     connect(aboutAction, &QAction::triggered, this, &MainWidget::onAbout);
     connect(quitAction, &QAction::triggered, this, &MainWidget::onQuitApplication);
@@ -312,6 +472,12 @@ void MainWidget::setupThreadManager()
         return;
     }
     m_threadManager->setVideoRenderObj(ui->videoWidget->getSDLWidget());
+    ui->videoWidget->setAudioAnalyzer(m_threadManager->getAudioAnalyzer());
+    m_threadManager->setVolume(AppContext::instance()->getAppData()->getVolume());
+    m_threadManager->setEqualizer(AppContext::instance()->getAppData()->getEqualizer());
+    m_threadManager->setDownmixMode(AppContext::instance()->getAppData()->getDownmixMode());
+    m_threadManager->setAudioOnly(AppContext::instance()->getAppData()->isAudioOnly());
+    m_threadManager->setSyncMaster(AppContext::instance()->getAppData()->getSyncMaster());
 
     connect(m_threadManager.get(),
             &ThreadManager::sigPlayStateChanged,
@@ -321,6 +487,27 @@ void MainWidget::setupThreadManager()
             &ThreadManager::sigVoiceStateChanged,
             this,
             &MainWidget::onVoiceStateChanged);
+    connect(m_threadManager.get(), &ThreadManager::sigFrameStepped, this, &MainWidget::onTimedRefreshUI);
+    connect(LoudnessScanner::instance(), &LoudnessScanner::sigScanned, this, [this](const QString &path) {
+        if (!m_replayGainPending || m_currentFile.isEmpty()
+            || !LoudnessScanner::instance()->albumFiles(m_currentFile).contains(path))
+            return;
+        // 已经出声后不再调整，避免一首曲目中途音量跳变；结果已写入缓存，下一首（或重新播放）开始时生效
+        const double position = m_threadManager->getCurrentPlayProgress();
+        if (!std::isnan(position) && position > 0) {
+            m_replayGainPending = false;
+            return;
+        }
+        applyReplayGain();
+    });
+}
+
+void MainWidget::applyReplayGain()
+{
+    if (!m_threadManager || m_currentFile.isEmpty())
+        return;
+    const ReplayGainMode mode = AppContext::instance()->getAppData()->getReplayGainMode();
+    m_threadManager->setReplayGain(LoudnessScanner::instance()->gainFor(m_currentFile, mode, &m_replayGainPending));
 }
 
 void MainWidget::setupPlayListWidget()
@@ -365,6 +552,8 @@ bool MainWidget::onOpenFile(const QString &filePath)
     if (!filePath.isEmpty()) {
         qDebug() << "Opening file:" << filePath;
         m_threadManager->openMedia(filePath);
+        m_currentFile = QFileInfo(filePath).absoluteFilePath();
+        applyReplayGain();
 
         if (!m_threadManager->startAllThreads()) {
             qWarning() << "线程启动失败...";
@@ -373,6 +562,7 @@ bool MainWidget::onOpenFile(const QString &filePath)
 
         auto ms = m_threadManager->getDemuxThread()->getDuration();
         ui->videoWidget->updateTotalDurationStr(ms);
+        ui->videoWidget->setMediaFile(filePath, ms);
         ui->playlistWidget->addFileToDefaultList(filePath);
         return true;
     }
@@ -433,10 +623,25 @@ void MainWidget::setupHotkeys()
         ui->videoWidget->onPreviousBtnClicked();
     });
 
+    // 逐帧步进：播放中先暂停
+    m_key_stepForward = new QShortcut(Qt::Key_Period, this);
+    connect(m_key_stepForward, &QShortcut::activated, this, [this]() { onStepFrame(true); });
+
+    m_key_stepBackward = new QShortcut(Qt::Key_Comma, this);
+    connect(m_key_stepBackward, &QShortcut::activated, this, [this]() { onStepFrame(false); });
+
     m_key_fullScreen = new QShortcut(Qt::Key_F11, this);
     connect(m_key_fullScreen, &QShortcut::activated, this, [this]() {
         ui->titlebar->onFullscreenButtonClicked();
     });
+
+    // 开启追踪（--trace）时按需导出当前的追踪事件
+    m_key_dumpTrace = new QShortcut(QKeySequence("Ctrl+Shift+T"), this);
+    connect(m_key_dumpTrace, &QShortcut::activated, this, []() {
+        const QString path = PlayTrace::dumpPath();
+        if (!path.isEmpty() && PlayTrace::dump(path))
+            qInfo() << "追踪事件已写入:" << path;
+    });
 }
 
 void MainWidget::connectTitleBarSignals()
@@ -481,17 +686,21 @@ void MainWidget::onOpenFolder()
                                                                | QFileDialog::DontResolveSymlinks);
 
     if (!folderPath.isEmpty()) {
-        // TODO: 处理打开文件夹的逻辑
         qDebug() << "Opening folder:" << folderPath;
+
+        // 大文件夹递归枚举耗时较长，放到线程池中进行，扫描到的文件分批加入默认专辑
+        m_folderScanPool.start(new FolderScanTask(this, folderPath, m_folderScanCancel));
     }
 }
 
-void MainWidget::onCloseToTray()
+void MainWidget::onFolderFilesFound(const QStringList &files)
 {
-    // 如果正在播放，需要暂停
-    if (m_threadManager->isPlaying())
-        onPlayTriggered();
+    ui->playlistWidget->addFilesToDefaultList(files);
+}
 
+void MainWidget::onCloseToTray()
+{
+    // 隐藏后视频解码与渲染自动挂起，音频继续在后台播放
     hide();
 
     // 如果托盘图标存在，显示通知
@@ -509,6 +718,20 @@ void MainWidget::onOptions()
     QMessageBox::information(this, tr("选项"), tr("选项功能尚未实现"));
 }
 
+void MainWidget::onEqualizer()
+{
+    if (!m_equalizerDialog) {
+        m_equalizerDialog = new EqualizerDialog(AppContext::instance()->getAppData()->getEqualizer(), this);
+        connect(m_equalizerDialog, &EqualizerDialog::sigChanged, this, [this](const EqualizerSettings &settings) {
+            m_threadManager->setEqualizer(settings);
+            AppContext::instance()->getAppData()->setEqualizer(settings);
+        });
+    }
+    m_equalizerDialog->show();
+    m_equalizerDialog->raise();
+    m_equalizerDialog->activateWindow();
+}
+
 void MainWidget::onAbout()
 {
     // 显示关于对话框
@@ -535,3 +758,11 @@ void MainWidget::onPlayTriggered()
         m_threadManager->resumePlay();
     }
 }
+
+void MainWidget::onStepFrame(bool forward)
+{
+    if (m_threadManager->isPlaying())
+        m_threadManager->pausePlay();
+    // 解码在步进线程中进行，帧显示后由 sigFrameStepped 刷新进度
+    m_threadManager->stepFrame(forward);
+}
@@ -7,13 +7,17 @@
 #include <QMenu>
 #include <QShowEvent>
 #include <QSystemTrayIcon>
+#include <QThreadPool>
 #include <QTimer>
 #include <QWidget>
+#include <atomic>
+#include <memory>
 
 namespace Ui {
 class MainWidget;
 }
 
+class EqualizerDialog;
 class QShortcut;
 
 class MainWidget : public QWidget
@@ -47,6 +51,8 @@ protected:
     void mouseMoveEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
     void closeEvent(QCloseEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
 
 private slots:
     // 处理TitleBar发出的信号的槽函数
@@ -54,11 +60,15 @@ private slots:
     void onOpenFolder();
     void onCloseToTray();
     void onOptions();
+    void onEqualizer();
     void onAbout();
     void onQuitApplication();
 
     void onPlayTriggered();
 
+    // 逐帧前进/后退
+    void onStepFrame(bool forward);
+
     // 托盘图标槽函数
     void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
 
@@ -83,6 +93,16 @@ private:
     void setupTrayIcon();
     void setupThreadManager();
 
+    // 按当前模式与已有的响度结果重新计算并设置均衡增益；只在曲目开始与切换模式时调用，播放中途不因扫描结果改变音量
+    void applyReplayGain();
+
+    // 窗口隐藏到托盘或最小化时挂起视频解码与渲染
+    void updateVideoVisibility();
+
+    // 文件夹扫描任务投递的一批媒体文件
+    void onFolderFilesFound(const QStringList &files);
+    friend class FolderScanTask;
+
 private:
     Ui::MainWidget *ui;
     bool            m_isMaximized = false;
@@ -95,17 +115,27 @@ private:
     QMenu           *m_menu;
     QSystemTrayIcon *m_trayIcon;
     QMenu           *m_trayMenu;
+    EqualizerDialog *m_equalizerDialog{nullptr};
 
     QShortcut *m_key_playSelected;
     QShortcut *m_key_pausePlay;
     QShortcut *m_key_nextPlay;
     QShortcut *m_key_prevPlay;
+    QShortcut *m_key_stepForward;
+    QShortcut *m_key_stepBackward;
     QShortcut *m_key_fullScreen;
+    QShortcut *m_key_dumpTrace;
 
     std::unique_ptr<ThreadManager> m_threadManager;
 
     QTimer  m_refreshTimer;
     int64_t m_testTime{0};
+    QString m_currentFile;               // 正在播放的文件，用于响度均衡
+    bool    m_replayGainPending{false}; // 计算增益时仍有曲目在扫描，结果只在尚未出声时采用
+
+    // 打开文件夹时的递归扫描在单线程池中进行，多次打开按顺序排队
+    QThreadPool                        m_folderScanPool;
+    std::shared_ptr<std::atomic<bool>> m_folderScanCancel{std::make_shared<std::atomic<bool>>(false)};
 };
 
 #endif // MAINWIDGET_H
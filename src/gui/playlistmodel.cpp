@@ -1,10 +1,85 @@
 #include "playlistmodel.h"
+#include "common.h"
+#include "librarywatcher.h"
+
+#include <algorithm>
+#include <numeric>
+#include <QCollator>
+#include <QColor>
+#include <QSet>
+#include <QSize>
+#include <QThread>
+#include <thread>
+
+// 超过该条目数才分块并行排序，小列表线程开销得不偿失
+static constexpr int kParallelSortThreshold = 20000;
+
+namespace {
+
+/**
+ * @brief 稳定排序：大列表分块在多个线程上 stable_sort，再两两 inplace_merge（归并同样稳定）
+ */
+template<typename Compare>
+void parallelStableSort(std::vector<int> &order, Compare lessThan)
+{
+    const int count = int(order.size());
+    const int chunks = qMin(QThread::idealThreadCount(), count / (kParallelSortThreshold / 2));
+    if (count < kParallelSortThreshold || chunks < 2) {
+        std::stable_sort(order.begin(), order.end(), lessThan);
+        return;
+    }
+
+    std::vector<int> bounds(chunks + 1);
+    for (int i = 0; i <= chunks; ++i)
+        bounds[i] = int(qint64(count) * i / chunks);
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (int i = 1; i < chunks; ++i) {
+        workers.emplace_back([&order, &bounds, &lessThan, i]() {
+            std::stable_sort(order.begin() + bounds[i], order.begin() + bounds[i + 1], lessThan);
+        });
+    }
+    std::stable_sort(order.begin(), order.begin() + bounds[1], lessThan);
+    for (std::thread &worker : workers)
+        worker.join();
+
+    // 相邻有序块两两归并，直到只剩一块
+    for (int width = 1; width < chunks; width *= 2) {
+        for (int i = 0; i + width < chunks; i += 2 * width) {
+            const int end = qMin(i + 2 * width, chunks);
+            std::inplace_merge(order.begin() + bounds[i],
+                               order.begin() + bounds[i + width],
+                               order.begin() + bounds[end],
+                               lessThan);
+        }
+    }
+}
+
+} // namespace
 
 PlayListModel::PlayListModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_sortMode(Name)
     , m_sortOrder(Ascending)
-{}
+{
+    connect(MediaProber::instance(), &MediaProber::sigProbed, this, &PlayListModel::onMediaProbed);
+    connect(LibraryWatcher::instance(), &LibraryWatcher::sigChanged, this, &PlayListModel::onFilesChanged);
+
+    // 行号变化时让行号缓存失效
+    auto invalidateRows = [this]() { m_rowsDirty = true; };
+    connect(this, &QAbstractItemModel::rowsInserted, this, invalidateRows);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, invalidateRows);
+    connect(this, &QAbstractItemModel::rowsMoved, this, invalidateRows);
+    connect(this, &QAbstractItemModel::layoutChanged, this, invalidateRows);
+    connect(this, &QAbstractItemModel::modelReset, this, invalidateRows);
+}
+
+PlayListModel::~PlayListModel()
+{
+    for (const PlayListItem &item : qAsConst(m_items))
+        LibraryWatcher::instance()->unwatchFile(item.filePath);
+}
 
 int PlayListModel::rowCount(const QModelIndex &parent) const
 {
@@ -17,40 +92,111 @@ QVariant PlayListModel::data(const QModelIndex &index, int role) const
         return QVariant();
 
     const PlayListItem &item = m_items[index.row()];
-    if (role == Qt::DisplayRole)
+    switch (role) {
+    case Qt::DisplayRole:
         return item.fileName;
-    else if (role == Qt::UserRole)
+    case Qt::UserRole:
         return item.filePath;
-    return QVariant();
+    case DurationRole:
+        return item.media.durationMs;
+    case ResolutionRole:
+        return item.media.hasVideo() ? QSize(item.media.width, item.media.height) : QVariant();
+    case StaleRole:
+        return item.stale;
+    case Qt::ForegroundRole:
+        return item.stale ? QVariant(QColor(Qt::gray)) : QVariant();
+    case MediaInfoRole: {
+        QStringList parts;
+        if (item.media.hasVideo())
+            parts << QString("%1x%2 %3").arg(item.media.width).arg(item.media.height).arg(item.media.videoCodec);
+        if (!item.media.audioCodec.isEmpty())
+            parts << item.media.audioCodec;
+        if (item.media.bitrate > 0)
+            parts << QString("%1 kbps").arg(item.media.bitrate / 1000);
+        return parts.join(", ");
+    }
+    case Qt::ToolTipRole: {
+        QString tip = item.filePath;
+        if (item.stale)
+            tip += "\n文件已不存在";
+        if (item.media.durationMs >= 0)
+            tip += "\n" + millisecondToString(item.media.durationMs);
+        const QString media = data(index, MediaInfoRole).toString();
+        if (!media.isEmpty())
+            tip += "\n" + media;
+        return tip;
+    }
+    default:
+        return QVariant();
+    }
 }
 
 bool PlayListModel::addItem(const QString &text)
 {
-    QFileInfo info(text);
-    if (!info.exists())
-        return false;
-    // 禁止重复添加
-    for (auto &item : m_items) {
-        if (item.filePath == text)
-            return false;
+    return !addItems({text}).isEmpty();
+}
+
+QStringList PlayListModel::addItems(const QStringList &paths)
+{
+    MediaProber        *prober = MediaProber::instance();
+    QList<PlayListItem> items;
+    QStringList         added;
+    items.reserve(paths.size());
+
+    for (const QString &path : paths) {
+        QFileInfo info(path);
+        if (!info.exists())
+            continue;
+        // 禁止重复添加（包括同一批次内的重复）
+        const QString absolutePath = info.absoluteFilePath();
+        if (m_pathIndex.contains(absolutePath))
+            continue;
+        m_pathIndex.insert(absolutePath);
+
+        // 元数据：命中缓存直接使用，否则后台探测
+        PlayListItem item(info);
+        if (!prober->lookup(info, item.media))
+            prober->request(info);
+        m_searchIndex.insert(absolutePath, item.fileName, searchText(item));
+        LibraryWatcher::instance()->watchFile(absolutePath);
+        items.append(item);
+        added.append(absolutePath);
     }
 
-    beginInsertRows(QModelIndex(), m_items.count(), m_items.count());
-    m_items.append(PlayListItem(info));
+    if (items.isEmpty())
+        return added;
+
+    beginInsertRows(QModelIndex(), m_items.count(), m_items.count() + items.count() - 1);
+    m_items.append(items);
     endInsertRows();
-    return true;
+    return added;
 }
 
 void PlayListModel::removeRows(const QModelIndexList &indexes)
 {
     QList<int> rows;
-    foreach (const QModelIndex &index, indexes)
-        rows << index.row();
+    rows.reserve(indexes.size());
+    for (const QModelIndex &index : indexes) {
+        if (index.isValid() && index.row() < m_items.count())
+            rows << index.row();
+    }
 
+    // 从后往前按连续区间删除，前面的行号不受影响
     std::sort(rows.begin(), rows.end(), std::greater<int>());
-    foreach (int row, rows) {
-        beginRemoveRows(QModelIndex(), row, row);
-        m_items.removeAt(row);
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    for (int i = 0; i < rows.size();) {
+        const int last = rows.at(i);
+        int       first = last;
+        while (++i < rows.size() && rows.at(i) == first - 1)
+            first = rows.at(i);
+
+        beginRemoveRows(QModelIndex(), first, last);
+        for (int row = first; row <= last; ++row) {
+            m_pathIndex.remove(m_items.at(row).filePath);
+            m_searchIndex.remove(m_items.at(row).filePath);
+            LibraryWatcher::instance()->unwatchFile(m_items.at(row).filePath);
+        }
+        m_items.erase(m_items.begin() + first, m_items.begin() + last + 1);
         endRemoveRows();
     }
 }
@@ -98,41 +244,190 @@ void PlayListModel::moveToBottom(int row)
     endMoveRows();
 }
 
-QModelIndex PlayListModel::find(const QString &text)
+QModelIndexList PlayListModel::search(const QString &text, int limit) const
+{
+    QModelIndexList result;
+    for (const SearchIndex::Hit &hit : m_searchIndex.search(text, limit).hits) {
+        const int row = rowOfPath(hit.key);
+        if (row >= 0)
+            result.append(index(row));
+    }
+    return result;
+}
+
+QModelIndex PlayListModel::find(const QString &text, const QModelIndex &after)
 {
+    const QModelIndexList hits = search(text);
+    if (hits.isEmpty())
+        return QModelIndex();
+
+    const int pos = after.isValid() ? hits.indexOf(after) : -1;
+    return hits.at((pos + 1) % hits.size());
+}
+
+void PlayListModel::onMediaProbed(const QStringList &paths)
+{
+    QSet<QString> probed;
+    for (const QString &path : paths)
+        probed.insert(path);
+
+    MediaProber *prober = MediaProber::instance();
     for (int i = 0; i < m_items.count(); ++i) {
-        if (m_items[i].fileName.contains(text, Qt::CaseInsensitive)) {
-            return index(i);
+        PlayListItem &item = m_items[i];
+        if (!probed.contains(item.filePath))
+            continue;
+        prober->result(QFileInfo(item.filePath), item.media);
+        m_searchIndex.insert(item.filePath, item.fileName, searchText(item));
+        emit dataChanged(index(i), index(i));
+    }
+}
+
+void PlayListModel::onFilesChanged(const FileChanges &changes)
+{
+    MediaProber *prober = MediaProber::instance();
+    auto         refresh = [this](int row) { emit dataChanged(index(row), index(row)); };
+
+    // 重命名：就地更新路径与名称，保留位置与元数据（缓存已由监视器迁移）
+    for (const auto &rename : changes.renamed) {
+        const int row = rowOfPath(rename.first);
+        if (row < 0 || m_pathIndex.contains(rename.second))
+            continue;
+        PlayListItem   &item = m_items[row];
+        const QFileInfo info(rename.second);
+        m_pathIndex.remove(item.filePath);
+        m_searchIndex.remove(item.filePath);
+        item.fileName = info.fileName();
+        item.filePath = rename.second;
+        item.suffix = info.suffix().toLower();
+        item.stale = false;
+        m_pathIndex.insert(item.filePath);
+        m_searchIndex.insert(item.filePath, item.fileName, searchText(item));
+        m_rowsDirty = true;
+        refresh(row);
+    }
+
+    for (const QString &path : changes.removed) {
+        const int row = rowOfPath(path);
+        if (row >= 0 && !m_items.at(row).stale) {
+            m_items[row].stale = true;
+            refresh(row);
+        }
+    }
+
+    // 新增或修改：失效条目恢复，文件信息刷新并重新探测元数据
+    QStringList updated = changes.modified;
+    updated.append(changes.added);
+    for (const QString &path : qAsConst(updated)) {
+        const int row = rowOfPath(path);
+        if (row < 0)
+            continue;
+        PlayListItem   &item = m_items[row];
+        const QFileInfo info(path);
+        item.stale = !info.exists();
+        item.size = info.size();
+        item.lastModified = info.lastModified();
+        if (!prober->lookup(info, item.media)) {
+            item.media = MediaInfo();
+            prober->request(info);
         }
+        refresh(row);
     }
-    return QModelIndex();
 }
 
 void PlayListModel::performSort()
 {
-    beginResetModel();
-    std::sort(m_items.begin(), m_items.end(), [this](const PlayListItem &a, const PlayListItem &b) {
-        bool lessThan = false;
-        switch (m_sortMode) {
-        case Name:
-            // 修改为不区分大小写的比较
-            lessThan = a.fileName.compare(b.fileName, Qt::CaseInsensitive) < 0;
-            break;
-        case Ext:
-            // 扩展名也不区分大小写
-            lessThan = QFileInfo(a.fileName)
-                           .suffix()
-                           .compare(QFileInfo(b.fileName).suffix(), Qt::CaseInsensitive)
-                       < 0;
-            break;
-        case Size:
-            lessThan = a.size < b.size;
-            break;
-        case Time:
-            lessThan = a.lastModified < b.lastModified;
-            break;
+    const int        count = m_items.count();
+    std::vector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+
+    // 排序键每个条目只计算一次，比较时不再构造 QFileInfo 或做大小写转换
+    const bool ascending = m_sortOrder == Ascending;
+    if (m_sortMode == Name) {
+        // 不区分大小写，数字按数值比较（"第2集" 排在 "第10集" 之前）
+        QCollator collator;
+        collator.setCaseSensitivity(Qt::CaseInsensitive);
+        collator.setNumericMode(true);
+        std::vector<QCollatorSortKey> keys;
+        keys.reserve(count);
+        for (const PlayListItem &item : qAsConst(m_items))
+            keys.push_back(collator.sortKey(item.fileName));
+        parallelStableSort(order, [&keys, ascending](int a, int b) {
+            return ascending ? keys[a].compare(keys[b]) < 0 : keys[b].compare(keys[a]) < 0;
+        });
+    } else if (m_sortMode == Ext) {
+        parallelStableSort(order, [this, ascending](int a, int b) {
+            return ascending ? m_items.at(a).suffix < m_items.at(b).suffix
+                             : m_items.at(b).suffix < m_items.at(a).suffix;
+        });
+    } else {
+        std::vector<qint64> keys;
+        keys.reserve(count);
+        for (const PlayListItem &item : qAsConst(m_items)) {
+            switch (m_sortMode) {
+            case Size:
+                keys.push_back(item.size);
+                break;
+            case Time:
+                keys.push_back(item.lastModified.toMSecsSinceEpoch());
+                break;
+            case Duration:
+                keys.push_back(item.media.durationMs);
+                break;
+            default:
+                keys.push_back(qint64(item.media.width) * item.media.height);
+                break;
+            }
         }
-        return m_sortOrder == Ascending ? lessThan : !lessThan;
-    });
-    endResetModel();
+        parallelStableSort(order, [&keys, ascending](int a, int b) {
+            return ascending ? keys[a] < keys[b] : keys[b] < keys[a];
+        });
+    }
+
+    applyOrder(order);
+}
+
+void PlayListModel::applyOrder(const std::vector<int> &order)
+{
+    emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+
+    QList<PlayListItem> sorted;
+    sorted.reserve(m_items.count());
+    std::vector<int> newRowOf(order.size());
+    for (int row = 0; row < int(order.size()); ++row) {
+        sorted.append(m_items.at(order[row]));
+        newRowOf[order[row]] = row;
+    }
+    m_items.swap(sorted);
+
+    const QModelIndexList from = persistentIndexList();
+    QModelIndexList       to;
+    to.reserve(from.size());
+    for (const QModelIndex &index : from)
+        to.append(index.row() < int(newRowOf.size()) ? this->index(newRowOf[index.row()]) : QModelIndex());
+    changePersistentIndexList(from, to);
+
+    emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+}
+
+int PlayListModel::rowOfPath(const QString &path) const
+{
+    if (m_rowsDirty) {
+        m_rowOfPath.clear();
+        m_rowOfPath.reserve(m_items.count());
+        for (int row = 0; row < m_items.count(); ++row)
+            m_rowOfPath.insert(m_items.at(row).filePath, row);
+        m_rowsDirty = false;
+    }
+    return m_rowOfPath.value(path, -1);
+}
+
+QString PlayListModel::searchText(const PlayListItem &item)
+{
+    // 路径 + 编码 + 分辨率，可以按目录名或 "h264"、"1080" 等搜索
+    QString text = item.filePath;
+    if (item.media.hasVideo())
+        text += QString(" %1 %2x%3").arg(item.media.videoCodec).arg(item.media.width).arg(item.media.height);
+    if (!item.media.audioCodec.isEmpty())
+        text += ' ' + item.media.audioCodec;
+    return text;
 }
@@ -1,21 +1,33 @@
 #ifndef PLAYLISTMODEL_H
 #define PLAYLISTMODEL_H
 
+#include "mediaprober.h"
+#include "searchindex.h"
+
+struct FileChanges;
+
 #include <QAbstractListModel>
 #include <QDateTime>
 #include <QFileInfo>
+#include <QHash>
+#include <QSet>
 #include <QWidget>
+#include <vector>
 
 struct PlayListItem
 {
     QString   fileName;
     QString   filePath;
+    QString   suffix; // 小写扩展名，作为排序键只计算一次
     qint64    size;
     QDateTime lastModified;
+    MediaInfo media;        // 由 MediaProber 异步填充
+    bool      stale{false}; // 文件已被删除或移走
 
     PlayListItem(const QFileInfo &info)
         : fileName(info.fileName())
         , filePath(info.absoluteFilePath())
+        , suffix(info.suffix().toLower())
         , size(info.size())
         , lastModified(info.lastModified())
     {}
@@ -25,10 +37,19 @@ class PlayListModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
-    enum SortMode { Name, Ext, Size, Time };
+    enum SortMode { Name, Ext, Size, Time, Duration, Resolution };
     enum SortOrder { Ascending, Descending };
 
+    // 自定义数据角色（Qt::UserRole 保持为文件路径）
+    enum Roles {
+        DurationRole = Qt::UserRole + 1, // 时长（毫秒），未知为-1
+        ResolutionRole,                  // 分辨率 QSize，纯音频为空
+        MediaInfoRole,                   // 编码与码率的文字描述
+        StaleRole,                       // 文件是否已失效（被删除或移走）
+    };
+
     explicit PlayListModel(QObject *parent = nullptr);
+    ~PlayListModel();
 
     // 基本模型接口
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -38,6 +59,10 @@ public:
     // 数据操作
     bool addItem(const QString &text);
 
+    // 批量添加：去重后作为一段连续区间插入，返回实际添加的文件绝对路径
+    QStringList addItems(const QStringList &paths);
+
+    // 批量删除：相邻行合并为区间，每个区间只发一次删除信号
     void removeRows(const QModelIndexList &indexes);
 
     // 排序接口
@@ -52,15 +77,37 @@ public:
 
     void moveToBottom(int row);
 
-    // 查找功能
-    QModelIndex find(const QString &text);
+    // 查找功能：按相关度排序的模糊匹配（文件名、路径、编码等元数据）
+    QModelIndexList search(const QString &text, int limit = 200) const;
+
+    // 返回排在 after 之后的下一个匹配（到末尾后回到第一个），after 无效时返回最佳匹配
+    QModelIndex find(const QString &text, const QModelIndex &after = QModelIndex());
 
 private:
+    // 元数据探测完成后刷新对应行
+    void onMediaProbed(const QStringList &paths);
+
+    // 文件监视的增量变化：重命名就地更新，删除标记为失效，修改后重新探测
+    void onFilesChanged(const FileChanges &changes);
+
     void performSort();
 
+    // 行号缓存，插入/删除/排序/移动后失效，查找时按需重建
+    int rowOfPath(const QString &path) const;
+
+    static QString searchText(const PlayListItem &item);
+
+    // 按新顺序重排条目，并把持久索引映射到新行（选中项与当前项得以保留）
+    void applyOrder(const std::vector<int> &order);
+
     QList<PlayListItem> m_items;
+    QSet<QString>       m_pathIndex; // 已有文件的绝对路径，用于O(1)去重
+    SearchIndex         m_searchIndex;
     SortMode            m_sortMode;
     SortOrder           m_sortOrder;
+
+    mutable QHash<QString, int> m_rowOfPath;
+    mutable bool                m_rowsDirty{true};
 };
 
 #endif // PLAYLISTMODEL_H
@@ -29,6 +29,13 @@ bool PlayListView::addItem(const QString &text)
     return static_cast<PlayListModel *>(model())->addItem(text);
 }
 
+QStringList PlayListView::addItems(const QStringList &paths)
+{
+    if (!model())
+        return QStringList();
+    return static_cast<PlayListModel *>(model())->addItems(paths);
+}
+
 void PlayListView::moveSelectedUp()
 {
     QModelIndexList indexes = selectionModel()->selectedIndexes();
@@ -13,6 +13,8 @@ public:
 
     bool addItem(const QString &text);
 
+    QStringList addItems(const QStringList &paths);
+
     void moveSelectedUp();
     void moveSelectedDown();
     void moveToTop();
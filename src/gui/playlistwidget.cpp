@@ -1,5 +1,6 @@
 #include "playlistwidget.h"
 #include "appcontext.h"
+#include "librarywatcher.h"
 #include "playlistmodel.h"
 #include "ui_playlistwidget.h"
 
@@ -13,6 +14,7 @@ PlaylistWidget::PlaylistWidget(QWidget *parent)
     setupTabWidget();
     setupDefaultList();
     setupComputerList();
+    setupSearch();
 }
 
 PlaylistWidget::~PlaylistWidget()
@@ -23,8 +25,16 @@ PlaylistWidget::~PlaylistWidget()
 void PlaylistWidget::addFileToDefaultList(const QString &file)
 {
     // file是文件的绝对路径
-    if (ui->listView_def->addItem(file))
-        AppContext::instance()->getAppData()->addPlayFileToDefAlbum(file);
+    addFilesToDefaultList({file});
+}
+
+void PlaylistWidget::addFilesToDefaultList(const QStringList &files)
+{
+    // 只把真正新增（存在且未重复）的文件写入专辑，整批一次写入
+    QList<PlayFile> added;
+    for (const QString &path : ui->listView_def->addItems(files))
+        added.append(PlayFile{QFileInfo(path).fileName(), path});
+    AppContext::instance()->getAppData()->addPlayFilesToDefAlbum(added);
 }
 
 void PlaylistWidget::playSelected()
@@ -60,11 +70,20 @@ void PlaylistWidget::setupDefaultList()
     m_defaultModel = new PlayListModel(this);
     ui->listView_def->setModel(m_defaultModel);
 
-    auto album = AppContext::instance()->getAppData()->getDefaultAlbum();
-    auto playFiles = album.getPlayfiles();
-    for (auto file : playFiles) {
-        ui->listView_def->addItem(file.filepath_);
-    }
+    // 只读取默认专辑；自定义专辑的文件列表在显示时才解析，启动耗时与库的总大小无关
+    const Album &album = AppContext::instance()->getAppData()->getDefaultAlbum();
+    QStringList  paths;
+    paths.reserve(album.getPlayfiles().size());
+    for (const PlayFile &file : album.getPlayfiles())
+        paths.append(file.filepath_);
+    ui->listView_def->addItems(paths);
+
+    // 专辑中的文件被重命名后同步路径，避免下次启动或播放时找不到
+    connect(LibraryWatcher::instance(), &LibraryWatcher::sigChanged, this, [](const FileChanges &changes) {
+        auto appData = AppContext::instance()->getAppData();
+        for (const auto &rename : changes.renamed)
+            appData->renamePlayFile(rename.first, rename.second);
+    });
 
     connect(ui->listView_def,
             &PlayListView::sigFileDoubleClicked,
@@ -76,3 +95,32 @@ void PlaylistWidget::setupComputerList()
 {
     connect(ui->listView, &FileListView::sigFileSelected, this, &PlaylistWidget::sigOpenFile);
 }
+
+void PlaylistWidget::setupSearch()
+{
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setObjectName("PlaylistSearchEdit");
+    m_searchEdit->setPlaceholderText("搜索文件名、路径或编码");
+    m_searchEdit->setClearButtonEnabled(true);
+    ui->verticalLayout->insertWidget(0, m_searchEdit);
+
+    // 边输入边定位到最佳匹配，回车跳到下一个
+    connect(m_searchEdit, &QLineEdit::textChanged, this, [this]() { findInDefaultList(false); });
+    connect(m_searchEdit, &QLineEdit::returnPressed, this, [this]() { findInDefaultList(true); });
+}
+
+void PlaylistWidget::findInDefaultList(bool next)
+{
+    const QString text = m_searchEdit->text().trimmed();
+    if (text.isEmpty())
+        return;
+
+    const QModelIndex current = next ? ui->listView_def->currentIndex() : QModelIndex();
+    const QModelIndex hit = m_defaultModel->find(text, current);
+    if (!hit.isValid())
+        return;
+
+    ui->tabWidget->setCurrentIndex(0);
+    ui->listView_def->setCurrentIndex(hit);
+    ui->listView_def->scrollTo(hit);
+}
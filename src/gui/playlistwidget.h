@@ -1,6 +1,7 @@
 #ifndef PLAYLISTWIDGET_H
 #define PLAYLISTWIDGET_H
 
+#include <QLineEdit>
 #include <QPushButton>
 #include <QWidget>
 
@@ -20,6 +21,9 @@ public:
 
     void addFileToDefaultList(const QString &file);
 
+    // 批量添加（如打开文件夹），整批只插入一次
+    void addFilesToDefaultList(const QStringList &files);
+
     // 播放选中项（提供给快捷键使用）
     void playSelected();
 
@@ -31,11 +35,16 @@ private:
 
     void setupDefaultList();
     void setupComputerList();
+    void setupSearch();
+
+    // 在默认专辑中查找并选中匹配项，next 为true时跳到下一个匹配
+    void findInDefaultList(bool next);
 
 private:
     Ui::PlaylistWidget *ui;
 
     QPushButton   *m_addTabBtn;
+    QLineEdit     *m_searchEdit;
     PlayListModel *m_defaultModel;
 };
 
@@ -1,5 +1,6 @@
 #include "sdlwidget.h"
 #include "appcontext.h"
+#include "playtrace.h"
 
 #include <SDL_render.h>
 #include <QDebug>
@@ -59,8 +60,14 @@ bool SDLWidget::initializeSDL()
     return true;
 }
 
+bool SDLWidget::initializeSink()
+{
+    return initializeSDL();
+}
+
 void SDLWidget::renderFrame(AVFrame *frame)
 {
+    PLAY_TRACE_SCOPE("SDLWidget::renderFrame");
     if (!frame && !m_sdlRenderer)
         return;
 
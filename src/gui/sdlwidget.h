@@ -2,6 +2,8 @@
 #define SDLWIDGET_H
 
 #define SDL_MAIN_HANDLED
+#include "videosink.h"
+
 #include <SDL.h>
 
 #include <QImage>
@@ -11,7 +13,7 @@ extern "C" {
 #include <libavformat/avformat.h>
 }
 
-class SDLWidget : public QWidget
+class SDLWidget : public QWidget, public VideoSink
 {
     Q_OBJECT
 public:
@@ -20,10 +22,12 @@ public:
 
     bool initializeSDL();
 
-    void renderFrame(AVFrame *frame);
+    // VideoSink
+    bool initializeSink() override;
+    void renderFrame(AVFrame *frame) override;
 
     // 重置渲染器状态
-    void reset();
+    void reset() override;
 
 protected:
     void paintEvent(QPaintEvent *event) override;
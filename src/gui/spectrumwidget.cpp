@@ -0,0 +1,129 @@
+#include "spectrumwidget.h"
+
+#include <QPainter>
+
+// 读取快照的间隔（毫秒），约60Hz
+static constexpr int kRefreshIntervalMs = 16;
+// 电平表宽度与间距（像素）
+static constexpr int kMeterWidth = 6;
+static constexpr int kMeterSpacing = 2;
+
+namespace {
+
+// dBFS 映射到 [0, 1]
+double levelRatio(float db)
+{
+    return qBound(0.0, double(db - SpectrumSnapshot::kFloorDb) / -SpectrumSnapshot::kFloorDb, 1.0);
+}
+
+QColor meterColor(float db)
+{
+    if (db > -6.0f)
+        return QColor(0xE0, 0x40, 0x40);
+    if (db > -18.0f)
+        return QColor(0xFA, 0xE1, 0x00);
+    return QColor(0x50, 0xC8, 0x50);
+}
+
+} // namespace
+
+SpectrumWidget::SpectrumWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    m_timer.setInterval(kRefreshIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &SpectrumWidget::onTick);
+}
+
+SpectrumWidget::~SpectrumWidget()
+{
+    setActive(false);
+}
+
+void SpectrumWidget::setAnalyzer(AudioAnalyzer *analyzer)
+{
+    setActive(false);
+    m_analyzer = analyzer;
+    if (isVisible())
+        setActive(true);
+}
+
+void SpectrumWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    setActive(true);
+}
+
+void SpectrumWidget::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    setActive(false);
+}
+
+void SpectrumWidget::setActive(bool active)
+{
+    if (active)
+        m_timer.start();
+    else
+        m_timer.stop();
+    if (m_analyzer)
+        m_analyzer->setActive(active);
+}
+
+void SpectrumWidget::onTick()
+{
+    if (!m_analyzer)
+        return;
+
+    SpectrumSnapshot snapshot;
+    if (!m_analyzer->snapshot(snapshot))
+        return;
+    if (m_hasSnapshot && snapshot.serial == m_snapshot.serial)
+        return; // 没有新数据（如暂停后电平已落到底）不重绘
+
+    m_snapshot = snapshot;
+    m_hasSnapshot = true;
+    update();
+}
+
+void SpectrumWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+    if (!m_hasSnapshot)
+        return;
+
+    const int h = height();
+    const int metersWidth = SpectrumSnapshot::kMeterChannels * (kMeterWidth + kMeterSpacing);
+    const int bandsWidth = width() - metersWidth - kMeterSpacing;
+    if (bandsWidth <= 0)
+        return;
+
+    // 频带柱与峰值保持线
+    const double bandWidth = double(bandsWidth) / SpectrumSnapshot::kBands;
+    const QColor barColor(0xFA, 0xE1, 0x00, 0xC0);
+    const QColor holdColor(0xF0, 0xF0, 0xF0);
+    for (int b = 0; b < SpectrumSnapshot::kBands; ++b) {
+        const double left = b * bandWidth;
+        const double barWidth = qMax(1.0, bandWidth - 1.0);
+        const double barHeight = levelRatio(m_snapshot.bandsDb[b]) * h;
+        painter.fillRect(QRectF(left, h - barHeight, barWidth, barHeight), barColor);
+
+        const double holdY = h - levelRatio(m_snapshot.peakHoldDb[b]) * h;
+        if (holdY < h - 1)
+            painter.fillRect(QRectF(left, holdY, barWidth, 1.0), holdColor);
+    }
+
+    // 电平表：柱高为RMS，细线为采样峰值与峰值保持
+    for (int m = 0; m < SpectrumSnapshot::kMeterChannels; ++m) {
+        const int    left = bandsWidth + kMeterSpacing + m * (kMeterWidth + kMeterSpacing);
+        const double rmsHeight = levelRatio(m_snapshot.rmsDb[m]) * h;
+        painter.fillRect(QRectF(left, 0, kMeterWidth, h), QColor(0x20, 0x20, 0x20));
+        painter.fillRect(QRectF(left, h - rmsHeight, kMeterWidth, rmsHeight), meterColor(m_snapshot.rmsDb[m]));
+
+        const double peakY = h - levelRatio(m_snapshot.peakDb[m]) * h;
+        painter.fillRect(QRectF(left, peakY, kMeterWidth, 1.0), meterColor(m_snapshot.peakDb[m]));
+        const double holdY = h - levelRatio(m_snapshot.peakHoldMeterDb[m]) * h;
+        painter.fillRect(QRectF(left, holdY, kMeterWidth, 1.0), holdColor);
+    }
+}
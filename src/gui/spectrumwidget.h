@@ -0,0 +1,40 @@
+#ifndef SPECTRUMWIDGET_H
+#define SPECTRUMWIDGET_H
+
+#include "audioanalyzer.h"
+
+#include <QPointer>
+#include <QTimer>
+#include <QWidget>
+
+/**
+ * @brief SpectrumWidget - 频谱柱状图与左右声道电平表
+ *
+ * 可见时启用分析线程并按显示帧率读取快照，快照未更新时不重绘；隐藏后停止分析。
+ */
+class SpectrumWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit SpectrumWidget(QWidget *parent = nullptr);
+    ~SpectrumWidget();
+
+    void setAnalyzer(AudioAnalyzer *analyzer);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    void onTick();
+    void setActive(bool active);
+
+private:
+    QPointer<AudioAnalyzer> m_analyzer;
+    SpectrumSnapshot        m_snapshot;
+    bool                    m_hasSnapshot{false};
+    QTimer                  m_timer;
+};
+
+#endif // SPECTRUMWIDGET_H
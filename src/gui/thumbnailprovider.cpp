@@ -0,0 +1,281 @@
+#include "thumbnailprovider.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QPixmap>
+#include <QRunnable>
+#include <QStandardPaths>
+#include <QThread>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+
+// 内存缓存上限（KB）
+static constexpr int kMemoryCacheKb = 32 * 1024;
+// 视图刷新合并间隔（毫秒）
+static constexpr int kFlushIntervalMs = 50;
+// 寻找关键帧时最多读取的包数
+static constexpr int kMaxThumbnailPackets = 600;
+
+namespace {
+
+// 把解码出的帧缩放为RGB32的QImage，长边不超过 maxSize
+QImage frameToImage(const AVFrame *frame, int maxSize)
+{
+    if (frame->width <= 0 || frame->height <= 0)
+        return QImage();
+
+    const double scale = qMin(1.0, double(maxSize) / qMax(frame->width, frame->height));
+    const int    width = qMax(1, int(frame->width * scale));
+    const int    height = qMax(1, int(frame->height * scale));
+
+    SwsContext *sws = sws_getContext(frame->width,
+                                     frame->height,
+                                     static_cast<AVPixelFormat>(frame->format),
+                                     width,
+                                     height,
+                                     AV_PIX_FMT_RGB32,
+                                     SWS_BILINEAR,
+                                     nullptr,
+                                     nullptr,
+                                     nullptr);
+    if (!sws)
+        return QImage();
+
+    QImage   image(width, height, QImage::Format_RGB32);
+    uint8_t *dst[4] = {image.bits(), nullptr, nullptr, nullptr};
+    int      dstStride[4] = {int(image.bytesPerLine()), 0, 0, 0};
+    sws_scale(sws, frame->data, frame->linesize, 0, frame->height, dst, dstStride);
+    sws_freeContext(sws);
+    return image;
+}
+
+/**
+ * @brief 解码一张缩略图：优先使用内嵌封面（attached_pic），否则跳到10%处只解码关键帧
+ */
+QImage decodeThumbnail(const QString &path, int maxSize)
+{
+    AVFormatContext *format = nullptr;
+    if (avformat_open_input(&format, path.toUtf8().constData(), nullptr, nullptr) < 0)
+        return QImage();
+
+    QImage          image;
+    AVCodecContext *codec = nullptr;
+    AVPacket       *packet = av_packet_alloc();
+    AVFrame        *frame = av_frame_alloc();
+
+    do {
+        if (avformat_find_stream_info(format, nullptr) < 0)
+            break;
+        const int streamIndex = av_find_best_stream(format, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (streamIndex < 0)
+            break;
+        AVStream      *stream = format->streams[streamIndex];
+        const AVCodec *decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+        if (!decoder)
+            break;
+        codec = avcodec_alloc_context3(decoder);
+        if (!codec || avcodec_parameters_to_context(codec, stream->codecpar) < 0)
+            break;
+        codec->skip_frame = AVDISCARD_NONKEY; // 只解码关键帧
+        codec->thread_count = 1;              // 并行度由线程池提供
+        if (avcodec_open2(codec, decoder, nullptr) < 0)
+            break;
+
+        if (stream->disposition & AV_DISPOSITION_ATTACHED_PIC) {
+            if (avcodec_send_packet(codec, &stream->attached_pic) >= 0) {
+                avcodec_send_packet(codec, nullptr);
+                if (avcodec_receive_frame(codec, frame) >= 0)
+                    image = frameToImage(frame, maxSize);
+            }
+            break;
+        }
+
+        // 跳过片头（常见黑场）
+        if (format->duration > 0)
+            av_seek_frame(format, -1, format->duration / 10, AVSEEK_FLAG_BACKWARD);
+
+        bool flushed = false;
+        for (int i = 0; i < kMaxThumbnailPackets && image.isNull(); ++i) {
+            if (!flushed && av_read_frame(format, packet) < 0) {
+                avcodec_send_packet(codec, nullptr);
+                flushed = true;
+            } else if (!flushed) {
+                if (packet->stream_index == streamIndex)
+                    avcodec_send_packet(codec, packet);
+                av_packet_unref(packet);
+            }
+            if (avcodec_receive_frame(codec, frame) >= 0)
+                image = frameToImage(frame, maxSize);
+            else if (flushed)
+                break;
+        }
+    } while (false);
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&codec);
+    avformat_close_input(&format);
+    return image;
+}
+
+} // namespace
+
+/**
+ * @brief ThumbnailTask - 线程池中的缩略图任务：先查磁盘缓存，未命中再解码并写回
+ */
+class ThumbnailTask : public QRunnable
+{
+public:
+    ThumbnailTask(ThumbnailProvider                 *provider,
+                  const QString                     &key,
+                  const QString                     &path,
+                  const QString                     &cacheFile,
+                  std::shared_ptr<std::atomic<bool>> cancel)
+        : m_provider(provider)
+        , m_key(key)
+        , m_path(path)
+        , m_cacheFile(cacheFile)
+        , m_cancel(std::move(cancel))
+    {}
+
+    void run() override
+    {
+        if (m_cancel->load(std::memory_order_relaxed))
+            return;
+
+        QImage        image;
+        const QString noneMarker = m_cacheFile + ".none";
+        if (QFile::exists(m_cacheFile)) {
+            image.load(m_cacheFile);
+        } else if (!QFile::exists(noneMarker)) {
+            image = decodeThumbnail(m_path, ThumbnailProvider::kThumbnailSize);
+            if (!image.isNull()) {
+                image.save(m_cacheFile, "PNG");
+            } else {
+                // 记录无法生成，避免每次浏览都重新探测
+                QFile marker(noneMarker);
+                marker.open(QIODevice::WriteOnly);
+            }
+        }
+
+        if (m_cancel->load(std::memory_order_relaxed))
+            return;
+        // 提供者析构前会取消并等待线程池，此处指针一定有效
+        ThumbnailProvider *provider = m_provider;
+        QMetaObject::invokeMethod(
+            provider,
+            [provider, key = m_key, path = m_path, image]() { provider->onThumbnailReady(key, path, image); },
+            Qt::QueuedConnection);
+    }
+
+private:
+    ThumbnailProvider                 *m_provider;
+    QString                            m_key;
+    QString                            m_path;
+    QString                            m_cacheFile;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+
+ThumbnailProvider::ThumbnailProvider(QObject *parent)
+    : QObject(parent)
+    , m_memoryCache(kMemoryCacheKb)
+    , m_cancel(std::make_shared<std::atomic<bool>>(false))
+{
+    m_diskCacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+    QDir().mkpath(m_diskCacheDir);
+
+    // 解码以IO和单线程解码为主，线程数取核心数的一半
+    m_workers.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(kFlushIntervalMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &ThumbnailProvider::flushUpdates);
+}
+
+ThumbnailProvider::~ThumbnailProvider()
+{
+    m_cancel->store(true, std::memory_order_relaxed);
+    m_workers.clear();
+    m_workers.waitForDone();
+}
+
+QIcon ThumbnailProvider::icon(const QFileInfo &fileInfo)
+{
+    if (fileInfo.isDir())
+        return typeIcon(fileInfo);
+
+    const QString key = cacheKey(fileInfo);
+    if (QIcon *cached = m_memoryCache.object(key))
+        return *cached;
+
+    if (!m_noThumbnail.contains(key) && !m_inFlight.contains(key)) {
+        m_inFlight.insert(key);
+        const QString cacheFile = m_diskCacheDir + "/"
+                                  + QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex()
+                                  + ".png";
+        // 优先级递增：最近请求（当前可见的行）最先处理
+        m_workers.start(new ThumbnailTask(this, key, fileInfo.absoluteFilePath(), cacheFile, m_cancel),
+                        ++m_requestSerial);
+    }
+    return typeIcon(fileInfo);
+}
+
+void ThumbnailProvider::cancelPending()
+{
+    m_cancel->store(true, std::memory_order_relaxed);
+    m_workers.clear();
+    m_cancel = std::make_shared<std::atomic<bool>>(false);
+    m_inFlight.clear();
+    m_readyPaths.clear();
+}
+
+void ThumbnailProvider::onThumbnailReady(const QString &key, const QString &path, const QImage &image)
+{
+    m_inFlight.remove(key);
+    if (image.isNull()) {
+        m_noThumbnail.insert(key);
+        return;
+    }
+
+    const int costKb = qMax(1, int(image.sizeInBytes() / 1024));
+    m_memoryCache.insert(key, new QIcon(QPixmap::fromImage(image)), costKb);
+
+    m_readyPaths.append(path);
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void ThumbnailProvider::flushUpdates()
+{
+    if (m_readyPaths.isEmpty())
+        return;
+    emit sigIconsUpdated(m_readyPaths);
+    m_readyPaths.clear();
+}
+
+QIcon ThumbnailProvider::typeIcon(const QFileInfo &fileInfo)
+{
+    // 同类文件图标相同，按扩展名缓存，避免每次都查询系统
+    const QString type = fileInfo.isDir() ? QStringLiteral("/") : fileInfo.suffix().toLower();
+    auto          it = m_typeIcons.constFind(type);
+    if (it != m_typeIcons.constEnd())
+        return it.value();
+
+    QIcon icon = fileInfo.isDir() ? m_iconProvider.icon(QFileIconProvider::Folder) : m_iconProvider.icon(fileInfo);
+    m_typeIcons.insert(type, icon);
+    return icon;
+}
+
+QString ThumbnailProvider::cacheKey(const QFileInfo &fileInfo) const
+{
+    // 文件被替换或修改后键随之变化，旧缓存自然失效
+    return fileInfo.absoluteFilePath() + '|' + QString::number(fileInfo.size()) + '|'
+           + QString::number(fileInfo.lastModified().toMSecsSinceEpoch());
+}
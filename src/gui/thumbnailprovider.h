@@ -0,0 +1,70 @@
+#ifndef THUMBNAILPROVIDER_H
+#define THUMBNAILPROVIDER_H
+
+#include <atomic>
+#include <memory>
+#include <QCache>
+#include <QFileIconProvider>
+#include <QFileInfo>
+#include <QHash>
+#include <QIcon>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+/**
+ * @brief 文件图标与缩略图服务 - 供文件浏览模型按需获取图标
+ *
+ * 类型图标按扩展名缓存；视频缩略图由工作线程池解码关键帧生成，结果进入内存LRU缓存与磁盘缓存。
+ * 缩略图就绪前返回类型图标作为占位，就绪后合并成一次 sigIconsUpdated 通知视图刷新。
+ */
+class ThumbnailProvider : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ThumbnailProvider(QObject *parent = nullptr);
+    ~ThumbnailProvider();
+
+    // 立即返回可显示的图标；尚无缩略图时返回类型图标并在后台生成
+    QIcon icon(const QFileInfo &fileInfo);
+
+    // 取消尚未开始的生成任务（切换目录时调用）
+    void cancelPending();
+
+    // 缩略图边长上限（像素）
+    static constexpr int kThumbnailSize = 64;
+
+signals:
+    // 一批文件的缩略图已就绪，参数为文件绝对路径
+    void sigIconsUpdated(const QStringList &paths);
+
+private:
+    void    onThumbnailReady(const QString &key, const QString &path, const QImage &image);
+    void    flushUpdates();
+    QIcon   typeIcon(const QFileInfo &fileInfo);
+    QString cacheKey(const QFileInfo &fileInfo) const;
+
+    friend class ThumbnailTask;
+
+private:
+    QFileIconProvider     m_iconProvider;
+    QHash<QString, QIcon> m_typeIcons; // 扩展名 -> 类型图标
+
+    QCache<QString, QIcon> m_memoryCache; // 键 -> 缩略图，代价按KB计
+    QSet<QString>          m_noThumbnail; // 无法生成缩略图的键（如纯音频）
+    QSet<QString>          m_inFlight;    // 已提交、未返回的键
+    QString                m_diskCacheDir;
+
+    QThreadPool                        m_workers;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+    int                                m_requestSerial{0};
+
+    // 合并视图刷新
+    QStringList m_readyPaths;
+    QTimer      m_flushTimer;
+};
+
+#endif // THUMBNAILPROVIDER_H
@@ -2,6 +2,7 @@
 #include "appcontext.h"
 #include "common.h"
 #include "fontmanager.h"
+#include "spectrumwidget.h"
 #include "ui_videowidget.h"
 #include <QDebug>
 
@@ -61,6 +62,11 @@ void VideoWidget::updateTotalDurationStr(int64_t val)
     ui->videoSlider->setMaximum(val);
 }
 
+void VideoWidget::setMediaFile(const QString &path, int64_t durationMs)
+{
+    m_waveform.request(path, durationMs);
+}
+
 void VideoWidget::updateCurrentDurationStr(const QString &val)
 {
     ui->label_currentduration->setText(val);
@@ -99,6 +105,16 @@ void VideoWidget::setVolume(int volume)
     ui->voiceSlider->setValue(volume);
 }
 
+void VideoWidget::setAudioAnalyzer(AudioAnalyzer *analyzer)
+{
+    m_spectrum->setAnalyzer(analyzer);
+}
+
+void VideoWidget::setSpectrumVisible(bool visible)
+{
+    m_spectrum->setVisible(visible);
+}
+
 void VideoWidget::onPreviousBtnClicked()
 {
     int  span = -TIMESPAN;
@@ -141,6 +157,16 @@ void VideoWidget::setupControls()
 void VideoWidget::setupVideoWidget()
 {
     ui->video->initializeSDL();
+
+    // 波形需要一定高度才看得清
+    ui->videoSlider->setMinimumHeight(24);
+    ui->videoSlider->setWaveform(&m_waveform.data());
+
+    // 频谱位于画面与进度条之间，默认隐藏
+    m_spectrum = new SpectrumWidget(this);
+    m_spectrum->setFixedHeight(80);
+    m_spectrum->hide();
+    ui->verticalLayout->insertWidget(1, m_spectrum);
 }
 
 void VideoWidget::initConnect()
@@ -162,4 +188,6 @@ void VideoWidget::initConnect()
     connect(ui->playlistBtn, &QPushButton::clicked, this, &VideoWidget::sigPlayListStateChanged);
 
     connect(ui->videoSlider, &ClickMovableSlider::sigSeekTo, this, &VideoWidget::sigSeekTo);
+    connect(&m_waveform, &WaveformBuilder::sigUpdated, ui->videoSlider, QOverload<>::of(&QWidget::update));
+    connect(ui->stopBtn, &QPushButton::clicked, &m_waveform, &WaveformBuilder::cancel);
 }
@@ -1,6 +1,7 @@
 #ifndef VIDEOWIDGET_H
 #define VIDEOWIDGET_H
 
+#include "waveformbuilder.h"
 #include <QWidget>
 
 extern "C" {
@@ -12,6 +13,8 @@ class VideoWidget;
 }
 
 class SDLWidget;
+class SpectrumWidget;
+class AudioAnalyzer;
 
 class VideoWidget : public QWidget
 {
@@ -28,12 +31,19 @@ public:
     void updateProgress(double val);
 
     void updateTotalDurationStr(int64_t val);
+
+    // 打开新文件时在后台生成波形概览并显示在进度条上
+    void setMediaFile(const QString &path, int64_t durationMs);
     void updateCurrentDurationStr(const QString &val);
 
     void updateUIForStateChanged();
 
     void setVolume(int volume);
 
+    // 频谱与电平表，显示时才运行分析
+    void setAudioAnalyzer(AudioAnalyzer *analyzer);
+    void setSpectrumVisible(bool visible);
+
 public slots:
     void onPreviousBtnClicked();
     void onNextBtnClicked();
@@ -59,6 +69,8 @@ private:
 private:
     Ui::VideoWidget *ui;
     int              m_volume{99};
+    WaveformBuilder  m_waveform;
+    SpectrumWidget  *m_spectrum{nullptr};
 };
 
 #endif // VIDEOWIDGET_H
@@ -1,5 +1,6 @@
 #include "application.h"
 #include "mainWidget.h"
+#include "playtrace.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
@@ -24,8 +25,16 @@ int main(int argc, char *argv[])
     parser.addHelpOption();
     parser.addVersionOption();
     parser.addPositionalArgument("file", "The file to open");
+    QCommandLineOption traceOpt("trace", "Record playback trace events and write them to <path> on exit", "path");
+    parser.addOption(traceOpt);
     parser.process(a);
 
+    // 播放线程事件追踪：命令行优先，其次环境变量 QWAVEBOX_TRACE
+    if (parser.isSet(traceOpt))
+        PlayTrace::enableWithDumpOnExit(parser.value(traceOpt));
+    else
+        PlayTrace::configureFromEnvironment();
+
     MainWidget w;
     w.show();
 
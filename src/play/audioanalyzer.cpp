@@ -0,0 +1,336 @@
+#include "audioanalyzer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// FFT长度（样本数），44.1kHz下约46ms，频率分辨率约21.5Hz
+static constexpr int kFftSize = 2048;
+// 分析节拍（毫秒），与显示帧率相当
+static constexpr int kTickMs = 16;
+// 频带范围（Hz），上限不超过奈奎斯特频率的90%
+static constexpr double kMinFreq = 30.0;
+static constexpr double kMaxFreq = 16000.0;
+// 频带与峰值的下落速度（dB/秒）
+static constexpr float kBandFallDbPerSec = 48.0f;
+static constexpr float kPeakFallDbPerSec = 24.0f;
+// 峰值保持时间（秒）
+static constexpr double kPeakHoldSec = 1.0;
+// RMS积分时间常数（秒）
+static constexpr double kRmsWindowSec = 0.3;
+
+static constexpr double kPi = 3.14159265358979323846;
+
+namespace {
+
+float powerToDb(double power)
+{
+    return power > 0.0 ? std::max(SpectrumSnapshot::kFloorDb, float(10.0 * std::log10(power)))
+                       : SpectrumSnapshot::kFloorDb;
+}
+
+// 带下落的峰值保持：新值更高时立即跟上，否则保持一段时间后按固定速度下落
+void holdPeak(float value, double elapsedSec, float &holdDb, double &heldSec)
+{
+    if (value >= holdDb) {
+        holdDb = value;
+        heldSec = 0.0;
+        return;
+    }
+    heldSec += elapsedSec;
+    if (heldSec > kPeakHoldSec)
+        holdDb = std::max(value, holdDb - kPeakFallDbPerSec * float(elapsedSec));
+}
+
+} // namespace
+
+void AudioTap::setFormat(int sampleRate, int channels)
+{
+    m_sampleRate.store(sampleRate, std::memory_order_relaxed);
+    m_channels.store(channels, std::memory_order_relaxed);
+}
+
+void AudioTap::write(const int16_t *samples, uint32_t count)
+{
+    if (!isEnabled())
+        return;
+    const uint32_t channels = uint32_t(std::max(0, m_channels.load(std::memory_order_relaxed)));
+    if (channels == 0)
+        return;
+
+    const uint32_t write = m_write.load(std::memory_order_relaxed);
+    const uint32_t read = m_read.load(std::memory_order_acquire);
+    uint32_t       n = std::min(count, kCapacity - (write - read));
+    n -= n % channels; // 只写整帧，读端不会错位
+    if (n == 0)
+        return;
+
+    const uint32_t pos = write & (kCapacity - 1);
+    const uint32_t first = std::min(n, kCapacity - pos);
+    std::memcpy(m_buffer.data() + pos, samples, first * sizeof(int16_t));
+    std::memcpy(m_buffer.data(), samples + first, (n - first) * sizeof(int16_t));
+    m_write.store(write + n, std::memory_order_release);
+}
+
+uint32_t AudioTap::read(int16_t *samples, uint32_t maxCount)
+{
+    const uint32_t channels = uint32_t(std::max(0, m_channels.load(std::memory_order_relaxed)));
+    if (channels == 0)
+        return 0;
+
+    const uint32_t read = m_read.load(std::memory_order_relaxed);
+    const uint32_t write = m_write.load(std::memory_order_acquire);
+    uint32_t       n = std::min(write - read, maxCount - maxCount % channels);
+    if (n == 0)
+        return 0;
+
+    const uint32_t pos = read & (kCapacity - 1);
+    const uint32_t first = std::min(n, kCapacity - pos);
+    std::memcpy(samples, m_buffer.data() + pos, first * sizeof(int16_t));
+    std::memcpy(samples + first, m_buffer.data(), (n - first) * sizeof(int16_t));
+    m_read.store(read + n, std::memory_order_release);
+    return n;
+}
+
+void AudioTap::drain()
+{
+    m_read.store(m_write.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+AudioAnalyzer::AudioAnalyzer(QObject *parent)
+    : ThreadBase(parent)
+    , m_fft(kFftSize)
+    , m_window(kFftSize)
+    , m_history(kFftSize, 0.0f)
+    , m_frame(kFftSize)
+    , m_power(kFftSize / 2)
+    , m_scratch(AudioTap::kCapacity)
+{
+    // Hann窗；满幅正弦的峰值频点功率为 (Σw/2)^2，据此换算到dBFS
+    double sum = 0.0;
+    for (int i = 0; i < kFftSize; ++i) {
+        m_window[i] = float(0.5 - 0.5 * std::cos(2.0 * kPi * i / (kFftSize - 1)));
+        sum += m_window[i];
+    }
+    m_windowGainDb = float(-20.0 * std::log10(sum / 2.0));
+
+    resetState();
+}
+
+AudioAnalyzer::~AudioAnalyzer()
+{
+    // 分析状态是本类成员，须在基类析构前停下线程
+    m_tap.setEnabled(false);
+    stopProcess();
+    wait();
+}
+
+bool AudioAnalyzer::initialize()
+{
+    return true;
+}
+
+void AudioAnalyzer::setActive(bool active)
+{
+    m_tap.setEnabled(active);
+    if (active)
+        startProcess();
+    else
+        stopProcess();
+}
+
+bool AudioAnalyzer::snapshot(SpectrumSnapshot &out) const
+{
+    // 写端极少与读端撞上同一缓冲，重试几次即可
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        const uint32_t version = m_seq.load(std::memory_order_acquire) / 2;
+        if (version == 0)
+            return false;
+        out = m_slots[version & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // 写端开始覆盖该缓冲时序号为 2 * version + 3
+        if (m_seq.load(std::memory_order_relaxed) < 2 * version + 3)
+            return true;
+    }
+    return false;
+}
+
+void AudioAnalyzer::process()
+{
+    const int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count();
+    // 停用一段时间后重新启用，间隔按上限计，电平不会瞬间跌到底
+    const double elapsedSec = m_lastTickUs > 0 ? std::min(0.25, (nowUs - m_lastTickUs) / 1e6) : kTickMs / 1000.0;
+    m_lastTickUs = nowUs;
+
+    analyze(elapsedSec);
+    msleep(kTickMs);
+}
+
+void AudioAnalyzer::analyze(double elapsedSec)
+{
+    const int sampleRate = m_tap.sampleRate();
+    const int channels = m_tap.channels();
+    if (sampleRate != m_layoutRate || channels != m_layoutChannels) {
+        m_layoutChannels = channels;
+        updateBandLayout(sampleRate);
+        resetState();
+        m_tap.drain();
+    }
+
+    consumeSamples();
+    const bool received = m_tickFrames > 0;
+
+    // 电平表：平滑后的均方值换算为RMS，峰值取本节拍的采样最大值
+    const double alpha = 1.0 - std::exp(-elapsedSec / kRmsWindowSec);
+    for (int m = 0; m < SpectrumSnapshot::kMeterChannels; ++m) {
+        const double meanSquare = m_tickFrames > 0 ? m_tickSquares[m] / m_tickFrames : 0.0;
+        m_meanSquare[m] += alpha * (meanSquare - m_meanSquare[m]);
+        m_current.rmsDb[m] = powerToDb(m_meanSquare[m]);
+
+        const float tickPeakDb = powerToDb(double(m_tickPeak[m]) * m_tickPeak[m]);
+        m_current.peakDb[m] = std::max({tickPeakDb,
+                                        m_current.peakDb[m] - kPeakFallDbPerSec * float(elapsedSec),
+                                        SpectrumSnapshot::kFloorDb});
+        holdPeak(m_current.peakDb[m], elapsedSec, m_current.peakHoldMeterDb[m], m_meterHoldSec[m]);
+
+        m_tickPeak[m] = 0.0f;
+        m_tickSquares[m] = 0.0;
+    }
+    m_tickFrames = 0;
+
+    updateSpectrum(elapsedSec);
+
+    // 暂停或停止后电平落到底就不再发布，界面据序号判断无需重绘
+    const bool silent = !received && isSilent();
+    if (silent && m_publishedSilence)
+        return;
+    m_publishedSilence = silent;
+
+    m_current.channels = m_layoutChannels;
+    m_current.sampleRate = m_layoutRate;
+    publish();
+}
+
+bool AudioAnalyzer::isSilent() const
+{
+    auto atFloor = [](float db) { return db <= SpectrumSnapshot::kFloorDb; };
+    return std::all_of(m_current.bandsDb.begin(), m_current.bandsDb.end(), atFloor)
+           && std::all_of(m_current.peakHoldDb.begin(), m_current.peakHoldDb.end(), atFloor)
+           && std::all_of(m_current.rmsDb.begin(), m_current.rmsDb.end(), atFloor)
+           && std::all_of(m_current.peakDb.begin(), m_current.peakDb.end(), atFloor)
+           && std::all_of(m_current.peakHoldMeterDb.begin(), m_current.peakHoldMeterDb.end(), atFloor);
+}
+
+void AudioAnalyzer::consumeSamples()
+{
+    const int channels = m_layoutChannels;
+    if (channels <= 0)
+        return;
+
+    uint32_t count = 0;
+    while ((count = m_tap.read(m_scratch.data(), uint32_t(m_scratch.size()))) > 0) {
+        const int      frames = int(count) / channels;
+        const int16_t *samples = m_scratch.data();
+        for (int f = 0; f < frames; ++f, samples += channels) {
+            float sum = 0.0f;
+            for (int ch = 0; ch < channels; ++ch)
+                sum += samples[ch];
+            m_history[m_historyPos] = sum / (channels * 32768.0f);
+            m_historyPos = (m_historyPos + 1) & (kFftSize - 1);
+
+            // 单声道时两个表显示同一声道
+            for (int m = 0; m < SpectrumSnapshot::kMeterChannels; ++m) {
+                const float value = samples[std::min(m, channels - 1)] / 32768.0f;
+                m_tickPeak[m] = std::max(m_tickPeak[m], std::fabs(value));
+                m_tickSquares[m] += double(value) * value;
+            }
+        }
+        m_tickFrames += frames;
+        m_hasNewSamples = true;
+    }
+}
+
+void AudioAnalyzer::updateSpectrum(double elapsedSec)
+{
+    const bool fresh = m_hasNewSamples && !m_bandFirstBin.empty();
+    if (fresh) {
+        // 环形窗口按时间顺序展开并加窗
+        for (int i = 0; i < kFftSize; ++i)
+            m_frame[i] = m_history[(m_historyPos + i) & (kFftSize - 1)] * m_window[i];
+        m_fft.powerSpectrum(m_frame.data(), m_power.data());
+    }
+    m_hasNewSamples = false;
+
+    const float fall = kBandFallDbPerSec * float(elapsedSec);
+    for (int b = 0; b < SpectrumSnapshot::kBands; ++b) {
+        float level = SpectrumSnapshot::kFloorDb;
+        if (fresh) {
+            // 频带内取最大功率，窄带信号不会被宽频带平均掉
+            float power = 0.0f;
+            for (int bin = m_bandFirstBin[b]; bin <= m_bandLastBin[b]; ++bin)
+                power = std::max(power, m_power[bin]);
+            level = std::max(SpectrumSnapshot::kFloorDb, powerToDb(power) + m_windowGainDb);
+        }
+        m_current.bandsDb[b] = std::max({level, m_current.bandsDb[b] - fall, SpectrumSnapshot::kFloorDb});
+        holdPeak(m_current.bandsDb[b], elapsedSec, m_current.peakHoldDb[b], m_bandHoldSec[b]);
+    }
+}
+
+void AudioAnalyzer::updateBandLayout(int sampleRate)
+{
+    m_layoutRate = sampleRate;
+    m_bandFirstBin.clear();
+    m_bandLastBin.clear();
+    if (sampleRate <= 0)
+        return;
+
+    // 频带边界按对数等分，低频频带窄于一个频点时共用同一频点
+    const double binHz = double(sampleRate) / kFftSize;
+    const double maxFreq = std::min(kMaxFreq, sampleRate * 0.45);
+    const double ratio = std::pow(maxFreq / kMinFreq, 1.0 / SpectrumSnapshot::kBands);
+    const int    lastBin = kFftSize / 2 - 1;
+    for (int b = 0; b < SpectrumSnapshot::kBands; ++b) {
+        const double low = kMinFreq * std::pow(ratio, b);
+        const double high = low * ratio;
+        const int    first = std::min(lastBin, std::max(1, int(low / binHz)));
+        const int    last = std::min(lastBin, std::max(first, int(std::ceil(high / binHz)) - 1));
+        m_bandFirstBin.push_back(first);
+        m_bandLastBin.push_back(last);
+    }
+}
+
+void AudioAnalyzer::resetState()
+{
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    m_historyPos = 0;
+    m_hasNewSamples = false;
+
+    m_meanSquare.fill(0.0);
+    m_tickPeak.fill(0.0f);
+    m_tickSquares.fill(0.0);
+    m_tickFrames = 0;
+    m_bandHoldSec.fill(0.0);
+    m_meterHoldSec.fill(0.0);
+
+    m_current.bandsDb.fill(SpectrumSnapshot::kFloorDb);
+    m_current.peakHoldDb.fill(SpectrumSnapshot::kFloorDb);
+    m_current.rmsDb.fill(SpectrumSnapshot::kFloorDb);
+    m_current.peakDb.fill(SpectrumSnapshot::kFloorDb);
+    m_current.peakHoldMeterDb.fill(SpectrumSnapshot::kFloorDb);
+    m_publishedSilence = false;
+}
+
+void AudioAnalyzer::publish()
+{
+    ++m_current.serial;
+
+    // 先把序号置为奇数再写后台缓冲，读端据此判断读到的缓冲是否被覆盖
+    const uint32_t seq = m_seq.load(std::memory_order_relaxed);
+    m_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_slots[(seq / 2 + 1) & 1] = m_current;
+    m_seq.store(seq + 2, std::memory_order_release);
+}
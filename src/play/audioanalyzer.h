@@ -0,0 +1,142 @@
+#ifndef AUDIOANALYZER_H
+#define AUDIOANALYZER_H
+
+#include "realfft.h"
+#include "threadbase.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 音频分析抽头 - 从SDL音频回调向分析线程传递PCM的单生产者单消费者无锁环形缓冲
+ *
+ * 回调只做一次 memcpy 和两次原子读写，不加锁、不分配内存；缓冲满时丢弃本次写入（分析只关心最新数据）。
+ * 未启用时回调直接返回，没有分析需求时没有额外开销。
+ */
+class AudioTap
+{
+public:
+    static constexpr uint32_t kCapacity = 1 << 15; // 样本数（各声道交错），须为2的幂
+
+    // 输出格式，打开音频设备时设置
+    void setFormat(int sampleRate, int channels);
+    int  sampleRate() const { return m_sampleRate.load(std::memory_order_relaxed); }
+    int  channels() const { return m_channels.load(std::memory_order_relaxed); }
+
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    // 生产者（音频回调）：写入交错的S16样本，count 为样本总数
+    void write(const int16_t *samples, uint32_t count);
+
+    // 消费者（分析线程）：读出至多 maxCount 个样本，返回实际读取数（整帧）
+    uint32_t read(int16_t *samples, uint32_t maxCount);
+
+    // 消费者：丢弃缓冲中的全部数据
+    void drain();
+
+private:
+    std::array<int16_t, kCapacity> m_buffer{};
+
+    alignas(64) std::atomic<uint32_t> m_write{0};
+    alignas(64) std::atomic<uint32_t> m_read{0};
+
+    std::atomic<int>  m_sampleRate{0};
+    std::atomic<int>  m_channels{0};
+    std::atomic<bool> m_enabled{false};
+};
+
+/**
+ * @brief 频谱与电平快照
+ */
+struct SpectrumSnapshot
+{
+    static constexpr int   kBands = 48;
+    static constexpr int   kMeterChannels = 2; // 只显示前两个声道（左/右）
+    static constexpr float kFloorDb = -90.0f;
+
+    std::array<float, kBands>         bandsDb;    // 各对数频带电平（dBFS），已做下落平滑
+    std::array<float, kBands>         peakHoldDb; // 各频带峰值保持
+    std::array<float, kMeterChannels> rmsDb;      // 约300ms积分的RMS电平
+    std::array<float, kMeterChannels> peakDb;     // 采样峰值（带下落）
+    std::array<float, kMeterChannels> peakHoldMeterDb;
+
+    int      channels{0};
+    int      sampleRate{0};
+    uint32_t serial{0}; // 每次发布递增
+};
+
+/**
+ * @brief 音频分析线程 - 频谱与电平表
+ *
+ * 以约60Hz的节拍从 AudioTap 取出新样本：更新各声道的RMS/峰值电平，各声道平均后写入滑动窗口，
+ * 加Hann窗做 2048 点实数FFT，按对数频率归并到 kBands 个频带，做下落平滑与峰值保持。
+ * 结果发布到双缓冲快照，界面线程按显示帧率调用 snapshot() 读取，读写双方都不会阻塞。
+ * 仅在 setActive(true) 期间运行，单次分析约数十微秒，整体CPU占用远低于1%。
+ */
+class AudioAnalyzer : public ThreadBase
+{
+    Q_OBJECT
+public:
+    explicit AudioAnalyzer(QObject *parent = nullptr);
+    ~AudioAnalyzer() override;
+
+    bool initialize() override;
+
+    AudioTap *tap() { return &m_tap; }
+
+    // 有界面显示时才启用抽头并运行分析线程
+    void setActive(bool active);
+
+    // 读取最新快照，尚无数据时返回false；可在任意线程调用
+    bool snapshot(SpectrumSnapshot &out) const;
+
+protected:
+    void process() override;
+
+private:
+    void analyze(double elapsedSec);
+    void consumeSamples();
+    void updateSpectrum(double elapsedSec);
+    void updateBandLayout(int sampleRate);
+    void resetState();
+    bool isSilent() const;
+    void publish();
+
+private:
+    AudioTap m_tap;
+
+    // 分析状态，仅分析线程访问
+    RealFft              m_fft;
+    std::vector<float>   m_window;
+    float                m_windowGainDb{0.0f}; // 把功率换算为满幅正弦为0dB的修正
+    std::vector<float>   m_history;            // 单声道滑动窗口（环形）
+    int                  m_historyPos{0};
+    std::vector<float>   m_frame;
+    std::vector<float>   m_power;
+    std::vector<int16_t> m_scratch;
+    std::vector<int>     m_bandFirstBin;
+    std::vector<int>     m_bandLastBin;
+    int                  m_layoutRate{0};
+    int                  m_layoutChannels{0};
+    bool                 m_hasNewSamples{false};
+    bool                 m_publishedSilence{false}; // 已发布过全静音快照
+
+    std::array<double, SpectrumSnapshot::kMeterChannels> m_meanSquare{}; // 平滑后的均方值
+    std::array<float, SpectrumSnapshot::kMeterChannels>  m_tickPeak{};   // 本节拍的采样峰值
+    std::array<double, SpectrumSnapshot::kMeterChannels> m_tickSquares{};
+    int                                                  m_tickFrames{0};
+    std::array<double, SpectrumSnapshot::kBands>         m_bandHoldSec{};
+    std::array<double, SpectrumSnapshot::kMeterChannels> m_meterHoldSec{};
+    int64_t                                              m_lastTickUs{0};
+
+    SpectrumSnapshot m_current;
+
+    // 双缓冲：m_seq 为奇数表示正在写入 m_slots[(m_seq / 2 + 1) & 1]，为偶数时版本 m_seq / 2 位于 m_slots[(m_seq / 2) & 1]
+    SpectrumSnapshot      m_slots[2];
+    std::atomic<uint32_t> m_seq{0};
+};
+
+#endif // AUDIOANALYZER_H
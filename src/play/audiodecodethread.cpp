@@ -1,6 +1,9 @@
 #include "audiodecodethread.h"
 #include "avframequeue.h"
 #include "avpacketqueue.h"
+#include "playlog.h"
+#include "playmetrics.h"
+#include "playtrace.h"
 
 #include <QDebug>
 
@@ -158,7 +161,7 @@ void AudioDecodeThread::process()
     if (packet) {
         // 解码包
         if (!decodePacket(packet)) {
-            qWarning() << "解码包失败";
+            PLAY_LOG_WARNING("解码包失败");
         }
 
         // 释放包
@@ -186,6 +189,10 @@ bool AudioDecodeThread::decodePacket(AVPacket *packet)
     if (!m_codecContext) {
         return false;
     }
+    PLAY_TRACE_SCOPE("AudioDecodeThread::decodePacket");
+
+    // 每帧耗时 = 距上一帧（或送包前）的时间，送包开销计入第一帧
+    int64_t frameStart = PlayMetrics::nowUs();
 
     // 发送包到解码器
     int ret = avcodec_send_packet(m_codecContext, packet);
@@ -193,7 +200,7 @@ bool AudioDecodeThread::decodePacket(AVPacket *packet)
         if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
             char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
             av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
-            qWarning() << "发送包到解码器失败:" << errbuf;
+            PLAY_LOG_WARNING("发送包到解码器失败: %s", errbuf);
             return false;
         }
     }
@@ -212,19 +219,26 @@ bool AudioDecodeThread::decodePacket(AVPacket *packet)
             av_frame_free(&frame);
             char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
             av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
-            qWarning() << "从解码器接收帧失败:" << errbuf;
+            PLAY_LOG_WARNING("从解码器接收帧失败: %s", errbuf);
             return false;
         }
 
+        const int64_t decoded = PlayMetrics::nowUs();
+        PlayMetrics::record(PlayMetrics::Histogram::AudioDecodeUs, decoded - frameStart);
+        PlayMetrics::add(PlayMetrics::Counter::AudioFramesDecoded);
+
         // 将解码后的帧放入帧队列
         if (!m_frameQueue->enqueue(frame)) {
-            qWarning() << "将帧放入队列失败";
+            PLAY_LOG_WARNING("将帧放入队列失败");
             av_frame_free(&frame);
             return false;
         }
 
+        PlayMetrics::set(PlayMetrics::Gauge::AudioFrameQueueDepth, m_frameQueue->size());
+
         // 释放帧
         av_frame_free(&frame);
+        frameStart = PlayMetrics::nowUs();
     }
 
     return true;
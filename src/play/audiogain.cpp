@@ -0,0 +1,59 @@
+#include "audiogain.h"
+
+#include <algorithm>
+#include <cmath>
+
+// 限制器恢复时间常数
+static constexpr double kReleaseSec = 0.1;
+
+void AudioGainStage::setSampleRate(int sampleRate)
+{
+    m_release = sampleRate > 0 ? float(1.0 - std::exp(-1.0 / (kReleaseSec * sampleRate))) : 1.0f;
+}
+
+void AudioGainStage::setReplayGainDb(double db)
+{
+    m_replayGain.store(float(std::pow(10.0, db / 20.0)), std::memory_order_relaxed);
+}
+
+void AudioGainStage::process(float *samples, int frames, int channels)
+{
+    if (frames <= 0 || channels <= 0)
+        return;
+
+    const float target = m_volume.load(std::memory_order_relaxed) * m_replayGain.load(std::memory_order_relaxed);
+    const int   count = frames * channels;
+    if (target == 1.0f && m_gain == 1.0f && m_envelope == 1.0f) {
+        // 均衡器提升可能使浮点样本超出满幅，只有这时才需要限制器
+        float peak = 0.0f;
+        for (int i = 0; i < count; ++i)
+            peak = std::max(peak, std::fabs(samples[i]));
+        if (peak <= kLimitThreshold)
+            return;
+    }
+
+    const float step = (target - m_gain) / frames;
+    float       gain = m_gain;
+    float       envelope = m_envelope;
+    for (int i = 0; i < frames; ++i) {
+        gain += step;
+        float *frame = samples + i * channels;
+
+        // 同一帧各声道共用限制增益，保持声像
+        float peak = 0.0f;
+        for (int ch = 0; ch < channels; ++ch)
+            peak = std::max(peak, std::fabs(frame[ch] * gain));
+        const float required = peak > kLimitThreshold ? kLimitThreshold / peak : 1.0f;
+        if (required < envelope)
+            envelope = required;
+        else
+            envelope += (required - envelope) * m_release;
+
+        const float total = gain * envelope;
+        for (int ch = 0; ch < channels; ++ch)
+            frame[ch] *= total;
+    }
+    m_gain = target;
+    // 恢复到 -0.01dB 以内时归位，使之后可以走快速路径（单精度逐帧逼近1时会因舍入停滞）
+    m_envelope = envelope > 0.999f ? 1.0f : envelope;
+}
@@ -0,0 +1,41 @@
+#ifndef AUDIOGAIN_H
+#define AUDIOGAIN_H
+
+#include <atomic>
+
+/**
+ * @brief 输出增益级 - 音量 × 响度均衡增益，带峰值限制器
+ *
+ * 在SDL音频回调中对交错浮点样本（满幅为±1.0）原地处理，处理后才转换为S16。目标增益由界面线程通过原子量设置，
+ * 回调内每块从当前增益线性过渡到目标增益，避免改动时的咔哒声。
+ * 样本（含均衡器提升后超出满幅的部分）乘以总增益后超过阈值时由限制器即时压低（无前视），
+ * 之后约100ms内平滑恢复，转换为S16时不会削波。
+ * 总增益为1、限制器未动作且本块没有超过阈值的样本时直接返回，不触碰样本。
+ */
+class AudioGainStage
+{
+public:
+    static constexpr float kLimitThreshold = 0.98f; // 限制器阈值（满幅比例）
+
+    void setSampleRate(int sampleRate);
+
+    // 音量，0.0 ~ 1.0
+    void setVolume(double volume) { m_volume.store(float(volume), std::memory_order_relaxed); }
+
+    // 响度均衡增益（dB），0 为不调整
+    void setReplayGainDb(double db);
+
+    // 音频回调：samples 为交错浮点样本，frames 为帧数
+    void process(float *samples, int frames, int channels);
+
+private:
+    std::atomic<float> m_volume{1.0f};
+    std::atomic<float> m_replayGain{1.0f};
+
+    // 仅音频回调访问
+    float m_gain{1.0f};     // 当前已生效的总增益
+    float m_envelope{1.0f}; // 限制器增益，≤1
+    float m_release{0.0f};  // 每帧的恢复系数
+};
+
+#endif // AUDIOGAIN_H
@@ -1,6 +1,13 @@
 #include "audiorenderthread.h"
+#include "audioanalyzer.h"
 #include "avframequeue.h"
+#include "equalizer.h"
+#include "playlog.h"
+#include "playmetrics.h"
+#include "playtrace.h"
 
+#include <algorithm>
+#include <cmath>
 #include <QDebug>
 
 extern "C" {
@@ -8,9 +15,28 @@ extern "C" {
 #include <libavutil/time.h>
 }
 
+// 环形缓冲容量（毫秒），决定均衡器参数生效的最大延迟
+static constexpr int kRingBufferMs = 200;
+// 每次从帧队列取帧的等待时间
+static constexpr int kDequeueTimeoutMs = 10;
+// 跟随主时钟：偏差取最近约20帧的指数平均，单帧样本数最多修正5%，偏差超过10秒视为不同步不再修正
+static constexpr int    kClockDiffAvgCount = 20;
+static constexpr double kMaxCompensation = 0.05;
+static constexpr double kNoSyncThreshold = 10.0;
+
 AudioRenderThread::AudioRenderThread(QObject *parent)
     : ThreadBase{parent}
-{}
+{
+    auto preamp = std::make_unique<PreampStage>();
+    auto equalizer = std::make_unique<EqualizerStage>();
+    auto bassBoost = std::make_unique<BassBoostStage>();
+    m_preamp = preamp.get();
+    m_equalizer = equalizer.get();
+    m_bassBoost = bassBoost.get();
+    m_dspChain.addStage(std::move(preamp));
+    m_dspChain.addStage(std::move(equalizer));
+    m_dspChain.addStage(std::move(bassBoost));
+}
 
 AudioRenderThread::~AudioRenderThread()
 {
@@ -54,16 +80,18 @@ bool AudioRenderThread::initializeAudioRenderer(AVRational timebase, AVCodecPara
     // 转换：
     m_inParams.sample_rate_ = audioParams->sample_rate;
     m_inParams.channels_ = audioParams->channels;
-    m_inParams.channel_layout_ = audioParams->channel_layout;
+    m_inParams.channel_layout_
+        = int64_t(ChannelMixer::sanitizeLayout(audioParams->channel_layout, audioParams->channels));
     m_inParams.fmt_ = (AVSampleFormat) audioParams->format;
     m_inParams.frame_size_ = audioParams->frame_size;
 
-    // 设置SDL音频规格
-    SDL_AudioSpec wanted_spec;
+    // 设置SDL音频规格：声道数按缩混模式请求，采样率与声道数允许设备改为其原生值，由重采样器适配
+    const DownmixMode mode = downmixMode();
+    SDL_AudioSpec     wanted_spec;
     SDL_memset(&wanted_spec, 0, sizeof(wanted_spec));
     wanted_spec.freq = m_inParams.sample_rate_;
     wanted_spec.format = AUDIO_S16SYS; // SDL需要S16格式，这是我们重采样的目标格式
-    wanted_spec.channels = m_inParams.channels_;
+    wanted_spec.channels = Uint8(ChannelMixer::preferredDeviceChannels(m_inParams.channels_, mode));
     wanted_spec.silence = 0;
     wanted_spec.samples = 1024; // 缓冲区大小
     wanted_spec.callback = &AudioRenderThread::sdlAudioCallback;
@@ -72,19 +100,43 @@ bool AudioRenderThread::initializeAudioRenderer(AVRational timebase, AVCodecPara
     // 实际获取的音频规格
     SDL_AudioSpec obtained_spec;
 
+    if (!m_traceBuffer)
+        m_traceBuffer = PlayTrace::reserveThread("SDLAudioCallback");
+
     // 打开音频设备，获取实际支持的规格
-    m_audioDevice = SDL_OpenAudioDevice(NULL, 0, &wanted_spec, &obtained_spec, 0);
+    m_audioDevice = SDL_OpenAudioDevice(NULL,
+                                        0,
+                                        &wanted_spec,
+                                        &obtained_spec,
+                                        SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
     if (m_audioDevice == 0) {
         qWarning() << "SDL_OpenAudioDevice failed:" << SDL_GetError();
         return false;
     }
 
     // 记录实际使用的音频参数
-    m_outParams.sample_rate_ = wanted_spec.freq;
-    m_outParams.channels_ = wanted_spec.channels;
-    m_outParams.channel_layout_ = av_get_default_channel_layout(2);
+    m_outParams.sample_rate_ = obtained_spec.freq;
+    m_outParams.channels_ = obtained_spec.channels;
+    m_outParams.channel_layout_ = int64_t(ChannelMixer::deviceLayout(obtained_spec.channels));
     m_outParams.fmt_ = AV_SAMPLE_FMT_S16;
-    m_outParams.frame_size_ = 1024 /*obtained_spec.samples*/;
+    m_outParams.frame_size_ = obtained_spec.samples > 0 ? obtained_spec.samples : 1024;
+    qInfo() << "音频输出:" << m_inParams.channels_ << "声道" << m_inParams.sample_rate_ << "Hz ->"
+            << m_outParams.channels_ << "声道" << m_outParams.sample_rate_ << "Hz";
+
+    // 预先计算源布局的缩混矩阵，回调开始前重采样器即可直接取用
+    m_mixer.matrix(uint64_t(m_inParams.channel_layout_), uint64_t(m_outParams.channel_layout_), mode);
+    swr_free(&m_swrContext);
+
+    m_ring.reset(m_outParams.sample_rate_,
+                 m_outParams.channels_,
+                 std::max(4 * m_outParams.frame_size_, m_outParams.sample_rate_ * kRingBufferMs / 1000));
+    m_callbackBuffer.assign(size_t(m_outParams.frame_size_) * m_outParams.channels_, 0.0f);
+    m_dspChain.prepare(m_outParams.sample_rate_, m_outParams.channels_);
+    m_flushRequested = false;
+    m_pendingFrames = 0;
+    m_gainStage.setSampleRate(m_outParams.sample_rate_);
+    if (m_audioTap)
+        m_audioTap->setFormat(m_outParams.sample_rate_, m_outParams.channels_);
 
     // 启动音频播放
     SDL_PauseAudioDevice(m_audioDevice, 0);
@@ -98,6 +150,11 @@ void AudioRenderThread::setSync(AVSync *sync)
     m_avSync = sync;
 }
 
+void AudioRenderThread::setAudioTap(AudioTap *tap)
+{
+    m_audioTap = tap;
+}
+
 void AudioRenderThread::closeRenderer()
 {
     qDebug() << "关闭渲染器，准备释放资源...";
@@ -141,14 +198,69 @@ void AudioRenderThread::resumePlay()
 void AudioRenderThread::setVolume(int volume)
 {
     double val = volume / 100.0;
-    m_volume = val;
+    m_gainStage.setVolume(val);
+}
+
+void AudioRenderThread::setReplayGain(double db)
+{
+    m_gainStage.setReplayGainDb(db);
+}
+
+void AudioRenderThread::setEqualizer(const EqualizerSettings &settings)
+{
+    const bool enabled = settings.enabled;
+    m_preamp->setGainDb(enabled ? settings.preampDb : 0.0f);
+    for (int i = 0; i < EqualizerStage::kBands; ++i)
+        m_equalizer->setGainDb(i, enabled ? settings.bandsDb[i] : 0.0f);
+    m_bassBoost->setGainDb(0, settings.bassBoostDb);
+}
+
+void AudioRenderThread::flush()
+{
+    m_flushRequested = true;
+}
+
+void AudioRenderThread::setDownmixMode(DownmixMode mode)
+{
+    m_downmixMode = int(mode);
+}
+
+DownmixMode AudioRenderThread::downmixMode() const
+{
+    return DownmixMode(m_downmixMode.load());
 }
 
 void AudioRenderThread::process()
 {
-    // 采用回调函数的方式播放，不需要线程处理业务
-    // TODO: 待优化
-    msleep(10);
+    if (!m_audioInitialized || !m_audioFrameQueue) {
+        msleep(10);
+        return;
+    }
+
+    if (m_flushRequested.exchange(false))
+        resetProducer();
+
+    // 先把上次放不下的数据写完
+    if (m_pendingFrames > 0) {
+        const int channels = m_outParams.channels_;
+        const int frames = std::min(m_pendingFrames, m_ring.writableFrames());
+        if (frames <= 0) {
+            // 缓冲已满，等回调消费约一个设备缓冲
+            msleep(std::max(1, m_outParams.frame_size_ * 1000 / m_outParams.sample_rate_ / 2));
+            return;
+        }
+        m_ring.write(m_pending.data() + size_t(m_pendingOffset) * channels, frames, m_pendingPts);
+        m_pendingOffset += frames;
+        m_pendingFrames -= frames;
+        m_pendingPts = std::isnan(m_pendingPts) ? NAN : m_pendingPts + double(frames) / m_outParams.sample_rate_;
+        return;
+    }
+
+    AVFrame *frame = m_audioFrameQueue->dequeue(kDequeueTimeoutMs);
+    if (!frame)
+        return;
+    convertFrame(frame);
+    av_frame_free(&frame);
 }
 
 void AudioRenderThread::cleanup()
@@ -156,109 +268,188 @@ void AudioRenderThread::cleanup()
     closeRenderer();
 }
 
+void AudioRenderThread::resetProducer()
+{
+    m_ring.discardPending();
+    m_pendingFrames = 0;
+    m_clockDiffCum = 0.0;
+    m_clockDiffCount = 0;
+    // 重采样器内部缓存有跳转前的尾部样本，下次取帧时重建
+    swr_free(&m_swrContext);
+    m_dspChain.prepare(m_outParams.sample_rate_, m_outParams.channels_);
+}
+
+bool AudioRenderThread::ensureConverter(const AVFrame *frame)
+{
+    const uint64_t    inLayout = ChannelMixer::sanitizeLayout(frame->channel_layout, frame->channels);
+    const DownmixMode mode = downmixMode();
+    if (m_swrContext) {
+        // 源参数在流中途变化（如广播流切换节目）或缩混模式切换时重建，重采样器内部不足1ms的缓存随之丢弃
+        if (frame->format == m_converterIn.fmt_ && frame->sample_rate == m_converterIn.sample_rate_
+            && int64_t(inLayout) == m_converterIn.channel_layout_ && mode == m_converterMode) {
+            return true;
+        }
+        PLAY_LOG_INFO("audio converter rebuilt for new source parameters.");
+        swr_free(&m_swrContext);
+    }
+
+    // 统一输出交错浮点，DSP链与回调中的限制器都在浮点上处理，到S16的转换在回调最后进行
+    m_swrContext = swr_alloc_set_opts(NULL,
+                                      m_outParams.channel_layout_,
+                                      AV_SAMPLE_FMT_FLT,
+                                      m_outParams.sample_rate_,
+                                      int64_t(inLayout),
+                                      (AVSampleFormat) frame->format,
+                                      frame->sample_rate,
+                                      0,
+                                      NULL);
+    if (!m_swrContext) {
+        PLAY_LOG_WARNING("create sample rate converter failed.");
+        return false;
+    }
+    const std::vector<double> *matrix = m_mixer.matrix(inLayout, uint64_t(m_outParams.channel_layout_), mode);
+    if (matrix && swr_set_matrix(m_swrContext, matrix->data(), av_get_channel_layout_nb_channels(inLayout)) < 0)
+        PLAY_LOG_WARNING("set downmix matrix failed, using default mapping.");
+    if (swr_init(m_swrContext) < 0) {
+        PLAY_LOG_WARNING("create sample rate converter failed.");
+        swr_free(&m_swrContext);
+        return false;
+    }
+
+    m_converterIn.sample_rate_ = frame->sample_rate;
+    m_converterIn.channels_ = frame->channels;
+    m_converterIn.channel_layout_ = int64_t(inLayout);
+    m_converterIn.fmt_ = (AVSampleFormat) frame->format;
+    m_converterMode = mode;
+    return true;
+}
+
+bool AudioRenderThread::convertFrame(AVFrame *frame)
+{
+    PLAY_TRACE_SCOPE("AudioRenderThread::convertFrame");
+    const int channels = m_outParams.channels_;
+    if (frame->nb_samples <= 0 || frame->sample_rate <= 0 || channels <= 0)
+        return false;
+
+    if (!ensureConverter(frame))
+        return false;
+
+    // 主时钟不是音频时，微调本帧重采样后的样本数，让音频跟随主时钟
+    const int wanted = synchronizeSamples(frame->nb_samples);
+    if (wanted != frame->nb_samples) {
+        const int64_t outRate = m_outParams.sample_rate_;
+        const int64_t inRate = frame->sample_rate;
+        if (swr_set_compensation(m_swrContext,
+                                 int((wanted - frame->nb_samples) * outRate / inRate),
+                                 int(wanted * outRate / inRate))
+            < 0) {
+            PLAY_LOG_WARNING("swr_set_compensation failed.");
+        }
+    }
+
+    // 补偿可能使输出多出至多 kMaxCompensation，留出余量
+    const int maxFrames = int(swr_get_out_samples(m_swrContext, std::max(wanted, frame->nb_samples))) + 256;
+    if (maxFrames <= 256)
+        return false;
+    m_pending.resize(size_t(maxFrames) * channels);
+    uint8_t  *out = reinterpret_cast<uint8_t *>(m_pending.data());
+    const int frames = swr_convert(m_swrContext,
+                                   &out,
+                                   maxFrames,
+                                   (const uint8_t **) frame->extended_data,
+                                   frame->nb_samples);
+    if (frames <= 0) {
+        if (frames < 0)
+            PLAY_LOG_WARNING("swr_convert failed.");
+        return false;
+    }
+
+    // 保持浮点写入环形缓冲，超出满幅的样本由回调中的限制器处理
+    m_dspChain.process(m_pending.data(), frames);
+
+    m_pendingOffset = 0;
+    m_pendingFrames = frames;
+    // 重采样器的延迟在此忽略（通常不足1ms）
+    m_pendingPts = frame->pts != AV_NOPTS_VALUE ? frame->pts * av_q2d(m_timebase) : NAN;
+    return true;
+}
+
+int AudioRenderThread::synchronizeSamples(int nbSamples)
+{
+    if (!m_avSync || m_avSync->master() == SyncMaster::Audio)
+        return nbSamples;
+
+    const double diff = m_avSync->audioClock() - m_avSync->getClock();
+    if (std::isnan(diff) || std::fabs(diff) >= kNoSyncThreshold) {
+        // 时钟未知或差得太多（刚跳转、刚切换主时钟），重新开始统计
+        m_clockDiffCum = 0.0;
+        m_clockDiffCount = 0;
+        return nbSamples;
+    }
+
+    // 指数平均，最近 kClockDiffAvgCount 次测量的权重合计约99%
+    static const double kAvgCoef = std::exp(std::log(0.01) / kClockDiffAvgCount);
+    m_clockDiffCum = diff + kAvgCoef * m_clockDiffCum;
+    if (m_clockDiffCount < kClockDiffAvgCount) {
+        ++m_clockDiffCount;
+        return nbSamples;
+    }
+
+    // 平均偏差小于一个设备缓冲时不修正，避免来回抖动
+    const double avgDiff = m_clockDiffCum * (1.0 - kAvgCoef);
+    const double threshold = double(m_outParams.frame_size_) / m_outParams.sample_rate_;
+    if (std::fabs(avgDiff) < threshold)
+        return nbSamples;
+
+    // 音频超前时多产出样本（放慢），落后时少产出
+    const int wanted = nbSamples + int(diff * m_converterIn.sample_rate_);
+    const int minSamples = int(nbSamples * (1.0 - kMaxCompensation));
+    const int maxSamples = int(nbSamples * (1.0 + kMaxCompensation));
+    return std::min(std::max(wanted, minSamples), maxSamples);
+}
+
 void AudioRenderThread::audioCallback(Uint8 *stream, int len)
 {
-    if (!m_audioFrameQueue) {
-        qWarning() << "err: audioFrameQueue is null";
+    PLAY_TRACE_SCOPE("AudioRenderThread::audioCallback");
+    const int channels = m_ring.channels();
+    const int chunk = channels > 0 ? int(m_callbackBuffer.size()) / channels : 0;
+    if (chunk <= 0) {
+        memset(stream, 0, len);
         return;
     }
-    uint32_t bufIndex = 0, bufSize = 0, buf1Size = 0;
-    uint8_t *buf = nullptr, *buf1 = nullptr;
-    int64_t  pts = AV_NOPTS_VALUE;
-    int      len1 = 0;
-
-    while (len > 0) { // >0 表示有数据未处理
-        if (bufIndex == bufSize) {
-            bufIndex = 0;
-            AVFrame *frame = m_audioFrameQueue->dequeueNoWait();
-            if (frame) {
-                pts = frame->pts;
-
-                if ((!m_swrContext)
-                    && ((frame->format != m_outParams.fmt_)
-                        || (frame->sample_rate != m_outParams.sample_rate_)
-                        || (frame->channel_layout != m_outParams.channel_layout_))) {
-                    m_swrContext = swr_alloc_set_opts(NULL,
-                                                      m_outParams.channel_layout_,
-                                                      (AVSampleFormat) m_outParams.fmt_,
-                                                      m_outParams.sample_rate_,
-                                                      frame->channel_layout,
-                                                      (AVSampleFormat) frame->format,
-                                                      frame->sample_rate,
-                                                      0,
-                                                      NULL);
-                    if (!m_swrContext || swr_init(m_swrContext) < 0) {
-                        qWarning() << "create sample rate converter failed.";
-                        swr_free((SwrContext **) (&m_swrContext));
-                        return;
-                    }
-                }
-                if (m_swrContext) { // 重采样
-                    const uint8_t **inBuf = (const uint8_t **) frame->extended_data;
-                    uint8_t       **outBuf = &buf1;
-                    int             outSamples = frame->nb_samples * m_outParams.sample_rate_
-                                         / frame->sample_rate
-                                     + 256;
-                    int outBytes = av_samples_get_buffer_size(NULL,
-                                                              m_outParams.channels_,
-                                                              outSamples,
-                                                              m_outParams.fmt_,
-                                                              0);
-                    if (outBytes < 0) {
-                        qWarning() << "av_samples_get_buffer_size failed.";
-                        return;
-                    }
-                    av_fast_malloc(&buf1, &buf1Size, outBytes);
-
-                    int len2 = swr_convert(m_swrContext,
-                                           outBuf,
-                                           outSamples,
-                                           inBuf,
-                                           frame->nb_samples); // 返回样本数量
-                    if (len2 < 0) {
-                        qWarning() << "swr_convert failed.";
-                        return;
-                    }
-                    buf = buf1;
-                    bufSize = av_samples_get_buffer_size(NULL,
-                                                         m_outParams.channels_,
-                                                         len2,
-                                                         (AVSampleFormat) m_outParams.fmt_,
-                                                         1);
-                } else { // 没有重采样
-                    int size = av_samples_get_buffer_size(NULL,
-                                                          frame->channels,
-                                                          frame->nb_samples,
-                                                          (AVSampleFormat) frame->format,
-                                                          1);
-                    av_fast_malloc(&buf1, &buf1Size, size);
-                    buf = buf1;
-                    bufSize = size;
-                    memcpy(buf, frame->data[0], size);
-                }
-                av_frame_free(&frame);
-            } else {
-                buf = nullptr;
-                bufSize = 512;
-            }
+
+    // 设备缓冲通常正好是一块，超出时分块处理
+    int16_t  *out = reinterpret_cast<int16_t *>(stream);
+    const int frames = len / int(sizeof(int16_t) * channels);
+    float    *samples = m_callbackBuffer.data();
+    double    clock = NAN;
+    bool      underrun = false;
+    for (int done = 0; done < frames;) {
+        const int wanted = std::min(chunk, frames - done);
+        double    chunkClock = NAN;
+        const int got = m_ring.read(samples, wanted, chunkClock);
+        if (done == 0)
+            clock = chunkClock;
+        if (got < wanted) {
+            // 缓冲中数据不足，以静音填充
+            std::fill(samples + got * channels, samples + wanted * channels, 0.0f);
+            underrun = true;
         }
-        len1 = bufSize - bufIndex;
-        if (len1 > len)
-            len1 = len;
-        if (!buf)
-            memset(stream, 0, len1);
-        else
-            memcpy(stream, buf + bufIndex, len1);
-        len -= len1;
-        stream += len1;
-        bufIndex += len1;
+
+        // 音量、响度均衡与限制器，之后转为S16，饱和到满幅
+        m_gainStage.process(samples, wanted, channels);
+        const int count = wanted * channels;
+        int16_t  *pcm = out + done * channels;
+        for (int i = 0; i < count; ++i)
+            pcm[i] = int16_t(std::min(std::max(samples[i] * 32768.0f, -32768.0f), 32767.0f));
+        done += wanted;
     }
+    if (underrun)
+        PlayMetrics::add(PlayMetrics::Counter::AudioUnderruns);
 
     // 更新时钟
-    if (pts != AV_NOPTS_VALUE) {
-        double tm = pts * av_q2d(m_timebase);
-        m_avSync->setClock(tm);
-    }
+    if (!std::isnan(clock) && m_avSync)
+        m_avSync->updateAudioClock(clock);
 }
 
 void AudioRenderThread::sdlAudioCallback(void *userdata, Uint8 *stream, int len)
@@ -266,17 +457,18 @@ void AudioRenderThread::sdlAudioCallback(void *userdata, Uint8 *stream, int len)
     // 转换userdata为RenderThread实例
     AudioRenderThread *self = static_cast<AudioRenderThread *>(userdata);
     if (self) {
-        // 调用实例方法处理音频回调
+        // 回调线程由SDL创建，首次进入时绑定打开设备前预留的追踪缓冲区，回调中不分配内存、不加锁
+        static thread_local bool s_traceAttached = false;
+        if (!s_traceAttached) {
+            PlayTrace::attachRealtimeThread(self->m_traceBuffer);
+            s_traceAttached = true;
+        }
+        // 调用实例方法处理音频回调（含音量与响度均衡）
         self->audioCallback(stream, len);
 
-        // 音量调节
-        if (self->m_volume != 1.0f) {
-            Sint16 *samples = reinterpret_cast<Sint16 *>(stream);
-            int     numSamples = len / sizeof(Sint16);
-            for (int i = 0; i < numSamples; ++i) {
-                samples[i] = static_cast<Sint16>(samples[i] * self->m_volume);
-            }
-        }
+        // 无锁拷贝，分析未启用时直接返回
+        if (self->m_audioTap)
+            self->m_audioTap->write(reinterpret_cast<const int16_t *>(stream), uint32_t(len / sizeof(Sint16)));
 
     } else {
         // 如果实例无效，填充静音
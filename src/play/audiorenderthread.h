@@ -1,12 +1,20 @@
 #ifndef AUDIORENDERTHREAD_H
 #define AUDIORENDERTHREAD_H
 
+#include "audiogain.h"
 #include "avsync.h"
+#include "channelmixer.h"
+#include "constants.h"
+#include "dspchain.h"
+#include "pcmring.h"
 #include "threadbase.h"
 
+#include <atomic>
+#include <cmath>
 #include <memory>
 #include <QMutex>
 #include <QQueue>
+#include <vector>
 
 extern "C" {
 #include <SDL.h>
@@ -17,6 +25,14 @@ extern "C" {
 }
 
 class AVFrameQueue;
+class AudioTap;
+class BassBoostStage;
+class EqualizerStage;
+class PreampStage;
+
+namespace PlayTrace {
+struct ThreadBuffer;
+}
 
 struct AudioParams
 {
@@ -29,6 +45,10 @@ struct AudioParams
 
 /**
  * @brief 音频渲染线程类 - 负责将解码后音频播放
+ *
+ * 线程本身是生产者：从帧队列取出解码帧，重采样为输出格式的浮点样本，经DSP链（前级、均衡、低音增强）
+ * 处理后仍以浮点写入 PcmRing，均衡器提升超出满幅的部分不在此截断。SDL音频回调从环形缓冲取出浮点样本，
+ * 做音量/响度均衡与限制后才转为S16，并更新时钟；回调中不分配内存。
  */
 class AudioRenderThread : public ThreadBase
 {
@@ -49,6 +69,9 @@ public:
     // 绑定同步时钟
     void setSync(AVSync *sync);
 
+    // 绑定分析抽头，送入SDL的PCM（已调节音量与响度均衡）同时复制一份给分析线程
+    void setAudioTap(AudioTap *tap);
+
     // 关闭渲染器
     void closeRenderer();
 
@@ -57,6 +80,19 @@ public:
 
     void setVolume(int volume);
 
+    // 响度均衡增益（dB），与音量一起在输出级生效，可在任意线程调用
+    void setReplayGain(double db);
+
+    // 均衡器参数，可在任意线程调用，在生产线程中平滑生效
+    void setEqualizer(const EqualizerSettings &settings);
+
+    // 跳转后调用：丢弃环形缓冲与重采样器中跳转前的数据
+    void flush();
+
+    // 缩混模式；设备声道数在打开时按模式协商，播放中切换只重建重采样器
+    void        setDownmixMode(DownmixMode mode);
+    DownmixMode downmixMode() const;
+
 protected:
     // 线程处理函数
     void process() override;
@@ -65,6 +101,14 @@ private:
     // 清理资源
     void cleanup();
 
+    // 转换并处理一帧，结果放入 m_pending；无数据时返回false
+    bool convertFrame(AVFrame *frame);
+    // 按帧的格式、采样率、布局与当前缩混模式（重新）创建重采样器
+    bool ensureConverter(const AVFrame *frame);
+    void resetProducer();
+    // 主时钟不是音频时，按音频与主时钟的平均偏差返回本帧期望的样本数（输入采样率下）
+    int synchronizeSamples(int nbSamples);
+
     // 回调
     void        audioCallback(Uint8 *stream, int len);
     static void sdlAudioCallback(void *userdata, Uint8 *stream, int len);
@@ -76,14 +120,42 @@ private:
     bool m_audioInitialized{false};
 
     SDL_AudioDeviceID  m_audioDevice;
-    SwrContext        *m_swrContext{nullptr}; // 音频重采样上下文
+    SwrContext        *m_swrContext{nullptr}; // 音频重采样上下文，仅生产线程使用
     AVSync            *m_avSync = nullptr;
+    AudioTap          *m_audioTap = nullptr;
     AVRational         m_timebase;
     AVCodecParameters *m_codecpar = nullptr;
     AudioParams        m_inParams;
     AudioParams        m_outParams;
 
-    double m_volume = 1.0;
+    AudioGainStage m_gainStage; // 音量、响度均衡与限制器
+
+    // 为SDL回调线程预留的追踪缓冲区，由注册表持有
+    PlayTrace::ThreadBuffer *m_traceBuffer{nullptr};
+
+    // 生产线程与回调之间的缓冲
+    PcmRing            m_ring;
+    // 回调中的浮点工作缓冲，打开设备时按设备缓冲大小分配
+    std::vector<float> m_callbackBuffer;
+
+    // 以下仅生产线程访问
+    ChannelMixer       m_mixer;
+    AudioParams        m_converterIn{}; // 当前重采样器的输入参数
+    DownmixMode        m_converterMode{DownmixMode::Auto};
+    DspChain           m_dspChain;
+    PreampStage       *m_preamp{nullptr};
+    EqualizerStage    *m_equalizer{nullptr};
+    BassBoostStage    *m_bassBoost{nullptr};
+    std::vector<float> m_pending;          // 已处理但环形缓冲暂时放不下的样本
+    int                m_pendingOffset{0}; // 帧
+    int                m_pendingFrames{0};
+    double             m_pendingPts{NAN};
+    // 音频时钟与主时钟偏差的指数累积，主时钟不是音频时用于微调重采样比例
+    double             m_clockDiffCum{0.0};
+    int                m_clockDiffCount{0};
+
+    std::atomic<bool> m_flushRequested{false};
+    std::atomic<int>  m_downmixMode{int(DownmixMode::Auto)};
 };
 
 #endif // AUDIORENDERTHREAD_H
@@ -0,0 +1,141 @@
+#include "avsync.h"
+
+#include <algorithm>
+
+// 偏差超过该值（秒）时不再微调，直接重置外部时钟
+static constexpr double kNoSyncThreshold = 10.0;
+// 外部时钟的速度修正：每秒偏差对应的速度增量，以及修正幅度上限
+static constexpr double kExternalSpeedGain = 0.1;
+static constexpr double kExternalMaxNudge = 0.01;
+
+void AVSync::initClock()
+{
+    m_streams.reset();
+    m_external.store(ClockSnapshot{});
+}
+
+void AVSync::setPreferredMaster(SyncMaster preferred)
+{
+    m_preferred = int(preferred);
+    m_master = int(resolveMaster());
+}
+
+SyncMaster AVSync::preferredMaster() const
+{
+    return SyncMaster(m_preferred.load());
+}
+
+void AVSync::setStreams(bool hasAudio, bool hasVideo)
+{
+    m_hasAudio = hasAudio;
+    m_hasVideo = hasVideo;
+    m_master = int(resolveMaster());
+}
+
+SyncMaster AVSync::master() const
+{
+    return SyncMaster(m_master.load(std::memory_order_relaxed));
+}
+
+SyncMaster AVSync::resolveMaster() const
+{
+    const bool hasAudio = m_hasAudio;
+    const bool hasVideo = m_hasVideo;
+    switch (SyncMaster(m_preferred.load())) {
+    case SyncMaster::Video:
+        if (hasVideo)
+            return SyncMaster::Video;
+        return hasAudio ? SyncMaster::Audio : SyncMaster::External;
+    case SyncMaster::External:
+        return SyncMaster::External;
+    case SyncMaster::Auto:
+    case SyncMaster::Audio:
+    default:
+        return hasAudio ? SyncMaster::Audio : SyncMaster::External;
+    }
+}
+
+double AVSync::getClock() const
+{
+    switch (master()) {
+    case SyncMaster::Video:
+        return videoClock();
+    case SyncMaster::External:
+        return externalClock();
+    default:
+        return audioClock();
+    }
+}
+
+double AVSync::audioClock() const
+{
+    return m_streams.audioClock().at(SyncData::nowUs());
+}
+
+double AVSync::videoClock() const
+{
+    return m_streams.videoClock().at(SyncData::nowUs());
+}
+
+double AVSync::externalClock() const
+{
+    return m_external.load().at(SyncData::nowUs());
+}
+
+void AVSync::updateAudioClock(double pts)
+{
+    const double speed = m_paused ? 0.0 : 1.0;
+    m_streams.setAudioClock(pts, speed);
+
+    // 外部时钟的参考流：主时钟为视频时跟随视频，否则有音频时跟随音频
+    if (master() != SyncMaster::Video)
+        slaveExternalClock(pts, SyncData::nowUs());
+}
+
+void AVSync::updateVideoClock(double pts)
+{
+    updateVideoClock(pts, SyncData::nowUs());
+}
+
+void AVSync::updateVideoClock(double pts, int64_t atUs)
+{
+    const double speed = m_paused ? 0.0 : 1.0;
+    m_streams.setVideoClock(pts, speed, atUs);
+
+    if (master() == SyncMaster::Video || !m_hasAudio)
+        slaveExternalClock(pts, atUs);
+}
+
+void AVSync::setPaused(bool paused)
+{
+    m_paused = paused;
+
+    // 以当前值为起点重新发布，暂停时速度为0
+    const int64_t now = SyncData::nowUs();
+    const double  speed = paused ? 0.0 : 1.0;
+    m_streams.setAudioClock(m_streams.audioClock().at(now), speed);
+    m_streams.setVideoClock(m_streams.videoClock().at(now), speed);
+    m_external.store({m_external.load().at(now), now, speed});
+}
+
+void AVSync::slaveExternalClock(double pts, int64_t nowUs)
+{
+    if (std::isnan(pts))
+        return;
+
+    const bool   paused = m_paused;
+    const double current = m_external.load().at(nowUs);
+    const double diff = pts - current;
+    if (std::isnan(current) || std::fabs(diff) > kNoSyncThreshold) {
+        m_external.store({pts, nowUs, paused ? 0.0 : 1.0});
+        return;
+    }
+
+    // 外部时钟作为主时钟时保持独立，只在上面偏差过大时重置
+    if (paused || master() == SyncMaster::External)
+        return;
+
+    // 不跳变，按偏差微调速度逐渐靠拢
+    const double nudge = std::clamp(diff * kExternalSpeedGain, -kExternalMaxNudge, kExternalMaxNudge);
+    m_external.store({current, nowUs, 1.0 + nudge});
+}
@@ -1,48 +1,70 @@
 #ifndef AVSYNC_H
 #define AVSYNC_H
 
-#include <chrono>
-#include <ctime>
-#include <math.h>
-using namespace std::chrono;
+#include "constants.h"
+#include "seqlock.h"
+#include "syncdata.h"
 
+#include <atomic>
+
+/**
+ * @brief 同步时钟 - 音频、视频、外部三路时钟与主时钟选择
+ *
+ * 音频回调按实际播放位置、视频渲染线程按显示的帧发布各自的时钟；外部时钟自由运行，
+ * 以微调速度的方式逐渐靠拢参考流（主时钟为外部时钟时只在偏差过大时重置）。
+ * 主时钟按用户偏好与媒体实际包含的流确定，视频与解码线程据此定时，音频在主时钟不是自己时微调重采样比例跟随。
+ * 全部状态保存在顺序锁与原子变量中，发布与读取都不加锁，也不需要专门的线程轮询。
+ */
 class AVSync
 {
 public:
     AVSync() = default;
 
-    void initClock() { setClock(NAN); }
+    // 打开媒体或跳转后清除全部时钟
+    void initClock();
+
+    // 主时钟偏好，可在播放中切换
+    void       setPreferredMaster(SyncMaster preferred);
+    SyncMaster preferredMaster() const;
+
+    // 当前媒体实际会输出的流，打开媒体后设置
+    void setStreams(bool hasAudio, bool hasVideo);
+
+    // 实际使用的主时钟：Audio、Video 或 External
+    SyncMaster master() const;
+
+    // 主时钟（秒），未知时为NAN
+    double getClock() const;
 
-    double getClock()
-    {
-        double time = getMicroseconds() / 1000000.0;
-        return m_diff + time;
-    }
+    double audioClock() const;
+    double videoClock() const;
+    double externalClock() const;
 
-    void setClock(double pts)
-    {
-        double time = getMicroseconds() / 1000000.0; // us -> s
-        setClockAt(pts, time);
-    }
+    // 输出端发布，pts 为秒
+    void updateAudioClock(double pts);
+    void updateVideoClock(double pts);
+    // 视频帧按其应显示的时刻 atUs（SyncData::nowUs 时基）发布，唤醒与呈现的延迟不会累积到视频时钟
+    void updateVideoClock(double pts, int64_t atUs);
+
+    // 暂停时冻结全部时钟，恢复后从冻结处继续
+    void setPaused(bool paused);
+
+    SyncData       &streams() { return m_streams; }
+    const SyncData &streams() const { return m_streams; }
 
 private:
-    double m_pts = 0;
-    double m_diff = 0;
-
-    void setClockAt(double pts, double time)
-    {
-        m_pts = pts;
-        m_diff = m_pts - time;
-    }
-
-    time_t getMicroseconds()
-    {
-        system_clock::time_point time_point_new = system_clock::now();
-        system_clock::duration   duration = time_point_new.time_since_epoch();
-
-        time_t us = duration_cast<microseconds>(duration).count();
-        return us;
-    }
+    SyncMaster resolveMaster() const;
+    void       slaveExternalClock(double pts, int64_t nowUs);
+
+private:
+    SyncData               m_streams;
+    SeqLock<ClockSnapshot> m_external;
+
+    std::atomic<int>  m_preferred{int(SyncMaster::Auto)};
+    std::atomic<int>  m_master{int(SyncMaster::Audio)};
+    std::atomic<bool> m_hasAudio{true};
+    std::atomic<bool> m_hasVideo{true};
+    std::atomic<bool> m_paused{false};
 };
 
 #endif // AVSYNC_H
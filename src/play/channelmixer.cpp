@@ -0,0 +1,181 @@
+#include "channelmixer.h"
+
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+}
+
+static constexpr double kMinus3Db = 0.70710678118654752;
+
+namespace {
+
+struct EarGains
+{
+    double left;
+    double right;
+};
+
+// ITU-R BS.775 立体声缩混系数；LFE不计入
+EarGains stereoGains(uint64_t channel)
+{
+    switch (channel) {
+    case AV_CH_FRONT_LEFT:
+    case AV_CH_FRONT_LEFT_OF_CENTER:
+    case AV_CH_WIDE_LEFT:
+        return {1.0, 0.0};
+    case AV_CH_FRONT_RIGHT:
+    case AV_CH_FRONT_RIGHT_OF_CENTER:
+    case AV_CH_WIDE_RIGHT:
+        return {0.0, 1.0};
+    case AV_CH_FRONT_CENTER:
+    case AV_CH_TOP_CENTER:
+    case AV_CH_TOP_FRONT_CENTER:
+        return {kMinus3Db, kMinus3Db};
+    case AV_CH_BACK_CENTER:
+    case AV_CH_TOP_BACK_CENTER:
+        return {0.5, 0.5};
+    case AV_CH_SIDE_LEFT:
+    case AV_CH_BACK_LEFT:
+    case AV_CH_TOP_FRONT_LEFT:
+    case AV_CH_TOP_BACK_LEFT:
+    case AV_CH_SURROUND_DIRECT_LEFT:
+        return {kMinus3Db, 0.0};
+    case AV_CH_SIDE_RIGHT:
+    case AV_CH_BACK_RIGHT:
+    case AV_CH_TOP_FRONT_RIGHT:
+    case AV_CH_TOP_BACK_RIGHT:
+    case AV_CH_SURROUND_DIRECT_RIGHT:
+        return {0.0, kMinus3Db};
+    default:
+        return {0.0, 0.0};
+    }
+}
+
+// 双耳简化：各声道按方位给同侧/对侧耳不同增益，对侧较弱，模拟扬声器听音时的串扰；不做延迟与滤波
+EarGains binauralGains(uint64_t channel)
+{
+    switch (channel) {
+    case AV_CH_FRONT_LEFT:
+    case AV_CH_FRONT_LEFT_OF_CENTER:
+    case AV_CH_WIDE_LEFT:
+        return {1.0, 0.3};
+    case AV_CH_FRONT_RIGHT:
+    case AV_CH_FRONT_RIGHT_OF_CENTER:
+    case AV_CH_WIDE_RIGHT:
+        return {0.3, 1.0};
+    case AV_CH_SIDE_LEFT:
+    case AV_CH_TOP_FRONT_LEFT:
+    case AV_CH_SURROUND_DIRECT_LEFT:
+        return {0.85, 0.2};
+    case AV_CH_SIDE_RIGHT:
+    case AV_CH_TOP_FRONT_RIGHT:
+    case AV_CH_SURROUND_DIRECT_RIGHT:
+        return {0.2, 0.85};
+    case AV_CH_BACK_LEFT:
+    case AV_CH_TOP_BACK_LEFT:
+        return {0.7, 0.4};
+    case AV_CH_BACK_RIGHT:
+    case AV_CH_TOP_BACK_RIGHT:
+        return {0.4, 0.7};
+    default:
+        return stereoGains(channel);
+    }
+}
+
+} // namespace
+
+int ChannelMixer::preferredDeviceChannels(int sourceChannels, DownmixMode mode)
+{
+    if (mode != DownmixMode::Auto)
+        return 2;
+    // SDL 支持 1 ~ 8 声道
+    return std::clamp(sourceChannels, 1, 8);
+}
+
+uint64_t ChannelMixer::deviceLayout(int channels)
+{
+    switch (channels) {
+    case 1:
+        return AV_CH_LAYOUT_MONO;
+    case 2:
+        return AV_CH_LAYOUT_STEREO;
+    case 3:
+        return AV_CH_LAYOUT_2POINT1;
+    case 4:
+        return AV_CH_LAYOUT_QUAD;
+    case 5:
+        return AV_CH_LAYOUT_QUAD | AV_CH_LOW_FREQUENCY; // SDL的4.1为 FL FR LFE BL BR，不同于FFmpeg的4.1
+    case 6:
+        return AV_CH_LAYOUT_5POINT1;
+    case 7:
+        return AV_CH_LAYOUT_6POINT1;
+    case 8:
+        return AV_CH_LAYOUT_7POINT1;
+    default:
+        return uint64_t(av_get_default_channel_layout(channels));
+    }
+}
+
+uint64_t ChannelMixer::sanitizeLayout(uint64_t layout, int channels)
+{
+    if (layout != 0 && av_get_channel_layout_nb_channels(layout) == channels)
+        return layout;
+    return uint64_t(av_get_default_channel_layout(channels));
+}
+
+const std::vector<double> *ChannelMixer::matrix(uint64_t inLayout, uint64_t outLayout, DownmixMode mode)
+{
+    // 多声道缩混到立体声、或模式要求立体声而设备为多声道时使用自定义系数，其余情况（含升混）交给默认映射
+    const int  inChannels = av_get_channel_layout_nb_channels(inLayout);
+    const int  outChannels = av_get_channel_layout_nb_channels(outLayout);
+    const bool stereoOut = outLayout == AV_CH_LAYOUT_STEREO && inChannels > 2;
+    const bool foldToFront = mode != DownmixMode::Auto && outChannels > 2
+                             && (outLayout & AV_CH_LAYOUT_STEREO) == AV_CH_LAYOUT_STEREO;
+    if (!stereoOut && !foldToFront)
+        return nullptr;
+
+    const Key key{inLayout, outLayout, int(mode)};
+    auto      found = m_cache.find(key);
+    if (found == m_cache.end())
+        found = m_cache.emplace(key, buildStereoMatrix(inLayout, outLayout, mode)).first;
+    return found->second.empty() ? nullptr : &found->second;
+}
+
+std::vector<double> ChannelMixer::buildStereoMatrix(uint64_t inLayout, uint64_t outLayout, DownmixMode mode)
+{
+    const int inChannels = av_get_channel_layout_nb_channels(inLayout);
+    const int outChannels = av_get_channel_layout_nb_channels(outLayout);
+
+    // 单声道/立体声源不加串扰
+    const bool binaural = mode == DownmixMode::Binaural && inChannels > 2;
+
+    std::vector<double> matrix(size_t(outChannels) * inChannels, 0.0);
+    const int           leftRow = av_get_channel_layout_channel_index(outLayout, AV_CH_FRONT_LEFT);
+    const int           rightRow = av_get_channel_layout_channel_index(outLayout, AV_CH_FRONT_RIGHT);
+    if (leftRow < 0 || rightRow < 0)
+        return {};
+    for (int i = 0; i < inChannels; ++i) {
+        const uint64_t channel = av_channel_layout_extract_channel(inLayout, i);
+        const EarGains gains = binaural ? binauralGains(channel) : stereoGains(channel);
+        matrix[size_t(leftRow) * inChannels + i] = gains.left;
+        matrix[size_t(rightRow) * inChannels + i] = gains.right;
+    }
+
+    // 按行和归一化，所有声道同时满幅时也不会削波
+    double maxSum = 0.0;
+    for (int row = 0; row < outChannels; ++row) {
+        double sum = 0.0;
+        for (int i = 0; i < inChannels; ++i)
+            sum += matrix[size_t(row) * inChannels + i];
+        maxSum = std::max(maxSum, sum);
+    }
+    if (maxSum <= 0.0)
+        return {};
+    if (maxSum > 1.0) {
+        for (double &value : matrix)
+            value /= maxSum;
+    }
+    return matrix;
+}
@@ -0,0 +1,41 @@
+#ifndef CHANNELMIXER_H
+#define CHANNELMIXER_H
+
+#include "constants.h"
+
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+/**
+ * @brief 声道布局协商与缩混矩阵
+ *
+ * 设备声道数按缩混模式与源声道数决定，再按SDL的声道顺序映射为FFmpeg布局。
+ * 缩混到立体声时由本类生成混音矩阵交给 swr_set_matrix，由 libswresample 的向量化混音执行；
+ * 设备多于两个声道而模式要求立体声时，缩混结果只送入前左/前右，播放中切换模式不必重开设备。
+ * 矩阵按（输入布局, 输出布局, 模式）缓存，源格式变化重建重采样器时直接取用，打开文件时预先计算。
+ */
+class ChannelMixer
+{
+public:
+    // 请求打开设备时使用的声道数
+    static int preferredDeviceChannels(int sourceChannels, DownmixMode mode);
+
+    // SDL 各声道数对应的声道顺序
+    static uint64_t deviceLayout(int channels);
+
+    // 声道数与布局掩码不一致或布局为0时按声道数取默认布局
+    static uint64_t sanitizeLayout(uint64_t layout, int channels);
+
+    // 返回 out × in 的矩阵（行跨度为输入声道数）；返回nullptr时使用 libswresample 的默认映射
+    const std::vector<double> *matrix(uint64_t inLayout, uint64_t outLayout, DownmixMode mode);
+
+private:
+    static std::vector<double> buildStereoMatrix(uint64_t inLayout, uint64_t outLayout, DownmixMode mode);
+
+    using Key = std::tuple<uint64_t, uint64_t, int>;
+    std::map<Key, std::vector<double>> m_cache; // 空矩阵表示使用默认映射
+};
+
+#endif // CHANNELMIXER_H
@@ -1,5 +1,8 @@
 #include "demuxthread.h"
 #include "avpacketqueue.h"
+#include "playlog.h"
+#include "playmetrics.h"
+#include "playtrace.h"
 
 #include <QDebug>
 
@@ -79,7 +82,9 @@ bool DemuxThread::openMedia(const QString &path)
 
     for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
         AVStream *stream = m_formatContext->streams[i];
-        if (stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && m_videoStreamIndex < 0) {
+        // 音乐文件的封面图也以视频流的形式出现，不作为视频播放
+        const bool isCoverArt = stream->disposition & AV_DISPOSITION_ATTACHED_PIC;
+        if (stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && !isCoverArt && m_videoStreamIndex < 0) {
             m_videoStreamIndex = i;
             m_videoWidth = stream->codecpar->width;
             m_videoHeight = stream->codecpar->height;
@@ -101,6 +106,21 @@ bool DemuxThread::openMedia(const QString &path)
         return false;
     }
 
+    // 没有真正的视频流或用户选择仅音频时，整条视频管线都不启动
+    m_audioOnly = m_audioStreamIndex >= 0 && (m_audioOnlyRequested || m_videoStreamIndex < 0);
+    if (m_audioOnly) {
+        m_videoStreamIndex = -1;
+        m_videoWidth = 0;
+        m_videoHeight = 0;
+        m_frameRate = 0.0;
+    }
+
+    // 未选用的流在解复用层直接丢弃，av_read_frame 不再为其读取和分配包
+    for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
+        if (int(i) != m_videoStreamIndex && int(i) != m_audioStreamIndex)
+            m_formatContext->streams[i]->discard = AVDISCARD_ALL;
+    }
+
     // 获取媒体总时长（微秒转毫秒）
     if (m_formatContext->duration != AV_NOPTS_VALUE) {
         m_duration = m_formatContext->duration / 1000;
@@ -119,7 +139,7 @@ bool DemuxThread::openMedia(const QString &path)
     qInfo() << "媒体已成功打开：" << path;
     qInfo() << "视频流索引:" << m_videoStreamIndex << "分辨率:" << m_videoWidth << "x"
             << m_videoHeight << "帧率:" << m_frameRate;
-    qInfo() << "音频流索引:" << m_audioStreamIndex;
+    qInfo() << "音频流索引:" << m_audioStreamIndex << (m_audioOnly ? "（仅音频）" : "");
     qInfo() << "时长(ms):" << m_duration;
 
     emit sigMediaInfoReady();
@@ -155,6 +175,17 @@ void DemuxThread::closeMedia()
     m_duration = 0;
     m_currentPosition = 0;
     m_isEof = false;
+    m_audioOnly = false;
+}
+
+void DemuxThread::setAudioOnly(bool audioOnly)
+{
+    m_audioOnlyRequested = audioOnly;
+}
+
+bool DemuxThread::isAudioOnly() const
+{
+    return m_audioOnly;
 }
 
 AVPacketQueue *DemuxThread::videoPacketQueue() const
@@ -309,6 +340,7 @@ bool DemuxThread::readPacket()
 
     // 避免在seek操作期间读取包
     QMutexLocker locker(&m_seekMutex);
+    PLAY_TRACE_SCOPE("DemuxThread::readPacket");
 
     AVPacket *packet = av_packet_alloc();
     int       ret = av_read_frame(m_formatContext, packet);
@@ -328,19 +360,24 @@ bool DemuxThread::readPacket()
             // 其他错误
             char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
             av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
-            qWarning() << "读取媒体包时出错:" << errbuf;
+            PLAY_LOG_WARNING("读取媒体包时出错: %s", errbuf);
         }
 
         return false;
     }
 
+    PlayMetrics::add(PlayMetrics::Counter::PacketsRead);
+    PlayMetrics::add(PlayMetrics::Counter::BytesRead, packet->size);
+
     // 将包放入对应的队列
     bool enqueued = false;
 
     if (packet->stream_index == m_videoStreamIndex) {
         enqueued = m_videoPacketQueue->enqueue(packet);
+        PlayMetrics::set(PlayMetrics::Gauge::VideoPacketQueueDepth, m_videoPacketQueue->size());
     } else if (packet->stream_index == m_audioStreamIndex) {
         enqueued = m_audioPacketQueue->enqueue(packet);
+        PlayMetrics::set(PlayMetrics::Gauge::AudioPacketQueueDepth, m_audioPacketQueue->size());
     }
 
     av_packet_free(&packet);
@@ -28,9 +28,15 @@ public:
     // 初始化线程
     bool initialize() override;
 
+    // 仅音频模式：视频流在解复用层丢弃，须在 openMedia 之前设置
+    void setAudioOnly(bool audioOnly);
+
     // 打开媒体文件或URL
     bool openMedia(const QString &path);
 
+    // 当前媒体是否按仅音频打开（用户要求，或没有真正的视频流）
+    bool isAudioOnly() const;
+
     // 关闭当前媒体
     void closeMedia();
 
@@ -120,6 +126,10 @@ private:
     // 是否已经到达文件末尾
     std::atomic<bool> m_isEof{false};
 
+    // 仅音频模式
+    bool m_audioOnlyRequested{false};
+    bool m_audioOnly{false};
+
     // 互斥锁
     QMutex m_seekMutex;
 };
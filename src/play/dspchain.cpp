@@ -0,0 +1,43 @@
+#include "dspchain.h"
+
+void DspChain::addStage(std::unique_ptr<DspStage> stage)
+{
+    if (m_sampleRate > 0)
+        stage->prepare(m_sampleRate, m_channels);
+    m_stages.push_back(std::move(stage));
+}
+
+void DspChain::prepare(int sampleRate, int channels)
+{
+    m_sampleRate = sampleRate;
+    m_channels = channels;
+    for (auto &stage : m_stages)
+        stage->prepare(sampleRate, channels);
+}
+
+bool DspChain::isActive() const
+{
+    // 超过 kMaxChannels 的声道数不处理
+    if (m_channels <= 0 || m_channels > kMaxChannels)
+        return false;
+    for (const auto &stage : m_stages) {
+        if (stage->isActive())
+            return true;
+    }
+    return false;
+}
+
+bool DspChain::process(float *samples, int frames)
+{
+    if (frames <= 0 || m_channels <= 0 || m_channels > kMaxChannels)
+        return false;
+
+    bool ran = false;
+    for (auto &stage : m_stages) {
+        if (stage->isActive()) {
+            stage->process(samples, frames);
+            ran = true;
+        }
+    }
+    return ran;
+}
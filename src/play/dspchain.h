@@ -0,0 +1,58 @@
+#ifndef DSPCHAIN_H
+#define DSPCHAIN_H
+
+#include <memory>
+#include <vector>
+
+/**
+ * @brief DSP处理级接口
+ *
+ * 在音频生产线程中对交错浮点样本原地处理。参数由其他线程通过各级自己的原子量设置，
+ * process 内部负责平滑过渡；isActive 为false时该级等同直通，链路直接跳过。
+ */
+class DspStage
+{
+public:
+    virtual ~DspStage() = default;
+
+    virtual const char *name() const = 0;
+
+    // 输出格式变化或跳转后调用，清空滤波器状态
+    virtual void prepare(int sampleRate, int channels) = 0;
+
+    // 仅读取原子量，开销可忽略
+    virtual bool isActive() const = 0;
+
+    virtual void process(float *samples, int frames) = 0;
+};
+
+/**
+ * @brief DSP处理链 - 按顺序执行各处理级
+ *
+ * 所有级都不活动时 process 直接返回false，调用方可以据此跳过整条链。
+ */
+class DspChain
+{
+public:
+    static constexpr int kMaxChannels = 8;
+
+    void addStage(std::unique_ptr<DspStage> stage);
+
+    const std::vector<std::unique_ptr<DspStage>> &stages() const { return m_stages; }
+
+    void prepare(int sampleRate, int channels);
+    bool isActive() const;
+
+    // 返回是否有处理级执行
+    bool process(float *samples, int frames);
+
+    int sampleRate() const { return m_sampleRate; }
+    int channels() const { return m_channels; }
+
+private:
+    std::vector<std::unique_ptr<DspStage>> m_stages;
+    int                                    m_sampleRate{0};
+    int                                    m_channels{0};
+};
+
+#endif // DSPCHAIN_H
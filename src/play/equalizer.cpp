@@ -0,0 +1,242 @@
+#include "equalizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr double kPi = 3.14159265358979323846;
+
+// 状态低于该值视为已衰减完，同时避免非规格化浮点数拖慢运算
+static constexpr float kStateEpsilon = 1e-15f;
+
+namespace {
+
+template<int C>
+void runBiquad(float *samples, int frames, float b0, float b1, float b2, float a1, float a2, float *s1, float *s2)
+{
+    float z1[C];
+    float z2[C];
+    for (int ch = 0; ch < C; ++ch) {
+        z1[ch] = s1[ch];
+        z2[ch] = s2[ch];
+    }
+    for (int i = 0; i < frames; ++i) {
+        float *frame = samples + i * C;
+        for (int ch = 0; ch < C; ++ch) {
+            const float in = frame[ch];
+            const float out = b0 * in + z1[ch];
+            z1[ch] = b1 * in - a1 * out + z2[ch];
+            z2[ch] = b2 * in - a2 * out;
+            frame[ch] = out;
+        }
+    }
+    for (int ch = 0; ch < C; ++ch) {
+        s1[ch] = z1[ch];
+        s2[ch] = z2[ch];
+    }
+}
+
+} // namespace
+
+BiquadBankStage::BiquadBankStage(const BandSpec *bands, int count)
+    : m_bandCount(std::min(count, kMaxBands))
+{
+    for (int i = 0; i < m_bandCount; ++i)
+        m_bands[i].spec = bands[i];
+}
+
+void BiquadBankStage::setGainDb(int band, float db)
+{
+    if (band >= 0 && band < m_bandCount)
+        m_bands[band].targetDb.store(db, std::memory_order_relaxed);
+}
+
+float BiquadBankStage::gainDb(int band) const
+{
+    return band >= 0 && band < m_bandCount ? m_bands[band].targetDb.load(std::memory_order_relaxed) : 0.0f;
+}
+
+void BiquadBankStage::prepare(int sampleRate, int channels)
+{
+    m_sampleRate = sampleRate;
+    m_channels = std::clamp(channels, 1, DspChain::kMaxChannels);
+    for (int i = 0; i < m_bandCount; ++i) {
+        Band &band = m_bands[i];
+        band.s1.fill(0.0f);
+        band.s2.fill(0.0f);
+        band.running = band.currentDb != 0.0f;
+        updateCoefficients(band);
+    }
+}
+
+bool BiquadBankStage::isActive() const
+{
+    for (int i = 0; i < m_bandCount; ++i) {
+        const Band &band = m_bands[i];
+        if (band.running || band.targetDb.load(std::memory_order_relaxed) != 0.0f)
+            return true;
+    }
+    return false;
+}
+
+void BiquadBankStage::updateCoefficients(Band &band) const
+{
+    // RBJ Audio EQ Cookbook
+    const double gain = std::pow(10.0, band.currentDb / 40.0);
+    const double frequency = std::min(band.spec.frequency, 0.45 * m_sampleRate);
+    const double w0 = 2.0 * kPi * frequency / m_sampleRate;
+    const double cosW = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * band.spec.q);
+
+    double b0, b1, b2, a0, a1, a2;
+    if (band.spec.shape == Shape::Peaking) {
+        b0 = 1.0 + alpha * gain;
+        b1 = -2.0 * cosW;
+        b2 = 1.0 - alpha * gain;
+        a0 = 1.0 + alpha / gain;
+        a1 = -2.0 * cosW;
+        a2 = 1.0 - alpha / gain;
+    } else {
+        const double root = 2.0 * std::sqrt(gain) * alpha;
+        b0 = gain * ((gain + 1.0) - (gain - 1.0) * cosW + root);
+        b1 = 2.0 * gain * ((gain - 1.0) - (gain + 1.0) * cosW);
+        b2 = gain * ((gain + 1.0) - (gain - 1.0) * cosW - root);
+        a0 = (gain + 1.0) + (gain - 1.0) * cosW + root;
+        a1 = -2.0 * ((gain - 1.0) + (gain + 1.0) * cosW);
+        a2 = (gain + 1.0) + (gain - 1.0) * cosW - root;
+    }
+    band.coeffs.b0 = float(b0 / a0);
+    band.coeffs.b1 = float(b1 / a0);
+    band.coeffs.b2 = float(b2 / a0);
+    band.coeffs.a1 = float(a1 / a0);
+    band.coeffs.a2 = float(a2 / a0);
+}
+
+void BiquadBankStage::runBand(Band &band, float *samples, int frames) const
+{
+    const Coefficients &c = band.coeffs;
+    float              *s1 = band.s1.data();
+    float              *s2 = band.s2.data();
+    switch (m_channels) {
+    case 1:
+        runBiquad<1>(samples, frames, c.b0, c.b1, c.b2, c.a1, c.a2, s1, s2);
+        break;
+    case 2:
+        runBiquad<2>(samples, frames, c.b0, c.b1, c.b2, c.a1, c.a2, s1, s2);
+        break;
+    case 4:
+        runBiquad<4>(samples, frames, c.b0, c.b1, c.b2, c.a1, c.a2, s1, s2);
+        break;
+    case 6:
+        runBiquad<6>(samples, frames, c.b0, c.b1, c.b2, c.a1, c.a2, s1, s2);
+        break;
+    default:
+        // 其他声道数按运行期声道数循环
+        for (int i = 0; i < frames; ++i) {
+            float *frame = samples + i * m_channels;
+            for (int ch = 0; ch < m_channels; ++ch) {
+                const float in = frame[ch];
+                const float out = c.b0 * in + s1[ch];
+                s1[ch] = c.b1 * in - c.a1 * out + s2[ch];
+                s2[ch] = c.b2 * in - c.a2 * out;
+                frame[ch] = out;
+            }
+        }
+        break;
+    }
+}
+
+void BiquadBankStage::process(float *samples, int frames)
+{
+    const float maxStep = float(kRampDbPerSec * kRampFrames / m_sampleRate);
+
+    for (int offset = 0; offset < frames; offset += kRampFrames) {
+        const int count = std::min(kRampFrames, frames - offset);
+        float    *block = samples + offset * m_channels;
+
+        for (int i = 0; i < m_bandCount; ++i) {
+            Band       &band = m_bands[i];
+            const float target = band.targetDb.load(std::memory_order_relaxed);
+            if (band.currentDb != target) {
+                const float delta = target - band.currentDb;
+                band.currentDb = std::fabs(delta) <= maxStep ? target : band.currentDb + std::copysign(maxStep, delta);
+                updateCoefficients(band);
+                band.running = true;
+            }
+            if (!band.running)
+                continue;
+
+            runBand(band, block, count);
+
+            // 增益回到0dB后系数即为直通，等残留状态衰减完再停止处理该频段
+            bool settled = band.currentDb == 0.0f;
+            for (int ch = 0; ch < m_channels; ++ch) {
+                if (std::fabs(band.s1[ch]) < kStateEpsilon)
+                    band.s1[ch] = 0.0f;
+                if (std::fabs(band.s2[ch]) < kStateEpsilon)
+                    band.s2[ch] = 0.0f;
+                settled = settled && band.s1[ch] == 0.0f && band.s2[ch] == 0.0f;
+            }
+            if (settled)
+                band.running = false;
+        }
+    }
+}
+
+const double EqualizerStage::kFrequencies[EqualizerStage::kBands]
+    = {31.25, 62.5, 125.0, 250.0, 500.0, 1000.0, 2000.0, 4000.0, 8000.0, 16000.0};
+
+static const BiquadBankStage::BandSpec *equalizerBands()
+{
+    static BiquadBankStage::BandSpec bands[EqualizerStage::kBands];
+    for (int i = 0; i < EqualizerStage::kBands; ++i)
+        bands[i] = {BiquadBankStage::Shape::Peaking, EqualizerStage::kFrequencies[i], std::sqrt(2.0)};
+    return bands;
+}
+
+EqualizerStage::EqualizerStage()
+    : BiquadBankStage(equalizerBands(), kBands)
+{}
+
+static const BiquadBankStage::BandSpec kBassBoostBand = {BiquadBankStage::Shape::LowShelf, 100.0, 0.7071};
+
+BassBoostStage::BassBoostStage()
+    : BiquadBankStage(&kBassBoostBand, 1)
+{}
+
+void PreampStage::setGainDb(float db)
+{
+    m_targetDb.store(db, std::memory_order_relaxed);
+    m_targetGain.store(db == 0.0f ? 1.0f : float(std::pow(10.0, db / 20.0)), std::memory_order_relaxed);
+}
+
+void PreampStage::prepare(int, int channels)
+{
+    m_channels = channels;
+    m_gain = m_targetGain.load(std::memory_order_relaxed);
+}
+
+bool PreampStage::isActive() const
+{
+    return m_gain != 1.0f || m_targetGain.load(std::memory_order_relaxed) != 1.0f;
+}
+
+void PreampStage::process(float *samples, int frames)
+{
+    const float target = m_targetGain.load(std::memory_order_relaxed);
+    const int   count = frames * m_channels;
+    if (target == m_gain) {
+        for (int i = 0; i < count; ++i)
+            samples[i] *= target;
+        return;
+    }
+
+    const float step = (target - m_gain) / frames;
+    float       gain = m_gain;
+    for (int i = 0; i < frames; ++i) {
+        gain += step;
+        float *frame = samples + i * m_channels;
+        for (int ch = 0; ch < m_channels; ++ch)
+            frame[ch] *= gain;
+    }
+    m_gain = target;
+}
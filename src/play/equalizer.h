@@ -0,0 +1,118 @@
+#ifndef EQUALIZER_H
+#define EQUALIZER_H
+
+#include "dspchain.h"
+
+#include <array>
+#include <atomic>
+
+/**
+ * @brief 双二阶滤波器组 - 若干个串联的峰值/低架滤波器
+ *
+ * 每个频段有独立的目标增益（原子量，任意线程设置）。处理时以 kRampFrames 帧为一小段，
+ * 增益按 kRampDbPerSec 的速度逼近目标并重算系数，改动参数时不会有咔哒声。
+ * 增益为0dB的频段等同直通，滤波器状态衰减完后跳过；所有频段都平直时整级不活动。
+ * 直接II型转置结构，状态按声道连续存放，内层循环跨声道，声道数在编译期已知时可向量化。
+ */
+class BiquadBankStage : public DspStage
+{
+public:
+    static constexpr int    kMaxBands = 16;
+    static constexpr int    kRampFrames = 64;
+    static constexpr double kRampDbPerSec = 60.0;
+
+    enum class Shape { Peaking, LowShelf };
+
+    struct BandSpec
+    {
+        Shape  shape;
+        double frequency;
+        double q;
+    };
+
+    int bandCount() const { return m_bandCount; }
+
+    void  setGainDb(int band, float db);
+    float gainDb(int band) const;
+
+    void prepare(int sampleRate, int channels) override;
+    bool isActive() const override;
+    void process(float *samples, int frames) override;
+
+protected:
+    BiquadBankStage(const BandSpec *bands, int count);
+
+private:
+    struct Coefficients
+    {
+        float b0{1.0f}, b1{0.0f}, b2{0.0f}, a1{0.0f}, a2{0.0f};
+    };
+
+    struct Band
+    {
+        BandSpec           spec;
+        std::atomic<float> targetDb{0.0f};
+        float              currentDb{0.0f}; // 以下仅处理线程访问
+        bool               running{false};  // 有增益或状态尚未衰减完
+        Coefficients       coeffs;
+
+        alignas(32) std::array<float, DspChain::kMaxChannels> s1{};
+        alignas(32) std::array<float, DspChain::kMaxChannels> s2{};
+    };
+
+    void updateCoefficients(Band &band) const;
+    void runBand(Band &band, float *samples, int frames) const;
+
+    std::array<Band, kMaxBands> m_bands;
+    int                         m_bandCount{0};
+    int                         m_sampleRate{48000};
+    int                         m_channels{2};
+};
+
+/**
+ * @brief 10段图示均衡器 - 31Hz ~ 16kHz 倍频程峰值滤波器，Q = √2
+ */
+class EqualizerStage : public BiquadBankStage
+{
+public:
+    static constexpr int kBands = 10;
+    static const double  kFrequencies[kBands];
+
+    EqualizerStage();
+
+    const char *name() const override { return "equalizer"; }
+};
+
+/**
+ * @brief 低音增强 - 100Hz 低架滤波器
+ */
+class BassBoostStage : public BiquadBankStage
+{
+public:
+    BassBoostStage();
+
+    const char *name() const override { return "bass_boost"; }
+};
+
+/**
+ * @brief 前级增益 - 每块内线性过渡到目标增益
+ */
+class PreampStage : public DspStage
+{
+public:
+    void  setGainDb(float db);
+    float gainDb() const { return m_targetDb.load(std::memory_order_relaxed); }
+
+    const char *name() const override { return "preamp"; }
+    void        prepare(int sampleRate, int channels) override;
+    bool        isActive() const override;
+    void        process(float *samples, int frames) override;
+
+private:
+    std::atomic<float> m_targetDb{0.0f};
+    std::atomic<float> m_targetGain{1.0f};
+    float              m_gain{1.0f};
+    int                m_channels{2};
+};
+
+#endif // EQUALIZER_H
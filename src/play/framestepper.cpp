@@ -0,0 +1,299 @@
+#include "framestepper.h"
+#include "playlog.h"
+#include "syncdata.h"
+
+#include <cmath>
+#include <iterator>
+
+// 空闲列表最多保留的帧结构体数，超出的直接释放
+static constexpr size_t kMaxPooledFrames = 64;
+
+FrameStepper::FrameStepper(size_t memoryBudget)
+    : m_budget(memoryBudget)
+{}
+
+FrameStepper::~FrameStepper()
+{
+    close();
+    for (AVFrame *frame : m_framePool)
+        av_frame_free(&frame);
+    m_framePool.clear();
+}
+
+bool FrameStepper::open(const QString &path)
+{
+    if (isOpen() && path == m_path)
+        return true;
+    close();
+
+    if (avformat_open_input(&m_format, path.toUtf8().constData(), nullptr, nullptr) < 0) {
+        PLAY_LOG_WARNING("逐帧步进打开文件失败: %s", path.toUtf8().constData());
+        return false;
+    }
+
+    do {
+        if (avformat_find_stream_info(m_format, nullptr) < 0)
+            break;
+        m_streamIndex = av_find_best_stream(m_format, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (m_streamIndex < 0)
+            break;
+        AVStream *stream = m_format->streams[m_streamIndex];
+        if (stream->disposition & AV_DISPOSITION_ATTACHED_PIC)
+            break;
+        // 只读取视频流
+        for (unsigned i = 0; i < m_format->nb_streams; ++i) {
+            if (int(i) != m_streamIndex)
+                m_format->streams[i]->discard = AVDISCARD_ALL;
+        }
+
+        const AVCodec *decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+        if (!decoder)
+            break;
+        AVCodecContext *codec = avcodec_alloc_context3(decoder);
+        if (!codec)
+            break;
+        codec->thread_count = 0; // 后退时整段GOP一次解码完，多线程缩短等待
+        if (avcodec_parameters_to_context(codec, stream->codecpar) < 0 || avcodec_open2(codec, decoder, nullptr) < 0) {
+            avcodec_free_context(&codec);
+            break;
+        }
+
+        m_codec = codec;
+        m_timebase = stream->time_base;
+        m_packet = av_packet_alloc();
+        m_path = path;
+        return true;
+    } while (false);
+
+    avformat_close_input(&m_format);
+    m_streamIndex = -1;
+    return false;
+}
+
+void FrameStepper::close()
+{
+    clearCache();
+    av_packet_free(&m_packet);
+    avcodec_free_context(&m_codec);
+    avformat_close_input(&m_format);
+    m_streamIndex = -1;
+    m_path.clear();
+}
+
+AVFrame *FrameStepper::seek(double position)
+{
+    if (!isOpen() || std::isnan(position))
+        return nullptr;
+
+    const int64_t target = std::llround(position / av_q2d(m_timebase));
+
+    // 目标落在某一帧与其相邻的后一帧之间时直接命中缓存
+    auto it = m_cache.upper_bound(target);
+    if (it != m_cache.begin() && it != m_cache.end() && it->second.linked) {
+        m_current = std::prev(it)->first;
+        return std::prev(it)->second.frame;
+    }
+
+    // 解码到目标之后的第一帧，目标时刻显示的是它之前的那一帧
+    m_current = AV_NOPTS_VALUE;
+    decodeFrom(target, target + 1);
+    it = m_cache.upper_bound(target);
+    if (it != m_cache.begin())
+        --it;
+    if (it == m_cache.end())
+        return nullptr;
+    m_current = it->first;
+    return it->second.frame;
+}
+
+AVFrame *FrameStepper::stepForward()
+{
+    auto it = m_cache.find(m_current);
+    if (it == m_cache.end())
+        return nullptr;
+
+    auto next = std::next(it);
+    if (next == m_cache.end() || !next->second.linked) {
+        // 解码器正停在当前帧之后时接着解码，否则从当前帧所在的GOP重新解码
+        if (m_lastDecoded == m_current)
+            decodeNext();
+        else
+            decodeFrom(m_current, m_current + 1);
+
+        it = m_cache.find(m_current);
+        if (it == m_cache.end())
+            return nullptr;
+        next = std::next(it);
+        if (next == m_cache.end() || !next->second.linked)
+            return nullptr;
+    }
+
+    m_current = next->first;
+    return next->second.frame;
+}
+
+AVFrame *FrameStepper::stepBackward()
+{
+    auto it = m_cache.find(m_current);
+    if (it == m_cache.end())
+        return nullptr;
+
+    if (it == m_cache.begin() || !it->second.linked) {
+        // 从当前帧之前的关键帧起把GOP解码到当前帧，当前帧是关键帧时即为上一个GOP
+        decodeFrom(m_current - 1, m_current);
+
+        it = m_cache.find(m_current);
+        if (it == m_cache.end() || it == m_cache.begin() || !it->second.linked)
+            return nullptr;
+    }
+
+    auto prev = std::prev(it);
+    m_current = prev->first;
+    return prev->second.frame;
+}
+
+double FrameStepper::currentTime() const
+{
+    return SyncData::toSeconds(m_current, m_timebase);
+}
+
+void FrameStepper::clearCache()
+{
+    for (auto &entry : m_cache)
+        releaseFrame(entry.second.frame);
+    m_cache.clear();
+    m_cachedBytes = 0;
+    m_current = AV_NOPTS_VALUE;
+    m_lastDecoded = AV_NOPTS_VALUE;
+}
+
+bool FrameStepper::decodeFrom(int64_t seekTs, int64_t stopPts)
+{
+    // 目标之前没有关键帧（如第一帧之前）时退而定位到之后最近的关键帧
+    if (avformat_seek_file(m_format, m_streamIndex, INT64_MIN, seekTs, seekTs, 0) < 0
+        && avformat_seek_file(m_format, m_streamIndex, INT64_MIN, seekTs, INT64_MAX, 0) < 0)
+        return false;
+    avcodec_flush_buffers(m_codec);
+    m_lastDecoded = AV_NOPTS_VALUE;
+    m_flushed = false;
+
+    for (;;) {
+        const int64_t pts = decodeNext();
+        if (pts == AV_NOPTS_VALUE)
+            return false;
+        if (pts >= stopPts)
+            return true;
+    }
+}
+
+int64_t FrameStepper::decodeNext()
+{
+    AVFrame *frame = acquireFrame();
+    for (;;) {
+        const int ret = avcodec_receive_frame(m_codec, frame);
+        if (ret >= 0) {
+            if (frame->pts == AV_NOPTS_VALUE)
+                frame->pts = frame->best_effort_timestamp;
+            if (frame->pts == AV_NOPTS_VALUE) {
+                av_frame_unref(frame);
+                continue;
+            }
+            const int64_t pts = frame->pts;
+            insert(frame);
+            return pts;
+        }
+        if (ret != AVERROR(EAGAIN) || m_flushed)
+            break;
+
+        // 解码器需要更多数据：读取下一个视频包，读完后送入结束标记取出剩余的帧
+        int readRet;
+        while ((readRet = av_read_frame(m_format, m_packet)) >= 0 && m_packet->stream_index != m_streamIndex)
+            av_packet_unref(m_packet);
+        if (readRet < 0) {
+            avcodec_send_packet(m_codec, nullptr);
+            m_flushed = true;
+        } else {
+            avcodec_send_packet(m_codec, m_packet);
+            av_packet_unref(m_packet);
+        }
+    }
+
+    releaseFrame(frame);
+    return AV_NOPTS_VALUE;
+}
+
+void FrameStepper::insert(AVFrame *frame)
+{
+    const int64_t pts = frame->pts;
+    auto          it = m_cache.find(pts);
+    if (it != m_cache.end()) {
+        // 重新解码出已缓存的帧，保留旧的
+        releaseFrame(frame);
+    } else {
+        it = m_cache.emplace(pts, CachedFrame{frame, false}).first;
+        m_cachedBytes += frameBytes(frame);
+        // 插在两帧之间后，后一帧的前驱已经变了
+        auto next = std::next(it);
+        if (next != m_cache.end())
+            next->second.linked = false;
+    }
+
+    if (m_lastDecoded != AV_NOPTS_VALUE && it != m_cache.begin() && std::prev(it)->first == m_lastDecoded)
+        it->second.linked = true;
+    m_lastDecoded = pts;
+
+    evict();
+}
+
+void FrameStepper::evict()
+{
+    const int64_t center = m_current != AV_NOPTS_VALUE ? m_current : m_lastDecoded;
+    while (m_cachedBytes > m_budget && m_cache.size() > 2) {
+        // 离中心最远的帧总在两端之一；当前帧与解码器最近输出的帧不淘汰
+        auto first = m_cache.begin();
+        auto last = std::prev(m_cache.end());
+        auto victim = center - first->first >= last->first - center ? first : last;
+        if (victim->first == m_current || victim->first == m_lastDecoded)
+            victim = victim == first ? last : first;
+        if (victim->first == m_current || victim->first == m_lastDecoded)
+            break;
+        erase(victim);
+    }
+}
+
+void FrameStepper::erase(Cache::iterator it)
+{
+    auto next = std::next(it);
+    if (next != m_cache.end())
+        next->second.linked = false;
+    m_cachedBytes -= frameBytes(it->second.frame);
+    releaseFrame(it->second.frame);
+    m_cache.erase(it);
+}
+
+AVFrame *FrameStepper::acquireFrame()
+{
+    if (m_framePool.empty())
+        return av_frame_alloc();
+    AVFrame *frame = m_framePool.back();
+    m_framePool.pop_back();
+    return frame;
+}
+
+void FrameStepper::releaseFrame(AVFrame *frame)
+{
+    if (m_framePool.size() >= kMaxPooledFrames) {
+        av_frame_free(&frame);
+        return;
+    }
+    av_frame_unref(frame);
+    m_framePool.push_back(frame);
+}
+
+size_t FrameStepper::frameBytes(const AVFrame *frame)
+{
+    size_t bytes = 0;
+    for (int i = 0; i < AV_NUM_DATA_POINTERS && frame->buf[i]; ++i)
+        bytes += frame->buf[i]->size;
+    return bytes;
+}
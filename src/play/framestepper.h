@@ -0,0 +1,100 @@
+#ifndef FRAMESTEPPER_H
+#define FRAMESTEPPER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <QString>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @brief 逐帧步进 - 暂停时按帧前进/后退
+ *
+ * 使用独立于播放管线的解复用与解码上下文，步进不会打乱管线中排队的包和帧。
+ * 解码出的帧按 pts 放入帧缓存，每帧记录它与前一缓存帧是否为解码顺序上相邻的两帧：
+ * - 前进：下一帧已缓存且相邻时直接取出，否则从当前位置继续解码一帧；
+ * - 后退：上一帧已缓存且相邻时直接取出，否则定位到当前帧之前的关键帧，把整个GOP解码到当前帧并全部缓存，
+ *   之后在该GOP内连续后退都直接命中缓存。
+ * 缓存只持有解码器输出缓冲的引用（不复制像素），按缓冲字节数计入内存预算，超出时淘汰离当前帧最远的帧；
+ * 帧结构体回收到空闲列表中复用，缓冲引用释放后回到解码器的缓冲池。
+ * 所有接口都在调用线程中同步执行，不是线程安全的。
+ */
+class FrameStepper
+{
+public:
+    static constexpr size_t kDefaultBudget = 256 * 1024 * 1024;
+
+    explicit FrameStepper(size_t memoryBudget = kDefaultBudget);
+    ~FrameStepper();
+
+    FrameStepper(const FrameStepper &) = delete;
+    FrameStepper &operator=(const FrameStepper &) = delete;
+
+    // 打开媒体中的视频流，已打开同一文件时直接返回
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_codec != nullptr; }
+
+    // 定位到 position（秒）时刻显示的帧，作为步进的起点
+    AVFrame *seek(double position);
+
+    // 前进/后退一帧，已到首尾或解码失败时返回nullptr并保持当前帧不变；返回的帧归缓存所有
+    AVFrame *stepForward();
+    AVFrame *stepBackward();
+
+    // 当前帧的时间（秒），没有当前帧时为NAN
+    double currentTime() const;
+
+    // 清空帧缓存（保留打开的文件），恢复播放后不再需要缓存时调用
+    void clearCache();
+
+    size_t cachedBytes() const { return m_cachedBytes; }
+    size_t cachedFrames() const { return m_cache.size(); }
+
+private:
+    struct CachedFrame
+    {
+        AVFrame *frame{nullptr};
+        bool     linked{false}; // 与缓存中的前一帧在解码顺序上相邻
+    };
+    using Cache = std::map<int64_t, CachedFrame>;
+
+    // 定位到 seekTs 之前（含）的关键帧，顺序解码直到输出 pts >= stopPts 的帧或文件结束
+    bool decodeFrom(int64_t seekTs, int64_t stopPts);
+
+    // 从解码器当前位置顺序解码出下一帧并放入缓存，返回该帧的 pts；文件结束或出错时返回 AV_NOPTS_VALUE
+    int64_t decodeNext();
+
+    void insert(AVFrame *frame);
+    void evict();
+    void erase(Cache::iterator it);
+
+    AVFrame *acquireFrame();
+    void     releaseFrame(AVFrame *frame);
+
+    static size_t frameBytes(const AVFrame *frame);
+
+private:
+    QString          m_path;
+    AVFormatContext *m_format{nullptr};
+    AVCodecContext  *m_codec{nullptr};
+    AVPacket        *m_packet{nullptr};
+    int              m_streamIndex{-1};
+    AVRational       m_timebase{0, 1};
+
+    Cache                  m_cache;
+    std::vector<AVFrame *> m_framePool; // 空闲的帧结构体
+    size_t                 m_budget;
+    size_t                 m_cachedBytes{0};
+
+    int64_t m_current{AV_NOPTS_VALUE};     // 当前帧的 pts
+    int64_t m_lastDecoded{AV_NOPTS_VALUE}; // 解码器最近输出的帧，定位后重置
+    bool    m_flushed{false};              // 已向解码器送入结束标记
+};
+
+#endif // FRAMESTEPPER_H
@@ -0,0 +1,228 @@
+#include "loudnessmeter.h"
+
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+}
+
+static constexpr double kPi = 3.14159265358979323846;
+// 子块长度（秒），门限块为4个子块，短时响度为30个子块
+static constexpr double kSubBlockSec = 0.1;
+static constexpr int    kBlockSubBlocks = 4;
+static constexpr int    kShortTermSubBlocks = 30;
+// 门限（LU）
+static constexpr double kRelativeGateLu = -10.0;
+static constexpr double kRangeGateLu = -20.0;
+// 真峰值插值滤波器每相抽头数
+static constexpr int kTruePeakTaps = 12;
+
+namespace {
+
+double energyToLufs(double energy)
+{
+    return energy > 0.0 ? -0.691 + 10.0 * std::log10(energy) : -HUGE_VAL;
+}
+
+double lufsToEnergy(double lufs)
+{
+    return std::pow(10.0, (lufs + 0.691) / 10.0);
+}
+
+// 门限以上能量的均值，没有块时返回0
+double gatedMean(const std::vector<double> &energies, double threshold)
+{
+    double sum = 0.0;
+    size_t count = 0;
+    for (double energy : energies) {
+        if (energy > threshold) {
+            sum += energy;
+            ++count;
+        }
+    }
+    return count > 0 ? sum / count : 0.0;
+}
+
+} // namespace
+
+LoudnessMeter::LoudnessMeter(int sampleRate, int channels, uint64_t channelLayout)
+    : m_channels(std::max(1, channels))
+    , m_subBlockFrames(std::max(1, int(std::lround(sampleRate * kSubBlockSec))))
+    , m_weights(m_channels, 1.0)
+    , m_filterState(size_t(m_channels) * 4, 0.0)
+    , m_recentSubBlocks(kShortTermSubBlocks, 0.0)
+{
+    const double fs = std::max(1, sampleRate);
+
+    // K计权系数按 BS.1770 的模拟原型对任意采样率做双线性变换
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(kPi * f0 / fs);
+        const double vh = std::pow(10.0, gainDb / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        m_shelf.b0 = (vh + vb * k / q + k * k) / a0;
+        m_shelf.b1 = 2.0 * (k * k - vh) / a0;
+        m_shelf.b2 = (vh - vb * k / q + k * k) / a0;
+        m_shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+        m_shelf.a2 = (1.0 - k / q + k * k) / a0;
+    }
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(kPi * f0 / fs);
+        const double a0 = 1.0 + k / q + k * k;
+        m_highPass.b0 = 1.0;
+        m_highPass.b1 = -2.0;
+        m_highPass.b2 = 1.0;
+        m_highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+        m_highPass.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    // 声道权重：环绕声道 1.41，LFE 不计入
+    uint64_t layout = channelLayout;
+    if (layout == 0 || av_get_channel_layout_nb_channels(layout) != m_channels)
+        layout = uint64_t(av_get_default_channel_layout(m_channels));
+    for (int ch = 0; ch < m_channels; ++ch) {
+        const uint64_t channel = layout ? av_channel_layout_extract_channel(layout, ch) : 0;
+        if (channel == AV_CH_LOW_FREQUENCY || channel == AV_CH_LOW_FREQUENCY_2)
+            m_weights[ch] = 0.0;
+        else if (channel & (AV_CH_BACK_LEFT | AV_CH_BACK_RIGHT | AV_CH_SIDE_LEFT | AV_CH_SIDE_RIGHT))
+            m_weights[ch] = 1.41;
+    }
+
+    // 真峰值：窗函数加权的sinc插值，各相系数归一化为直流增益1
+    m_oversample = sampleRate < 96000 ? 4 : (sampleRate < 192000 ? 2 : 1);
+    if (m_oversample > 1) {
+        m_tapsPerPhase = kTruePeakTaps;
+        const int length = m_oversample * m_tapsPerPhase;
+        m_interpolator.resize(length);
+        for (int p = 0; p < m_oversample; ++p) {
+            double sum = 0.0;
+            for (int k = 0; k < m_tapsPerPhase; ++k) {
+                const int    n = p + m_oversample * k;
+                const double t = (n - (length - 1) / 2.0) / m_oversample;
+                const double sinc = std::fabs(t) < 1e-9 ? 1.0 : std::sin(kPi * t) / (kPi * t);
+                const double window = 0.5 - 0.5 * std::cos(2.0 * kPi * (n + 0.5) / length);
+                m_interpolator[p * m_tapsPerPhase + k] = float(sinc * window);
+                sum += sinc * window;
+            }
+            for (int k = 0; k < m_tapsPerPhase; ++k)
+                m_interpolator[p * m_tapsPerPhase + k] = float(m_interpolator[p * m_tapsPerPhase + k] / sum);
+        }
+    }
+    m_peakHistory.assign(size_t(m_channels) * m_tapsPerPhase * 2, 0.0f);
+    m_peakPos.assign(m_channels, 0);
+}
+
+void LoudnessMeter::addFrames(const float *const *planes, int frames)
+{
+    for (int f = 0; f < frames; ++f) {
+        for (int ch = 0; ch < m_channels; ++ch) {
+            const float x = planes[ch][f];
+            updateTruePeak(ch, x);
+            if (m_weights[ch] == 0.0)
+                continue;
+
+            // 两级直接II型转置
+            double *s = &m_filterState[size_t(ch) * 4];
+            const double y1 = m_shelf.b0 * x + s[0];
+            s[0] = m_shelf.b1 * x - m_shelf.a1 * y1 + s[1];
+            s[1] = m_shelf.b2 * x - m_shelf.a2 * y1;
+            const double y2 = m_highPass.b0 * y1 + s[2];
+            s[2] = m_highPass.b1 * y1 - m_highPass.a1 * y2 + s[3];
+            s[3] = m_highPass.b2 * y1 - m_highPass.a2 * y2;
+
+            m_subBlockEnergy += m_weights[ch] * y2 * y2;
+        }
+        if (++m_subBlockFill == m_subBlockFrames)
+            finishSubBlock();
+    }
+}
+
+void LoudnessMeter::finishSubBlock()
+{
+    m_recentSubBlocks[m_subBlockCount % kShortTermSubBlocks] = m_subBlockEnergy / m_subBlockFrames;
+    ++m_subBlockCount;
+    m_subBlockEnergy = 0.0;
+    m_subBlockFill = 0;
+
+    // 最近 n 个子块的平均能量
+    auto recentMean = [this](int n) {
+        double sum = 0.0;
+        for (int i = 1; i <= n; ++i)
+            sum += m_recentSubBlocks[(m_subBlockCount - i) % kShortTermSubBlocks];
+        return sum / n;
+    };
+    if (m_subBlockCount >= kBlockSubBlocks)
+        m_blockEnergies.push_back(recentMean(kBlockSubBlocks));
+    if (m_subBlockCount >= kShortTermSubBlocks)
+        m_shortTermEnergies.push_back(recentMean(kShortTermSubBlocks));
+}
+
+void LoudnessMeter::updateTruePeak(int channel, float sample)
+{
+    double peak = std::fabs(sample);
+    if (m_oversample > 1) {
+        // 历史存两份，最近 m_tapsPerPhase 个样本总是连续的一段
+        const int taps = m_tapsPerPhase;
+        float    *history = &m_peakHistory[size_t(channel) * taps * 2];
+        int      &pos = m_peakPos[channel];
+        history[pos] = sample;
+        history[pos + taps] = sample;
+        const float *newest = history + pos + taps; // newest[-k] 为 k 个样本之前
+        for (int p = 0; p < m_oversample; ++p) {
+            const float *h = &m_interpolator[p * taps];
+            float        acc = 0.0f;
+            for (int k = 0; k < taps; ++k)
+                acc += h[k] * newest[-k];
+            peak = std::max(peak, double(std::fabs(acc)));
+        }
+        pos = (pos + 1) % taps;
+    }
+    m_truePeak = std::max(m_truePeak, peak);
+}
+
+double LoudnessMeter::integratedLoudness() const
+{
+    const double absolute = lufsToEnergy(kSilenceLufs);
+    const double ungated = gatedMean(m_blockEnergies, absolute);
+    if (ungated <= 0.0)
+        return kSilenceLufs;
+
+    const double relative = std::max(absolute, lufsToEnergy(energyToLufs(ungated) + kRelativeGateLu));
+    const double gated = gatedMean(m_blockEnergies, relative);
+    return gated > 0.0 ? energyToLufs(gated) : kSilenceLufs;
+}
+
+double LoudnessMeter::loudnessRange() const
+{
+    const double absolute = lufsToEnergy(kSilenceLufs);
+    const double ungated = gatedMean(m_shortTermEnergies, absolute);
+    if (ungated <= 0.0)
+        return 0.0;
+
+    const double        relative = std::max(absolute, lufsToEnergy(energyToLufs(ungated) + kRangeGateLu));
+    std::vector<double> gated;
+    for (double energy : m_shortTermEnergies) {
+        if (energy > relative)
+            gated.push_back(energy);
+    }
+    if (gated.empty())
+        return 0.0;
+
+    // 能量与响度单调对应，直接对能量排序取分位
+    std::sort(gated.begin(), gated.end());
+    const size_t last = gated.size() - 1;
+    const double low = gated[size_t(std::lround(last * 0.10))];
+    const double high = gated[size_t(std::lround(last * 0.95))];
+    return energyToLufs(high) - energyToLufs(low);
+}
+
+double LoudnessMeter::truePeakDb() const
+{
+    return m_truePeak > 0.0 ? 20.0 * std::log10(m_truePeak) : -HUGE_VAL;
+}
@@ -0,0 +1,65 @@
+#ifndef LOUDNESSMETER_H
+#define LOUDNESSMETER_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 响度测量 - ITU-R BS.1770-4 / EBU R128
+ *
+ * 各声道经K计权（高架 + 高通两级双二阶滤波），按声道权重求和后以100ms为子块累积能量：
+ * - 综合响度：400ms块（75%重叠），先按 -70 LUFS 绝对门限、再按低于均值 10 LU 的相对门限选块；
+ * - 响度范围（LRA，EBU Tech 3342）：3s短时响度，-70 LUFS 绝对门限与 -20 LU 相对门限后取 10% ~ 95% 分位差；
+ * - 真峰值：采样率低于96kHz时做4倍（低于192kHz时2倍）多相插值过采样后取绝对值最大值。
+ * 输入为平面浮点样本，逐块调用 addFrames，全部送完后读取结果。
+ */
+class LoudnessMeter
+{
+public:
+    static constexpr double kSilenceLufs = -70.0;
+
+    // channelLayout 为 FFmpeg 声道布局掩码，用于识别环绕声道（权重1.41）与LFE（不计入）；为0时按声道数推断
+    LoudnessMeter(int sampleRate, int channels, uint64_t channelLayout);
+
+    void addFrames(const float *const *planes, int frames);
+
+    // 没有超过绝对门限的块（静音或过短）时返回 kSilenceLufs
+    double integratedLoudness() const;
+    double loudnessRange() const;
+    double truePeak() const { return m_truePeak; } // 线性值，1.0 为满幅
+    double truePeakDb() const;
+
+private:
+    struct Biquad
+    {
+        double b0{1}, b1{0}, b2{0}, a1{0}, a2{0};
+    };
+
+    void finishSubBlock();
+    void updateTruePeak(int channel, float sample);
+
+    int    m_channels;
+    int    m_subBlockFrames; // 100ms
+    Biquad m_shelf;
+    Biquad m_highPass;
+
+    std::vector<double> m_weights;     // 各声道权重
+    std::vector<double> m_filterState; // 每声道两级滤波的 4 个状态（直接II型转置）
+
+    double              m_subBlockEnergy{0.0}; // 当前子块的加权平方和
+    int                 m_subBlockFill{0};
+    std::vector<double> m_recentSubBlocks; // 最近30个子块能量（环形），覆盖3s
+    int                 m_subBlockCount{0};
+    std::vector<double> m_blockEnergies;     // 400ms 块的均方值
+    std::vector<double> m_shortTermEnergies; // 3s 短时均方值
+
+    // 真峰值过采样
+    int                m_oversample{1};
+    int                m_tapsPerPhase{1};
+    std::vector<float> m_interpolator; // 多相系数，按 相位 * 每相抽头数 排列
+    std::vector<float> m_peakHistory;  // 每声道最近 m_tapsPerPhase 个样本，存两份以免取模
+    std::vector<int>   m_peakPos;
+    double             m_truePeak{0.0};
+};
+
+#endif // LOUDNESSMETER_H
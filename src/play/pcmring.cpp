@@ -0,0 +1,112 @@
+#include "pcmring.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void PcmRing::reset(int sampleRate, int channels, int capacityFrames)
+{
+    int capacity = 1;
+    while (capacity < capacityFrames)
+        capacity <<= 1;
+
+    m_capacity = capacity;
+    m_sampleRate = sampleRate;
+    m_channels = channels;
+    // 环中最多容纳 kMarks / 2 个标记，其余余量留给消费者正在查找的旧标记
+    m_markSpacing = std::max(1, capacity / (kMarks / 2));
+    m_buffer.assign(size_t(capacity) * std::max(channels, 1), 0.0f);
+    m_markCount.store(0, std::memory_order_relaxed);
+    m_lastMarkFrame = 0;
+    m_forceMark = true;
+    m_write.store(0, std::memory_order_relaxed);
+    m_read.store(0, std::memory_order_relaxed);
+    m_discardUntil.store(0, std::memory_order_relaxed);
+}
+
+int PcmRing::writableFrames() const
+{
+    const uint64_t write = m_write.load(std::memory_order_relaxed);
+    const uint64_t read = m_read.load(std::memory_order_acquire);
+    return m_capacity - int(write - read);
+}
+
+void PcmRing::write(const float *samples, int frames, double pts)
+{
+    if (frames <= 0 || m_channels <= 0)
+        return;
+    const uint64_t write = m_write.load(std::memory_order_relaxed);
+    frames = std::min(frames, writableFrames());
+
+    const uint64_t markCount = m_markCount.load(std::memory_order_relaxed);
+    if (!std::isnan(pts) && (m_forceMark || write - m_lastMarkFrame >= uint64_t(m_markSpacing))) {
+        m_marks[markCount % kMarks] = Mark{write, pts};
+        m_markCount.store(markCount + 1, std::memory_order_release);
+        m_lastMarkFrame = write;
+        m_forceMark = false;
+    }
+
+    const int first = std::min(frames, m_capacity - int(write & (m_capacity - 1)));
+    const int offset = int(write & (m_capacity - 1)) * m_channels;
+    memcpy(m_buffer.data() + offset, samples, size_t(first) * m_channels * sizeof(float));
+    if (frames > first)
+        memcpy(m_buffer.data(), samples + first * m_channels, size_t(frames - first) * m_channels * sizeof(float));
+
+    m_write.store(write + frames, std::memory_order_release);
+}
+
+void PcmRing::discardPending()
+{
+    m_discardUntil.store(m_write.load(std::memory_order_relaxed), std::memory_order_release);
+    // 跳转后的第一段数据必须带标记，否则会沿用跳转前的时间
+    m_forceMark = true;
+}
+
+int PcmRing::read(float *samples, int frames, double &clock)
+{
+    clock = NAN;
+    if (m_channels <= 0)
+        return 0;
+
+    uint64_t       read = m_read.load(std::memory_order_relaxed);
+    const uint64_t discard = m_discardUntil.load(std::memory_order_acquire);
+    if (read < discard)
+        read = discard;
+    const uint64_t write = m_write.load(std::memory_order_acquire);
+    frames = int(std::min<uint64_t>(uint64_t(frames), write - read));
+    if (frames <= 0) {
+        m_read.store(read, std::memory_order_release);
+        return 0;
+    }
+
+    const int first = std::min(frames, m_capacity - int(read & (m_capacity - 1)));
+    const int offset = int(read & (m_capacity - 1)) * m_channels;
+    memcpy(samples, m_buffer.data() + offset, size_t(first) * m_channels * sizeof(float));
+    if (frames > first)
+        memcpy(samples + first * m_channels, m_buffer.data(), size_t(frames - first) * m_channels * sizeof(float));
+
+    clock = clockAt(read);
+    m_read.store(read + frames, std::memory_order_release);
+    return frames;
+}
+
+int PcmRing::bufferedFrames() const
+{
+    const uint64_t write = m_write.load(std::memory_order_acquire);
+    const uint64_t read = std::max(m_read.load(std::memory_order_relaxed),
+                                   m_discardUntil.load(std::memory_order_relaxed));
+    return read < write ? int(write - read) : 0;
+}
+
+double PcmRing::clockAt(uint64_t frame) const
+{
+    // 从最新的标记向前找第一个不晚于 frame 的标记
+    const uint64_t count = m_markCount.load(std::memory_order_acquire);
+    const uint64_t oldest = count > uint64_t(kMarks) ? count - kMarks : 0;
+    for (uint64_t i = count; i > oldest; --i) {
+        const Mark &mark = m_marks[(i - 1) % kMarks];
+        if (mark.frame <= frame)
+            return mark.pts + double(frame - mark.frame) / m_sampleRate;
+    }
+    return NAN;
+}
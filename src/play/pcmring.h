@@ -0,0 +1,62 @@
+#ifndef PCMRING_H
+#define PCMRING_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief PCM环形缓冲 - 音频生产线程与SDL音频回调之间的单生产者单消费者无锁队列
+ *
+ * 存放已经过DSP链处理的交错浮点样本（满幅为±1.0），音量、限制器与到S16的转换在消费者一端进行。读写位置为单调递增的64位帧计数，
+ * 生产者每写入一段数据可附带该段首帧的pts（时间标记），消费者据此换算出当前读到位置的播放时间。
+ * 回调中只有 memcpy 与原子读写，不加锁、不分配内存。
+ */
+class PcmRing
+{
+public:
+    // 非并发调用：打开音频设备时、两端都未运行时
+    void reset(int sampleRate, int channels, int capacityFrames);
+
+    int sampleRate() const { return m_sampleRate; }
+    int channels() const { return m_channels; }
+
+    // 生产者
+    int  writableFrames() const;
+    void write(const float *samples, int frames, double pts); // pts 为首帧时间（秒），未知时传NAN
+    void discardPending(); // 跳转后丢弃已写入尚未播放的数据
+
+    // 消费者：读出至多 frames 帧，返回实际帧数；clock 返回首个读出样本的播放时间，未知时为NAN
+    int read(float *samples, int frames, double &clock);
+
+    int bufferedFrames() const;
+
+private:
+    static constexpr int kMarks = 256;
+
+    struct Mark
+    {
+        uint64_t frame{0};
+        double   pts{0.0};
+    };
+
+    double clockAt(uint64_t frame) const;
+
+    std::vector<float> m_buffer;
+    int                m_capacity{0}; // 帧数，2的幂
+    int                m_sampleRate{0};
+    int                m_channels{0};
+    int                m_markSpacing{1}; // 两个时间标记之间至少间隔的帧数，保证标记环不会被追尾
+
+    std::array<Mark, kMarks> m_marks{};
+    std::atomic<uint64_t>    m_markCount{0};
+    uint64_t                 m_lastMarkFrame{0}; // 以下两项仅生产者访问
+    bool                     m_forceMark{true};
+
+    alignas(64) std::atomic<uint64_t> m_write{0};
+    alignas(64) std::atomic<uint64_t> m_read{0};
+    std::atomic<uint64_t>             m_discardUntil{0};
+};
+
+#endif // PCMRING_H
@@ -0,0 +1,174 @@
+#include "playlog.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <QDebug>
+
+namespace PlayLog {
+
+namespace {
+
+struct Record
+{
+    Level    level;
+    uint32_t suppressed;
+    char     text[kMaxMessageLength];
+};
+
+/**
+ * @brief ThreadRing - 单生产者单消费者环形缓冲区
+ *
+ * 生产者为所属线程，消费者为后台输出线程（或 flush 的调用者，由 Writer 的互斥量串行化）。
+ */
+struct ThreadRing
+{
+    std::atomic<uint64_t>     head{0}; // 生产者写入位置
+    std::atomic<uint64_t>     tail{0}; // 消费者读取位置
+    std::atomic<uint32_t>     dropped{0};
+    std::unique_ptr<Record[]> records{new Record[kRecordsPerThread]};
+};
+
+/**
+ * @brief Writer - 持有所有线程缓冲区并运行后台输出线程
+ */
+class Writer
+{
+public:
+    Writer()
+        : m_thread([this]() { run(); })
+    {}
+
+    ~Writer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+        drain();
+    }
+
+    ThreadRing *registerThread()
+    {
+        std::lock_guard<std::mutex> lock(m_ringsMutex);
+        m_rings.push_back(std::make_unique<ThreadRing>());
+        return m_rings.back().get();
+    }
+
+    // 取出所有缓冲区的日志并交给Qt输出
+    void drain()
+    {
+        std::lock_guard<std::mutex> lock(m_ringsMutex);
+        for (const auto &ring : m_rings) {
+            const uint32_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0)
+                qWarning().noquote() << QString("日志缓冲区已满，丢弃 %1 条").arg(dropped);
+
+            const uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t       tail = ring->tail.load(std::memory_order_relaxed);
+            for (; tail < head; ++tail) {
+                const Record &record = ring->records[tail % kRecordsPerThread];
+                emitRecord(record);
+            }
+            ring->tail.store(tail, std::memory_order_release);
+        }
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_stateMutex);
+        while (!m_stop) {
+            m_wake.wait_for(lock, std::chrono::milliseconds(20));
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
+
+    static void emitRecord(const Record &record)
+    {
+        QString text = QString::fromUtf8(record.text);
+        if (record.suppressed > 0)
+            text += QString(" (已限流 %1 条)").arg(record.suppressed);
+
+        switch (record.level) {
+        case Level::Debug:
+            qDebug().noquote() << text;
+            break;
+        case Level::Info:
+            qInfo().noquote() << text;
+            break;
+        case Level::Warning:
+            qWarning().noquote() << text;
+            break;
+        case Level::Error:
+            qCritical().noquote() << text;
+            break;
+        }
+    }
+
+private:
+    std::mutex                               m_ringsMutex;
+    std::vector<std::unique_ptr<ThreadRing>> m_rings;
+
+    std::mutex              m_stateMutex;
+    std::condition_variable m_wake;
+    bool                    m_stop{false};
+    std::thread             m_thread; // 最后构造，保证线程启动时其余成员已就绪
+};
+
+Writer &writer()
+{
+    static Writer instance;
+    return instance;
+}
+
+thread_local ThreadRing *t_ring = nullptr;
+
+} // namespace
+
+void write(Level level, uint32_t suppressed, const char *fmt, ...)
+{
+    // 每个线程首次写日志时登记一次缓冲区，之后的写入不加锁
+    if (!t_ring)
+        t_ring = writer().registerThread();
+
+    ThreadRing    *ring = t_ring;
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= uint64_t(kRecordsPerThread)) {
+        ring->dropped.fetch_add(1 + suppressed, std::memory_order_relaxed);
+        return;
+    }
+
+    Record &record = ring->records[head % kRecordsPerThread];
+    record.level = level;
+    record.suppressed = suppressed;
+
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(record.text, sizeof(record.text), fmt, args);
+    va_end(args);
+
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void flush()
+{
+    writer().drain();
+}
+
+int64_t nowUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace PlayLog
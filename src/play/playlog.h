@@ -0,0 +1,102 @@
+#ifndef PLAYLOG_H
+#define PLAYLOG_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief 播放线程日志 - 异步、限流，供热路径使用
+ *
+ * 调用线程只把格式化后的文本写入自己的无锁环形缓冲区（不分配内存、不加锁、不阻塞），
+ * 缓冲区满时丢弃并计数；后台线程定期取出，转交 Qt 的日志处理（qDebug/qInfo/qWarning）。
+ * 低于 QWAVEBOX_LOG_MIN_LEVEL 的日志在编译期移除；每个调用点单独限流。
+ */
+namespace PlayLog {
+
+enum class Level { Debug = 0, Info, Warning, Error };
+
+// 单条日志的最大长度（含结尾0），超出部分截断
+constexpr int kMaxMessageLength = 240;
+
+// 每个线程缓冲区可容纳的日志条数
+constexpr int kRecordsPerThread = 512;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PLAY_LOG_PRINTF_FORMAT(fmtIndex, argIndex) __attribute__((format(printf, fmtIndex, argIndex)))
+#else
+#define PLAY_LOG_PRINTF_FORMAT(fmtIndex, argIndex)
+#endif
+
+// 写入当前线程的缓冲区，suppressed 为该调用点上次输出后被限流丢弃的条数
+void write(Level level, uint32_t suppressed, const char *fmt, ...) PLAY_LOG_PRINTF_FORMAT(3, 4);
+
+// 同步取出所有缓冲区中的日志（退出前或需要立即看到日志时调用）
+void flush();
+
+// 单调时钟，微秒
+int64_t nowUs();
+
+/**
+ * @brief RateLimiter - 调用点限流：每个时间窗口最多放行 burst 条
+ *
+ * 可常量初始化，作为函数内静态变量时没有线程安全初始化的开销。
+ */
+class RateLimiter
+{
+public:
+    constexpr RateLimiter(int burst = 5, int64_t intervalUs = 1000000)
+        : m_burst(burst)
+        , m_intervalUs(intervalUs)
+    {}
+
+    bool allow(uint32_t &suppressed)
+    {
+        const int64_t now = nowUs();
+        int64_t       windowStart = m_windowStart.load(std::memory_order_relaxed);
+        if (now - windowStart >= m_intervalUs
+            && m_windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed)) {
+            m_count.store(0, std::memory_order_relaxed);
+        }
+
+        if (m_count.fetch_add(1, std::memory_order_relaxed) < m_burst) {
+            suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        m_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+private:
+    const int             m_burst;
+    const int64_t         m_intervalUs;
+    std::atomic<int64_t>  m_windowStart{INT64_MIN / 2};
+    std::atomic<int>      m_count{0};
+    std::atomic<uint32_t> m_suppressed{0};
+};
+
+} // namespace PlayLog
+
+#ifndef QWAVEBOX_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define QWAVEBOX_LOG_MIN_LEVEL 1 // Release 默认去掉 Debug
+#else
+#define QWAVEBOX_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+#define PLAY_LOG(level, ...) \
+    do { \
+        if constexpr (static_cast<int>(level) >= QWAVEBOX_LOG_MIN_LEVEL) { \
+            static PlayLog::RateLimiter playLogLimiter_; \
+            uint32_t                    playLogSuppressed_ = 0; \
+            if (playLogLimiter_.allow(playLogSuppressed_)) \
+                PlayLog::write(level, playLogSuppressed_, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define PLAY_LOG_DEBUG(...) PLAY_LOG(PlayLog::Level::Debug, __VA_ARGS__)
+#define PLAY_LOG_INFO(...) PLAY_LOG(PlayLog::Level::Info, __VA_ARGS__)
+#define PLAY_LOG_WARNING(...) PLAY_LOG(PlayLog::Level::Warning, __VA_ARGS__)
+#define PLAY_LOG_ERROR(...) PLAY_LOG(PlayLog::Level::Error, __VA_ARGS__)
+
+#endif // PLAYLOG_H
@@ -0,0 +1,211 @@
+#include "playmetrics.h"
+
+#include <algorithm>
+
+namespace PlayMetrics {
+
+namespace {
+
+struct MetricInfo
+{
+    Stage       stage;
+    const char *name;
+};
+
+const char *const kStageNames[] = {"demux", "video_decode", "audio_decode", "video_render", "audio_render", "sync"};
+
+const MetricInfo kCounterInfo[] = {
+    {Stage::Demux, "packets_read"},
+    {Stage::Demux, "bytes_read"},
+    {Stage::VideoDecode, "frames_decoded"},
+    {Stage::AudioDecode, "frames_decoded"},
+    {Stage::VideoRender, "frames_rendered"},
+    {Stage::VideoRender, "frames_dropped"},
+    {Stage::VideoRender, "frames_late"},
+    {Stage::AudioRender, "underruns"},
+};
+
+const MetricInfo kGaugeInfo[] = {
+    {Stage::Demux, "video_packet_queue"},
+    {Stage::Demux, "audio_packet_queue"},
+    {Stage::VideoDecode, "frame_queue"},
+    {Stage::AudioDecode, "frame_queue"},
+    {Stage::Sync, "av_drift_us"},
+};
+
+const MetricInfo kHistogramInfo[] = {
+    {Stage::VideoDecode, "decode_us"},
+    {Stage::AudioDecode, "decode_us"},
+    {Stage::VideoRender, "upload_us"},
+    {Stage::Sync, "abs_drift_us"},
+};
+
+static_assert(sizeof(kStageNames) / sizeof(kStageNames[0]) == size_t(Stage::Count), "stage names out of sync");
+static_assert(sizeof(kCounterInfo) / sizeof(kCounterInfo[0]) == size_t(Counter::Count), "counter table out of sync");
+static_assert(sizeof(kGaugeInfo) / sizeof(kGaugeInfo[0]) == size_t(Gauge::Count), "gauge table out of sync");
+static_assert(sizeof(kHistogramInfo) / sizeof(kHistogramInfo[0]) == size_t(Histogram::Count),
+              "histogram table out of sync");
+
+struct GaugeCell
+{
+    std::atomic<int64_t> value{0};
+    std::atomic<int64_t> max{0};
+};
+
+struct Registry
+{
+    std::array<std::atomic<uint64_t>, size_t(Counter::Count)> counters{};
+    std::array<GaugeCell, size_t(Gauge::Count)>               gauges{};
+    std::array<LatencyHistogram, size_t(Histogram::Count)>    histograms{};
+};
+
+Registry &registry()
+{
+    static Registry reg;
+    return reg;
+}
+
+void atomicMax(std::atomic<int64_t> &target, int64_t value)
+{
+    int64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+int highestBit(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1)
+        ++bit;
+    return bit;
+#endif
+}
+
+} // namespace
+
+int LatencyHistogram::bucketIndex(int64_t value)
+{
+    if (value < kSubBuckets)
+        return int(std::max<int64_t>(value, 0));
+    const int shift = highestBit(uint64_t(value)) - kSubBucketBits;
+    return shift * kSubBuckets + int(value >> shift);
+}
+
+int64_t LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < kSubBuckets)
+        return index;
+    const int     shift = index / kSubBuckets - 1;
+    const int64_t top = index - shift * kSubBuckets;
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(int64_t value)
+{
+    value = std::min(std::max<int64_t>(value, 0), kMaxValue);
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(uint64_t(value), std::memory_order_relaxed);
+    atomicMax(m_max, value);
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::percentile(double p) const
+{
+    // 快照期间仍可能有并发写入，以各桶之和为准
+    uint64_t total = 0;
+    for (const auto &bucket : m_buckets)
+        total += bucket.load(std::memory_order_relaxed);
+    if (total == 0)
+        return 0;
+
+    const uint64_t rank = std::max<uint64_t>(1, uint64_t(p * total + 0.5));
+    uint64_t       seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::min(bucketUpperBound(i), m_max.load(std::memory_order_relaxed));
+    }
+    return m_max.load(std::memory_order_relaxed);
+}
+
+QJsonObject LatencyHistogram::summary() const
+{
+    const uint64_t count = m_count.load(std::memory_order_relaxed);
+    QJsonObject    obj;
+    obj["count"] = qint64(count);
+    obj["mean"] = count ? double(m_sum.load(std::memory_order_relaxed)) / count : 0.0;
+    obj["p50"] = qint64(percentile(0.50));
+    obj["p90"] = qint64(percentile(0.90));
+    obj["p99"] = qint64(percentile(0.99));
+    obj["max"] = qint64(m_max.load(std::memory_order_relaxed));
+    return obj;
+}
+
+void add(Counter counter, uint64_t n)
+{
+    registry().counters[size_t(counter)].fetch_add(n, std::memory_order_relaxed);
+}
+
+void set(Gauge gauge, int64_t value)
+{
+    GaugeCell &cell = registry().gauges[size_t(gauge)];
+    cell.value.store(value, std::memory_order_relaxed);
+    atomicMax(cell.max, value);
+}
+
+void record(Histogram histogram, int64_t valueUs)
+{
+    registry().histograms[size_t(histogram)].record(valueUs);
+}
+
+void reset()
+{
+    Registry &reg = registry();
+    for (auto &counter : reg.counters)
+        counter.store(0, std::memory_order_relaxed);
+    for (auto &cell : reg.gauges) {
+        cell.value.store(0, std::memory_order_relaxed);
+        cell.max.store(0, std::memory_order_relaxed);
+    }
+    for (auto &histogram : reg.histograms)
+        histogram.reset();
+}
+
+QJsonObject snapshot()
+{
+    Registry   &reg = registry();
+    QJsonObject stages[size_t(Stage::Count)];
+
+    for (size_t i = 0; i < size_t(Counter::Count); ++i)
+        stages[size_t(kCounterInfo[i].stage)][kCounterInfo[i].name] = qint64(
+            reg.counters[i].load(std::memory_order_relaxed));
+
+    for (size_t i = 0; i < size_t(Gauge::Count); ++i) {
+        QJsonObject gauge;
+        gauge["current"] = qint64(reg.gauges[i].value.load(std::memory_order_relaxed));
+        gauge["max"] = qint64(reg.gauges[i].max.load(std::memory_order_relaxed));
+        stages[size_t(kGaugeInfo[i].stage)][kGaugeInfo[i].name] = gauge;
+    }
+
+    for (size_t i = 0; i < size_t(Histogram::Count); ++i)
+        stages[size_t(kHistogramInfo[i].stage)][kHistogramInfo[i].name] = reg.histograms[i].summary();
+
+    QJsonObject root;
+    for (size_t i = 0; i < size_t(Stage::Count); ++i)
+        root[kStageNames[i]] = stages[i];
+    return root;
+}
+
+} // namespace PlayMetrics
@@ -0,0 +1,125 @@
+#ifndef PLAYMETRICS_H
+#define PLAYMETRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <QJsonObject>
+
+/**
+ * @brief 播放管线指标 - 按阶段分组的计数器、瞬时值与延迟直方图
+ *
+ * 所有指标在编译期固定，记录路径只有relaxed原子操作，不加锁、不分配内存，可在SDL音频回调中调用。
+ * 界面与无界面工具通过 snapshot() 轮询。
+ */
+namespace PlayMetrics {
+
+// 指标所属的管线阶段
+enum class Stage { Demux, VideoDecode, AudioDecode, VideoRender, AudioRender, Sync, Count };
+
+// 单调递增计数器
+enum class Counter {
+    PacketsRead,
+    BytesRead,
+    VideoFramesDecoded,
+    AudioFramesDecoded,
+    VideoFramesRendered,
+    VideoFramesDropped,
+    VideoFramesLate,
+    AudioUnderruns,
+    Count
+};
+
+// 瞬时值（同时记录历史最大值）
+enum class Gauge {
+    VideoPacketQueueDepth,
+    AudioPacketQueueDepth,
+    VideoFrameQueueDepth,
+    AudioFrameQueueDepth,
+    AvDriftUs,
+    Count
+};
+
+// 延迟分布，单位微秒
+enum class Histogram { VideoDecodeUs, AudioDecodeUs, RenderUploadUs, AvDriftAbsUs, Count };
+
+/**
+ * @brief LatencyHistogram - HDR风格的对数线性直方图
+ *
+ * 每个2的幂区间再等分为16个子桶，相对误差约6%，覆盖 0 ~ 2^40。
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int     kSubBucketBits = 4;
+    static constexpr int     kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int     kMaxBits = 40;
+    static constexpr int     kBucketCount = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+    static constexpr int64_t kMaxValue = (int64_t(1) << kMaxBits) - 1;
+
+    void record(int64_t value);
+    void reset();
+
+    // 汇总为 count/mean/p50/p90/p99/max
+    QJsonObject summary() const;
+
+    // 返回第p分位（0~1）所在桶的上界
+    int64_t percentile(double p) const;
+
+private:
+    static int     bucketIndex(int64_t value);
+    static int64_t bucketUpperBound(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> m_buckets{};
+    std::atomic<uint64_t>                           m_count{0};
+    std::atomic<uint64_t>                           m_sum{0};
+    std::atomic<int64_t>                            m_max{0};
+};
+
+// 计数器加n
+void add(Counter counter, uint64_t n = 1);
+
+// 设置瞬时值
+void set(Gauge gauge, int64_t value);
+
+// 记录一次延迟样本
+void record(Histogram histogram, int64_t valueUs);
+
+// 清零全部指标（打开新媒体时调用）
+void reset();
+
+// 以 {阶段: {指标名: 值}} 的形式导出当前快照
+QJsonObject snapshot();
+
+// 单调时钟，微秒
+inline int64_t nowUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief ScopedTimer - 作用域结束时把耗时记入直方图
+ */
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Histogram histogram)
+        : m_histogram(histogram)
+        , m_start(nowUs())
+    {}
+    ~ScopedTimer() { record(m_histogram, nowUs() - m_start); }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    Histogram m_histogram;
+    int64_t   m_start;
+};
+
+} // namespace PlayMetrics
+
+#endif // PLAYMETRICS_H
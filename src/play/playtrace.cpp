@@ -0,0 +1,231 @@
+#include "playtrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+
+namespace PlayTrace {
+
+std::atomic<bool> g_enabled{false};
+
+struct Event
+{
+    const char *name;
+    int64_t     start;
+    int64_t     duration;
+};
+
+/**
+ * @brief ThreadBuffer - 单个线程的事件环，只由所属线程写入
+ *
+ * 线程退出后缓冲区仍由注册表持有，以便退出时统一导出。
+ */
+struct ThreadBuffer
+{
+    int                     tid{0};
+    const char             *name{nullptr};
+    std::atomic<uint64_t>   head{0};
+    std::unique_ptr<Event[]> events{new Event[kEventsPerThread]};
+};
+
+namespace {
+
+struct Registry
+{
+    QMutex                                     mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    int                                        nextTid{1};
+    QString                                    dumpPath;
+    bool                                       postRoutineAdded{false};
+};
+
+Registry &registry()
+{
+    static Registry reg;
+    return reg;
+}
+
+thread_local ThreadBuffer *t_buffer = nullptr;
+thread_local const char   *t_threadName = nullptr;
+thread_local bool          t_realtime = false; // 实时线程从不分配缓冲区
+
+ThreadBuffer *registerBuffer(const char *name)
+{
+    Registry    &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    auto         buffer = std::make_unique<ThreadBuffer>();
+    buffer->tid = reg.nextTid++;
+    buffer->name = name;
+    ThreadBuffer *raw = buffer.get();
+    reg.buffers.push_back(std::move(buffer));
+    return raw;
+}
+
+// 首次记录事件时才分配缓冲区，未开启追踪的线程不占内存；未预留缓冲区的实时线程返回nullptr
+ThreadBuffer *currentBuffer()
+{
+    if (!t_buffer && !t_realtime)
+        t_buffer = registerBuffer(t_threadName);
+    return t_buffer;
+}
+
+void dumpAtExit()
+{
+    const QString path = dumpPath();
+    if (!path.isEmpty() && !dump(path))
+        qWarning() << "写入追踪文件失败:" << path;
+}
+
+} // namespace
+
+void setEnabled(bool enabled)
+{
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void setThreadName(const char *name)
+{
+    if (t_threadName == name)
+        return;
+    t_threadName = name;
+    if (t_buffer) {
+        QMutexLocker locker(&registry().mutex);
+        t_buffer->name = name;
+    }
+}
+
+ThreadBuffer *reserveThread(const char *name)
+{
+    return isEnabled() ? registerBuffer(name) : nullptr;
+}
+
+void attachRealtimeThread(ThreadBuffer *buffer)
+{
+    t_realtime = true;
+    t_buffer = buffer;
+    t_threadName = buffer ? buffer->name : nullptr;
+}
+
+void recordComplete(const char *name, int64_t startUs, int64_t durationUs)
+{
+    ThreadBuffer *buffer = currentBuffer();
+    if (!buffer)
+        return;
+    const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head % kEventsPerThread] = Event{name, startUs, durationUs};
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+int64_t nowUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool dump(const QString &path)
+{
+    struct ThreadEvents
+    {
+        int                tid;
+        QByteArray         name;
+        std::vector<Event> events;
+    };
+    std::vector<ThreadEvents> threads;
+    int64_t                   origin = INT64_MAX;
+
+    {
+        Registry    &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        for (const auto &buffer : reg.buffers) {
+            ThreadEvents   copy{buffer->tid, buffer->name ? buffer->name : "thread", {}};
+            const uint64_t head = buffer->head.load(std::memory_order_acquire);
+            const uint64_t first = head > uint64_t(kEventsPerThread) ? head - kEventsPerThread : 0;
+            copy.events.reserve(head - first);
+            for (uint64_t i = first; i < head; ++i)
+                copy.events.push_back(buffer->events[i % kEventsPerThread]);
+
+            // 复制期间被所属线程覆盖的槽位不可信，丢弃
+            const uint64_t after = buffer->head.load(std::memory_order_acquire);
+            const uint64_t valid = after > uint64_t(kEventsPerThread) ? after - kEventsPerThread : 0;
+            if (valid > first)
+                copy.events.erase(copy.events.begin(),
+                                  copy.events.begin() + std::min<uint64_t>(valid - first, copy.events.size()));
+
+            for (const Event &event : copy.events)
+                origin = std::min(origin, event.start);
+            threads.push_back(std::move(copy));
+        }
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    QByteArray       out;
+    out.reserve(1 << 20);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&out, &first]() {
+        if (!first)
+            out += ",\n";
+        first = false;
+    };
+
+    for (const ThreadEvents &thread : threads) {
+        const QByteArray tid = QByteArray::number(thread.tid);
+        separator();
+        out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + pid + ",\"tid\":" + tid
+               + ",\"args\":{\"name\":\"" + thread.name + "\"}}";
+        for (const Event &event : thread.events) {
+            separator();
+            out += "{\"ph\":\"X\",\"name\":\"";
+            out += event.name;
+            out += "\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"ts\":" + QByteArray::number(event.start - origin)
+                   + ",\"dur\":" + QByteArray::number(event.duration) + "}";
+        }
+        if (out.size() > (1 << 20)) {
+            file.write(out);
+            out.clear();
+        }
+    }
+    out += "]}\n";
+    file.write(out);
+    return file.error() == QFileDevice::NoError;
+}
+
+void configureFromEnvironment()
+{
+    const QString path = QString::fromLocal8Bit(qgetenv("QWAVEBOX_TRACE"));
+    if (!path.isEmpty())
+        enableWithDumpOnExit(path);
+}
+
+void enableWithDumpOnExit(const QString &path)
+{
+    Registry &reg = registry();
+    {
+        QMutexLocker locker(&reg.mutex);
+        reg.dumpPath = path;
+        if (!reg.postRoutineAdded) {
+            qAddPostRoutine(dumpAtExit);
+            reg.postRoutineAdded = true;
+        }
+    }
+    setEnabled(true);
+}
+
+QString dumpPath()
+{
+    Registry    &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    return reg.dumpPath;
+}
+
+} // namespace PlayTrace
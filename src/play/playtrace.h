@@ -0,0 +1,91 @@
+#ifndef PLAYTRACE_H
+#define PLAYTRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <QString>
+
+/**
+ * @brief 播放线程事件追踪 - 输出 Chrome trace / Perfetto 可读取的JSON
+ *
+ * 每个线程写入自己的环形缓冲区（写入路径无锁），缓冲区满后覆盖最旧的事件。
+ * 未开启时每个作用域只有一次relaxed原子读；定义 QWAVEBOX_NO_TRACE 可在编译期彻底去除。
+ */
+namespace PlayTrace {
+
+// 每个线程缓冲区保留的事件数
+constexpr int kEventsPerThread = 1 << 15;
+
+extern std::atomic<bool> g_enabled;
+
+inline bool isEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void setEnabled(bool enabled);
+
+// 设置当前线程在追踪视图中的名称
+void setThreadName(const char *name);
+
+struct ThreadBuffer;
+
+// 实时线程（SDL音频回调）不能在首次记录事件时分配缓冲区或加锁：由普通线程先预留缓冲区，
+// 实时线程首次进入时绑定（只写线程局部变量）。未开启追踪时预留返回nullptr，绑定后该线程的事件直接丢弃
+ThreadBuffer *reserveThread(const char *name);
+void          attachRealtimeThread(ThreadBuffer *buffer);
+
+// 记录一个完整事件（name 须为静态字符串）
+void recordComplete(const char *name, int64_t startUs, int64_t durationUs);
+
+// 单调时钟，微秒
+int64_t nowUs();
+
+// 把所有线程缓冲区中的事件写入 path，成功返回true
+bool dump(const QString &path);
+
+// 读取环境变量 QWAVEBOX_TRACE=<path>：存在则开启追踪，并在程序退出时写入该文件
+void configureFromEnvironment();
+
+// 开启追踪并在程序退出时写入 path
+void enableWithDumpOnExit(const QString &path);
+
+// 退出时写入的目标路径（未配置时为空）
+QString dumpPath();
+
+/**
+ * @brief Scope - 作用域事件，析构时记录起止时间
+ */
+class Scope
+{
+public:
+    explicit Scope(const char *name)
+        : m_name(isEnabled() ? name : nullptr)
+        , m_start(m_name ? nowUs() : 0)
+    {}
+    ~Scope()
+    {
+        if (m_name)
+            recordComplete(m_name, m_start, nowUs() - m_start);
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const char *m_name;
+    int64_t     m_start;
+};
+
+} // namespace PlayTrace
+
+#define PLAY_TRACE_CONCAT_INNER(a, b) a##b
+#define PLAY_TRACE_CONCAT(a, b) PLAY_TRACE_CONCAT_INNER(a, b)
+
+#ifdef QWAVEBOX_NO_TRACE
+#define PLAY_TRACE_SCOPE(name)
+#else
+#define PLAY_TRACE_SCOPE(name) PlayTrace::Scope PLAY_TRACE_CONCAT(playTraceScope_, __LINE__)(name)
+#endif
+
+#endif // PLAYTRACE_H
@@ -0,0 +1,98 @@
+#include "realfft.h"
+
+#include <cassert>
+#include <cmath>
+
+static constexpr double kPi = 3.14159265358979323846;
+
+RealFft::RealFft(int size)
+    : m_size(size)
+    , m_half(size / 2)
+    , m_bitReverse(m_half)
+    , m_splitCos(m_half)
+    , m_splitSin(m_half)
+    , m_re(m_half)
+    , m_im(m_half)
+{
+    assert(size >= 4 && (size & (size - 1)) == 0);
+
+    int bits = 0;
+    while ((1 << bits) < m_half)
+        ++bits;
+    for (int i = 0; i < m_half; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b))
+                reversed |= 1 << (bits - 1 - b);
+        }
+        m_bitReverse[i] = reversed;
+    }
+
+    // 长度为 len 的一级使用 e^{-2πij/len}，j < len/2
+    m_stageCos.reserve(m_half);
+    m_stageSin.reserve(m_half);
+    for (int len = 2; len <= m_half; len <<= 1) {
+        for (int j = 0; j < len / 2; ++j) {
+            const double angle = 2.0 * kPi * j / len;
+            m_stageCos.push_back(float(std::cos(angle)));
+            m_stageSin.push_back(float(-std::sin(angle)));
+        }
+    }
+
+    for (int k = 0; k < m_half; ++k) {
+        const double angle = 2.0 * kPi * k / m_size;
+        m_splitCos[k] = float(std::cos(angle));
+        m_splitSin[k] = float(std::sin(angle));
+    }
+}
+
+void RealFft::powerSpectrum(const float *input, float *power)
+{
+    float *re = m_re.data();
+    float *im = m_im.data();
+
+    // z[m] = x[2m] + i·x[2m+1]，按位反序放置
+    for (int m = 0; m < m_half; ++m) {
+        const int target = m_bitReverse[m];
+        re[target] = input[2 * m];
+        im[target] = input[2 * m + 1];
+    }
+
+    // 迭代式按时间抽取
+    int offset = 0;
+    for (int len = 2; len <= m_half; len <<= 1) {
+        const int    half = len / 2;
+        const float *wr = m_stageCos.data() + offset;
+        const float *wi = m_stageSin.data() + offset;
+        for (int i = 0; i < m_half; i += len) {
+            float *ar = re + i;
+            float *ai = im + i;
+            float *br = re + i + half;
+            float *bi = im + i + half;
+            for (int j = 0; j < half; ++j) {
+                const float tr = br[j] * wr[j] - bi[j] * wi[j];
+                const float ti = br[j] * wi[j] + bi[j] * wr[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+        offset += half;
+    }
+
+    // 拆分：X[k] = Fe[k] + e^{-2πik/N}·Fo[k]
+    // Fe = (Z[k] + conj(Z[M-k])) / 2，Fo = (Z[k] - conj(Z[M-k])) / 2i
+    for (int k = 0; k < m_half; ++k) {
+        const int   mirror = k == 0 ? 0 : m_half - k;
+        const float evenRe = 0.5f * (re[k] + re[mirror]);
+        const float evenIm = 0.5f * (im[k] - im[mirror]);
+        const float oddRe = 0.5f * (im[k] + im[mirror]);
+        const float oddIm = 0.5f * (re[mirror] - re[k]);
+        const float c = m_splitCos[k];
+        const float s = m_splitSin[k];
+        const float xr = evenRe + c * oddRe + s * oddIm;
+        const float xi = evenIm + c * oddIm - s * oddRe;
+        power[k] = xr * xr + xi * xi;
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef REALFFT_H
+#define REALFFT_H
+
+#include <vector>
+
+/**
+ * @brief RealFft - 实数序列的基2快速傅里叶变换
+ *
+ * 长度为 N 的实数输入两两打包成 N/2 点复数序列，做一次复数FFT后再拆分出 0 ~ N/2-1 的频点，
+ * 计算量约为同长度复数FFT的一半。实部与虚部分开存放，旋转因子按级展开为连续数组，
+ * 蝶形内层循环是连续访存的乘加，编译器可直接向量化。构造后不再分配内存。
+ */
+class RealFft
+{
+public:
+    // size 为2的幂且不小于4
+    explicit RealFft(int size);
+
+    int size() const { return m_size; }
+
+    // 输入 size 个实数，输出 size/2 个频点的功率 |X[k]|^2
+    void powerSpectrum(const float *input, float *power);
+
+private:
+    int                m_size;
+    int                m_half;
+    std::vector<int>   m_bitReverse;
+    std::vector<float> m_stageCos; // 各级旋转因子依次排列，共 N/2-1 个
+    std::vector<float> m_stageSin;
+    std::vector<float> m_splitCos; // 拆分实数频谱用的 e^{-2πik/N}
+    std::vector<float> m_splitSin;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+};
+
+#endif // REALFFT_H
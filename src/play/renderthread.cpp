@@ -1,21 +1,31 @@
 #include "renderthread.h"
-#include "../gui/sdlwidget.h"
 #include "avframequeue.h"
+#include "playlog.h"
+#include "playmetrics.h"
+#include "playtrace.h"
+#include "videosink.h"
 
 #include <QDebug>
 #include <QElapsedTimer>
+#include <utility>
 
 extern "C" {
-#include <SDL2/SDL.h>
-#include <libavutil/opt.h>
 #include <libavutil/time.h>
-#include <libswresample/swresample.h>
 }
 
+// 落后主时钟超过该值（秒）的帧记为迟到
+static constexpr double kLateFrameThreshold = 0.04;
+// 帧未到显示时间时单次最多等待（秒），暂停、跳转与倍速切换能及时生效
+static constexpr double kMaxFrameWait = 0.01;
+// 没有可显示的帧时的轮询间隔（秒）
+static constexpr double kIdleWait = 0.005;
+// 帧落后主时钟超过该值（秒）时不再按应显示的时刻发布视频时钟，而是从当前时刻重新计时（同 ffplay 的 frame_timer）
+static constexpr double kFrameTimerResetThreshold = 0.1;
+
 RenderThread::RenderThread(QObject *parent)
     : ThreadBase(parent)
     , m_videoFrameQueue(nullptr)
-    , m_videoWidget(nullptr)
+    , m_videoSink(nullptr)
     , m_videoInitialized(false)
 {}
 
@@ -34,6 +44,7 @@ RenderThread::~RenderThread()
 
     // 关闭渲染器并释放资源
     closeRenderer();
+    av_frame_free(&m_stepFrame);
 
     qDebug() << "RenderThread 析构函数执行完毕";
 }
@@ -49,21 +60,21 @@ void RenderThread::setVideoFrameQueue(AVFrameQueue *queue)
     m_videoFrameQueue = queue;
 }
 
-void RenderThread::setVideoWidget(SDLWidget *widget)
+void RenderThread::setVideoSink(VideoSink *sink)
 {
-    m_videoWidget = widget;
+    m_videoSink = sink;
 }
 
 bool RenderThread::initializeVideoRenderer(AVRational timebase)
 {
-    if (!m_videoWidget) {
-        qWarning() << "无效的视频渲染控件";
+    if (!m_videoSink) {
+        qWarning() << "无效的视频输出端";
         return false;
     }
 
-    // 初始化SDL渲染器
-    if (!m_videoWidget->initializeSDL()) {
-        qWarning() << "初始化SDL渲染器失败";
+    // 初始化视频输出端
+    if (!m_videoSink->initializeSink()) {
+        qWarning() << "初始化视频输出端失败";
         return false;
     }
 
@@ -83,34 +94,98 @@ void RenderThread::closeRenderer()
 {
     qDebug() << "关闭渲染器，准备释放资源...";
 
-    if (m_videoWidget)
-        m_videoWidget->reset();
+    if (m_videoSink)
+        m_videoSink->reset();
     // 清理视频渲染器资源
     m_videoInitialized = false;
 
     qDebug() << "渲染器资源释放完毕";
 }
 
+void RenderThread::setSuspended(bool suspended)
+{
+    m_suspended.store(suspended, std::memory_order_relaxed);
+}
+
+bool RenderThread::postFrame(AVFrame *frame)
+{
+    if (!m_videoInitialized || !frame)
+        return false;
+    AVFrame *clone = av_frame_clone(frame);
+    if (!clone)
+        return false;
+
+    QMutexLocker locker(&m_mutex);
+    av_frame_free(&m_stepFrame);
+    m_stepFrame = clone;
+    m_condition.wakeAll();
+    return true;
+}
+
 void RenderThread::process()
 {
+    // 逐帧步进投递的帧优先显示，暂停时线程只为它醒来
+    AVFrame *stepFrame = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        std::swap(stepFrame, m_stepFrame);
+    }
+    if (stepFrame) {
+        if (m_videoInitialized)
+            renderVideoFrame(stepFrame);
+        av_frame_free(&stepFrame);
+        return;
+    }
+
+    if (m_suspended.load(std::memory_order_relaxed)) {
+        m_dropLate = true;
+        msleep(20);
+        return;
+    }
+
     // 获取视频帧
     if (!m_currentRenderFrame && m_videoInitialized && m_videoFrameQueue
         && !m_videoFrameQueue->isEmpty())
         m_currentRenderFrame = m_videoFrameQueue->dequeue(1);
 
-    double sleepTime = 0;
+    double sleepTime = kIdleWait;
 
     // 处理视频帧
     if (m_currentRenderFrame) {
-        double tm = m_currentRenderFrame->pts * av_q2d(m_timebase);
-        double diff = tm - m_avSync->getClock();
+        double        tm = SyncData::toSeconds(m_currentRenderFrame->pts, m_timebase);
+        double        diff = tm - m_avSync->getClock();
+        const int64_t nowUs = SyncData::nowUs();
         if (diff > 0) {
-            sleepTime = FFMIN(sleepTime, diff);
+            // 等到帧的显示时间，但不超过 kMaxFrameWait，之后重新比较时钟
+            usleep(static_cast<unsigned long>(FFMIN(diff, kMaxFrameWait) * 1000000));
+            return;
+        }
+        if (m_dropLate && -diff > kLateFrameThreshold) {
+            PlayMetrics::add(PlayMetrics::Counter::VideoFramesDropped);
+            av_frame_free(&m_currentRenderFrame);
             return;
         }
+        m_dropLate = false;
+
+        // 跳转或打开后主时钟尚未建立时 diff 为NAN，不计入偏差
+        if (!std::isnan(diff)) {
+            PlayMetrics::set(PlayMetrics::Gauge::AvDriftUs, static_cast<int64_t>(diff * 1000000));
+            PlayMetrics::record(PlayMetrics::Histogram::AvDriftAbsUs, static_cast<int64_t>(-diff * 1000000));
+            if (-diff > kLateFrameThreshold)
+                PlayMetrics::add(PlayMetrics::Counter::VideoFramesLate);
+        }
+
+        // 帧应在主时钟走到 tm 时显示，即 nowUs + diff；以该时刻发布视频时钟，唤醒超时与上传/呈现的耗时不累积，
+        // 主时钟为视频时下一帧在上一帧应显示时刻之后正好一个帧间隔到期。落后过多或时钟未知时从当前时刻重新计时
+        const int64_t dueUs = !std::isnan(diff) && -diff <= kFrameTimerResetThreshold
+                                  ? nowUs + static_cast<int64_t>(diff * 1000000)
+                                  : nowUs;
         renderVideoFrame(m_currentRenderFrame);
+        if (!std::isnan(tm))
+            m_avSync->updateVideoClock(tm, dueUs);
         av_frame_free(&m_currentRenderFrame);
         m_currentRenderFrame = nullptr;
+        sleepTime = 0; // 刚送出一帧，立即检查下一帧
     }
 
     // 检查是否都已结束
@@ -120,24 +195,27 @@ void RenderThread::process()
     }
 
     // 控制渲染速率，避免CPU占用过高
-    msleep(sleepTime * 1000);
+    usleep(static_cast<unsigned long>(sleepTime * 1000000));
 }
 
 bool RenderThread::renderVideoFrame(AVFrame *frame)
 {
-    if (!m_videoWidget || !frame) {
+    if (!m_videoSink || !frame) {
         return false;
     }
 
     QMutexLocker locker(&m_videoMutex);
+    PLAY_TRACE_SCOPE("RenderThread::renderVideoFrame");
 
     try {
         // 渲染帧
-        m_videoWidget->renderFrame(frame);
+        PlayMetrics::ScopedTimer timer(PlayMetrics::Histogram::RenderUploadUs);
+        m_videoSink->renderFrame(frame);
+        PlayMetrics::add(PlayMetrics::Counter::VideoFramesRendered);
 
         return true;
     } catch (const std::exception &e) {
-        qWarning() << "渲染视频帧出错:" << e.what();
+        PLAY_LOG_WARNING("渲染视频帧出错: %s", e.what());
         return false;
     }
 }
@@ -4,19 +4,16 @@
 #include "avsync.h"
 #include "threadbase.h"
 
-#include <SDL.h>
 #include <memory>
 #include <QMutex>
 #include <QQueue>
 
 extern "C" {
 #include <libavutil/frame.h>
-#include <libavutil/samplefmt.h>
-#include <libswresample/swresample.h>
 }
 
 class AVFrameQueue;
-class SDLWidget;
+class VideoSink;
 
 /**
  * @brief 渲染线程类 - 负责将解码后的视频帧渲染到屏幕上
@@ -34,8 +31,8 @@ public:
     // 设置视频帧队列
     void setVideoFrameQueue(AVFrameQueue *queue);
 
-    // 设置视频渲染控件
-    void setVideoWidget(SDLWidget *widget);
+    // 设置视频输出端
+    void setVideoSink(VideoSink *sink);
 
     // 初始化视频渲染器
     bool initializeVideoRenderer(AVRational timebase);
@@ -46,9 +43,17 @@ public:
     // 关闭渲染器
     void closeRenderer();
 
+    // 窗口不可见时停止取帧和上传；可在任意线程调用
+    void setSuspended(bool suspended);
+
+    // 投递一帧由渲染线程立即显示，不经过帧队列，暂停时也会显示（逐帧步进用）；
+    // 内部只增加帧数据的引用，帧仍归调用方所有；未显示前再次投递时替换旧帧
+    bool postFrame(AVFrame *frame);
+
 protected:
     // 线程处理函数
     void process() override;
+    bool hasPendingWork() const override { return m_stepFrame != nullptr; }
 
 private:
     // 渲染视频帧
@@ -60,14 +65,18 @@ private:
 private:
     AVFrameQueue *m_videoFrameQueue{nullptr};
     AVFrame      *m_currentRenderFrame{nullptr};
+    AVFrame      *m_stepFrame{nullptr}; // 逐帧步进投递的帧，受 m_mutex 保护
 
-    SDLWidget *m_videoWidget{nullptr};
+    VideoSink *m_videoSink{nullptr};
 
     AVSync    *m_avSync = nullptr;
     AVRational m_timebase;
 
     QMutex m_videoMutex;
     bool   m_videoInitialized{false};
+
+    std::atomic<bool> m_suspended{false};
+    bool              m_dropLate{false}; // 恢复可见后丢弃积压的过期帧，直到有帧按时到达
 };
 
 #endif // RENDERTHREAD_H
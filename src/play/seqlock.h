@@ -0,0 +1,67 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief 顺序锁 - 多读者无锁读取一个小的可平凡复制结构体
+ *
+ * 写者先把序号加到奇数，写完数据再加到偶数；读者在读取前后各取一次序号，
+ * 两次相同且为偶数时数据完整，否则重试。读者不写共享内存，不会让写者等待，也不会互相争用缓存行。
+ * 数据按64位字存放在原子变量中（relaxed读写），读者与写者并发时没有数据竞争。
+ * 写者之间以自旋标志互斥：写入只是几次原子存储，临界区极短，可以在音频回调中调用。
+ */
+template<typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock 只能保存可平凡复制的类型");
+
+public:
+    SeqLock() { store(T{}); }
+    explicit SeqLock(const T &value) { store(value); }
+
+    void store(const T &value)
+    {
+        uint64_t words[kWords] = {};
+        memcpy(words, &value, sizeof(T));
+
+        while (m_writing.test_and_set(std::memory_order_acquire)) {
+        }
+        const uint32_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; ++i)
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        m_seq.store(seq + 2, std::memory_order_release);
+        m_writing.clear(std::memory_order_release);
+    }
+
+    T load() const
+    {
+        uint64_t words[kWords];
+        uint32_t before, after;
+        do {
+            before = m_seq.load(std::memory_order_acquire);
+            for (size_t i = 0; i < kWords; ++i)
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_seq.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> m_seq{0};
+    std::atomic<uint64_t> m_words[kWords];
+    std::atomic_flag      m_writing = ATOMIC_FLAG_INIT;
+};
+
+#endif // SEQLOCK_H
@@ -1,158 +1,70 @@
 #ifndef SYNCDATA_H
 #define SYNCDATA_H
 
-#include <QMutex>
-#include <QReadWriteLock>
+#include "seqlock.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+extern "C" {
+#include <libavutil/avutil.h>
+}
 
 /**
- * @brief 同步数据类 - 用于渲染线程和同步线程之间共享同步数据
+ * @brief 时钟快照 - 最近一次发布的播放时间与发布时刻，读取时按经过的时间外推
  */
-class SyncData
+struct ClockSnapshot
 {
-    struct AVData
-    {
-        int64_t pts_ = 0;
-        int     num_ = 0;
-        int     den_ = 0;
-    };
-
-public:
-    SyncData()
-        : m_videoPts(0)
-        , m_audioPts(0)
-        , m_masterClock(0)
-        , m_videoDelay(0.0)
-        , m_audioDelay(0.0)
-        , m_playbackSpeed(1.0)
-        , m_audioSampleRate(44100)
-    {}
-
-    // 设置视频时间戳
-    void setVideoData(int64_t pts, int num, int den)
-    {
-        QWriteLocker locker(&m_mutex);
-        m_videoData.pts_ = pts;
-        m_videoData.num_ = num;
-        m_videoData.den_ = den;
-    }
-
-    // 设置音频时间戳
-    void setAudioData(int64_t pts, int num, int den)
-    {
-        QWriteLocker locker(&m_mutex);
-        m_audioData.pts_ = pts;
-        m_audioData.num_ = num;
-        m_audioData.den_ = den;
-    }
-
-    AVData getAudioData() const
-    {
-        QReadLocker locker(&m_mutex);
-        return m_audioData;
-    }
+    double  pts{NAN};     // 发布时的播放时间（秒），未知时为NAN
+    int64_t updatedUs{0}; // 发布时刻（单调时钟，微秒）
+    double  speed{1.0};   // 外推速度，暂停时为0
 
-    AVData getVideoData() const
-    {
-        QReadLocker locker(&m_mutex);
-        return m_videoData;
-    }
-
-    // 设置主时钟和延迟值
-    void setSyncInfo(int64_t masterClock, double videoDelay, double audioDelay)
-    {
-        QWriteLocker locker(&m_mutex);
-        m_masterClock = masterClock;
-        m_videoDelay = videoDelay;
-        m_audioDelay = audioDelay;
-    }
-
-    // 获取同步信息
-    void getSyncInfo(int64_t &masterClock, double &videoDelay, double &audioDelay) const
-    {
-        QReadLocker locker(&m_mutex);
-        masterClock = m_masterClock;
-        videoDelay = m_videoDelay;
-        audioDelay = m_audioDelay;
-    }
-
-    // 获取主时钟
-    int64_t getMasterClock() const
-    {
-        QReadLocker locker(&m_mutex);
-        return m_masterClock;
-    }
-
-    // 设置主时钟
-    void setMasterClock(int64_t masterClock)
-    {
-        QWriteLocker locker(&m_mutex);
-        m_masterClock = masterClock;
-    }
-
-    // 获取视频延迟
-    double getVideoDelay() const
-    {
-        QReadLocker locker(&m_mutex);
-        return m_videoDelay;
-    }
+    double at(int64_t nowUs) const { return pts + (nowUs - updatedUs) / 1000000.0 * speed; }
+};
 
-    // 获取音频延迟
-    double getAudioDelay() const
-    {
-        QReadLocker locker(&m_mutex);
-        return m_audioDelay;
-    }
+/**
+ * @brief 同步数据类 - 音频、视频各自的输出时钟
+ *
+ * 由各输出端在送出数据时发布（音频回调、视频渲染线程），时间戳按各流自己的时间基换算为秒。
+ * 每路时钟保存在顺序锁中，发布与读取都不加锁，不需要专门的线程轮询。
+ */
+class SyncData
+{
+public:
+    void setAudioClock(double pts, double speed = 1.0) { m_audio.store({pts, nowUs(), speed}); }
+    void setVideoClock(double pts, double speed = 1.0) { setVideoClock(pts, speed, nowUs()); }
+    // 按帧应显示的时刻发布，送帧的延迟不计入时钟
+    void setVideoClock(double pts, double speed, int64_t atUs) { m_video.store({pts, atUs, speed}); }
 
-    // 设置播放速度
-    void setPlaybackSpeed(double speed)
-    {
-        QWriteLocker locker(&m_mutex);
-        if (speed <= 0.0) {
-            return; // 忽略无效速度
-        }
-        m_playbackSpeed = speed;
-    }
+    ClockSnapshot audioClock() const { return m_audio.load(); }
+    ClockSnapshot videoClock() const { return m_video.load(); }
 
-    // 获取播放速度
-    double getPlaybackSpeed() const
+    // 打开媒体或跳转后清除
+    void reset()
     {
-        QReadLocker locker(&m_mutex);
-        return m_playbackSpeed;
+        m_audio.store(ClockSnapshot{});
+        m_video.store(ClockSnapshot{});
     }
 
-    // 设置音频采样率
-    void setAudioSampleRate(int sampleRate)
+    // 流时间戳按时间基换算为秒，无效时返回NAN
+    static double toSeconds(int64_t pts, AVRational timebase)
     {
-        QWriteLocker locker(&m_mutex);
-        if (sampleRate <= 0) {
-            return; // 忽略无效采样率
-        }
-        m_audioSampleRate = sampleRate;
+        if (pts == AV_NOPTS_VALUE || timebase.den == 0)
+            return NAN;
+        return pts * av_q2d(timebase);
     }
 
-    // 获取音频采样率
-    int getAudioSampleRate() const
+    // 单调时钟，微秒
+    static int64_t nowUs()
     {
-        QReadLocker locker(&m_mutex);
-        return m_audioSampleRate;
+        using namespace std::chrono;
+        return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
     }
 
 private:
-    mutable QReadWriteLock m_mutex;
-    int64_t                m_videoPts;
-    int64_t                m_audioPts;
-    int64_t                m_masterClock;
-    double                 m_videoDelay;
-    double                 m_audioDelay;
-    int                    m_videoTmBase_num;
-    int                    m_videoTmBase_den;
-    int                    m_audioTmBase_num;
-    int                    m_audioTmBase_den;
-    double                 m_playbackSpeed;   // 播放速度
-    int                    m_audioSampleRate; // 音频采样率
-
-    AVData m_videoData;
-    AVData m_audioData;
+    SeqLock<ClockSnapshot> m_audio;
+    SeqLock<ClockSnapshot> m_video;
 };
 
 #endif // SYNCDATA_H
@@ -1,4 +1,5 @@
 #include "threadbase.h"
+#include "playtrace.h"
 
 ThreadBase::ThreadBase(QObject *parent)
     : QThread(parent)
@@ -66,11 +67,15 @@ bool ThreadBase::isPaused() const
 
 void ThreadBase::run()
 {
+    // 追踪视图中以类名区分线程
+    const char *name = metaObject()->className();
+    PlayTrace::setThreadName(name);
+
     while (m_running) {
         // 处理暂停
         {
             QMutexLocker locker(&m_mutex);
-            while (m_paused && m_running) {
+            while (m_paused && m_running && !hasPendingWork()) {
                 m_condition.wait(&m_mutex);
             }
         }
@@ -81,6 +86,7 @@ void ThreadBase::run()
         }
         
         // 执行具体处理逻辑
+        PLAY_TRACE_SCOPE(name);
         process();
     }
 }
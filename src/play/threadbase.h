@@ -44,6 +44,9 @@ protected:
     // 具体的处理逻辑，由子类实现
     virtual void process() = 0;
 
+    // 暂停期间仍需处理的工作（如逐帧步进投递的帧），有则唤醒执行一次 process；在 m_mutex 保护下调用
+    virtual bool hasPendingWork() const { return false; }
+
 signals:
     // 线程错误信号
     void threadError(const QString &errorMsg);
@@ -1,30 +1,65 @@
 #include "threadmanager.h"
-#include "appcontext.h"
+#include "audioanalyzer.h"
 #include "audiodecodethread.h"
 #include "audiorenderthread.h"
 #include "demuxthread.h"
+#include "playmetrics.h"
 #include "renderthread.h"
-#include "syncthread.h"
 #include "threadbase.h"
 #include "videodecodethread.h"
 
+#include <cmath>
+#include <cstdlib>
 #include <QDebug>
+#include <QRunnable>
+
+/**
+ * @brief FrameStepTask - 在步进线程中执行合并后的逐帧步进请求，向后退时可能需要解码整个GOP
+ */
+class FrameStepTask : public QRunnable
+{
+public:
+    FrameStepTask(ThreadManager *manager, std::shared_ptr<std::atomic<bool>> cancel)
+        : m_manager(manager)
+        , m_cancel(std::move(cancel))
+    {}
+
+    // ThreadManager 析构前会取消并等待线程池，此处指针一定有效
+    void run() override { m_manager->processFrameSteps(m_cancel); }
+
+private:
+    ThreadManager                     *m_manager;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
 
 ThreadManager::ThreadManager(QObject *parent)
     : QObject(parent)
     , m_initialized(false)
     , m_playState(PlayState::StoppedState)
-{}
+{
+    m_stepPool.setMaxThreadCount(1);
+}
 
 ThreadManager::~ThreadManager()
 {
     if (isPlaying())
         stopPlay();
+
+    m_stepCancel->store(true);
+    m_stepPool.clear();
+    m_stepPool.waitForDone();
 }
 
 bool ThreadManager::openMedia(const QString &path)
 {
+    // 指标按媒体统计
+    PlayMetrics::reset();
+
+    endFrameStep(true);
+    m_mediaPath = path;
+
     auto demuxThd = getDemuxThread();
+    demuxThd->setAudioOnly(m_audioOnly);
     auto bRet = demuxThd->openMedia(path);
     if (!bRet) {
         qWarning() << "openMedia failed.";
@@ -32,7 +67,10 @@ bool ThreadManager::openMedia(const QString &path)
     }
     // 更新音量
     auto aRenderThd = getAudioRenderThread();
-    aRenderThd->setVolume(AppContext::instance()->getAppData()->getVolume());
+    aRenderThd->setVolume(m_volume);
+    aRenderThd->setReplayGain(m_replayGainDb);
+    aRenderThd->setEqualizer(m_equalizer);
+    aRenderThd->setDownmixMode(m_downmixMode);
 
     bRet = resetThreadLinkage();
     return bRet;
@@ -48,6 +86,8 @@ void ThreadManager::stopPlay()
     if (!demuxThd || !videoThd || !vRenderThd || !audioThd || !aRenderThd)
         return;
     // 停止播放的具体流程：
+    // 结束逐帧步进，之后不再向渲染线程投递步进帧
+    endFrameStep(true);
     // 停止所有线程
     stopAllThreads();
     // 渲染线程关闭渲染器
@@ -68,6 +108,7 @@ void ThreadManager::pausePlay()
 
     pauseAllThreads();
     aRenderThd->pausePlay();
+    m_avSync.setPaused(true);
 }
 
 void ThreadManager::resumePlay()
@@ -78,8 +119,17 @@ void ThreadManager::resumePlay()
     auto aRenderThd = getAudioRenderThread();
     if (!aRenderThd)
         return;
-    aRenderThd->setVolume(AppContext::instance()->getAppData()->getVolume());
+    aRenderThd->setVolume(m_volume);
     aRenderThd->resumePlay();
+    m_avSync.setPaused(false);
+
+    // 逐帧步进过：管线仍停在暂停处，从步进到的帧继续播放
+    if (m_stepping) {
+        const double position = m_stepPosition;
+        endFrameStep();
+        if (!std::isnan(position))
+            seekToPosition(static_cast<int64_t>(position * 1000));
+    }
 }
 
 void ThreadManager::seekToPosition(int64_t position)
@@ -101,11 +151,14 @@ void ThreadManager::seekToPosition(int64_t position)
         // 2. 执行 Seek 操作
         demuxThd->seekTo(position);
 
-        // 3. 刷新解码器（需确保线程已暂停）
-        if (videoThd->isPaused() && audioThd->isPaused()) {
+        // 3. 刷新解码器（需确保线程已暂停，仅音频或没有音频流时对应的线程未运行）
+        const bool videoPaused = isAudioOnly() || videoThd->isPaused();
+        const bool audioPaused = !hasAudioStream() || audioThd->isPaused();
+        if (videoPaused && audioPaused) {
             m_avSync.initClock();
             audioThd->flush();
             videoThd->flush();
+            aRenderThd->flush();
         }
 
         // 4. 恢复线程
@@ -117,6 +170,107 @@ void ThreadManager::seekToPosition(int64_t position)
     }
 }
 
+bool ThreadManager::stepFrame(bool forward)
+{
+    auto vRenderThd = getRenderThread();
+    if (!vRenderThd || !isPauseed() || isAudioOnly())
+        return false;
+
+    QMutexLocker locker(&m_stepMutex);
+    // 第一次步进以暂停时显示的帧为起点
+    if (!m_stepping) {
+        double position = m_avSync.videoClock();
+        if (std::isnan(position))
+            position = m_avSync.getClock();
+        if (std::isnan(position))
+            return false;
+        m_stepRequest.seekTo = position;
+        m_stepping = true;
+    }
+    m_stepRequest.path = m_mediaPath;
+    m_stepRequest.renderer = vRenderThd;
+    m_stepRequest.steps += forward ? 1 : -1;
+    scheduleFrameSteps();
+    return true;
+}
+
+void ThreadManager::scheduleFrameSteps()
+{
+    if (m_stepTaskRunning)
+        return;
+    m_stepTaskRunning = true;
+    m_stepPool.start(new FrameStepTask(this, m_stepCancel));
+}
+
+void ThreadManager::processFrameSteps(const std::shared_ptr<std::atomic<bool>> &cancel)
+{
+    for (;;) {
+        StepRequest request;
+        {
+            QMutexLocker locker(&m_stepMutex);
+            request = m_stepRequest;
+            m_stepRequest.seekTo = NAN;
+            m_stepRequest.steps = 0;
+            m_stepRequest.clearCache = false;
+            m_stepRequest.closeFile = false;
+            const bool idle = request.steps == 0 && std::isnan(request.seekTo) && !request.clearCache
+                              && !request.closeFile;
+            if (idle || cancel->load()) {
+                m_stepTaskRunning = false;
+                return;
+            }
+        }
+
+        if (request.closeFile)
+            m_frameStepper.close();
+        else if (request.clearCache)
+            m_frameStepper.clearCache();
+        if (request.steps == 0 && std::isnan(request.seekTo))
+            continue;
+        if (!request.renderer || !m_frameStepper.open(request.path))
+            continue;
+
+        // 合并的步数一次走完，中间的帧不显示；走到首尾时停在最后一个有效帧
+        AVFrame *frame = std::isnan(request.seekTo) ? nullptr : m_frameStepper.seek(request.seekTo);
+        if (!std::isnan(request.seekTo) && !frame)
+            continue;
+        for (int i = 0; i < std::abs(request.steps) && !cancel->load(); ++i) {
+            AVFrame *next = request.steps > 0 ? m_frameStepper.stepForward() : m_frameStepper.stepBackward();
+            if (!next)
+                break;
+            frame = next;
+        }
+        if (!frame)
+            continue;
+
+        // 解码期间步进已结束（恢复播放、打开或关闭文件）时不再显示；持锁投递，结束步进后不会再有帧送到渲染线程
+        {
+            QMutexLocker locker(&m_stepMutex);
+            if (request.generation != m_stepRequest.generation)
+                continue;
+            // 在渲染线程中显示，视频输出端只在渲染线程访问
+            if (!request.renderer->postFrame(frame))
+                continue;
+        }
+        const double   position = m_frameStepper.currentTime();
+        const uint64_t generation = request.generation;
+        QMetaObject::invokeMethod(
+            this, [this, generation, position]() { onFrameStepped(generation, position); }, Qt::QueuedConnection);
+    }
+}
+
+void ThreadManager::onFrameStepped(uint64_t generation, double position)
+{
+    {
+        QMutexLocker locker(&m_stepMutex);
+        if (generation != m_stepRequest.generation)
+            return;
+    }
+    m_stepPosition = position;
+    m_avSync.updateVideoClock(position);
+    emit sigFrameStepped();
+}
+
 bool ThreadManager::initializeThreads()
 {
     if (m_initialized) {
@@ -136,8 +290,6 @@ bool ThreadManager::initializeThreads()
         m_threads[VIDEO_RENDER] = std::make_shared<RenderThread>();
         m_threads[AUDIO_RENDER] = std::make_shared<AudioRenderThread>();
 
-        // 同步线程
-        // m_threads[SYNC] = std::make_shared<SyncThread>();
 #ifdef ENABLE_LIVE_DANMU
         // 弹幕线程
         m_threads[DANMAKU] = std::make_shared<DanmakuThread>();
@@ -179,8 +331,11 @@ bool ThreadManager::initializeThreads()
         // audio decode -> audio render (frameQueue)
         aRenderThd->setAudioFrameQueue(audioThd->getFrameQueue());
         // sync
+        videoThd->setSync(&m_avSync);
         vRenderThd->setSync(&m_avSync);
         aRenderThd->setSync(&m_avSync);
+        // audio render -> analyzer (tap)
+        aRenderThd->setAudioTap(getAudioAnalyzer()->tap());
 
         m_initialized = true;
         return true;
@@ -204,13 +359,19 @@ bool ThreadManager::startAllThreads()
     // 1. 先启动解复用线程
     m_threads[DEMUX]->startProcess();
 
-    // 2. 启动解码线程
-    m_threads[VIDEO_DECODE]->startProcess();
-    m_threads[AUDIO_DECODE]->startProcess();
+    // 2. 启动解码线程，仅音频时不启动视频解码与渲染
+    const bool audioOnly = isAudioOnly();
+    const bool hasAudio = hasAudioStream();
+    if (!audioOnly)
+        m_threads[VIDEO_DECODE]->startProcess();
+    if (hasAudio)
+        m_threads[AUDIO_DECODE]->startProcess();
 
     // 4. 启动渲染线程
-    m_threads[VIDEO_RENDER]->startProcess();
-    m_threads[AUDIO_RENDER]->startProcess();
+    if (!audioOnly)
+        m_threads[VIDEO_RENDER]->startProcess();
+    if (hasAudio)
+        m_threads[AUDIO_RENDER]->startProcess();
 
 #ifdef ENABLE_LIVE_DANMU
     // 5. 启动弹幕线程（如果需要）
@@ -303,11 +464,11 @@ ThreadBase *ThreadManager::getThread(ThreadType type)
     return nullptr;
 }
 
-void ThreadManager::setVideoRenderObj(SDLWidget *obj)
+void ThreadManager::setVideoRenderObj(VideoSink *obj)
 {
     auto vRender = getRenderThread();
     if (vRender)
-        vRender->setVideoWidget(obj);
+        vRender->setVideoSink(obj);
 }
 
 DemuxThread *ThreadManager::getDemuxThread()
@@ -335,6 +496,13 @@ AudioRenderThread *ThreadManager::getAudioRenderThread()
     return static_cast<AudioRenderThread *>(getThread(AUDIO_RENDER));
 }
 
+AudioAnalyzer *ThreadManager::getAudioAnalyzer()
+{
+    if (!m_audioAnalyzer)
+        m_audioAnalyzer = std::make_unique<AudioAnalyzer>();
+    return m_audioAnalyzer.get();
+}
+
 #ifdef ENABLE_LIVE_DANMU
 DanmakuThread *ThreadManager::getDanmakuThread()
 {
@@ -359,17 +527,19 @@ double ThreadManager::getPlaybackSpeed() const
 
 double ThreadManager::getCurrentPlayProgress()
 {
-    double progress = m_avSync.getClock() * 1000;
+    const bool stepped = m_stepping && !std::isnan(m_stepPosition);
+    double     progress = (stepped ? m_stepPosition : m_avSync.getClock()) * 1000;
     return progress;
 }
 
 int64_t ThreadManager::getPlayDuration()
 {
-    return (int64_t) (m_avSync.getClock() * 1000);
+    return (int64_t) (getCurrentPlayProgress());
 }
 
 void ThreadManager::setVolume(int volume)
 {
+    m_volume = volume;
     auto audioThd = getAudioRenderThread();
     if (audioThd)
         audioThd->setVolume(volume);
@@ -382,11 +552,82 @@ void ThreadManager::setVolume(int volume)
     }
 }
 
+void ThreadManager::setReplayGain(double db)
+{
+    m_replayGainDb = db;
+    auto audioThd = getAudioRenderThread();
+    if (audioThd)
+        audioThd->setReplayGain(db);
+}
+
+void ThreadManager::setEqualizer(const EqualizerSettings &settings)
+{
+    m_equalizer = settings;
+    auto audioThd = getAudioRenderThread();
+    if (audioThd)
+        audioThd->setEqualizer(settings);
+}
+
+void ThreadManager::setAudioOnly(bool audioOnly)
+{
+    m_audioOnly = audioOnly;
+}
+
+bool ThreadManager::isAudioOnly()
+{
+    auto demuxThd = getDemuxThread();
+    return demuxThd && demuxThd->isAudioOnly();
+}
+
+void ThreadManager::setVideoVisible(bool visible)
+{
+    auto videoThd = getVideoDecodeThread();
+    auto vRenderThd = getRenderThread();
+    if (videoThd)
+        videoThd->setSuspended(!visible);
+    if (vRenderThd)
+        vRenderThd->setSuspended(!visible);
+}
+
+void ThreadManager::setSyncMaster(SyncMaster master)
+{
+    m_avSync.setPreferredMaster(master);
+}
+
+bool ThreadManager::hasAudioStream()
+{
+    auto demuxThd = getDemuxThread();
+    return demuxThd && demuxThd->getAudioStreamIndex() >= 0;
+}
+
+void ThreadManager::endFrameStep(bool closeFile)
+{
+    m_stepping = false;
+    m_stepPosition = NAN;
+
+    QMutexLocker locker(&m_stepMutex);
+    ++m_stepRequest.generation;
+    m_stepRequest.seekTo = NAN;
+    m_stepRequest.steps = 0;
+    m_stepRequest.clearCache = true;
+    m_stepRequest.closeFile = m_stepRequest.closeFile || closeFile;
+    scheduleFrameSteps();
+}
+
+void ThreadManager::setDownmixMode(DownmixMode mode)
+{
+    m_downmixMode = mode;
+    auto audioThd = getAudioRenderThread();
+    if (audioThd)
+        audioThd->setDownmixMode(mode);
+}
+
 bool ThreadManager::resetThreadLinkage()
 {
     bool bRet = false;
     // reset sync
     m_avSync.initClock();
+    m_avSync.setPaused(false);
 
     // demux -> decode (packetQueue)
     auto demuxThd = getDemuxThread();
@@ -396,16 +637,29 @@ bool ThreadManager::resetThreadLinkage()
     auto aRenderThd = getAudioRenderThread();
     if (!demuxThd || !videoThd || !vRenderThd || !audioThd || !aRenderThd)
         return false;
-    videoThd->openDecoder(demuxThd->getVideoStreamIndex(), demuxThd->videoCodecParameters());
-    audioThd->openDecoder(demuxThd->getAudioStreamIndex(), demuxThd->audioCodecParameters());
 
-    // videoRender
-    bRet = vRenderThd->initializeVideoRenderer(getDemuxThread()->videoTimebase());
-    if (!bRet) {
-        qDebug() << "initializeVideoRenderer failed.";
-        return false;
+    // 按实际输出的流确定主时钟：没有音频流的视频退回外部时钟
+    const bool hasAudio = demuxThd->getAudioStreamIndex() >= 0;
+    m_avSync.setStreams(hasAudio, !demuxThd->isAudioOnly() && demuxThd->getVideoStreamIndex() >= 0);
+
+    // 仅音频时不打开视频解码器和视频输出端
+    if (!demuxThd->isAudioOnly()) {
+        videoThd->openDecoder(demuxThd->getVideoStreamIndex(), demuxThd->videoCodecParameters());
+        videoThd->setTimebase(demuxThd->videoTimebase());
+
+        // videoRender
+        bRet = vRenderThd->initializeVideoRenderer(getDemuxThread()->videoTimebase());
+        if (!bRet) {
+            qDebug() << "initializeVideoRenderer failed.";
+            return false;
+        }
     }
 
+    // 没有音频流时不打开音频解码器和音频设备
+    if (!hasAudio)
+        return true;
+    audioThd->openDecoder(demuxThd->getAudioStreamIndex(), demuxThd->audioCodecParameters());
+
     // audioRender
     bRet = aRenderThd->initializeAudioRenderer(getDemuxThread()->audioTimebase(),
                                                getDemuxThread()->audioCodecParameters());
@@ -3,20 +3,24 @@
 
 #include "avsync.h"
 #include "constants.h"
-#include "syncdata.h"
+#include "framestepper.h"
 
+#include <atomic>
+#include <cmath>
 #include <memory>
 #include <QMap>
+#include <QMutex>
 #include <QObject>
+#include <QThreadPool>
 
-class SDLWidget;
+class VideoSink;
 class ThreadBase;
 class DemuxThread;
 class VideoDecodeThread;
 class AudioDecodeThread;
 class RenderThread;
 class AudioRenderThread;
-class SyncThread;
+class AudioAnalyzer;
 class DanmakuThread;
 class LiveStreamThread;
 
@@ -59,6 +63,10 @@ public:
     // 跳转播放
     void seekToPosition(int64_t position);
 
+    // 暂停时前进/后退一帧，从当前显示的帧开始；恢复播放时从步进到的位置继续。
+    // 解码在步进线程中进行，连续的请求合并执行，只显示最后到达的帧，完成后发出 sigFrameStepped
+    bool stepFrame(bool forward);
+
     // 初始化所有线程
     bool initializeThreads();
 
@@ -77,8 +85,8 @@ public:
     // 获取指定线程
     ThreadBase *getThread(ThreadType type);
 
-    // 绑定视频渲染对象
-    void setVideoRenderObj(SDLWidget *obj);
+    // 绑定视频输出端
+    void setVideoRenderObj(VideoSink *obj);
 
     // 获取特定线程实例
     DemuxThread       *getDemuxThread();
@@ -86,6 +94,7 @@ public:
     AudioDecodeThread *getAudioDecodeThread();
     RenderThread      *getRenderThread();
     AudioRenderThread *getAudioRenderThread();
+    AudioAnalyzer     *getAudioAnalyzer();
 #ifdef ENABLE_LIVE_DANMU
     DanmakuThread    *getDanmakuThread();
     LiveStreamThread *getLiveStreamThread();
@@ -101,6 +110,27 @@ public:
 
     void setVolume(int volume);
 
+    // 响度均衡增益（dB），随音量一起作用于输出级
+    void setReplayGain(double db);
+
+    // 均衡器与低音增强
+    void setEqualizer(const EqualizerSettings &settings);
+
+    // 多声道缩混模式，设备声道数在下次打开文件时按新模式协商
+    void setDownmixMode(DownmixMode mode);
+
+    // 仅音频播放（后台听音），下次打开文件时生效
+    void setAudioOnly(bool audioOnly);
+
+    // 当前媒体是否以仅音频方式播放，此时视频解码与渲染线程不运行
+    bool isAudioOnly();
+
+    // 视频画面是否可见；不可见时视频解码与渲染挂起，恢复时追到当前时钟，音频不受影响
+    void setVideoVisible(bool visible);
+
+    // 主时钟偏好，可在播放中切换；媒体缺少对应的流时自动退回
+    void setSyncMaster(SyncMaster master);
+
     inline bool isPlaying() { return m_playState == PlayState::PlayingState; }
     inline bool isPauseed() { return m_playState == PlayState::PausedState; }
     inline bool isStopped() { return m_playState == PlayState::StoppedState; }
@@ -118,10 +148,31 @@ signals:
     // 音量变化信号
     void sigVoiceStateChanged(VoiceState);
 
+    // 逐帧步进的帧已送去显示，时钟与进度已更新
+    void sigFrameStepped();
+
 private:
     bool resetThreadLinkage();
 
+    // 当前媒体是否有音频流，没有时音频解码与输出线程不运行
+    bool hasAudioStream();
+
+    // 结束逐帧步进，在步进线程中释放帧缓存，closeFile 时同时关闭文件；尚未完成的步进结果作废
+    void endFrameStep(bool closeFile = false);
+
+    // 持有 m_stepMutex 时调用：步进线程空闲时提交任务，否则由正在运行的任务取走新请求
+    void scheduleFrameSteps();
+    // 步进线程：取出合并后的请求依次执行，直到没有新请求
+    void processFrameSteps(const std::shared_ptr<std::atomic<bool>> &cancel);
+    // 界面线程：步进结果送达
+    void onFrameStepped(uint64_t generation, double position);
+
+    friend class FrameStepTask;
+
 private:
+    // 频谱/电平分析线程，不随播放启停；先于各线程声明，保证在音频设备关闭后才析构
+    std::unique_ptr<AudioAnalyzer> m_audioAnalyzer;
+
     // 存储所有线程的映射
     QMap<ThreadType, std::shared_ptr<ThreadBase>> m_threads;
 
@@ -132,10 +183,41 @@ private:
     PlayState m_playState;
 
     // 音量状态
-    VoiceState m_voiceState;
+    VoiceState m_voiceState{VoiceState::NormalState};
+    int        m_volume{50};
+    double     m_replayGainDb{0.0};
+
+    EqualizerSettings m_equalizer;
+    DownmixMode       m_downmixMode{DownmixMode::Auto};
+    bool              m_audioOnly{false};
 
     // 同步时钟
     AVSync m_avSync;
+
+    // 逐帧步进，使用独立的解码器，暂停期间才会打开；m_frameStepper 只在步进线程中访问
+    QString      m_mediaPath;
+    FrameStepper m_frameStepper;
+    bool         m_stepping{false};   // 暂停后已步进过，显示的帧与播放管线的位置不一致
+    double       m_stepPosition{NAN}; // 最近一次显示的步进帧的时间（秒）
+
+    // 界面线程写入、步进线程取走的请求，受 m_stepMutex 保护；连续按键只累加步数
+    struct StepRequest
+    {
+        QString       path;
+        RenderThread *renderer{nullptr};
+        double        seekTo{NAN}; // 非NAN时先定位到该时刻显示的帧
+        int           steps{0};    // 尚未执行的净步数，前进为正
+        bool          clearCache{false};
+        bool          closeFile{false};
+        uint64_t      generation{0}; // 结束步进时递增，之前的结果不再显示
+    };
+    QMutex      m_stepMutex;
+    StepRequest m_stepRequest;
+    bool        m_stepTaskRunning{false};
+
+    // 单线程池，保证 m_frameStepper 串行访问；先于步进器析构
+    QThreadPool                        m_stepPool;
+    std::shared_ptr<std::atomic<bool>> m_stepCancel{std::make_shared<std::atomic<bool>>(false)};
 };
 
 #endif // THREADMANAGER_H
@@ -1,14 +1,22 @@
 #include "videodecodethread.h"
 #include "avframequeue.h"
 #include "avpacketqueue.h"
+#include "playlog.h"
+#include "playmetrics.h"
+#include "playtrace.h"
 
 #include <QDebug>
 
+#include <cmath>
+
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavutil/error.h>
 }
 
+// 挂起期间缓存的包数上限（25fps 下约1分钟），超出时放弃缓存，恢复后从下一个关键帧开始
+static constexpr size_t kMaxCachedPackets = 1500;
+
 VideoDecodeThread::VideoDecodeThread(QObject *parent)
     : ThreadBase(parent)
     , m_codecContext(nullptr)
@@ -106,11 +114,17 @@ void VideoDecodeThread::closeDecoder()
     }
 
     m_streamIndex = -1;
+
+    clearPacketCache();
+    m_skipping = false;
+    m_catchingUp = false;
+    m_waitKeyframe = false;
 }
 
 void VideoDecodeThread::flush()
 {
     QMutexLocker locker(&m_flushMutex);
+    ++m_flushGeneration;
     if (m_codecContext) {
         // 刷新解码器
         avcodec_flush_buffers(m_codecContext);
@@ -120,6 +134,26 @@ void VideoDecodeThread::flush()
     if (m_frameQueue) {
         m_frameQueue->clear();
     }
+
+    // 跳转后旧的缓存不再有效，挂起时从跳转位置的关键帧重新缓存
+    clearPacketCache();
+    m_catchingUp = false;
+    m_waitKeyframe = false;
+}
+
+void VideoDecodeThread::setSync(AVSync *sync)
+{
+    m_avSync = sync;
+}
+
+void VideoDecodeThread::setTimebase(AVRational timebase)
+{
+    m_timebase = timebase;
+}
+
+void VideoDecodeThread::setSuspended(bool suspended)
+{
+    m_suspended.store(suspended, std::memory_order_relaxed);
 }
 
 void VideoDecodeThread::process()
@@ -129,8 +163,12 @@ void VideoDecodeThread::process()
         return;
     }
 
-    // 如果帧队列已满，等待
-    if (m_frameQueue->isFull()) {
+    const bool suspended = m_suspended.load(std::memory_order_relaxed);
+    if (!suspended && m_skipping)
+        resync();
+
+    // 如果帧队列已满，等待；挂起时不产出帧，须继续取包以免阻塞解复用和音频
+    if (!suspended && m_frameQueue->isFull()) {
         msleep(10);
         return;
     }
@@ -139,10 +177,22 @@ void VideoDecodeThread::process()
     // 从包队列中获取一个包
     AVPacket *packet = m_packetQueue->dequeue(10);
 
-    if (packet) {
+    if (packet && suspended) {
+        if (!m_skipping) {
+            // 刚进入挂起：已解码的帧不会再显示，释放掉
+            m_skipping = true;
+            m_frameQueue->clear();
+        }
+        cachePacket(packet);
+    } else if (packet && m_waitKeyframe && !(packet->flags & AV_PKT_FLAG_KEY)) {
+        PlayMetrics::add(PlayMetrics::Counter::VideoFramesDropped);
+        av_packet_free(&packet);
+    } else if (packet) {
+        m_waitKeyframe = false;
+
         // 解码包
         if (!decodePacket(packet)) {
-            qWarning() << "解码包失败";
+            PLAY_LOG_WARNING("解码包失败");
         }
 
         // 释放包
@@ -170,6 +220,10 @@ bool VideoDecodeThread::decodePacket(AVPacket *packet)
     if (!m_codecContext) {
         return false;
     }
+    PLAY_TRACE_SCOPE("VideoDecodeThread::decodePacket");
+
+    // 每帧耗时 = 距上一帧（或送包前）的时间，送包开销计入第一帧
+    int64_t frameStart = PlayMetrics::nowUs();
 
     // 发送包到解码器
     int ret = avcodec_send_packet(m_codecContext, packet);
@@ -177,7 +231,7 @@ bool VideoDecodeThread::decodePacket(AVPacket *packet)
         if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
             char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
             av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
-            qWarning() << "发送包到解码器失败:" << errbuf;
+            PLAY_LOG_WARNING("发送包到解码器失败: %s", errbuf);
             return false;
         }
     }
@@ -196,19 +250,38 @@ bool VideoDecodeThread::decodePacket(AVPacket *packet)
             av_frame_free(&frame);
             char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
             av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
-            qWarning() << "从解码器接收帧失败:" << errbuf;
+            PLAY_LOG_WARNING("从解码器接收帧失败: %s", errbuf);
             return false;
         }
 
+        const int64_t decoded = PlayMetrics::nowUs();
+        PlayMetrics::record(PlayMetrics::Histogram::VideoDecodeUs, decoded - frameStart);
+        PlayMetrics::add(PlayMetrics::Counter::VideoFramesDecoded);
+
+        // 恢复可见后追帧：早于时钟的帧不再送去渲染
+        if (m_catchingUp) {
+            const double clock = m_avSync ? m_avSync->getClock() : NAN;
+            if (timestampToSeconds(frame->pts) < clock) {
+                PlayMetrics::add(PlayMetrics::Counter::VideoFramesDropped);
+                av_frame_free(&frame);
+                frameStart = PlayMetrics::nowUs();
+                continue;
+            }
+            m_catchingUp = false;
+        }
+
         // 将解码后的帧放入帧队列
         if (!m_frameQueue->enqueue(frame)) {
-            qWarning() << "将帧放入队列失败";
+            PLAY_LOG_WARNING("将帧放入队列失败");
             av_frame_free(&frame);
             return false;
         }
 
+        PlayMetrics::set(PlayMetrics::Gauge::VideoFrameQueueDepth, m_frameQueue->size());
+
         // 释放帧
         av_frame_free(&frame);
+        frameStart = PlayMetrics::nowUs();
     }
 
     return true;
@@ -218,3 +291,96 @@ void VideoDecodeThread::cleanup()
 {
     closeDecoder();
 }
+
+void VideoDecodeThread::cachePacket(AVPacket *packet)
+{
+    if (m_waitKeyframe && !(packet->flags & AV_PKT_FLAG_KEY)) {
+        PlayMetrics::add(PlayMetrics::Counter::VideoFramesDropped);
+        av_packet_free(&packet);
+        return;
+    }
+    m_waitKeyframe = false;
+    m_packetCache.push_back(packet);
+
+    // 不晚于时钟的最后一个关键帧之前的包，恢复时已用不到
+    const double clock = m_avSync ? m_avSync->getClock() : NAN;
+    size_t       drop = 0;
+    for (size_t i = 1; i < m_packetCache.size(); ++i) {
+        const AVPacket *cached = m_packetCache[i];
+        const int64_t   ts = cached->pts != AV_NOPTS_VALUE ? cached->pts : cached->dts;
+        if ((cached->flags & AV_PKT_FLAG_KEY) && timestampToSeconds(ts) <= clock)
+            drop = i;
+    }
+    if (drop == 0 && m_packetCache.size() > kMaxCachedPackets) {
+        drop = m_packetCache.size();
+        m_waitKeyframe = true;
+    }
+
+    for (size_t i = 0; i < drop; ++i) {
+        av_packet_free(&m_packetCache.front());
+        m_packetCache.pop_front();
+        PlayMetrics::add(PlayMetrics::Counter::VideoFramesDropped);
+    }
+}
+
+void VideoDecodeThread::resync()
+{
+    PLAY_TRACE_SCOPE("VideoDecodeThread::resync");
+    std::deque<AVPacket *> packets;
+    uint64_t               generation = 0;
+    {
+        QMutexLocker locker(&m_flushMutex);
+        m_skipping = false;
+        m_frameQueue->clear();
+
+        // 缓存从关键帧开始时解码器从头解码；否则缓存紧接着挂起前送入的包，解码器状态仍然可用
+        const bool fromKeyframe = !m_packetCache.empty() && (m_packetCache.front()->flags & AV_PKT_FLAG_KEY);
+        if (fromKeyframe || m_waitKeyframe)
+            avcodec_flush_buffers(m_codecContext);
+
+        m_catchingUp = true;
+        packets.swap(m_packetCache);
+        generation = m_flushGeneration;
+    }
+
+    // 缓存可能有上千个包，不能整段持锁解码，否则跳转（flush）要等到追帧结束
+    while (!packets.empty() && m_running) {
+        QMutexLocker locker(&m_flushMutex);
+        if (m_flushGeneration != generation)
+            break; // 已跳转，剩余的包和解码器状态都已过时
+        if (m_suspended.load(std::memory_order_relaxed)) {
+            // 又被挂起：剩余的包放回缓存，下次恢复时接着解码
+            m_skipping = true;
+            m_frameQueue->clear();
+            m_packetCache.swap(packets);
+            return;
+        }
+        if (!m_catchingUp && m_frameQueue->isFull()) {
+            locker.unlock();
+            msleep(10);
+            continue;
+        }
+
+        AVPacket *packet = packets.front();
+        packets.pop_front();
+        decodePacket(packet);
+        av_packet_free(&packet);
+    }
+
+    for (AVPacket *packet : packets)
+        av_packet_free(&packet);
+}
+
+void VideoDecodeThread::clearPacketCache()
+{
+    for (AVPacket *packet : m_packetCache)
+        av_packet_free(&packet);
+    m_packetCache.clear();
+}
+
+double VideoDecodeThread::timestampToSeconds(int64_t ts) const
+{
+    if (ts == AV_NOPTS_VALUE || m_timebase.den == 0)
+        return NAN;
+    return ts * av_q2d(m_timebase);
+}
@@ -1,7 +1,10 @@
 #ifndef VIDEODECODETHREAD_H
 #define VIDEODECODETHREAD_H
 
+#include "avsync.h"
 #include "threadbase.h"
+
+#include <deque>
 #include <memory>
 
 extern "C" {
@@ -13,6 +16,9 @@ class AVFrameQueue;
 
 /**
  * @brief 视频解码线程类 - 负责将视频包解码为视频帧
+ *
+ * 窗口不可见时进入挂起状态：视频包不再送入解码器，只缓存同步时钟所在GOP（从不晚于时钟的最后一个关键帧起）
+ * 的压缩包，解码开销降为零。恢复可见时从缓存的关键帧重新解码，早于时钟的帧直接丢弃，追上时钟后恢复正常输出。
  */
 class VideoDecodeThread : public ThreadBase
 {
@@ -39,6 +45,13 @@ public:
     // 清空解码缓冲区
     void flush();
 
+    // 设置同步时钟与视频流时间基，挂起期间裁剪缓存和恢复时追帧使用
+    void setSync(AVSync *sync);
+    void setTimebase(AVRational timebase);
+
+    // 窗口不可见时挂起解码，恢复时追到当前时钟；可在任意线程调用
+    void setSuspended(bool suspended);
+
 signals:
     // 解码完成信号
     void decodeFinished();
@@ -57,6 +70,18 @@ private:
     // 清理资源
     void cleanup();
 
+    // 挂起期间缓存一个包（接管所有权），并丢弃时钟之前已不再需要的GOP
+    void cachePacket(AVPacket *packet);
+
+    // 恢复可见：从缓存的关键帧开始解码到当前时钟；逐包加锁，期间发生跳转时放弃剩余的包
+    void resync();
+
+    // 释放缓存的包
+    void clearPacketCache();
+
+    // 以秒为单位的时间戳，无效时返回NAN
+    double timestampToSeconds(int64_t ts) const;
+
 private:
     // 解码器相关
     AVCodecContext *m_codecContext{nullptr};
@@ -70,7 +95,17 @@ private:
     // 流索引
     int m_streamIndex{-1};
 
-    QMutex m_flushMutex;
+    QMutex   m_flushMutex;
+    uint64_t m_flushGeneration{0}; // 每次 flush 递增，受 m_flushMutex 保护
+
+    // 窗口可见性
+    AVSync                *m_avSync{nullptr};
+    AVRational             m_timebase{0, 1};
+    std::atomic<bool>      m_suspended{false};
+    bool                   m_skipping{false};     // 解码线程实际所处的挂起状态
+    bool                   m_catchingUp{false};   // 恢复后丢弃早于时钟的帧，直到追上
+    bool                   m_waitKeyframe{false}; // 缓存溢出后只能从下一个关键帧重新开始
+    std::deque<AVPacket *> m_packetCache;
 };
 
 #endif // VIDEODECODETHREAD_H
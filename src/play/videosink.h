@@ -0,0 +1,26 @@
+#ifndef VIDEOSINK_H
+#define VIDEOSINK_H
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+/**
+ * @brief 视频输出端接口 - 渲染线程只依赖此接口，由界面层（如SDLWidget）或无界面的测试/基准程序实现
+ */
+class VideoSink
+{
+public:
+    virtual ~VideoSink() = default;
+
+    // 初始化输出端（创建窗口、渲染器等），失败返回false
+    virtual bool initializeSink() = 0;
+
+    // 输出一帧，调用方保留帧的所有权
+    virtual void renderFrame(AVFrame *frame) = 0;
+
+    // 重置输出端状态（释放纹理等）
+    virtual void reset() = 0;
+};
+
+#endif // VIDEOSINK_H
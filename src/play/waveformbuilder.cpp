@@ -0,0 +1,488 @@
+#include "waveformbuilder.h"
+#include "playlog.h"
+
+#include <cmath>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+#include <libswresample/swresample.h>
+}
+
+// 每段的目标时长（毫秒），段数决定并行度
+static constexpr qint64 kSegmentMs = 20 * 1000;
+// 段数上限，超长文件的段相应变长
+static constexpr int kMaxSegments = 64;
+// 界面刷新合并间隔（毫秒）
+static constexpr int kUpdateIntervalMs = 100;
+// 磁盘缓存格式
+static constexpr quint32 kCacheMagic = 0x51574657; // "QWFW"
+static constexpr quint32 kCacheVersion = 1;
+
+WaveformPeak WaveformPeak::merge(const WaveformPeak &a, const WaveformPeak &b)
+{
+    if (!a.isValid())
+        return b;
+    if (!b.isValid())
+        return a;
+    WaveformPeak peak;
+    peak.min = qMin(a.min, b.min);
+    peak.max = qMax(a.max, b.max);
+    peak.rms = std::sqrt((a.rms * a.rms + b.rms * b.rms) * 0.5f);
+    return peak;
+}
+
+void WaveformData::reset(int baseBuckets)
+{
+    m_levels.clear();
+    m_filled = 0;
+    int count = qMax(1, baseBuckets);
+    m_levels.append(QVector<WaveformPeak>(count));
+    while (count > kMinBuckets) {
+        count = (count + 1) / 2;
+        m_levels.append(QVector<WaveformPeak>(count));
+    }
+}
+
+void WaveformData::clear()
+{
+    m_levels.clear();
+    m_filled = 0;
+}
+
+const QVector<WaveformPeak> &WaveformData::levelFor(int pixels) const
+{
+    for (int i = m_levels.size() - 1; i > 0; --i) {
+        if (m_levels.at(i).size() >= pixels)
+            return m_levels.at(i);
+    }
+    return m_levels.first();
+}
+
+void WaveformData::setRange(int first, const QVector<WaveformPeak> &peaks)
+{
+    if (m_levels.isEmpty() || peaks.isEmpty())
+        return;
+
+    QVector<WaveformPeak> &base = m_levels.first();
+    first = qBound(0, first, base.size());
+    int last = qMin(base.size(), first + peaks.size()); // 不含
+    for (int i = first; i < last; ++i) {
+        if (!base.at(i).isValid() && peaks.at(i - first).isValid())
+            ++m_filled;
+        base[i] = peaks.at(i - first);
+    }
+
+    // 逐级向上只重算受影响的父桶
+    for (int level = 1; level < m_levels.size() && first < last; ++level) {
+        const QVector<WaveformPeak> &child = m_levels.at(level - 1);
+        QVector<WaveformPeak>       &parent = m_levels[level];
+        first /= 2;
+        last = qMin(parent.size(), (last + 1) / 2);
+        for (int i = first; i < last; ++i) {
+            const int c = i * 2;
+            parent[i] = c + 1 < child.size() ? WaveformPeak::merge(child.at(c), child.at(c + 1)) : child.at(c);
+        }
+    }
+}
+
+namespace {
+
+/**
+ * @brief 一个段的解码参数：第0级桶 [firstBucket, firstBucket + bucketCount)
+ */
+struct SegmentJob
+{
+    int    firstBucket{0};
+    int    bucketCount{0};
+    double startSec{0.0};
+    double bucketsPerSec{0.0};
+};
+
+struct PeakAccumulator
+{
+    float  min{1.0f};
+    float  max{-1.0f};
+    double sumSquares{0.0};
+    qint64 samples{0};
+};
+
+/**
+ * @brief 解码文件中的一段音频并归约为波形桶
+ *
+ * 独立打开文件，向后定位到段起点所在的包，时间戳早于段起点的样本丢弃，落到段之后的桶即停止。
+ * 样本统一转换为平面浮点，各声道一起统计，不做下混，避免反相声道相互抵消。
+ */
+bool decodeSegment(const QString &path, const SegmentJob &job, const std::atomic<bool> &cancel, QVector<WaveformPeak> &peaks)
+{
+    AVFormatContext *format = nullptr;
+    if (avformat_open_input(&format, path.toUtf8().constData(), nullptr, nullptr) < 0)
+        return false;
+
+    bool                         ok = false;
+    AVCodecContext              *codec = nullptr;
+    SwrContext                  *swr = nullptr;
+    AVPacket                    *packet = av_packet_alloc();
+    AVFrame                     *frame = av_frame_alloc();
+    std::vector<PeakAccumulator> buckets(job.bucketCount);
+    std::vector<float>           samples;
+
+    do {
+        if (avformat_find_stream_info(format, nullptr) < 0)
+            break;
+        const int streamIndex = av_find_best_stream(format, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+        if (streamIndex < 0)
+            break;
+        AVStream      *stream = format->streams[streamIndex];
+        const AVCodec *decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+        if (!decoder)
+            break;
+        codec = avcodec_alloc_context3(decoder);
+        if (!codec || avcodec_parameters_to_context(codec, stream->codecpar) < 0)
+            break;
+        codec->thread_count = 1; // 并行度由线程池提供
+        if (avcodec_open2(codec, decoder, nullptr) < 0 || codec->channels <= 0 || codec->sample_rate <= 0)
+            break;
+
+        const int     channels = codec->channels;
+        const int64_t layout = codec->channel_layout ? int64_t(codec->channel_layout)
+                                                     : av_get_default_channel_layout(channels);
+        swr = swr_alloc_set_opts(nullptr,
+                                 layout,
+                                 AV_SAMPLE_FMT_FLTP,
+                                 codec->sample_rate,
+                                 layout,
+                                 codec->sample_fmt,
+                                 codec->sample_rate,
+                                 0,
+                                 nullptr);
+        if (!swr || swr_init(swr) < 0)
+            break;
+
+        const double  timeBase = av_q2d(stream->time_base);
+        const int64_t startPts = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+        if (job.startSec > 0.0)
+            av_seek_frame(format, streamIndex, startPts + int64_t(job.startSec / timeBase), AVSEEK_FLAG_BACKWARD);
+
+        double nextSec = job.startSec; // 帧没有时间戳时按样本数顺推
+        bool   flushed = false;
+        bool   done = false;
+        while (!done && !cancel.load(std::memory_order_relaxed)) {
+            if (!flushed) {
+                if (av_read_frame(format, packet) < 0) {
+                    avcodec_send_packet(codec, nullptr);
+                    flushed = true;
+                } else {
+                    const bool isAudio = packet->stream_index == streamIndex;
+                    if (isAudio)
+                        avcodec_send_packet(codec, packet);
+                    av_packet_unref(packet);
+                    if (!isAudio)
+                        continue;
+                }
+            }
+
+            while (!done && avcodec_receive_frame(codec, frame) >= 0) {
+                const int count = frame->nb_samples;
+                double    frameSec = nextSec;
+                if (frame->best_effort_timestamp != AV_NOPTS_VALUE)
+                    frameSec = (frame->best_effort_timestamp - startPts) * timeBase;
+                nextSec = frameSec + double(count) / codec->sample_rate;
+
+                // 中途格式变化的帧（少见）直接跳过
+                if (count <= 0 || frame->channels != channels || frame->format != codec->sample_fmt) {
+                    av_frame_unref(frame);
+                    continue;
+                }
+
+                samples.resize(size_t(channels) * count);
+                std::vector<uint8_t *> planes(channels);
+                for (int ch = 0; ch < channels; ++ch)
+                    planes[ch] = reinterpret_cast<uint8_t *>(samples.data() + size_t(ch) * count);
+                const int converted = swr_convert(swr,
+                                                  planes.data(),
+                                                  count,
+                                                  const_cast<const uint8_t **>(frame->extended_data),
+                                                  count);
+                av_frame_unref(frame);
+                if (converted <= 0)
+                    continue;
+
+                const double secPerSample = 1.0 / codec->sample_rate;
+                for (int i = 0; i < converted; ++i) {
+                    const int bucket = int(std::floor((frameSec + i * secPerSample) * job.bucketsPerSec)) - job.firstBucket;
+                    if (bucket < 0)
+                        continue;
+                    if (bucket >= job.bucketCount) {
+                        done = true;
+                        break;
+                    }
+                    PeakAccumulator &acc = buckets[bucket];
+                    for (int ch = 0; ch < channels; ++ch) {
+                        const float value = samples[size_t(ch) * count + i];
+                        acc.min = qMin(acc.min, value);
+                        acc.max = qMax(acc.max, value);
+                        acc.sumSquares += double(value) * value;
+                    }
+                    acc.samples += channels;
+                }
+            }
+            if (flushed)
+                done = true;
+        }
+        ok = !cancel.load(std::memory_order_relaxed);
+    } while (false);
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    swr_free(&swr);
+    avcodec_free_context(&codec);
+    avformat_close_input(&format);
+    if (!ok)
+        return false;
+
+    peaks.resize(job.bucketCount);
+    for (int i = 0; i < job.bucketCount; ++i) {
+        const PeakAccumulator &acc = buckets[i];
+        if (acc.samples == 0)
+            continue; // 定位偏差或流提前结束，保持未解码
+        peaks[i].min = qBound(-1.0f, acc.min, 1.0f);
+        peaks[i].max = qBound(-1.0f, acc.max, 1.0f);
+        peaks[i].rms = qMin(1.0f, float(std::sqrt(acc.sumSquares / acc.samples)));
+    }
+    return true;
+}
+
+// 按二分顺序排列段号（0, n/2, n/4, 3n/4, ...），先完成的段均匀分布在时间轴上
+QVector<int> refinementOrder(int count)
+{
+    int bits = 0;
+    while ((1 << bits) < count)
+        ++bits;
+
+    QVector<int> order;
+    order.reserve(count);
+    for (int i = 0; i < (1 << bits); ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b))
+                reversed |= 1 << (bits - 1 - b);
+        }
+        if (reversed < count)
+            order.append(reversed);
+    }
+    return order;
+}
+
+} // namespace
+
+/**
+ * @brief WaveformSegmentTask - 线程池中的单段解码任务
+ */
+class WaveformSegmentTask : public QRunnable
+{
+public:
+    WaveformSegmentTask(WaveformBuilder                   *builder,
+                        int                                serial,
+                        const QString                     &path,
+                        const SegmentJob                  &job,
+                        std::shared_ptr<std::atomic<bool>> cancel)
+        : m_builder(builder)
+        , m_serial(serial)
+        , m_path(path)
+        , m_job(job)
+        , m_cancel(std::move(cancel))
+    {}
+
+    void run() override
+    {
+        if (m_cancel->load(std::memory_order_relaxed))
+            return;
+
+        QVector<WaveformPeak> peaks;
+        const bool            ok = decodeSegment(m_path, m_job, *m_cancel, peaks);
+
+        if (m_cancel->load(std::memory_order_relaxed))
+            return;
+        // 生成器析构前会取消并等待线程池，此处指针一定有效
+        WaveformBuilder *builder = m_builder;
+        QMetaObject::invokeMethod(
+            builder,
+            [builder, serial = m_serial, first = m_job.firstBucket, peaks, ok]() {
+                builder->onSegmentReady(serial, first, peaks, ok);
+            },
+            Qt::QueuedConnection);
+    }
+
+private:
+    WaveformBuilder                   *m_builder;
+    int                                m_serial;
+    QString                            m_path;
+    SegmentJob                         m_job;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+
+WaveformBuilder::WaveformBuilder(QObject *parent)
+    : QObject(parent)
+    , m_cancel(std::make_shared<std::atomic<bool>>(false))
+{
+    m_cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/waveforms";
+    QDir().mkpath(m_cacheDir);
+
+    // 与播放同时进行，只占用一半核心
+    m_workers.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(kUpdateIntervalMs);
+    connect(&m_updateTimer, &QTimer::timeout, this, &WaveformBuilder::sigUpdated);
+}
+
+WaveformBuilder::~WaveformBuilder()
+{
+    m_cancel->store(true, std::memory_order_relaxed);
+    m_workers.clear();
+    m_workers.waitForDone();
+}
+
+void WaveformBuilder::request(const QString &path, qint64 durationMs)
+{
+    cancel();
+    if (path.isEmpty() || durationMs <= 0)
+        return;
+
+    // 文件被替换或修改后键随之变化，旧缓存自然失效
+    const QFileInfo info(path);
+    const QString   key = info.absoluteFilePath() + '|' + QString::number(info.size()) + '|'
+                        + QString::number(info.lastModified().toMSecsSinceEpoch()) + '|'
+                        + QString::number(WaveformData::kBaseBuckets);
+    const QString cacheFile = m_cacheDir + "/" + QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex()
+                              + ".wfm";
+
+    m_durationMs = durationMs;
+    if (loadCache(cacheFile, durationMs)) {
+        emit sigUpdated();
+        return;
+    }
+
+    m_cacheFile = cacheFile;
+    m_data.reset(WaveformData::kBaseBuckets);
+
+    const int    buckets = m_data.bucketCount();
+    const int    segments = int(qBound<qint64>(1, (durationMs + kSegmentMs - 1) / kSegmentMs, kMaxSegments));
+    const double bucketsPerSec = buckets / (durationMs / 1000.0);
+    for (int index : refinementOrder(segments)) {
+        SegmentJob job;
+        job.firstBucket = int(qint64(buckets) * index / segments);
+        job.bucketCount = int(qint64(buckets) * (index + 1) / segments) - job.firstBucket;
+        job.startSec = job.firstBucket / bucketsPerSec;
+        job.bucketsPerSec = bucketsPerSec;
+        // 优先级递减，线程池按二分顺序取任务
+        m_workers.start(new WaveformSegmentTask(this, m_serial, path, job, m_cancel), segments - m_pending);
+        ++m_pending;
+    }
+}
+
+void WaveformBuilder::cancel()
+{
+    m_cancel->store(true, std::memory_order_relaxed);
+    m_workers.clear();
+    m_cancel = std::make_shared<std::atomic<bool>>(false);
+
+    ++m_serial;
+    m_pending = 0;
+    m_failed = false;
+    m_cacheFile.clear();
+    m_durationMs = 0;
+    m_updateTimer.stop();
+    if (!m_data.isEmpty()) {
+        m_data.clear();
+        emit sigUpdated();
+    }
+}
+
+void WaveformBuilder::onSegmentReady(int serial, int firstBucket, const QVector<WaveformPeak> &peaks, bool ok)
+{
+    if (serial != m_serial)
+        return; // 已切换文件
+
+    --m_pending;
+    if (ok)
+        m_data.setRange(firstBucket, peaks);
+    else
+        m_failed = true;
+
+    if (m_pending == 0) {
+        // 没有音频流或无法解码时保持空白，播放进度条回退为普通样式
+        if (m_data.filledBuckets() == 0) {
+            PLAY_LOG_WARNING("waveform: no audio decoded");
+            m_data.clear();
+        } else if (!m_failed && !saveCache(m_cacheFile, m_durationMs)) {
+            PLAY_LOG_WARNING("waveform: write cache failed");
+        }
+        m_updateTimer.stop();
+        emit sigUpdated();
+        return;
+    }
+    scheduleUpdate();
+}
+
+bool WaveformBuilder::loadCache(const QString &file, qint64 durationMs)
+{
+    QFile cache(file);
+    if (!cache.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&cache);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    quint32 magic = 0, version = 0;
+    qint64  cachedDuration = 0;
+    qint32  buckets = 0;
+    stream >> magic >> version >> cachedDuration >> buckets;
+    if (magic != kCacheMagic || version != kCacheVersion || cachedDuration != durationMs
+        || buckets != WaveformData::kBaseBuckets)
+        return false;
+
+    QVector<WaveformPeak> peaks(buckets);
+    for (WaveformPeak &peak : peaks)
+        stream >> peak.min >> peak.max >> peak.rms;
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    m_data.reset(buckets);
+    m_data.setRange(0, peaks);
+    return true;
+}
+
+bool WaveformBuilder::saveCache(const QString &file, qint64 durationMs) const
+{
+    QSaveFile cache(file);
+    if (!cache.open(QIODevice::WriteOnly))
+        return false;
+
+    // 只保存第0级，其余级别读取时重新合并
+    QDataStream stream(&cache);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    const QVector<WaveformPeak> &peaks = m_data.level(0);
+    stream << kCacheMagic << kCacheVersion << durationMs << qint32(peaks.size());
+    for (const WaveformPeak &peak : peaks)
+        stream << peak.min << peak.max << peak.rms;
+    return stream.status() == QDataStream::Ok && cache.commit();
+}
+
+void WaveformBuilder::scheduleUpdate()
+{
+    if (!m_updateTimer.isActive())
+        m_updateTimer.start();
+}
@@ -0,0 +1,110 @@
+#ifndef WAVEFORMBUILDER_H
+#define WAVEFORMBUILDER_H
+
+#include <atomic>
+#include <memory>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * @brief 波形桶 - 一段时间内的最小/最大采样值与均方根，取值范围[-1, 1]
+ */
+struct WaveformPeak
+{
+    float min{1.0f}; // min > max 表示该桶尚未解码
+    float max{-1.0f};
+    float rms{0.0f};
+
+    bool isValid() const { return min <= max; }
+
+    // 合并两个相邻桶，任一未解码时取另一个（渐进显示时空缺不拉低波形）
+    static WaveformPeak merge(const WaveformPeak &a, const WaveformPeak &b);
+};
+
+/**
+ * @brief 多分辨率波形（mipmap）
+ *
+ * 第0级为固定桶数的最细一级，其后每一级由上一级两两合并得到，直到桶数不超过 kMinBuckets。
+ * 绘制时按像素宽度选取桶数不少于像素数的最粗一级，每像素只需合并少量桶。
+ */
+class WaveformData
+{
+public:
+    static constexpr int kBaseBuckets = 8192;
+    static constexpr int kMinBuckets = 64;
+
+    void reset(int baseBuckets = kBaseBuckets);
+    void clear();
+
+    bool isEmpty() const { return m_levels.isEmpty(); }
+    int  levelCount() const { return m_levels.size(); }
+    int  bucketCount() const { return m_levels.isEmpty() ? 0 : m_levels.first().size(); }
+    int  filledBuckets() const { return m_filled; }
+
+    const QVector<WaveformPeak> &level(int index) const { return m_levels.at(index); }
+
+    // 桶数不少于 pixels 的最粗一级；都不够时返回第0级
+    const QVector<WaveformPeak> &levelFor(int pixels) const;
+
+    // 写入第0级 [first, first + peaks.size()) 的桶，并更新各级中受影响的范围
+    void setRange(int first, const QVector<WaveformPeak> &peaks);
+
+private:
+    QVector<QVector<WaveformPeak>> m_levels;
+    int                            m_filled{0};
+};
+
+/**
+ * @brief 波形概览生成服务
+ *
+ * 使用独立于播放管线的解码器读取音频流：按时长切分为若干段，每段在工作线程池中各自打开文件、
+ * 定位并解码，归约为第0级的 最小/最大/RMS 桶后回投到GUI线程合并进 WaveformData。
+ * 段按二分顺序提交，先得到分布在整条时间轴上的粗略轮廓，再逐步填满；更新合并为一次 sigUpdated。
+ * 完整结果以 路径+大小+修改时间 为键写入磁盘缓存，再次打开时直接读取。
+ */
+class WaveformBuilder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WaveformBuilder(QObject *parent = nullptr);
+    ~WaveformBuilder();
+
+    // 为文件生成波形，durationMs 为媒体时长（决定桶与时间的对应关系）；会取消上一次请求
+    void request(const QString &path, qint64 durationMs);
+
+    // 取消生成并清空波形
+    void cancel();
+
+    const WaveformData &data() const { return m_data; }
+    bool                isComplete() const { return !m_data.isEmpty() && m_pending == 0; }
+
+signals:
+    // 波形有新内容（已合并）
+    void sigUpdated();
+
+private:
+    void onSegmentReady(int serial, int firstBucket, const QVector<WaveformPeak> &peaks, bool ok);
+    bool loadCache(const QString &file, qint64 durationMs);
+    bool saveCache(const QString &file, qint64 durationMs) const;
+    void scheduleUpdate();
+
+    friend class WaveformSegmentTask;
+
+private:
+    WaveformData m_data;
+    QString      m_cacheDir;
+    QString      m_cacheFile; // 当前请求的缓存文件，生成完成后写入
+    qint64       m_durationMs{0};
+    int          m_serial{0};     // 请求序号，丢弃过期请求的结果
+    int          m_pending{0};    // 尚未返回的段数
+    bool         m_failed{false}; // 有段解码失败，结果不写缓存
+
+    QThreadPool                        m_workers;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+    QTimer                             m_updateTimer;
+};
+
+#endif // WAVEFORMBUILDER_H
@@ -0,0 +1,222 @@
+/**
+ * @brief DSP微基准
+ *
+ * 对音频DSP链的各处理级（前级、10段均衡、低音增强、整条链、浮点转S16）按块测量耗时，
+ * 输出每块耗时分布、每帧纳秒数与实时倍率（JSON），用于在改动滤波器实现前后做回归对比。
+ * 参数变化的处理级在每块开始时切换目标增益，覆盖平滑过渡（重算系数）的路径。
+ */
+#include "dspchain.h"
+#include "equalizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now().time_since_epoch()).count();
+}
+
+struct BenchConfig
+{
+    int sampleRate;
+    int channels;
+    int blockFrames;
+    int blocks;
+};
+
+// 白噪声输入，每块处理前复制一份，避免滤波结果累积
+std::vector<float> makeInput(const BenchConfig &config)
+{
+    std::vector<float> input(size_t(config.blockFrames) * config.channels);
+    uint32_t           seed = 0x12345678u;
+    for (float &sample : input) {
+        seed = seed * 1664525u + 1013904223u;
+        sample = (float(seed >> 8) / float(1u << 24) - 0.5f) * 0.5f;
+    }
+    return input;
+}
+
+QJsonObject measure(const BenchConfig &config, const std::function<void(float *, int, int)> &process)
+{
+    const std::vector<float> input = makeInput(config);
+    std::vector<float>       block(input.size());
+    std::vector<int64_t>     durations;
+    durations.reserve(config.blocks);
+
+    // 预热：填充缓存与滤波器状态
+    for (int i = 0; i < 16; ++i) {
+        std::copy(input.begin(), input.end(), block.begin());
+        process(block.data(), config.blockFrames, -1 - i);
+    }
+    for (int i = 0; i < config.blocks; ++i) {
+        std::copy(input.begin(), input.end(), block.begin());
+        const int64_t start = nowNs();
+        process(block.data(), config.blockFrames, i);
+        durations.push_back(nowNs() - start);
+    }
+
+    std::sort(durations.begin(), durations.end());
+    auto percentile = [&durations](double p) {
+        size_t idx = static_cast<size_t>(p * (durations.size() - 1) + 0.5);
+        return static_cast<qint64>(durations[std::min(idx, durations.size() - 1)]);
+    };
+    double total = 0.0;
+    for (int64_t ns : durations)
+        total += double(ns);
+    const double meanNs = total / durations.size();
+    const double blockNs = 1e9 * config.blockFrames / config.sampleRate;
+
+    QJsonObject obj;
+    QJsonObject timing;
+    timing["mean"] = meanNs;
+    timing["p50"] = percentile(0.50);
+    timing["p99"] = percentile(0.99);
+    timing["max"] = static_cast<qint64>(durations.back());
+    obj["block_ns"] = timing;
+    obj["ns_per_frame"] = meanNs / config.blockFrames;
+    obj["realtime_factor"] = meanNs > 0.0 ? blockNs / meanNs : 0.0;
+    obj["cpu_percent"] = 100.0 * meanNs / blockNs;
+    return obj;
+}
+
+// 静态参数：增益固定，测量稳态；ramp 为true时每块交替切换目标增益，测量过渡路径
+QJsonObject benchStage(const BenchConfig &config, DspStage &stage, const std::function<void(bool)> &setGains, bool ramp)
+{
+    stage.prepare(config.sampleRate, config.channels);
+    setGains(false);
+    return measure(config, [&](float *samples, int frames, int index) {
+        if (ramp)
+            setGains(index & 1);
+        stage.process(samples, frames);
+    });
+}
+
+QJsonObject benchEqualizer(const BenchConfig &config, bool ramp)
+{
+    EqualizerStage equalizer;
+    return benchStage(
+        config,
+        equalizer,
+        [&](bool alternate) {
+            for (int i = 0; i < EqualizerStage::kBands; ++i)
+                equalizer.setGainDb(i, float(((i & 1) ? 6 : -6) * (alternate ? -1 : 1)));
+        },
+        ramp);
+}
+
+QJsonObject benchBassBoost(const BenchConfig &config, bool ramp)
+{
+    BassBoostStage bassBoost;
+    return benchStage(
+        config, bassBoost, [&](bool alternate) { bassBoost.setGainDb(0, alternate ? 3.0f : 9.0f); }, ramp);
+}
+
+QJsonObject benchPreamp(const BenchConfig &config, bool ramp)
+{
+    PreampStage preamp;
+    return benchStage(
+        config, preamp, [&](bool alternate) { preamp.setGainDb(alternate ? -3.0f : -6.0f); }, ramp);
+}
+
+QJsonObject benchChain(const BenchConfig &config, bool flat)
+{
+    DspChain chain;
+    auto     preamp = std::make_unique<PreampStage>();
+    auto     equalizer = std::make_unique<EqualizerStage>();
+    auto     bassBoost = std::make_unique<BassBoostStage>();
+    if (!flat) {
+        preamp->setGainDb(-6.0f);
+        for (int i = 0; i < EqualizerStage::kBands; ++i)
+            equalizer->setGainDb(i, float((i & 1) ? 4 : -4));
+        bassBoost->setGainDb(0, 6.0f);
+    }
+    chain.addStage(std::move(preamp));
+    chain.addStage(std::move(equalizer));
+    chain.addStage(std::move(bassBoost));
+    chain.prepare(config.sampleRate, config.channels);
+    return measure(config, [&](float *samples, int frames, int) { chain.process(samples, frames); });
+}
+
+// 与音频渲染线程中相同的饱和转换
+QJsonObject benchToS16(const BenchConfig &config)
+{
+    std::vector<int16_t> pcm(size_t(config.blockFrames) * config.channels);
+    return measure(config, [&](float *samples, int frames, int) {
+        const int count = frames * config.channels;
+        for (int i = 0; i < count; ++i)
+            pcm[i] = int16_t(std::min(std::max(samples[i] * 32768.0f, -32768.0f), 32767.0f));
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Per-block CPU benchmarks for the QWaveBox audio DSP stages");
+    parser.addHelpOption();
+    QCommandLineOption rateOpt("rate", "Sample rate (default 48000)", "hz", "48000");
+    QCommandLineOption channelsOpt("channels", "Channel count, 1-8 (default 2)", "n", "2");
+    QCommandLineOption blockOpt("block", "Frames per block; may be repeated (default 256, 1024, 4096)", "n");
+    QCommandLineOption blocksOpt("blocks", "Measured blocks per case (default 2000)", "n", "2000");
+    parser.addOption(rateOpt);
+    parser.addOption(channelsOpt);
+    parser.addOption(blockOpt);
+    parser.addOption(blocksOpt);
+    parser.process(app);
+
+    QList<int> blockSizes;
+    for (const QString &value : parser.values(blockOpt))
+        blockSizes.append(qMax(1, value.toInt()));
+    if (blockSizes.isEmpty())
+        blockSizes = {256, 1024, 4096};
+
+    QJsonArray results;
+    for (int blockFrames : blockSizes) {
+        BenchConfig config;
+        config.sampleRate = qMax(8000, parser.value(rateOpt).toInt());
+        config.channels = qBound(1, parser.value(channelsOpt).toInt(), DspChain::kMaxChannels);
+        config.blockFrames = blockFrames;
+        config.blocks = qMax(1, parser.value(blocksOpt).toInt());
+
+        QJsonObject cases;
+        cases["preamp"] = benchPreamp(config, false);
+        cases["preamp_ramp"] = benchPreamp(config, true);
+        cases["equalizer"] = benchEqualizer(config, false);
+        cases["equalizer_ramp"] = benchEqualizer(config, true);
+        cases["bass_boost"] = benchBassBoost(config, false);
+        cases["bass_boost_ramp"] = benchBassBoost(config, true);
+        cases["chain_flat"] = benchChain(config, true);
+        cases["chain"] = benchChain(config, false);
+        cases["to_s16"] = benchToS16(config);
+
+        QJsonObject entry;
+        entry["sample_rate"] = config.sampleRate;
+        entry["channels"] = config.channels;
+        entry["block_frames"] = config.blockFrames;
+        entry["cases"] = cases;
+        results.append(entry);
+    }
+
+    QJsonObject report;
+    report["results"] = results;
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    fwrite(json.constData(), 1, json.size(), stdout);
+    return 0;
+}
@@ -0,0 +1,566 @@
+/**
+ * @brief 合成测试素材生成器
+ *
+ * 使用 libavformat/libavcodec 编码器生成带帧号条码与整秒提示音的测试片段，覆盖不同编码器、GOP长度、
+ * 可变帧率、纯音频、纯视频以及音视频交织错乱等情况，并为每个片段写出描述其内容的清单（<片段>.json），
+ * 供 qwavebox_playcheck 做确定性的回归校验。
+ */
+#include "syntheticmedia.h"
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/error.h>
+}
+
+namespace {
+
+/**
+ * @brief 片段描述 - 视频/音频编码器为空表示不生成对应的流
+ */
+struct ClipSpec
+{
+    QString name;
+    QString videoCodec{"mpeg4"};
+    QString audioCodec{"mp2"};
+    int     width{320};
+    int     height{240};
+    int     fps{25};
+    int     gop{12};
+    int     bframes{0};
+    bool    vfr{false};
+    int     durationSec{10};
+    int     sampleRate{48000};
+    int     channels{2};
+    int     interleaveSkewMs{0}; // >0 时音频包整体推迟写入，制造错乱的交织
+};
+
+// 可变帧率模式下的帧时长系数（相对于1/fps），循环使用
+constexpr double kVfrPattern[] = {0.5, 1.5, 1.0};
+
+QString errorString(int err)
+{
+    char buf[AV_ERROR_MAX_STRING_SIZE] = {0};
+    av_strerror(err, buf, sizeof(buf));
+    return QString::fromUtf8(buf);
+}
+
+void writeSample(AVFrame *frame, int ch, int i, double v)
+{
+    auto format = static_cast<AVSampleFormat>(frame->format);
+    bool planar = av_sample_fmt_is_planar(format);
+    int  idx = planar ? i : i * frame->channels + ch;
+    auto data = frame->extended_data[planar ? ch : 0];
+    switch (av_get_packed_sample_fmt(format)) {
+    case AV_SAMPLE_FMT_U8:
+        data[idx] = static_cast<uint8_t>(v * 127 + 128);
+        break;
+    case AV_SAMPLE_FMT_S16:
+        reinterpret_cast<int16_t *>(data)[idx] = static_cast<int16_t>(v * 32767);
+        break;
+    case AV_SAMPLE_FMT_S32:
+        reinterpret_cast<int32_t *>(data)[idx] = static_cast<int32_t>(v * 2147483647.0);
+        break;
+    case AV_SAMPLE_FMT_FLT:
+        reinterpret_cast<float *>(data)[idx] = static_cast<float>(v);
+        break;
+    case AV_SAMPLE_FMT_DBL:
+        reinterpret_cast<double *>(data)[idx] = v;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief 片段写入器 - 负责一个输出文件的编码与封装
+ */
+class ClipWriter
+{
+public:
+    explicit ClipWriter(const ClipSpec &spec)
+        : m_spec(spec)
+    {}
+    ~ClipWriter() { cleanup(); }
+
+    bool write(const QString &path);
+
+    int videoFrames() const { return m_videoFrames; }
+    int beeps() const { return m_beeps; }
+
+private:
+    bool openVideo();
+    bool openAudio();
+    bool encode(AVCodecContext *enc, AVStream *st, AVFrame *frame);
+    bool writePacket(AVPacket *pkt);
+    bool flushDelayedAudio(double untilSec);
+    bool nextVideoFrame();
+    bool nextAudioFrame();
+    void cleanup();
+
+    double videoTime() const { return m_videoPts * av_q2d(m_videoEnc->time_base); }
+    double audioTime() const { return m_audioPts / static_cast<double>(m_spec.sampleRate); }
+
+private:
+    ClipSpec         m_spec;
+    AVFormatContext *m_oc{nullptr};
+    AVCodecContext  *m_videoEnc{nullptr};
+    AVCodecContext  *m_audioEnc{nullptr};
+    AVStream        *m_videoStream{nullptr};
+    AVStream        *m_audioStream{nullptr};
+    AVFrame         *m_videoFrame{nullptr};
+    AVFrame         *m_audioFrame{nullptr};
+    AVPacket        *m_packet{nullptr};
+
+    int64_t m_videoPts{0};
+    int64_t m_audioPts{0};
+    int     m_videoFrames{0};
+    int     m_beeps{0};
+    int64_t m_lastSecond{-1};
+
+    std::deque<AVPacket *> m_delayedAudio; // 错乱交织时暂存的音频包
+};
+
+bool ClipWriter::write(const QString &path)
+{
+    int ret = avformat_alloc_output_context2(&m_oc, nullptr, nullptr, path.toUtf8().constData());
+    if (ret < 0 || !m_oc) {
+        fprintf(stderr, "cannot create muxer for %s: %s\n", qPrintable(path), qPrintable(errorString(ret)));
+        return false;
+    }
+
+    if (!m_spec.videoCodec.isEmpty() && !openVideo())
+        return false;
+    if (!m_spec.audioCodec.isEmpty() && !openAudio())
+        return false;
+
+    m_packet = av_packet_alloc();
+
+    if (!(m_oc->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&m_oc->pb, path.toUtf8().constData(), AVIO_FLAG_WRITE);
+        if (ret < 0) {
+            fprintf(stderr, "cannot open %s: %s\n", qPrintable(path), qPrintable(errorString(ret)));
+            return false;
+        }
+    }
+    ret = avformat_write_header(m_oc, nullptr);
+    if (ret < 0) {
+        fprintf(stderr, "write header failed: %s\n", qPrintable(errorString(ret)));
+        return false;
+    }
+
+    // 按时间交替生成音视频帧
+    bool videoDone = !m_videoEnc;
+    bool audioDone = !m_audioEnc;
+    while (!videoDone || !audioDone) {
+        bool pickVideo = !videoDone && (audioDone || videoTime() <= audioTime());
+        if (pickVideo) {
+            if (!nextVideoFrame())
+                videoDone = true;
+        } else if (!nextAudioFrame()) {
+            audioDone = true;
+        }
+    }
+
+    // 冲刷编码器
+    if (m_videoEnc && !encode(m_videoEnc, m_videoStream, nullptr))
+        return false;
+    if (m_audioEnc && !encode(m_audioEnc, m_audioStream, nullptr))
+        return false;
+    if (!flushDelayedAudio(1e9))
+        return false;
+
+    ret = av_write_trailer(m_oc);
+    if (ret < 0) {
+        fprintf(stderr, "write trailer failed: %s\n", qPrintable(errorString(ret)));
+        return false;
+    }
+    return true;
+}
+
+bool ClipWriter::openVideo()
+{
+    const AVCodec *codec = avcodec_find_encoder_by_name(m_spec.videoCodec.toUtf8().constData());
+    if (!codec) {
+        fprintf(stderr, "video encoder %s not available\n", qPrintable(m_spec.videoCodec));
+        return false;
+    }
+
+    m_videoStream = avformat_new_stream(m_oc, nullptr);
+    m_videoEnc = avcodec_alloc_context3(codec);
+    m_videoEnc->width = m_spec.width;
+    m_videoEnc->height = m_spec.height;
+    m_videoEnc->time_base = m_spec.vfr ? AVRational{1, 1000} : AVRational{1, m_spec.fps};
+    m_videoEnc->framerate = AVRational{m_spec.fps, 1};
+    m_videoEnc->gop_size = m_spec.gop;
+    m_videoEnc->max_b_frames = m_spec.bframes;
+    m_videoEnc->bit_rate = 2000000;
+    m_videoEnc->pix_fmt = AV_PIX_FMT_YUV420P;
+    if (codec->pix_fmts) {
+        // mjpeg 等编码器只接受全范围的 YUVJ420P，内存布局相同
+        bool supported = false;
+        for (const AVPixelFormat *p = codec->pix_fmts; *p != AV_PIX_FMT_NONE; ++p)
+            supported |= (*p == AV_PIX_FMT_YUV420P);
+        if (!supported)
+            m_videoEnc->pix_fmt = codec->pix_fmts[0];
+    }
+    if (m_oc->oformat->flags & AVFMT_GLOBALHEADER)
+        m_videoEnc->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+    int ret = avcodec_open2(m_videoEnc, codec, nullptr);
+    if (ret < 0) {
+        fprintf(stderr, "open video encoder failed: %s\n", qPrintable(errorString(ret)));
+        return false;
+    }
+    avcodec_parameters_from_context(m_videoStream->codecpar, m_videoEnc);
+    m_videoStream->time_base = m_videoEnc->time_base;
+    if (!m_spec.vfr)
+        m_videoStream->avg_frame_rate = m_videoEnc->framerate;
+
+    m_videoFrame = av_frame_alloc();
+    m_videoFrame->format = m_videoEnc->pix_fmt;
+    m_videoFrame->width = m_spec.width;
+    m_videoFrame->height = m_spec.height;
+    return av_frame_get_buffer(m_videoFrame, 0) >= 0;
+}
+
+bool ClipWriter::openAudio()
+{
+    const AVCodec *codec = avcodec_find_encoder_by_name(m_spec.audioCodec.toUtf8().constData());
+    if (!codec) {
+        fprintf(stderr, "audio encoder %s not available\n", qPrintable(m_spec.audioCodec));
+        return false;
+    }
+
+    m_audioStream = avformat_new_stream(m_oc, nullptr);
+    m_audioEnc = avcodec_alloc_context3(codec);
+    m_audioEnc->sample_rate = m_spec.sampleRate;
+    m_audioEnc->channels = m_spec.channels;
+    m_audioEnc->channel_layout = av_get_default_channel_layout(m_spec.channels);
+    m_audioEnc->sample_fmt = codec->sample_fmts ? codec->sample_fmts[0] : AV_SAMPLE_FMT_S16;
+    m_audioEnc->bit_rate = 192000;
+    m_audioEnc->time_base = AVRational{1, m_spec.sampleRate};
+    if (m_oc->oformat->flags & AVFMT_GLOBALHEADER)
+        m_audioEnc->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+    int ret = avcodec_open2(m_audioEnc, codec, nullptr);
+    if (ret < 0) {
+        fprintf(stderr, "open audio encoder failed: %s\n", qPrintable(errorString(ret)));
+        return false;
+    }
+    avcodec_parameters_from_context(m_audioStream->codecpar, m_audioEnc);
+    m_audioStream->time_base = m_audioEnc->time_base;
+
+    m_audioFrame = av_frame_alloc();
+    m_audioFrame->format = m_audioEnc->sample_fmt;
+    m_audioFrame->channels = m_audioEnc->channels;
+    m_audioFrame->channel_layout = m_audioEnc->channel_layout;
+    m_audioFrame->sample_rate = m_audioEnc->sample_rate;
+    // PCM等可变帧长编码器没有固定frame_size
+    m_audioFrame->nb_samples = m_audioEnc->frame_size > 0 ? m_audioEnc->frame_size : 1024;
+    return av_frame_get_buffer(m_audioFrame, 0) >= 0;
+}
+
+bool ClipWriter::nextVideoFrame()
+{
+    double t = videoTime();
+    if (t >= m_spec.durationSec)
+        return false;
+
+    if (av_frame_make_writable(m_videoFrame) < 0)
+        return false;
+
+    // 每个整秒后的第一帧带闪光标记
+    int64_t second = static_cast<int64_t>(t);
+    bool    flash = second != m_lastSecond;
+    m_lastSecond = second;
+
+    synthetic::drawMarkers(m_videoFrame, m_videoFrames, flash);
+    for (int plane = 1; plane <= 2; ++plane) {
+        int rows = (m_videoFrame->height + 1) / 2;
+        for (int y = 0; y < rows; ++y)
+            memset(m_videoFrame->data[plane] + y * m_videoFrame->linesize[plane], 128, m_videoFrame->linesize[plane]);
+    }
+    m_videoFrame->pts = m_videoPts;
+
+    if (m_spec.vfr) {
+        double factor = kVfrPattern[m_videoFrames % (sizeof(kVfrPattern) / sizeof(kVfrPattern[0]))];
+        m_videoPts += qMax<int64_t>(1, static_cast<int64_t>(1000.0 * factor / m_spec.fps + 0.5));
+    } else {
+        m_videoPts += 1;
+    }
+    ++m_videoFrames;
+
+    return encode(m_videoEnc, m_videoStream, m_videoFrame);
+}
+
+bool ClipWriter::nextAudioFrame()
+{
+    if (audioTime() >= m_spec.durationSec)
+        return false;
+
+    if (av_frame_make_writable(m_audioFrame) < 0)
+        return false;
+
+    for (int i = 0; i < m_audioFrame->nb_samples; ++i) {
+        int64_t n = m_audioPts + i;
+        if (n % m_spec.sampleRate == 0)
+            ++m_beeps;
+        double v = synthetic::toneSample(n, m_spec.sampleRate);
+        for (int ch = 0; ch < m_spec.channels; ++ch)
+            writeSample(m_audioFrame, ch, i, v);
+    }
+    m_audioFrame->pts = m_audioPts;
+    m_audioPts += m_audioFrame->nb_samples;
+
+    return encode(m_audioEnc, m_audioStream, m_audioFrame);
+}
+
+bool ClipWriter::encode(AVCodecContext *enc, AVStream *st, AVFrame *frame)
+{
+    int ret = avcodec_send_frame(enc, frame);
+    if (ret < 0 && ret != AVERROR_EOF) {
+        fprintf(stderr, "encode failed: %s\n", qPrintable(errorString(ret)));
+        return false;
+    }
+
+    while ((ret = avcodec_receive_packet(enc, m_packet)) >= 0) {
+        av_packet_rescale_ts(m_packet, enc->time_base, st->time_base);
+        m_packet->stream_index = st->index;
+        if (!writePacket(m_packet))
+            return false;
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+}
+
+bool ClipWriter::writePacket(AVPacket *pkt)
+{
+    if (m_spec.interleaveSkewMs <= 0) {
+        int ret = av_interleaved_write_frame(m_oc, pkt);
+        av_packet_unref(pkt);
+        return ret >= 0;
+    }
+
+    // 错乱交织：音频包推迟到视频时间越过 pts + skew 之后才写入，且不经过封装器的交织缓冲
+    if (m_audioStream && pkt->stream_index == m_audioStream->index) {
+        m_delayedAudio.push_back(av_packet_clone(pkt));
+        av_packet_unref(pkt);
+        return true;
+    }
+
+    double now = pkt->dts * av_q2d(m_oc->streams[pkt->stream_index]->time_base);
+    int    ret = av_write_frame(m_oc, pkt);
+    av_packet_unref(pkt);
+    if (ret < 0)
+        return false;
+    return flushDelayedAudio(now - m_spec.interleaveSkewMs / 1000.0);
+}
+
+bool ClipWriter::flushDelayedAudio(double untilSec)
+{
+    while (!m_delayedAudio.empty()) {
+        AVPacket *pkt = m_delayedAudio.front();
+        if (pkt->dts * av_q2d(m_audioStream->time_base) > untilSec)
+            break;
+        m_delayedAudio.pop_front();
+        int ret = av_write_frame(m_oc, pkt);
+        av_packet_free(&pkt);
+        if (ret < 0)
+            return false;
+    }
+    return true;
+}
+
+void ClipWriter::cleanup()
+{
+    for (AVPacket *pkt : m_delayedAudio)
+        av_packet_free(&pkt);
+    m_delayedAudio.clear();
+
+    av_packet_free(&m_packet);
+    av_frame_free(&m_videoFrame);
+    av_frame_free(&m_audioFrame);
+    avcodec_free_context(&m_videoEnc);
+    avcodec_free_context(&m_audioEnc);
+    if (m_oc) {
+        if (m_oc->pb && !(m_oc->oformat->flags & AVFMT_NOFILE))
+            avio_closep(&m_oc->pb);
+        avformat_free_context(m_oc);
+        m_oc = nullptr;
+    }
+}
+
+bool writeManifest(const ClipSpec &spec, const QString &clipPath, const ClipWriter &writer)
+{
+    QJsonObject manifest;
+    manifest["file"] = QFileInfo(clipPath).fileName();
+    manifest["duration_ms"] = spec.durationSec * 1000;
+    manifest["interleave_skew_ms"] = spec.interleaveSkewMs;
+
+    if (!spec.videoCodec.isEmpty()) {
+        QJsonObject video;
+        video["codec"] = spec.videoCodec;
+        video["fps"] = spec.fps;
+        video["gop"] = spec.gop;
+        video["bframes"] = spec.bframes;
+        video["vfr"] = spec.vfr;
+        video["frames"] = writer.videoFrames();
+        manifest["video"] = video;
+    }
+    if (!spec.audioCodec.isEmpty()) {
+        QJsonObject audio;
+        audio["codec"] = spec.audioCodec;
+        audio["sample_rate"] = spec.sampleRate;
+        audio["channels"] = spec.channels;
+        audio["tone_hz"] = synthetic::kToneHz;
+        audio["tone_ms"] = synthetic::kToneMs;
+        audio["beeps"] = writer.beeps();
+        manifest["audio"] = audio;
+    }
+
+    QFile file(clipPath + ".json");
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(manifest).toJson(QJsonDocument::Indented));
+    return true;
+}
+
+bool generate(const ClipSpec &spec, const QString &path)
+{
+    ClipWriter writer(spec);
+    if (!writer.write(path))
+        return false;
+    if (!writeManifest(spec, path, writer))
+        return false;
+    printf("%s\n", qPrintable(path));
+    return true;
+}
+
+// 标准回归素材集
+QList<ClipSpec> standardSuite()
+{
+    QList<ClipSpec> suite;
+
+    ClipSpec base;
+    base.name = "mpeg4_gop12.mkv";
+    suite << base;
+
+    ClipSpec longGop = base;
+    longGop.name = "mpeg4_gop250_bframes.mkv";
+    longGop.gop = 250;
+    longGop.bframes = 2;
+    suite << longGop;
+
+    ClipSpec intra = base;
+    intra.name = "mjpeg_intra_pcm.mkv";
+    intra.videoCodec = "mjpeg";
+    intra.audioCodec = "pcm_s16le";
+    intra.gop = 1;
+    suite << intra;
+
+    ClipSpec h264 = base;
+    h264.name = "h264_gop48_aac.mp4";
+    h264.videoCodec = "libx264";
+    h264.audioCodec = "aac";
+    h264.gop = 48;
+    suite << h264;
+
+    ClipSpec vfr = base;
+    vfr.name = "mpeg4_vfr.mkv";
+    vfr.vfr = true;
+    suite << vfr;
+
+    ClipSpec audioOnly = base;
+    audioOnly.name = "audio_only.mka";
+    audioOnly.videoCodec.clear();
+    suite << audioOnly;
+
+    ClipSpec videoOnly = base;
+    videoOnly.name = "video_only.mkv";
+    videoOnly.audioCodec.clear();
+    suite << videoOnly;
+
+    ClipSpec skewed = base;
+    skewed.name = "skewed_interleave.mkv";
+    skewed.interleaveSkewMs = 2000;
+    suite << skewed;
+
+    return suite;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Synthetic test media generator for the QWaveBox regression suite");
+    parser.addHelpOption();
+    parser.addPositionalArgument("output", "Output clip path (container is chosen from the extension)");
+    QCommandLineOption suiteOpt("suite", "Generate the standard clip set into <dir>", "dir");
+    QCommandLineOption vcodecOpt("vcodec", "Video encoder, 'none' for audio-only (default mpeg4)", "name", "mpeg4");
+    QCommandLineOption acodecOpt("acodec", "Audio encoder, 'none' for video-only (default mp2)", "name", "mp2");
+    QCommandLineOption sizeOpt("size", "Frame size WxH (default 320x240)", "WxH", "320x240");
+    QCommandLineOption fpsOpt("fps", "Nominal frame rate (default 25)", "n", "25");
+    QCommandLineOption gopOpt("gop", "GOP length (default 12)", "n", "12");
+    QCommandLineOption bframesOpt("bframes", "Max consecutive B-frames (default 0)", "n", "0");
+    QCommandLineOption vfrOpt("vfr", "Use a variable frame rate pattern");
+    QCommandLineOption durationOpt("duration", "Clip length in seconds (default 10)", "sec", "10");
+    QCommandLineOption rateOpt("sample-rate", "Audio sample rate (default 48000)", "hz", "48000");
+    QCommandLineOption skewOpt("interleave-skew", "Delay audio packets by <ms> in the file", "ms", "0");
+    parser.addOptions(
+        {suiteOpt, vcodecOpt, acodecOpt, sizeOpt, fpsOpt, gopOpt, bframesOpt, vfrOpt, durationOpt, rateOpt, skewOpt});
+    parser.process(app);
+
+    if (parser.isSet(suiteOpt)) {
+        QDir dir(parser.value(suiteOpt));
+        if (!dir.mkpath("."))
+            return 1;
+        int failed = 0;
+        for (const ClipSpec &spec : standardSuite()) {
+            if (!generate(spec, dir.filePath(spec.name))) {
+                fprintf(stderr, "skipped %s\n", qPrintable(spec.name));
+                QFile::remove(dir.filePath(spec.name));
+                ++failed;
+            }
+        }
+        // 个别编码器（如libx264）可能未编译进FFmpeg，只要生成了部分素材即视为成功
+        return failed == standardSuite().size() ? 1 : 0;
+    }
+
+    const QStringList args = parser.positionalArguments();
+    if (args.isEmpty())
+        parser.showHelp(1);
+
+    ClipSpec spec;
+    spec.name = args.first();
+    spec.videoCodec = parser.value(vcodecOpt) == "none" ? QString() : parser.value(vcodecOpt);
+    spec.audioCodec = parser.value(acodecOpt) == "none" ? QString() : parser.value(acodecOpt);
+    const QStringList size = parser.value(sizeOpt).split('x');
+    if (size.size() == 2) {
+        spec.width = size[0].toInt();
+        spec.height = size[1].toInt();
+    }
+    spec.fps = qMax(1, parser.value(fpsOpt).toInt());
+    spec.gop = qMax(1, parser.value(gopOpt).toInt());
+    spec.bframes = qMax(0, parser.value(bframesOpt).toInt());
+    spec.vfr = parser.isSet(vfrOpt);
+    spec.durationSec = qMax(1, parser.value(durationOpt).toInt());
+    spec.sampleRate = qMax(8000, parser.value(rateOpt).toInt());
+    spec.interleaveSkewMs = qMax(0, parser.value(skewOpt).toInt());
+
+    return generate(spec, spec.name) ? 0 : 1;
+}
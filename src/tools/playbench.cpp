@@ -0,0 +1,458 @@
+/**
+ * @brief 播放管线基准测试工具
+ *
+ * 不依赖Qt界面、SDL窗口和音频设备，直接将 DemuxThread、VideoDecodeThread、
+ * AudioDecodeThread 串联到空/校验和输出端，统计吞吐、延迟、队列占用、CPU时间与峰值内存，
+ * 结果以JSON格式输出，可在没有显示与音频硬件的CI机器上运行。
+ */
+#include "audiodecodethread.h"
+#include "avframequeue.h"
+#include "avpacketqueue.h"
+#include "demuxthread.h"
+#include "playmetrics.h"
+#include "playtrace.h"
+#include "threadbase.h"
+#include "videodecodethread.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <initializer_list>
+#include <vector>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+extern "C" {
+#include <libavutil/adler32.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace {
+
+// 进程资源占用
+struct ProcessUsage
+{
+    double  cpuUserMs = 0;
+    double  cpuSystemMs = 0;
+    int64_t peakRssKb = 0;
+};
+
+ProcessUsage queryProcessUsage()
+{
+    ProcessUsage usage;
+#ifdef Q_OS_WIN
+    FILETIME creation, exitTime, kernel, user;
+    if (GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) {
+        auto toMs = [](const FILETIME &ft) {
+            ULARGE_INTEGER v;
+            v.LowPart = ft.dwLowDateTime;
+            v.HighPart = ft.dwHighDateTime;
+            return v.QuadPart / 10000.0; // 100ns -> ms
+        };
+        usage.cpuUserMs = toMs(user);
+        usage.cpuSystemMs = toMs(kernel);
+    }
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        usage.peakRssKb = pmc.PeakWorkingSetSize / 1024;
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        usage.cpuUserMs = ru.ru_utime.tv_sec * 1000.0 + ru.ru_utime.tv_usec / 1000.0;
+        usage.cpuSystemMs = ru.ru_stime.tv_sec * 1000.0 + ru.ru_stime.tv_usec / 1000.0;
+        usage.peakRssKb = ru.ru_maxrss; // Linux下单位为KB
+    }
+#endif
+    return usage;
+}
+
+// 对一组耗时样本（毫秒）求统计值
+QJsonObject summarize(std::vector<double> samples)
+{
+    QJsonObject obj;
+    obj["count"] = static_cast<qint64>(samples.size());
+    if (samples.empty())
+        return obj;
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double v : samples)
+        sum += v;
+    auto percentile = [&samples](double p) {
+        size_t idx = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+        return samples[std::min(idx, samples.size() - 1)];
+    };
+    obj["mean"] = sum / samples.size();
+    obj["p50"] = percentile(0.50);
+    obj["p95"] = percentile(0.95);
+    obj["p99"] = percentile(0.99);
+    obj["max"] = samples.back();
+    return obj;
+}
+
+/**
+ * @brief 实时模式下各输出端共享的时间锚点 - 第一帧到达时记录pts与墙钟的对应关系
+ */
+class RealtimeAnchor
+{
+public:
+    // 返回该pts（秒）相对墙钟还需要等待的毫秒数
+    double waitMs(double pts, qint64 nowMs)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_valid) {
+            m_valid = true;
+            m_pts = pts;
+            m_timeMs = nowMs;
+            return 0;
+        }
+        return (pts - m_pts) * 1000.0 - (nowMs - m_timeMs);
+    }
+
+private:
+    QMutex m_mutex;
+    bool   m_valid{false};
+    double m_pts{0};
+    qint64 m_timeMs{0};
+};
+
+/**
+ * @brief 空输出线程 - 代替渲染线程消费帧队列，可选计算帧数据的校验和
+ */
+class NullSinkThread : public ThreadBase
+{
+public:
+    NullSinkThread(AVMediaType type, AVFrameQueue *queue, AVRational timebase, const QElapsedTimer &clock)
+        : m_type(type)
+        , m_queue(queue)
+        , m_timebase(timebase)
+        , m_clock(clock)
+    {}
+    ~NullSinkThread() override
+    {
+        stopProcess();
+        wait();
+    }
+
+    bool initialize() override { return true; }
+
+    void setChecksum(bool enabled) { m_checksumEnabled = enabled; }
+    void setRealtime(RealtimeAnchor *anchor) { m_anchor = anchor; }
+
+    bool     isDone() const { return m_done; }
+    int64_t  frameCount() const { return m_frames; }
+    uint32_t checksum() const { return m_checksum; }
+    qint64   firstFrameMs() const { return m_firstFrameMs; }
+    qint64   lastFrameMs() const { return m_lastFrameMs; }
+
+    // 仅在线程结束后读取
+    const std::vector<double> &intervals() const { return m_intervals; }
+
+protected:
+    void process() override
+    {
+        AVFrame *frame = m_queue->dequeue(10);
+        if (!frame) {
+            if (m_queue->isFinished() && m_queue->isEmpty()) {
+                m_done = true;
+                pauseProcess();
+            }
+            return;
+        }
+
+        if (m_anchor && frame->pts != AV_NOPTS_VALUE) {
+            double wait = m_anchor->waitMs(frame->pts * av_q2d(m_timebase), m_clock.elapsed());
+            if (wait > 0)
+                msleep(static_cast<unsigned long>(std::min(wait, 1000.0)));
+        }
+
+        qint64 now = m_clock.elapsed();
+        if (m_frames == 0)
+            m_firstFrameMs = now;
+        else
+            m_intervals.push_back(static_cast<double>(now - m_lastFrameMs));
+        m_lastFrameMs = now;
+        ++m_frames;
+
+        if (m_checksumEnabled)
+            updateChecksum(frame);
+
+        av_frame_free(&frame);
+    }
+
+private:
+    void updateChecksum(const AVFrame *frame)
+    {
+        if (m_type == AVMEDIA_TYPE_VIDEO) {
+            auto                      format = static_cast<AVPixelFormat>(frame->format);
+            const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+            if (!desc)
+                return;
+            for (int plane = 0; plane < AV_NUM_DATA_POINTERS && frame->data[plane]; ++plane) {
+                int rowBytes = av_image_get_linesize(format, frame->width, plane);
+                int rows = (plane == 1 || plane == 2) ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h)
+                                                      : frame->height;
+                if (rowBytes <= 0)
+                    break;
+                for (int y = 0; y < rows; ++y)
+                    m_checksum = av_adler32_update(m_checksum,
+                                                   frame->data[plane] + y * frame->linesize[plane],
+                                                   rowBytes);
+            }
+        } else {
+            auto format = static_cast<AVSampleFormat>(frame->format);
+            int  bytes = av_get_bytes_per_sample(format);
+            if (av_sample_fmt_is_planar(format)) {
+                for (int ch = 0; ch < frame->channels; ++ch)
+                    m_checksum = av_adler32_update(m_checksum,
+                                                   frame->extended_data[ch],
+                                                   frame->nb_samples * bytes);
+            } else {
+                m_checksum = av_adler32_update(m_checksum,
+                                               frame->data[0],
+                                               frame->nb_samples * frame->channels * bytes);
+            }
+        }
+    }
+
+private:
+    AVMediaType          m_type;
+    AVFrameQueue        *m_queue{nullptr};
+    AVRational           m_timebase;
+    const QElapsedTimer &m_clock;
+    RealtimeAnchor      *m_anchor{nullptr};
+    bool                 m_checksumEnabled{false};
+
+    std::atomic<bool>    m_done{false};
+    std::atomic<int64_t> m_frames{0};
+    uint32_t             m_checksum{1};
+    qint64               m_firstFrameMs{-1};
+    qint64               m_lastFrameMs{0};
+    std::vector<double>  m_intervals; // 相邻两帧到达间隔（毫秒）
+};
+
+// 队列占用采样
+struct QueueOccupancy
+{
+    int64_t sum = 0;
+    int     max = 0;
+    int     samples = 0;
+
+    void add(int size)
+    {
+        sum += size;
+        max = std::max(max, size);
+        ++samples;
+    }
+
+    QJsonObject toJson() const
+    {
+        QJsonObject obj;
+        obj["mean"] = samples ? static_cast<double>(sum) / samples : 0.0;
+        obj["max"] = max;
+        return obj;
+    }
+};
+
+QJsonObject sinkReport(const NullSinkThread &sink, bool checksum)
+{
+    QJsonObject obj;
+    obj["frames"] = static_cast<qint64>(sink.frameCount());
+    obj["first_frame_ms"] = sink.firstFrameMs();
+    qint64 span = sink.lastFrameMs() - sink.firstFrameMs();
+    obj["fps"] = span > 0 ? (sink.frameCount() - 1) * 1000.0 / span : 0.0;
+    obj["frame_interval_ms"] = summarize(sink.intervals());
+    if (checksum)
+        obj["adler32"] = QString::number(sink.checksum(), 16);
+    return obj;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("qwavebox_playbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless throughput benchmark for the QWaveBox play pipeline");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "The media file to benchmark");
+    QCommandLineOption realtimeOpt("realtime", "Pace frames by their timestamps instead of running flat out");
+    QCommandLineOption checksumOpt("checksum", "Compute an adler32 checksum over every decoded frame");
+    QCommandLineOption outputOpt({"o", "output"}, "Write the JSON report to <path> instead of stdout", "path");
+    QCommandLineOption timeoutOpt("timeout", "Abort after <seconds> (default 600)", "seconds", "600");
+    QCommandLineOption intervalOpt("sample-interval",
+                                   "Queue occupancy sampling interval in ms (default 5)",
+                                   "ms",
+                                   "5");
+    parser.addOption(realtimeOpt);
+    parser.addOption(checksumOpt);
+    parser.addOption(outputOpt);
+    parser.addOption(timeoutOpt);
+    QCommandLineOption traceOpt("trace", "Write a Chrome trace of the pipeline threads to <path>", "path");
+    parser.addOption(intervalOpt);
+    parser.addOption(traceOpt);
+    parser.process(app);
+
+    if (parser.isSet(traceOpt))
+        PlayTrace::enableWithDumpOnExit(parser.value(traceOpt));
+
+    const QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        parser.showHelp(1);
+    }
+    const QString path = args.first();
+    const bool    realtime = parser.isSet(realtimeOpt);
+    const bool    checksum = parser.isSet(checksumOpt);
+    const qint64  timeoutMs = parser.value(timeoutOpt).toLongLong() * 1000;
+    const int     intervalMs = qMax(1, parser.value(intervalOpt).toInt());
+
+    QElapsedTimer clock;
+    clock.start();
+
+    DemuxThread       demux;
+    VideoDecodeThread videoDecode;
+    AudioDecodeThread audioDecode;
+    demux.initialize();
+    videoDecode.initialize();
+    audioDecode.initialize();
+
+    if (!demux.openMedia(path)) {
+        fprintf(stderr, "failed to open %s\n", qPrintable(path));
+        return 1;
+    }
+
+    // 解复用线程会向每个存在的流投递数据包，某路解码器打不开时没有消费者，队列写满后整个管线停住
+    const bool hasVideo = demux.getVideoStreamIndex() >= 0;
+    const bool hasAudio = demux.getAudioStreamIndex() >= 0;
+    if (hasVideo && !videoDecode.openDecoder(demux.getVideoStreamIndex(), demux.videoCodecParameters())) {
+        fprintf(stderr, "failed to open video decoder for %s\n", qPrintable(path));
+        return 1;
+    }
+    if (hasAudio && !audioDecode.openDecoder(demux.getAudioStreamIndex(), demux.audioCodecParameters())) {
+        fprintf(stderr, "failed to open audio decoder for %s\n", qPrintable(path));
+        return 1;
+    }
+    const qint64 openMs = clock.elapsed();
+
+    videoDecode.setPacketQueue(demux.videoPacketQueue());
+    audioDecode.setPacketQueue(demux.audioPacketQueue());
+
+    RealtimeAnchor anchor;
+    NullSinkThread videoSink(AVMEDIA_TYPE_VIDEO, videoDecode.getFrameQueue(), demux.videoTimebase(), clock);
+    NullSinkThread audioSink(AVMEDIA_TYPE_AUDIO, audioDecode.getFrameQueue(), demux.audioTimebase(), clock);
+    for (NullSinkThread *sink : {&videoSink, &audioSink}) {
+        sink->setChecksum(checksum);
+        if (realtime)
+            sink->setRealtime(&anchor);
+    }
+
+    PlayMetrics::reset();
+    const ProcessUsage usageBefore = queryProcessUsage();
+    const qint64       startMs = clock.elapsed();
+
+    // 启动顺序与 ThreadManager::startAllThreads 保持一致
+    demux.startProcess();
+    if (hasVideo) {
+        videoDecode.startProcess();
+        videoSink.startProcess();
+    }
+    if (hasAudio) {
+        audioDecode.startProcess();
+        audioSink.startProcess();
+    }
+
+    QueueOccupancy videoPackets, audioPackets, videoFrames, audioFrames;
+    bool           timedOut = false;
+    while ((hasVideo && !videoSink.isDone()) || (hasAudio && !audioSink.isDone())) {
+        videoPackets.add(demux.videoPacketQueue()->size());
+        audioPackets.add(demux.audioPacketQueue()->size());
+        videoFrames.add(videoDecode.getFrameQueue()->size());
+        audioFrames.add(audioDecode.getFrameQueue()->size());
+
+        if (clock.elapsed() - startMs > timeoutMs) {
+            timedOut = true;
+            break;
+        }
+        QThread::msleep(intervalMs);
+    }
+    const qint64 wallMs = clock.elapsed() - startMs;
+
+    // 先停消费者，再停生产者；标记队列结束，避免超时退出时生产者阻塞在已满的队列上
+    videoSink.stopProcess();
+    audioSink.stopProcess();
+    videoDecode.getFrameQueue()->setFinished(true);
+    audioDecode.getFrameQueue()->setFinished(true);
+    videoDecode.stopProcess();
+    audioDecode.stopProcess();
+    demux.videoPacketQueue()->setFinished(true);
+    demux.audioPacketQueue()->setFinished(true);
+    demux.stopProcess();
+
+    const std::initializer_list<ThreadBase *> threads = {&videoSink, &audioSink, &videoDecode, &audioDecode, &demux};
+    for (ThreadBase *thd : threads)
+        thd->wait();
+
+    const ProcessUsage usageAfter = queryProcessUsage();
+
+    QJsonObject report;
+    report["file"] = path;
+    report["mode"] = realtime ? "realtime" : "fast";
+    report["timed_out"] = timedOut;
+    report["open_ms"] = openMs;
+    report["wall_ms"] = wallMs;
+    report["media_duration_ms"] = static_cast<qint64>(demux.getDuration());
+
+    QJsonObject cpu;
+    cpu["user_ms"] = usageAfter.cpuUserMs - usageBefore.cpuUserMs;
+    cpu["system_ms"] = usageAfter.cpuSystemMs - usageBefore.cpuSystemMs;
+    cpu["utilization"] = wallMs > 0 ? (usageAfter.cpuUserMs + usageAfter.cpuSystemMs - usageBefore.cpuUserMs
+                                       - usageBefore.cpuSystemMs)
+                                          / wallMs
+                                    : 0.0;
+    report["cpu"] = cpu;
+    report["peak_rss_kb"] = static_cast<qint64>(usageAfter.peakRssKb);
+
+    QJsonObject queues;
+    queues["video_packets"] = videoPackets.toJson();
+    queues["audio_packets"] = audioPackets.toJson();
+    queues["video_frames"] = videoFrames.toJson();
+    queues["audio_frames"] = audioFrames.toJson();
+    report["queue_occupancy"] = queues;
+    report["metrics"] = PlayMetrics::snapshot();
+
+    QJsonObject stages;
+    if (hasVideo)
+        stages["video"] = sinkReport(videoSink, checksum);
+    if (hasAudio)
+        stages["audio"] = sinkReport(audioSink, checksum);
+    report["streams"] = stages;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outputOpt)) {
+        QFile file(parser.value(outputOpt));
+        if (!file.open(QIODevice::WriteOnly)) {
+            fprintf(stderr, "failed to write %s\n", qPrintable(parser.value(outputOpt)));
+            return 1;
+        }
+        file.write(json);
+    } else {
+        fwrite(json.constData(), 1, json.size(), stdout);
+    }
+
+    return timedOut ? 2 : 0;
+}
@@ -0,0 +1,780 @@
+/**
+ * @brief 播放管线回归校验工具
+ *
+ * 以无界面方式运行 src/play 管线播放 qwavebox_mediagen 生成的片段，对照清单断言：
+ * 帧顺序与帧数、音视频时间戳对齐、seek 落点精度以及首帧耗时预算；音视频同步误差由真实的 RenderThread 与
+ * AudioRenderThread 实时播放测得（视频送入采集输出端，音频经 SDL 输出，无声卡时使用 dummy 驱动），主时钟为视频时另检查时钟速度。
+ * 任一断言失败时返回非0。
+ */
+#define SDL_MAIN_HANDLED
+#include "audioanalyzer.h"
+#include "audiodecodethread.h"
+#include "audiorenderthread.h"
+#include "avframequeue.h"
+#include "avpacketqueue.h"
+#include "avsync.h"
+#include "demuxthread.h"
+#include "renderthread.h"
+#include "syntheticmedia.h"
+#include "threadbase.h"
+#include "videodecodethread.h"
+#include "videosink.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+namespace {
+
+struct Manifest
+{
+    QString path;
+    int     durationMs{0};
+    bool    hasVideo{false};
+    int     fps{0};
+    int     gop{0};
+    bool    vfr{false};
+    int     frames{0};
+    bool    hasAudio{false};
+    int     beeps{0};
+
+    bool load(const QString &manifestPath)
+    {
+        QFile file(manifestPath);
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+        const QJsonObject obj = QJsonDocument::fromJson(file.readAll()).object();
+        if (obj.isEmpty())
+            return false;
+
+        path = QFileInfo(manifestPath).dir().filePath(obj["file"].toString());
+        durationMs = obj["duration_ms"].toInt();
+        hasVideo = obj.contains("video");
+        hasAudio = obj.contains("audio");
+        const QJsonObject video = obj["video"].toObject();
+        fps = video["fps"].toInt();
+        gop = video["gop"].toInt();
+        vfr = video["vfr"].toBool();
+        frames = video["frames"].toInt();
+        beeps = obj["audio"].toObject()["beeps"].toInt();
+        return true;
+    }
+
+    // 最长帧时长（秒），可变帧率时按生成器的最大系数1.5计算
+    double maxFrameDuration() const { return fps > 0 ? (vfr ? 1.5 : 1.0) / fps : 0.0; }
+};
+
+struct Budgets
+{
+    double syncToleranceMs{40};
+    double seekToleranceMs{40};
+    double audioSeekWindowMs{5000}; // 纯音频文件的索引粒度较粗（如mkv按cluster）
+    qint64 ttffBudgetMs{500};
+    qint64 timeoutMs{120000};
+    int    presentUs{5000};           // 实时播放时采集输出端模拟的每帧上传与呈现耗时
+    double clockSpeedTolerance{0.005}; // 主时钟为视频时，时钟速度与1.0的最大偏差
+};
+
+struct VideoRecord
+{
+    double pts;
+    int    index;
+    bool   flash;
+    qint64 shownUs; // 实时播放时画面送出的时刻，否则为-1
+};
+
+/**
+ * @brief 采集输出端 - 尽快取出解码帧，记录每一视频帧的pts与条码，以及音频提示音的起始时刻，不做时间控制
+ */
+class CaptureSinkThread : public ThreadBase
+{
+public:
+    CaptureSinkThread(AVMediaType type, AVFrameQueue *queue, AVRational timebase, const QElapsedTimer &clock)
+        : m_type(type)
+        , m_queue(queue)
+        , m_timebase(timebase)
+        , m_clock(clock)
+    {}
+    ~CaptureSinkThread() override
+    {
+        stopProcess();
+        wait();
+    }
+
+    bool initialize() override { return true; }
+
+    bool   isDone() const { return m_done; }
+    int    frameCount() const { return m_frames; }
+    qint64 firstFrameMs() const { return m_firstFrameMs; }
+
+    // 以下结果仅在线程结束后读取
+    const std::vector<VideoRecord> &videoRecords() const { return m_videoRecords; }
+    const std::vector<double>      &onsets() const { return m_onsets; }
+    double                          firstPts() const { return m_firstPts; }
+
+protected:
+    void process() override
+    {
+        AVFrame *frame = m_queue->dequeue(10);
+        if (!frame) {
+            if (m_queue->isFinished() && m_queue->isEmpty()) {
+                m_done = true;
+                pauseProcess();
+            }
+            return;
+        }
+
+        const int64_t ts = frame->best_effort_timestamp != AV_NOPTS_VALUE ? frame->best_effort_timestamp
+                                                                          : frame->pts;
+        const double  pts = ts * av_q2d(m_timebase);
+        if (m_frames == 0) {
+            m_firstFrameMs = m_clock.elapsed();
+            m_firstPts = pts;
+        }
+
+        if (m_type == AVMEDIA_TYPE_VIDEO) {
+            VideoRecord record{pts, -1, false, -1};
+            synthetic::readMarkers(frame, record.index, record.flash);
+            m_videoRecords.push_back(record);
+        } else {
+            detectOnsets(frame, pts);
+        }
+
+        ++m_frames;
+        av_frame_free(&frame);
+    }
+
+private:
+    // 静音至少持续200ms后首次越过阈值的采样视为一次提示音起始
+    void detectOnsets(const AVFrame *frame, double pts)
+    {
+        const double rate = frame->sample_rate;
+        for (int i = 0; i < frame->nb_samples; ++i) {
+            const double t = pts + i / rate;
+            if (std::fabs(synthetic::sampleAt(frame, i)) > synthetic::kOnsetThreshold) {
+                if (t - m_lastLoud > 0.2)
+                    m_onsets.push_back(t);
+                m_lastLoud = t;
+            }
+        }
+    }
+
+private:
+    AVMediaType          m_type;
+    AVFrameQueue        *m_queue{nullptr};
+    AVRational           m_timebase;
+    const QElapsedTimer &m_clock;
+
+    std::atomic<bool> m_done{false};
+    std::atomic<int>  m_frames{0};
+    qint64            m_firstFrameMs{-1};
+    double            m_firstPts{0};
+
+    std::vector<VideoRecord> m_videoRecords;
+    std::vector<double>      m_onsets;
+    double                   m_lastLoud{-1e9};
+};
+
+/**
+ * @brief 无界面播放管线 - 组装方式与 ThreadManager 相同，只是把渲染线程换成采集输出端
+ */
+class HeadlessPipeline
+{
+public:
+    bool open(const QString &path)
+    {
+        m_demux.initialize();
+        m_videoDecode.initialize();
+        m_audioDecode.initialize();
+        if (!m_demux.openMedia(path))
+            return false;
+        m_hasVideo = m_demux.getVideoStreamIndex() >= 0
+                     && m_videoDecode.openDecoder(m_demux.getVideoStreamIndex(), m_demux.videoCodecParameters());
+        m_hasAudio = m_demux.getAudioStreamIndex() >= 0
+                     && m_audioDecode.openDecoder(m_demux.getAudioStreamIndex(), m_demux.audioCodecParameters());
+        m_videoDecode.setPacketQueue(m_demux.videoPacketQueue());
+        m_audioDecode.setPacketQueue(m_demux.audioPacketQueue());
+
+        m_videoSink = std::make_unique<CaptureSinkThread>(AVMEDIA_TYPE_VIDEO,
+                                                          m_videoDecode.getFrameQueue(),
+                                                          m_demux.videoTimebase(),
+                                                          m_clock);
+        m_audioSink = std::make_unique<CaptureSinkThread>(AVMEDIA_TYPE_AUDIO,
+                                                          m_audioDecode.getFrameQueue(),
+                                                          m_demux.audioTimebase(),
+                                                          m_clock);
+        return true;
+    }
+
+    bool seek(int64_t ms) { return m_demux.seekTo(ms); }
+
+    void start()
+    {
+        m_clock.start();
+        m_demux.startProcess();
+        if (m_hasVideo) {
+            m_videoDecode.startProcess();
+            m_videoSink->startProcess();
+        }
+        if (m_hasAudio) {
+            m_audioDecode.startProcess();
+            m_audioSink->startProcess();
+        }
+    }
+
+    bool waitFor(const std::function<bool()> &done, qint64 timeoutMs)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while (!done()) {
+            if (timer.elapsed() > timeoutMs)
+                return false;
+            QThread::msleep(2);
+        }
+        return true;
+    }
+
+    bool finished() const
+    {
+        return (!m_hasVideo || m_videoSink->isDone()) && (!m_hasAudio || m_audioSink->isDone());
+    }
+
+    void stop()
+    {
+        m_videoSink->stopProcess();
+        m_audioSink->stopProcess();
+        m_videoSink->wait();
+        m_audioSink->wait();
+        m_videoDecode.getFrameQueue()->setFinished(true);
+        m_audioDecode.getFrameQueue()->setFinished(true);
+        m_videoDecode.stopProcess();
+        m_audioDecode.stopProcess();
+        m_videoDecode.wait();
+        m_audioDecode.wait();
+        m_demux.videoPacketQueue()->setFinished(true);
+        m_demux.audioPacketQueue()->setFinished(true);
+        m_demux.stopProcess();
+        m_demux.wait();
+    }
+
+    bool                     hasVideo() const { return m_hasVideo; }
+    bool                     hasAudio() const { return m_hasAudio; }
+    const CaptureSinkThread &videoSink() const { return *m_videoSink; }
+    const CaptureSinkThread &audioSink() const { return *m_audioSink; }
+
+private:
+    QElapsedTimer     m_clock;
+    DemuxThread       m_demux;
+    VideoDecodeThread m_videoDecode;
+    AudioDecodeThread m_audioDecode;
+    bool              m_hasVideo{false};
+    bool              m_hasAudio{false};
+
+    // 输出端持有解码线程帧队列的指针，需先于解码线程析构
+    std::unique_ptr<CaptureSinkThread> m_videoSink;
+    std::unique_ptr<CaptureSinkThread> m_audioSink;
+};
+
+/**
+ * @brief 采集视频输出端 - 接在真实的 RenderThread 之后，记录每一帧送出的时刻与条码
+ *
+ * 每帧按设定时长阻塞，模拟纹理上传与呈现的耗时，渲染线程定时上的误差因此可以测出。
+ */
+class CaptureVideoSink : public VideoSink
+{
+public:
+    CaptureVideoSink(AVRational timebase, const QElapsedTimer &clock, const AVSync &sync, int presentUs)
+        : m_timebase(timebase)
+        , m_clock(clock)
+        , m_sync(sync)
+        , m_presentUs(presentUs)
+    {}
+
+    bool initializeSink() override { return true; }
+
+    void renderFrame(AVFrame *frame) override
+    {
+        // 与 RenderThread 一样按 pts 换算
+        const double pts = SyncData::toSeconds(frame->pts, m_timebase);
+        VideoRecord  record{pts, -1, false, m_clock.nsecsElapsed() / 1000};
+        synthetic::readMarkers(frame, record.index, record.flash);
+        m_records.push_back(record);
+
+        // 画面送出时与音频时钟的偏差
+        const double audioClock = m_sync.audioClock();
+        if (!std::isnan(pts) && !std::isnan(audioClock))
+            m_maxClockError = std::max(m_maxClockError, std::fabs(pts - audioClock));
+
+        ++m_frames;
+        if (m_presentUs > 0)
+            QThread::usleep(static_cast<unsigned long>(m_presentUs));
+    }
+
+    void reset() override {}
+
+    int frameCount() const { return m_frames; }
+
+    // 以下结果仅在渲染线程结束后读取
+    const std::vector<VideoRecord> &records() const { return m_records; }
+    double                          maxClockError() const { return m_maxClockError; }
+
+private:
+    AVRational           m_timebase;
+    const QElapsedTimer &m_clock;
+    const AVSync        &m_sync;
+    const int            m_presentUs;
+
+    std::atomic<int>         m_frames{0};
+    std::vector<VideoRecord> m_records;
+    double                   m_maxClockError{0}; // 秒
+};
+
+/**
+ * @brief 音频输出采集 - 从 AudioRenderThread 的分析抽头读出送入设备的PCM，检测提示音起始
+ *
+ * 抽头在音频回调中写入，频繁轮询时读出时刻与回调时刻相差不超过轮询间隔，据此估计提示音的实际播出时刻。
+ */
+class TapOnsetDetector
+{
+public:
+    explicit TapOnsetDetector(const QElapsedTimer &clock)
+        : m_clock(clock)
+        , m_buffer(AudioTap::kCapacity)
+    {
+        m_tap.setEnabled(true);
+    }
+
+    AudioTap *tap() { return &m_tap; }
+
+    void poll()
+    {
+        const uint32_t count = m_tap.read(m_buffer.data(), AudioTap::kCapacity);
+        const int      channels = m_tap.channels();
+        const int      rate = m_tap.sampleRate();
+        if (count == 0 || channels <= 0 || rate <= 0)
+            return;
+
+        // 静音至少持续200ms后首次越过阈值的采样视为一次提示音起始
+        const qint64 nowUs = m_clock.nsecsElapsed() / 1000;
+        const int    frames = static_cast<int>(count) / channels;
+        for (int i = 0; i < frames; ++i, ++m_position) {
+            const double value = m_buffer[static_cast<size_t>(i) * channels] / 32768.0;
+            if (std::fabs(value) > synthetic::kOnsetThreshold) {
+                if (m_position - m_lastLoud > rate / 5)
+                    m_onsetsUs.push_back(nowUs + static_cast<qint64>(i) * 1000000 / rate);
+                m_lastLoud = m_position;
+            }
+        }
+    }
+
+    const std::vector<qint64> &onsetsUs() const { return m_onsetsUs; }
+
+private:
+    const QElapsedTimer &m_clock;
+    AudioTap             m_tap;
+    std::vector<int16_t> m_buffer;
+    int64_t              m_position{0}; // 已读出的帧数
+    int64_t              m_lastLoud{-(int64_t(1) << 40)};
+    std::vector<qint64>  m_onsetsUs;
+};
+
+/**
+ * @brief 实时播放管线 - 与 ThreadManager 相同的解复用、解码线程以及真实的 RenderThread 与 AudioRenderThread
+ *
+ * 视频送入采集输出端，音频经 SDL 设备输出并从分析抽头检测提示音；两路时钟都由被测的输出线程发布。
+ */
+class RealtimePipeline
+{
+public:
+    bool open(const QString &path, SyncMaster master, int presentUs)
+    {
+        m_clock.start();
+        m_demux.initialize();
+        m_videoDecode.initialize();
+        m_audioDecode.initialize();
+        m_render.initialize();
+        m_audioRender.initialize();
+        if (!m_demux.openMedia(path))
+            return false;
+        if (m_demux.getVideoStreamIndex() < 0 || m_demux.getAudioStreamIndex() < 0)
+            return false;
+
+        m_sync.initClock();
+        m_sync.setPreferredMaster(master);
+        m_sync.setStreams(true, true);
+
+        m_videoDecode.setPacketQueue(m_demux.videoPacketQueue());
+        m_audioDecode.setPacketQueue(m_demux.audioPacketQueue());
+        m_videoDecode.setSync(&m_sync);
+        m_videoDecode.setTimebase(m_demux.videoTimebase());
+        if (!m_videoDecode.openDecoder(m_demux.getVideoStreamIndex(), m_demux.videoCodecParameters())
+            || !m_audioDecode.openDecoder(m_demux.getAudioStreamIndex(), m_demux.audioCodecParameters()))
+            return false;
+
+        m_videoSink = std::make_unique<CaptureVideoSink>(m_demux.videoTimebase(), m_clock, m_sync, presentUs);
+        m_render.setVideoFrameQueue(m_videoDecode.getFrameQueue());
+        m_render.setVideoSink(m_videoSink.get());
+        m_render.setSync(&m_sync);
+        m_audioRender.setAudioFrameQueue(m_audioDecode.getFrameQueue());
+        m_audioRender.setSync(&m_sync);
+        m_audioRender.setAudioTap(m_tap.tap());
+        return m_render.initializeVideoRenderer(m_demux.videoTimebase())
+               && m_audioRender.initializeAudioRenderer(m_demux.audioTimebase(), m_demux.audioCodecParameters());
+    }
+
+    void start()
+    {
+        m_demux.startProcess();
+        m_videoDecode.startProcess();
+        m_audioDecode.startProcess();
+        m_render.startProcess();
+        m_audioRender.startProcess();
+    }
+
+    // 轮询抽头直到视频帧全部送出且音频时钟越过片段末尾
+    bool waitUntilFinished(double endSec, qint64 timeoutMs)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (;;) {
+            m_tap.poll();
+            const AVFrameQueue *frames = m_videoDecode.getFrameQueue();
+            const bool          videoDone = frames->isFinished() && frames->isEmpty() && m_render.isPaused();
+            const double        audioClock = m_sync.audioClock();
+            if (videoDone && !std::isnan(audioClock) && audioClock >= endSec)
+                return true;
+            if (timer.elapsed() > timeoutMs)
+                return false;
+            QThread::usleep(500);
+        }
+    }
+
+    void stop()
+    {
+        m_render.stopProcess();
+        m_audioRender.stopProcess();
+        m_render.wait();
+        m_audioRender.wait();
+        m_audioRender.closeRenderer();
+        m_render.closeRenderer();
+        m_videoDecode.getFrameQueue()->setFinished(true);
+        m_audioDecode.getFrameQueue()->setFinished(true);
+        m_videoDecode.stopProcess();
+        m_audioDecode.stopProcess();
+        m_videoDecode.wait();
+        m_audioDecode.wait();
+        m_demux.videoPacketQueue()->setFinished(true);
+        m_demux.audioPacketQueue()->setFinished(true);
+        m_demux.stopProcess();
+        m_demux.wait();
+    }
+
+    const AVSync           &sync() const { return m_sync; }
+    const CaptureVideoSink &videoSink() const { return *m_videoSink; }
+    const TapOnsetDetector &tones() const { return m_tap; }
+
+private:
+    QElapsedTimer     m_clock;
+    AVSync            m_sync;
+    TapOnsetDetector  m_tap{m_clock};
+    DemuxThread       m_demux;
+    VideoDecodeThread m_videoDecode;
+    AudioDecodeThread m_audioDecode;
+
+    // 输出端与抽头须比输出线程活得久，输出线程持有解码线程帧队列的指针，需先于解码线程析构
+    std::unique_ptr<CaptureVideoSink> m_videoSink;
+    RenderThread                      m_render;
+    AudioRenderThread                 m_audioRender;
+};
+
+/**
+ * @brief 断言结果收集
+ */
+class CheckList
+{
+public:
+    void add(const QString &name, bool passed, const QJsonObject &detail = QJsonObject())
+    {
+        QJsonObject obj = detail;
+        obj["check"] = name;
+        obj["passed"] = passed;
+        m_results.append(obj);
+        m_allPassed &= passed;
+    }
+
+    bool       allPassed() const { return m_allPassed; }
+    QJsonArray results() const { return m_results; }
+
+private:
+    QJsonArray m_results;
+    bool       m_allPassed{true};
+};
+
+void checkPlaythrough(const Manifest &manifest, const Budgets &budgets, CheckList &checks)
+{
+    HeadlessPipeline pipeline;
+    if (!pipeline.open(manifest.path)) {
+        checks.add("open", false);
+        return;
+    }
+    pipeline.start();
+    const bool completed = pipeline.waitFor([&pipeline]() { return pipeline.finished(); }, budgets.timeoutMs);
+    pipeline.stop();
+    checks.add("completed", completed);
+
+    // 首帧耗时
+    const CaptureSinkThread &firstSink = pipeline.hasVideo() ? pipeline.videoSink() : pipeline.audioSink();
+    QJsonObject              ttff;
+    ttff["ms"] = firstSink.firstFrameMs();
+    ttff["budget_ms"] = budgets.ttffBudgetMs;
+    checks.add("time_to_first_frame",
+               firstSink.firstFrameMs() >= 0 && firstSink.firstFrameMs() <= budgets.ttffBudgetMs,
+               ttff);
+
+    // 帧顺序：条码帧号必须从0开始逐一递增，pts严格递增
+    std::vector<double> flashes;
+    if (manifest.hasVideo) {
+        const auto &records = pipeline.videoSink().videoRecords();
+        int         firstBad = -1;
+        for (size_t i = 0; i < records.size() && firstBad < 0; ++i) {
+            bool ordered = records[i].index == static_cast<int>(i);
+            bool monotonic = i == 0 || records[i].pts > records[i - 1].pts;
+            if (!ordered || !monotonic)
+                firstBad = static_cast<int>(i);
+        }
+        for (const VideoRecord &record : records) {
+            if (record.flash)
+                flashes.push_back(record.pts);
+        }
+        QJsonObject order;
+        order["frames"] = static_cast<int>(records.size());
+        order["expected_frames"] = manifest.frames;
+        order["first_bad_position"] = firstBad;
+        if (firstBad >= 0)
+            order["first_bad_index"] = records[firstBad].index;
+        checks.add("frame_order", firstBad < 0 && static_cast<int>(records.size()) == manifest.frames, order);
+    }
+
+    // 时间戳对齐：第k个提示音起点与第k个闪光帧的pts都应落在第k秒
+    if (manifest.hasAudio) {
+        const auto &onsets = pipeline.audioSink().onsets();
+        QJsonObject beeps;
+        beeps["detected"] = static_cast<int>(onsets.size());
+        beeps["expected"] = manifest.beeps;
+        checks.add("audio_tones", static_cast<int>(onsets.size()) == manifest.beeps, beeps);
+
+        if (manifest.hasVideo) {
+            const double tolerance = budgets.syncToleranceMs / 1000.0 + manifest.maxFrameDuration();
+            double       maxError = 0;
+            const size_t pairs = std::min(onsets.size(), flashes.size());
+            for (size_t k = 0; k < pairs; ++k)
+                maxError = std::max(maxError, std::fabs(onsets[k] - flashes[k]));
+            QJsonObject alignment;
+            alignment["pairs"] = static_cast<int>(pairs);
+            alignment["max_error_ms"] = maxError * 1000.0;
+            alignment["tolerance_ms"] = tolerance * 1000.0;
+            checks.add("av_timestamps", pairs > 0 && maxError <= tolerance, alignment);
+        }
+    }
+}
+
+// 按送出的视频帧估计时钟速度：第1秒起的pts跨度除以实际送出时刻的跨度，应为1.0
+double measureClockSpeed(const std::vector<VideoRecord> &records)
+{
+    const auto first = std::find_if(records.begin(), records.end(), [](const VideoRecord &record) {
+        return record.pts >= 1.0;
+    });
+    if (first == records.end() || records.back().shownUs <= first->shownUs)
+        return NAN;
+    const double wallSec = (records.back().shownUs - first->shownUs) / 1000000.0;
+    return (records.back().pts - first->pts) / wallSec;
+}
+
+// 实时播放：真实的 AudioRenderThread 发布音频时钟，RenderThread 按主时钟送帧并发布视频时钟。
+// 主时钟为音频时检查送帧时与音频时钟的偏差，以及第k个闪光帧送出与第k个提示音播出的实际时刻差；
+// 主时钟为视频时检查视频时钟按实际时间匀速前进，送帧的延迟不能逐帧累积成慢放
+void checkClockSync(const Manifest &manifest, const Budgets &budgets, SyncMaster master, CheckList &checks)
+{
+    if (!manifest.hasAudio || !manifest.hasVideo)
+        return;
+
+    const QString    name = master == SyncMaster::Video ? "av_sync_video_master" : "av_sync";
+    RealtimePipeline pipeline;
+    if (!pipeline.open(manifest.path, master, budgets.presentUs)) {
+        checks.add(name, false);
+        return;
+    }
+    pipeline.start();
+    const bool completed = pipeline.waitUntilFinished(manifest.durationMs / 1000.0,
+                                                      budgets.timeoutMs + manifest.durationMs);
+    pipeline.stop();
+
+    const auto         &records = pipeline.videoSink().records();
+    std::vector<qint64> flashUs;
+    for (const VideoRecord &record : records) {
+        if (record.flash)
+            flashUs.push_back(record.shownUs);
+    }
+    // 第0秒的闪光帧在音频时钟建立前就作为起播画面送出，从第1秒起比较
+    const auto  &onsets = pipeline.tones().onsetsUs();
+    const size_t pairs = std::min(onsets.size(), flashUs.size());
+    double       maxDrift = 0;
+    for (size_t k = 1; k < pairs; ++k)
+        maxDrift = std::max(maxDrift, std::fabs(flashUs[k] - onsets[k]) / 1000000.0);
+
+    const double tolerance = budgets.syncToleranceMs / 1000.0 + manifest.maxFrameDuration();
+    const double clockError = pipeline.videoSink().maxClockError();
+    const double speed = measureClockSpeed(records);
+    QJsonObject  detail;
+    detail["completed"] = completed;
+    detail["master"] = static_cast<int>(pipeline.sync().master());
+    detail["frames"] = pipeline.videoSink().frameCount();
+    detail["max_clock_error_ms"] = clockError * 1000.0;
+    detail["pairs"] = static_cast<int>(pairs);
+    detail["max_flash_tone_ms"] = maxDrift * 1000.0;
+    detail["tolerance_ms"] = tolerance * 1000.0;
+    if (!std::isnan(speed))
+        detail["clock_speed"] = speed;
+
+    bool passed = completed && pairs > 1;
+    if (master == SyncMaster::Video) {
+        // 音频以微调重采样比例跟随，偏差只作记录；dummy 驱动的节拍与采样率不完全一致，不检查音频时钟的速度
+        detail["speed_tolerance"] = budgets.clockSpeedTolerance;
+        passed &= !std::isnan(speed) && std::fabs(speed - 1.0) <= budgets.clockSpeedTolerance;
+    } else {
+        passed &= clockError <= tolerance && maxDrift <= tolerance;
+    }
+    checks.add(name, passed, detail);
+}
+
+void checkSeek(const Manifest &manifest, const Budgets &budgets, int percent, CheckList &checks)
+{
+    const int64_t target = static_cast<int64_t>(manifest.durationMs) * percent / 100;
+    const QString name = QString("seek_%1pct").arg(percent);
+
+    HeadlessPipeline pipeline;
+    if (!pipeline.open(manifest.path) || !pipeline.seek(target)) {
+        checks.add(name, false);
+        return;
+    }
+    pipeline.start();
+    const CaptureSinkThread &sink = pipeline.hasVideo() ? pipeline.videoSink() : pipeline.audioSink();
+    const bool landed = pipeline.waitFor([&sink]() { return sink.frameCount() > 0 || sink.isDone(); },
+                                         budgets.timeoutMs);
+    pipeline.stop();
+    if (!landed || sink.frameCount() == 0) {
+        checks.add(name, false);
+        return;
+    }
+
+    // AVSEEK_FLAG_BACKWARD 落在目标之前的关键帧上，误差上限为一个GOP（纯音频取索引粒度）
+    const double tol = budgets.seekToleranceMs;
+    const double errorMs = target - sink.firstPts() * 1000.0;
+    const double windowMs = pipeline.hasVideo() ? manifest.gop * manifest.maxFrameDuration() * 1000.0
+                                                : budgets.audioSeekWindowMs;
+    QJsonObject  detail;
+    detail["target_ms"] = static_cast<qint64>(target);
+    detail["landed_ms"] = sink.firstPts() * 1000.0;
+    detail["window_ms"] = windowMs;
+    bool passed = errorMs >= -tol && errorMs <= windowMs + tol;
+
+    // 恒定帧率下画面内容（条码）必须与pts一致
+    if (pipeline.hasVideo() && !manifest.vfr && manifest.fps > 0) {
+        const VideoRecord &first = sink.videoRecords().front();
+        const int          expected = static_cast<int>(std::lround(first.pts * manifest.fps));
+        detail["frame_index"] = first.index;
+        detail["expected_index"] = expected;
+        passed &= first.index == expected;
+    }
+    checks.add(name, passed, detail);
+}
+
+QJsonObject runClip(const QString &manifestPath, const Budgets &budgets, bool &passed)
+{
+    QJsonObject report;
+    report["manifest"] = manifestPath;
+
+    Manifest  manifest;
+    CheckList checks;
+    if (!manifest.load(manifestPath)) {
+        checks.add("manifest", false);
+    } else {
+        checkPlaythrough(manifest, budgets, checks);
+        checkClockSync(manifest, budgets, SyncMaster::Audio, checks);
+        checkClockSync(manifest, budgets, SyncMaster::Video, checks);
+        for (int percent : {25, 50, 75})
+            checkSeek(manifest, budgets, percent, checks);
+    }
+
+    report["checks"] = checks.results();
+    report["passed"] = checks.allPassed();
+    passed = checks.allPassed();
+    return report;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // 实时播放经 SDL 输出音频，未指定驱动时使用 dummy，校验不依赖声卡
+    if (!qEnvironmentVariableIsSet("SDL_AUDIODRIVER"))
+        qputenv("SDL_AUDIODRIVER", "dummy");
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Deterministic regression checks for the QWaveBox play pipeline");
+    parser.addHelpOption();
+    parser.addPositionalArgument("manifest", "Clip manifest(s) written by qwavebox_mediagen", "[manifest...]");
+    QCommandLineOption suiteOpt("suite", "Check every manifest in <dir>", "dir");
+    QCommandLineOption syncOpt("sync-tolerance-ms", "A/V sync error bound (default 40)", "ms", "40");
+    QCommandLineOption seekOpt("seek-tolerance-ms", "Seek landing slack (default 40)", "ms", "40");
+    QCommandLineOption ttffOpt("ttff-budget-ms", "Time-to-first-frame budget (default 500)", "ms", "500");
+    QCommandLineOption presentOpt("present-ms", "Simulated upload/present cost per video frame (default 5)", "ms", "5");
+    parser.addOptions({suiteOpt, syncOpt, seekOpt, ttffOpt, presentOpt});
+    parser.process(app);
+
+    Budgets budgets;
+    budgets.syncToleranceMs = parser.value(syncOpt).toDouble();
+    budgets.seekToleranceMs = parser.value(seekOpt).toDouble();
+    budgets.ttffBudgetMs = parser.value(ttffOpt).toLongLong();
+    budgets.presentUs = static_cast<int>(parser.value(presentOpt).toDouble() * 1000);
+
+    QStringList manifests = parser.positionalArguments();
+    if (parser.isSet(suiteOpt)) {
+        QDir dir(parser.value(suiteOpt));
+        for (const QString &name : dir.entryList({"*.json"}, QDir::Files, QDir::Name))
+            manifests << dir.filePath(name);
+    }
+    if (manifests.isEmpty())
+        parser.showHelp(1);
+
+    QJsonArray clips;
+    bool       allPassed = true;
+    for (const QString &manifest : manifests) {
+        bool passed = false;
+        clips.append(runClip(manifest, budgets, passed));
+        fprintf(stderr, "%s %s\n", passed ? "PASS" : "FAIL", qPrintable(manifest));
+        allPassed &= passed;
+    }
+
+    QJsonObject report;
+    report["clips"] = clips;
+    report["passed"] = allPassed;
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    fwrite(json.constData(), 1, json.size(), stdout);
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+/**
+ * @brief 队列微基准
+ *
+ * 单生产者/单消费者压测 AVPacketQueue 与 AVFrameQueue，输出吞吐与入队到出队的延迟分布（JSON），
+ * 用于在改动队列实现前后做回归对比。
+ */
+#include "avframequeue.h"
+#include "avpacketqueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now().time_since_epoch()).count();
+}
+
+QJsonObject summarizeNs(std::vector<int64_t> &latencies, int64_t elapsedNs)
+{
+    QJsonObject obj;
+    obj["items"] = static_cast<qint64>(latencies.size());
+    obj["items_per_sec"] = elapsedNs > 0 ? latencies.size() * 1e9 / elapsedNs : 0.0;
+    if (latencies.empty())
+        return obj;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        size_t idx = static_cast<size_t>(p * (latencies.size() - 1) + 0.5);
+        return static_cast<qint64>(latencies[std::min(idx, latencies.size() - 1)]);
+    };
+    QJsonObject lat;
+    lat["p50"] = percentile(0.50);
+    lat["p99"] = percentile(0.99);
+    lat["max"] = static_cast<qint64>(latencies.back());
+    obj["latency_ns"] = lat;
+    return obj;
+}
+
+// 包队列：包的pts字段携带入队时刻
+QJsonObject benchPacketQueue(int items, int capacity, int payload)
+{
+    AVPacketQueue queue(capacity);
+    AVPacket     *templ = av_packet_alloc();
+    av_new_packet(templ, payload);
+
+    std::vector<int64_t> latencies;
+    latencies.reserve(items);
+
+    const int64_t start = nowNs();
+    std::thread   producer([&]() {
+        for (int i = 0; i < items; ++i) {
+            AVPacket *pkt = av_packet_alloc();
+            av_packet_ref(pkt, templ);
+            pkt->pts = nowNs();
+            queue.enqueue(pkt);
+            av_packet_free(&pkt);
+        }
+        queue.setFinished(true);
+    });
+
+    for (;;) {
+        AVPacket *pkt = queue.dequeue(100);
+        if (!pkt) {
+            if (queue.isFinished() && queue.isEmpty())
+                break;
+            continue;
+        }
+        latencies.push_back(nowNs() - pkt->pts);
+        av_packet_free(&pkt);
+    }
+    producer.join();
+    const int64_t elapsed = nowNs() - start;
+
+    av_packet_free(&templ);
+    return summarizeNs(latencies, elapsed);
+}
+
+// 帧队列：模拟1080p YUV420P帧的引用传递
+QJsonObject benchFrameQueue(int items, int capacity)
+{
+    AVFrameQueue queue(capacity);
+    AVFrame     *templ = av_frame_alloc();
+    templ->format = AV_PIX_FMT_YUV420P;
+    templ->width = 1920;
+    templ->height = 1080;
+    av_frame_get_buffer(templ, 0);
+
+    std::vector<int64_t> latencies;
+    latencies.reserve(items);
+
+    const int64_t start = nowNs();
+    std::thread   producer([&]() {
+        for (int i = 0; i < items; ++i) {
+            AVFrame *frame = av_frame_alloc();
+            av_frame_ref(frame, templ);
+            frame->pts = nowNs();
+            queue.enqueue(frame);
+            av_frame_free(&frame);
+        }
+        queue.setFinished(true);
+    });
+
+    for (;;) {
+        AVFrame *frame = queue.dequeue(100);
+        if (!frame) {
+            if (queue.isFinished() && queue.isEmpty())
+                break;
+            continue;
+        }
+        latencies.push_back(nowNs() - frame->pts);
+        av_frame_free(&frame);
+    }
+    producer.join();
+    const int64_t elapsed = nowNs() - start;
+
+    av_frame_free(&templ);
+    return summarizeNs(latencies, elapsed);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Micro-benchmarks for the QWaveBox packet/frame queues");
+    parser.addHelpOption();
+    QCommandLineOption itemsOpt("items", "Items pushed through each queue (default 200000)", "n", "200000");
+    QCommandLineOption capacityOpt("capacity", "Queue capacity (default 100)", "n", "100");
+    parser.addOption(itemsOpt);
+    parser.addOption(capacityOpt);
+    parser.process(app);
+
+    const int items = qMax(1, parser.value(itemsOpt).toInt());
+    const int capacity = qMax(1, parser.value(capacityOpt).toInt());
+
+    QJsonObject report;
+    report["packet_queue"] = benchPacketQueue(items, capacity, 4096);
+    report["frame_queue"] = benchFrameQueue(items, capacity);
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    fwrite(json.constData(), 1, json.size(), stdout);
+    return 0;
+}
@@ -0,0 +1,113 @@
+#ifndef SYNTHETICMEDIA_H
+#define SYNTHETICMEDIA_H
+
+#include <cmath>
+#include <cstdint>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+}
+
+/**
+ * @brief 合成测试素材的约定 - qwavebox_mediagen 写入、qwavebox_playcheck 读回
+ *
+ * 视频：画面上方1/4是16位帧号条码（每位一列，白=1黑=0），每个整秒后的第一帧下方1/4整条置白（闪光标记）；
+ * 音频：每个整秒开始播放一段固定频率的提示音，其余为静音。
+ * 条码与色块都足够大，可经受有损编码。
+ */
+namespace synthetic {
+
+constexpr int    kBarcodeBits = 16;
+constexpr int    kToneHz = 1000;
+constexpr int    kToneMs = 50;
+constexpr double kToneAmplitude = 0.5;
+constexpr double kOnsetThreshold = 0.1;
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr uint8_t kLumaBlack = 16;
+constexpr uint8_t kLumaWhite = 235;
+
+// 在YUV帧的Y平面上绘制帧号条码与闪光标记（U/V平面由调用方填充为中性灰）
+inline void drawMarkers(AVFrame *frame, int index, bool flash)
+{
+    const int bandHeight = frame->height / 4;
+    const int colWidth = frame->width / kBarcodeBits;
+    for (int y = 0; y < frame->height; ++y) {
+        uint8_t *row = frame->data[0] + y * frame->linesize[0];
+        for (int x = 0; x < frame->width; ++x) {
+            uint8_t value = kLumaBlack;
+            if (y < bandHeight) {
+                int bit = x / colWidth;
+                if (bit < kBarcodeBits && ((index >> (kBarcodeBits - 1 - bit)) & 1))
+                    value = kLumaWhite;
+            } else if (y >= frame->height - bandHeight) {
+                value = flash ? kLumaWhite : kLumaBlack;
+            } else {
+                value = 128;
+            }
+            row[x] = value;
+        }
+    }
+}
+
+// 在解码后的帧上采样每一列中心的8x8区域，读回帧号与闪光标记
+inline bool readMarkers(const AVFrame *frame, int &index, bool &flash)
+{
+    if (!frame->data[0] || frame->width < kBarcodeBits * 8 || frame->height < 32)
+        return false;
+
+    auto average = [frame](int cx, int cy) {
+        int sum = 0;
+        for (int y = cy - 4; y < cy + 4; ++y)
+            for (int x = cx - 4; x < cx + 4; ++x)
+                sum += frame->data[0][y * frame->linesize[0] + x];
+        return sum / 64;
+    };
+
+    const int bandHeight = frame->height / 4;
+    const int colWidth = frame->width / kBarcodeBits;
+    index = 0;
+    for (int bit = 0; bit < kBarcodeBits; ++bit) {
+        index <<= 1;
+        if (average(bit * colWidth + colWidth / 2, bandHeight / 2) > 128)
+            index |= 1;
+    }
+    flash = average(frame->width / 2, frame->height - bandHeight / 2) > 128;
+    return true;
+}
+
+// 第n个采样点的提示音取值（秒内偏移 < kToneMs 时为正弦，否则静音）
+inline double toneSample(int64_t n, int sampleRate)
+{
+    int64_t offset = n % sampleRate;
+    if (offset * 1000 >= static_cast<int64_t>(kToneMs) * sampleRate)
+        return 0.0;
+    return kToneAmplitude * std::sin(2.0 * kPi * kToneHz * offset / sampleRate);
+}
+
+// 读取音频帧第0声道第i个采样，归一化到[-1, 1]
+inline double sampleAt(const AVFrame *frame, int i)
+{
+    auto           format = static_cast<AVSampleFormat>(frame->format);
+    const int      stride = av_sample_fmt_is_planar(format) ? 1 : frame->channels;
+    const uint8_t *data = frame->extended_data[0];
+    switch (av_get_packed_sample_fmt(format)) {
+    case AV_SAMPLE_FMT_U8:
+        return (data[i * stride] - 128) / 128.0;
+    case AV_SAMPLE_FMT_S16:
+        return reinterpret_cast<const int16_t *>(data)[i * stride] / 32768.0;
+    case AV_SAMPLE_FMT_S32:
+        return reinterpret_cast<const int32_t *>(data)[i * stride] / 2147483648.0;
+    case AV_SAMPLE_FMT_FLT:
+        return reinterpret_cast<const float *>(data)[i * stride];
+    case AV_SAMPLE_FMT_DBL:
+        return reinterpret_cast<const double *>(data)[i * stride];
+    default:
+        return 0.0;
+    }
+}
+
+} // namespace synthetic
+
+#endif // SYNTHETICMEDIA_H
@@ -0,0 +1,132 @@
+#include "equalizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <QtTest>
+#include <vector>
+
+static constexpr int    kRate = 48000;
+static constexpr int    kChannels = 2;
+static constexpr int    kBlock = 1024;
+static constexpr double kPi = 3.14159265358979323846;
+
+// 送入1秒正弦，等增益渐变与滤波器瞬态结束后，按最后0.25秒的有效值测量该频率上的增益（dB）
+static double measureGainDb(DspStage &stage, double frequency)
+{
+    const int          frames = kRate;
+    std::vector<float> samples(size_t(frames) * kChannels);
+    for (int i = 0; i < frames; ++i) {
+        const float value = float(0.25 * std::sin(2.0 * kPi * frequency * i / kRate));
+        for (int ch = 0; ch < kChannels; ++ch)
+            samples[size_t(i) * kChannels + ch] = value;
+    }
+
+    for (int offset = 0; offset < frames; offset += kBlock) {
+        if (stage.isActive())
+            stage.process(samples.data() + size_t(offset) * kChannels, std::min(kBlock, frames - offset));
+    }
+
+    double    energy = 0.0;
+    const int tail = frames / 4;
+    for (int i = frames - tail; i < frames; ++i) {
+        const double value = samples[size_t(i) * kChannels];
+        energy += value * value;
+    }
+    const double rms = std::sqrt(energy / tail);
+    return 20.0 * std::log10(rms / (0.25 / std::sqrt(2.0)));
+}
+
+static void processSilence(DspStage &stage, int frames)
+{
+    std::vector<float> silence(size_t(kBlock) * kChannels);
+    for (int offset = 0; offset < frames && stage.isActive(); offset += kBlock) {
+        std::fill(silence.begin(), silence.end(), 0.0f);
+        stage.process(silence.data(), kBlock);
+    }
+}
+
+class TestEqualizer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void flatStageIsInactive();
+    void peakingBandResponse_data();
+    void peakingBandResponse();
+    void bassBoostShelf();
+    void preampGain();
+};
+
+void TestEqualizer::flatStageIsInactive()
+{
+    EqualizerStage equalizer;
+    equalizer.prepare(kRate, kChannels);
+    QVERIFY(!equalizer.isActive());
+
+    // 回到0dB且滤波器状态衰减完后重新变为不活动
+    equalizer.setGainDb(5, 6.0f);
+    QVERIFY(equalizer.isActive());
+    measureGainDb(equalizer, 1000.0);
+    equalizer.setGainDb(5, 0.0f);
+    processSilence(equalizer, kRate);
+    QVERIFY(!equalizer.isActive());
+}
+
+void TestEqualizer::peakingBandResponse_data()
+{
+    QTest::addColumn<int>("band");
+    QTest::addColumn<float>("gainDb");
+
+    QTest::newRow("125Hz +6dB") << 2 << 6.0f;
+    QTest::newRow("1kHz +6dB") << 5 << 6.0f;
+    QTest::newRow("1kHz -9dB") << 5 << -9.0f;
+    QTest::newRow("8kHz +12dB") << 8 << 12.0f;
+}
+
+void TestEqualizer::peakingBandResponse()
+{
+    QFETCH(int, band);
+    QFETCH(float, gainDb);
+    const double center = EqualizerStage::kFrequencies[band];
+
+    // 中心频率上为设定增益
+    EqualizerStage atCenter;
+    atCenter.prepare(kRate, kChannels);
+    atCenter.setGainDb(band, gainDb);
+    QVERIFY(std::fabs(measureGainDb(atCenter, center) - gainDb) < 0.2);
+    QCOMPARE(atCenter.gainDb(band), gainDb);
+
+    // 相隔3个倍频程以上几乎不受影响
+    const double far = center >= 1000.0 ? center / 16.0 : center * 16.0;
+    EqualizerStage farAway;
+    farAway.prepare(kRate, kChannels);
+    farAway.setGainDb(band, gainDb);
+    QVERIFY(std::fabs(measureGainDb(farAway, far)) < 0.3);
+}
+
+void TestEqualizer::bassBoostShelf()
+{
+    BassBoostStage low;
+    low.prepare(kRate, kChannels);
+    low.setGainDb(0, 6.0f);
+    QVERIFY(std::fabs(measureGainDb(low, 25.0) - 6.0) < 0.3);
+
+    BassBoostStage high;
+    high.prepare(kRate, kChannels);
+    high.setGainDb(0, 6.0f);
+    QVERIFY(std::fabs(measureGainDb(high, 4000.0)) < 0.1);
+}
+
+void TestEqualizer::preampGain()
+{
+    PreampStage preamp;
+    preamp.prepare(kRate, kChannels);
+    QVERIFY(!preamp.isActive());
+
+    preamp.setGainDb(-6.0f);
+    QVERIFY(std::fabs(measureGainDb(preamp, 440.0) + 6.0) < 0.01);
+}
+
+QTEST_APPLESS_MAIN(TestEqualizer)
+
+#include "tst_equalizer.moc"
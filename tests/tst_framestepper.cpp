@@ -0,0 +1,127 @@
+#include "framestepper.h"
+#include "syntheticmedia.h"
+
+#include <QtTest>
+
+// 素材由 qwavebox_mediagen 生成：4秒、25fps、GOP 12、2个B帧，共100帧，条码即帧号
+static constexpr int    kFps = 25;
+static constexpr int    kFrameCount = 100;
+static constexpr size_t kTinyBudget = 1; // 几乎只保留当前帧与解码器最近输出的帧
+
+// 读回帧上的条码，读不出时返回-1
+static int frameIndex(const AVFrame *frame)
+{
+    int  index = -1;
+    bool flash = false;
+    if (!frame || !synthetic::readMarkers(frame, index, flash))
+        return -1;
+    return index;
+}
+
+class TestFrameStepper : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void seekShowsFrameAtPosition();
+    void stepsForwardAcrossGops();
+    void stepsBackwardAcrossGops();
+    void stopsAtFirstAndLastFrame();
+    void tinyBudgetKeepsOrder();
+
+private:
+    QString m_clip;
+};
+
+void TestFrameStepper::initTestCase()
+{
+    m_clip = qEnvironmentVariable("QWAVEBOX_TEST_CLIP");
+    if (m_clip.isEmpty() || !QFileInfo::exists(m_clip))
+        QSKIP("QWAVEBOX_TEST_CLIP 未设置，需要 qwavebox_mediagen 生成的片段");
+}
+
+void TestFrameStepper::seekShowsFrameAtPosition()
+{
+    FrameStepper stepper;
+    QVERIFY(stepper.open(m_clip));
+
+    // 目标落在两帧之间时显示前一帧
+    QCOMPARE(frameIndex(stepper.seek(1.0)), 25);
+    QCOMPARE(frameIndex(stepper.seek(1.0 + 0.5 / kFps)), 25);
+    QCOMPARE(frameIndex(stepper.seek(1.0 - 0.5 / kFps)), 24);
+    QCOMPARE(frameIndex(stepper.seek(0.0)), 0);
+    QCOMPARE(stepper.currentTime(), 0.0);
+}
+
+void TestFrameStepper::stepsForwardAcrossGops()
+{
+    FrameStepper stepper;
+    QVERIFY(stepper.open(m_clip));
+    QCOMPARE(frameIndex(stepper.seek(0.0)), 0);
+
+    for (int i = 1; i <= 40; ++i)
+        QCOMPARE(frameIndex(stepper.stepForward()), i);
+    QCOMPARE(stepper.currentTime(), 40.0 / kFps);
+}
+
+void TestFrameStepper::stepsBackwardAcrossGops()
+{
+    FrameStepper stepper;
+    QVERIFY(stepper.open(m_clip));
+    QCOMPARE(frameIndex(stepper.seek(2.0)), 50);
+
+    // 每越过一个GOP起点就把前一个GOP整段解码进缓存
+    for (int i = 49; i >= 20; --i)
+        QCOMPARE(frameIndex(stepper.stepBackward()), i);
+
+    // 后退时解码的帧彼此相邻，再前进回去全部命中缓存，不再解码新帧
+    const size_t cached = stepper.cachedFrames();
+    QVERIFY(cached >= 30);
+    for (int i = 21; i <= 50; ++i)
+        QCOMPARE(frameIndex(stepper.stepForward()), i);
+    QCOMPARE(stepper.cachedFrames(), cached);
+
+    stepper.clearCache();
+    QCOMPARE(stepper.cachedFrames(), size_t(0));
+    QCOMPARE(stepper.cachedBytes(), size_t(0));
+}
+
+void TestFrameStepper::stopsAtFirstAndLastFrame()
+{
+    FrameStepper stepper;
+    QVERIFY(stepper.open(m_clip));
+
+    QCOMPARE(frameIndex(stepper.seek(0.0)), 0);
+    QVERIFY(!stepper.stepBackward());
+    QCOMPARE(stepper.currentTime(), 0.0);
+    QCOMPARE(frameIndex(stepper.stepForward()), 1);
+
+    QCOMPARE(frameIndex(stepper.seek(double(kFrameCount - 3) / kFps)), kFrameCount - 3);
+    QCOMPARE(frameIndex(stepper.stepForward()), kFrameCount - 2);
+    QCOMPARE(frameIndex(stepper.stepForward()), kFrameCount - 1);
+    QVERIFY(!stepper.stepForward());
+    QCOMPARE(stepper.currentTime(), double(kFrameCount - 1) / kFps);
+}
+
+void TestFrameStepper::tinyBudgetKeepsOrder()
+{
+    // 预算不足时不断淘汰，相邻关系必须随之失效，步进结果仍按帧号连续
+    FrameStepper stepper(kTinyBudget);
+    QVERIFY(stepper.open(m_clip));
+    QCOMPARE(frameIndex(stepper.seek(0.0)), 0);
+
+    for (int i = 1; i <= 30; ++i) {
+        QCOMPARE(frameIndex(stepper.stepForward()), i);
+        QVERIFY(stepper.cachedFrames() <= 3);
+    }
+    for (int i = 29; i >= 0; --i) {
+        QCOMPARE(frameIndex(stepper.stepBackward()), i);
+        QVERIFY(stepper.cachedFrames() <= 3);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestFrameStepper)
+
+#include "tst_framestepper.moc"
@@ -0,0 +1,150 @@
+#include "pcmring.h"
+
+#include <algorithm>
+#include <cmath>
+#include <QtTest>
+#include <thread>
+#include <vector>
+
+static constexpr int kRate = 48000;
+static constexpr int kChannels = 2;
+
+// 第 frame 帧第 ch 声道的测试值，读回时据此校验顺序
+static float sampleValue(int frame, int ch)
+{
+    return float(frame * kChannels + ch);
+}
+
+static std::vector<float> makeSamples(int first, int frames)
+{
+    std::vector<float> samples(size_t(frames) * kChannels);
+    for (int i = 0; i < frames; ++i)
+        for (int ch = 0; ch < kChannels; ++ch)
+            samples[size_t(i) * kChannels + ch] = sampleValue(first + i, ch);
+    return samples;
+}
+
+class TestPcmRing : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void capacityRoundsUpToPowerOfTwo();
+    void wrapAroundKeepsOrder();
+    void clockFollowsMarks();
+    void discardDropsPendingFrames();
+    void concurrentProducerConsumer();
+};
+
+void TestPcmRing::capacityRoundsUpToPowerOfTwo()
+{
+    PcmRing ring;
+    ring.reset(kRate, kChannels, 100);
+    QCOMPARE(ring.writableFrames(), 128);
+
+    // 写入超出容量的部分被截掉
+    const std::vector<float> samples = makeSamples(0, 200);
+    ring.write(samples.data(), 200, 0.0);
+    QCOMPARE(ring.bufferedFrames(), 128);
+    QCOMPARE(ring.writableFrames(), 0);
+}
+
+void TestPcmRing::wrapAroundKeepsOrder()
+{
+    PcmRing ring;
+    ring.reset(kRate, kChannels, 8);
+
+    std::vector<float> out(16 * kChannels);
+    double             clock = 0.0;
+    int                next = 0;
+    int                expected = 0;
+    for (int round = 0; round < 10; ++round) {
+        const std::vector<float> samples = makeSamples(next, 6);
+        ring.write(samples.data(), 6, NAN);
+        next += 6;
+
+        QCOMPARE(ring.read(out.data(), 6, clock), 6);
+        for (int i = 0; i < 6; ++i, ++expected)
+            for (int ch = 0; ch < kChannels; ++ch)
+                QCOMPARE(out[size_t(i) * kChannels + ch], sampleValue(expected, ch));
+    }
+    QCOMPARE(ring.read(out.data(), 16, clock), 0);
+}
+
+void TestPcmRing::clockFollowsMarks()
+{
+    PcmRing ring;
+    ring.reset(kRate, kChannels, 4096);
+
+    const std::vector<float> samples = makeSamples(0, 480);
+    ring.write(samples.data(), 480, 10.0);
+    double             clock = NAN;
+    std::vector<float> out(480 * kChannels);
+    QCOMPARE(ring.read(out.data(), 240, clock), 240);
+    QCOMPARE(clock, 10.0);
+
+    // 读到标记之后的位置时按采样率外推
+    QCOMPARE(ring.read(out.data(), 240, clock), 240);
+    QVERIFY(std::fabs(clock - (10.0 + 240.0 / kRate)) < 1e-9);
+}
+
+void TestPcmRing::discardDropsPendingFrames()
+{
+    PcmRing ring;
+    ring.reset(kRate, kChannels, 1024);
+
+    const std::vector<float> before = makeSamples(0, 300);
+    ring.write(before.data(), 300, 1.0);
+    ring.discardPending();
+    QCOMPARE(ring.bufferedFrames(), 0);
+
+    // 跳转后的数据带新的时间标记，不沿用跳转前的时间
+    const std::vector<float> after = makeSamples(1000, 100);
+    ring.write(after.data(), 100, 5.0);
+    std::vector<float> out(100 * kChannels);
+    double             clock = NAN;
+    QCOMPARE(ring.read(out.data(), 100, clock), 100);
+    QCOMPARE(clock, 5.0);
+    QCOMPARE(out[0], sampleValue(1000, 0));
+}
+
+void TestPcmRing::concurrentProducerConsumer()
+{
+    static constexpr int kTotal = 200000;
+    PcmRing              ring;
+    ring.reset(kRate, kChannels, 256);
+
+    std::thread producer([&ring]() {
+        int next = 0;
+        while (next < kTotal) {
+            const int frames = std::min({97, kTotal - next, ring.writableFrames()});
+            if (frames <= 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            const std::vector<float> samples = makeSamples(next, frames);
+            ring.write(samples.data(), frames, NAN);
+            next += frames;
+        }
+    });
+
+    std::vector<float> out(61 * kChannels);
+    double             clock = 0.0;
+    int                expected = 0;
+    bool               ordered = true;
+    while (expected < kTotal) {
+        const int got = ring.read(out.data(), 61, clock);
+        if (got == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (int i = 0; i < got; ++i, ++expected)
+            ordered = ordered && out[size_t(i) * kChannels] == sampleValue(expected, 0);
+    }
+    producer.join();
+    QVERIFY(ordered);
+}
+
+QTEST_APPLESS_MAIN(TestPcmRing)
+
+#include "tst_pcmring.moc"
@@ -0,0 +1,105 @@
+#include "searchindex.h"
+
+#include <QtTest>
+
+// 结果中 key 的顺序
+static QStringList keysOf(const SearchIndex::Result &result)
+{
+    QStringList keys;
+    for (const SearchIndex::Hit &hit : result.hits)
+        keys.append(hit.key);
+    return keys;
+}
+
+class TestSearchIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void matchesWordInName();
+    void toleratesOneTypo();
+    void rejectsUnrelatedNames();
+    void everyTermMustMatch();
+    void shortQueryNeedsVerbatimMatch();
+    void pathMatchesRankBelowNameMatches();
+    void removeAndCompact();
+
+private:
+    SearchIndex m_index;
+};
+
+void TestSearchIndex::init()
+{
+    m_index.clear();
+    m_index.insert("/music/pink_floyd_time.flac", "Pink Floyd - Time.flac", "/music");
+    m_index.insert("/music/beethoven_5.mp3", "Beethoven - Symphony No. 5.mp3", "/music/classical");
+    m_index.insert("/music/sympathy.mp3", "Sympathy for the Devil.mp3", "/music/rock");
+    m_index.insert("/video/ovation.mkv", "Ovation Live.mkv", "/video");
+    m_index.insert("/video/floyd_live.mkv", "Live at Pompeii.mkv", "/video/floyd");
+}
+
+void TestSearchIndex::matchesWordInName()
+{
+    const SearchIndex::Result result = m_index.search("time");
+    QVERIFY(result.complete);
+    QCOMPARE(keysOf(result), QStringList{"/music/pink_floyd_time.flac"});
+}
+
+void TestSearchIndex::toleratesOneTypo()
+{
+    // beethovan：7个三元组缺失2个，在允许范围内
+    QCOMPARE(keysOf(m_index.search("beethovan")), QStringList{"/music/beethoven_5.mp3"});
+    QCOMPARE(keysOf(m_index.search("SYMPHONY")), QStringList{"/music/beethoven_5.mp3"});
+}
+
+void TestSearchIndex::rejectsUnrelatedNames()
+{
+    // symphony 与 sympathy 只共有2个三元组
+    QVERIFY(!keysOf(m_index.search("symphony")).contains("/music/sympathy.mp3"));
+    // 两个错字超出容忍范围
+    QVERIFY(m_index.search("beathovan").hits.isEmpty());
+    QVERIFY(m_index.search("zzzzzz").hits.isEmpty());
+}
+
+void TestSearchIndex::everyTermMustMatch()
+{
+    // 每个词分别检查缺失数，一个词命中不能弥补另一个词完全不匹配
+    QVERIFY(m_index.search("beethoven qwerty").hits.isEmpty());
+    QCOMPARE(keysOf(m_index.search("beethoven symphony")), QStringList{"/music/beethoven_5.mp3"});
+}
+
+void TestSearchIndex::shortQueryNeedsVerbatimMatch()
+{
+    QCOMPARE(keysOf(m_index.search("no")), QStringList{"/music/beethoven_5.mp3"});
+    QVERIFY(m_index.search("qx").hits.isEmpty());
+}
+
+void TestSearchIndex::pathMatchesRankBelowNameMatches()
+{
+    const QStringList keys = keysOf(m_index.search("floyd"));
+    QCOMPARE(keys.size(), 2);
+    QCOMPARE(keys.first(), QString("/music/pink_floyd_time.flac"));
+    QCOMPARE(keys.last(), QString("/video/floyd_live.mkv"));
+}
+
+void TestSearchIndex::removeAndCompact()
+{
+    m_index.remove("/music/beethoven_5.mp3");
+    QVERIFY(!m_index.contains("/music/beethoven_5.mp3"));
+    QVERIFY(m_index.search("beethoven").hits.isEmpty());
+
+    // 大量删除触发压缩后，剩余文档仍能查到
+    for (int i = 0; i < 3000; ++i)
+        m_index.insert(QString("/tmp/%1.wav").arg(i), QString("take %1.wav").arg(i), "/tmp");
+    for (int i = 0; i < 3000; ++i)
+        m_index.remove(QString("/tmp/%1.wav").arg(i));
+    QCOMPARE(m_index.size(), 4);
+    QCOMPARE(keysOf(m_index.search("pompeii")), QStringList{"/video/floyd_live.mkv"});
+    QVERIFY(m_index.search("take").hits.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(TestSearchIndex)
+
+#include "tst_searchindex.moc"
@@ -0,0 +1,117 @@
+#include "seqlock.h"
+
+#include <atomic>
+#include <QtTest>
+#include <thread>
+#include <vector>
+
+// 跨越多个64位字的结构体，读到撕裂的数据时各字段不再满足约束
+struct Sample
+{
+    int64_t  serial{0};
+    double   doubled{0.0};
+    int64_t  negated{0};
+    uint32_t tag{0};
+};
+
+static Sample makeSample(int64_t serial)
+{
+    Sample sample;
+    sample.serial = serial;
+    sample.doubled = double(serial) * 2.0;
+    sample.negated = -serial;
+    sample.tag = uint32_t(serial) ^ 0x5a5a5a5au;
+    return sample;
+}
+
+static bool isConsistent(const Sample &sample)
+{
+    return sample.doubled == double(sample.serial) * 2.0 && sample.negated == -sample.serial
+           && sample.tag == (uint32_t(sample.serial) ^ 0x5a5a5a5au);
+}
+
+class TestSeqLock : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void storeAndLoad();
+    void readersNeverSeeTornValues();
+    void concurrentWriters();
+};
+
+void TestSeqLock::storeAndLoad()
+{
+    SeqLock<Sample> lock;
+    QCOMPARE(lock.load().serial, int64_t(0));
+
+    lock.store(makeSample(42));
+    const Sample loaded = lock.load();
+    QCOMPARE(loaded.serial, int64_t(42));
+    QVERIFY(isConsistent(loaded));
+
+    SeqLock<double> value(1.5);
+    QCOMPARE(value.load(), 1.5);
+}
+
+void TestSeqLock::readersNeverSeeTornValues()
+{
+    static constexpr int64_t kWrites = 200000;
+    SeqLock<Sample>          lock(makeSample(0));
+    std::atomic<bool>        done{false};
+    std::atomic<int>         torn{0};
+    std::atomic<int>         backwards{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.emplace_back([&]() {
+            int64_t last = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                const Sample sample = lock.load();
+                if (!isConsistent(sample))
+                    ++torn;
+                // 单个写者时读到的序号不会倒退
+                if (sample.serial < last)
+                    ++backwards;
+                last = sample.serial;
+            }
+        });
+    }
+
+    for (int64_t i = 1; i <= kWrites; ++i)
+        lock.store(makeSample(i));
+    done = true;
+    for (std::thread &reader : readers)
+        reader.join();
+
+    QCOMPARE(torn.load(), 0);
+    QCOMPARE(backwards.load(), 0);
+    QCOMPARE(lock.load().serial, kWrites);
+}
+
+void TestSeqLock::concurrentWriters()
+{
+    static constexpr int64_t kWrites = 50000;
+    SeqLock<Sample>          lock;
+    std::atomic<int>         torn{0};
+
+    // 写者之间互斥：两个写者交错写入时数据仍然完整
+    auto writer = [&](int64_t base) {
+        for (int64_t i = 0; i < kWrites; ++i) {
+            lock.store(makeSample(base + i));
+            if (!isConsistent(lock.load()))
+                ++torn;
+        }
+    };
+    std::thread first(writer, 0);
+    std::thread second(writer, 1000000);
+    first.join();
+    second.join();
+
+    QCOMPARE(torn.load(), 0);
+    QVERIFY(isConsistent(lock.load()));
+}
+
+QTEST_APPLESS_MAIN(TestSeqLock)
+
+#include "tst_seqlock.moc"